@@ -0,0 +1,655 @@
+#include "Cat++_config.h"
+#include "alloc/Cat++_memory_resource.h"
+#include "dev_dependency/Cat++_test/Cat++_PerformanceTest.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <thread>
+#include <vector>
+//分配器基准测试
+/*
+用法：bench_alloc [--threads 1,4] [--sweep-max N] [--only 子串] [--quick] [--counters] [--csv 文件] [--json 文件] [--baseline 文件] [--threshold 百分比]
+对每个AllocatorType × 大小分布 × 场景 × 线程数运行一次Benchmark::run(见Cat++_PerformanceTest.h)，每行输出一项：
+大小分布(每种预先生成SIZE_TABLE个大小，循环取用，计时循环内不调用随机数)：
+- fixed16：全部16字节
+- small：8~128字节
+- medium：128~4K
+- mixed：90% 8~256，9% 256~8K，1% 8K~64K，覆盖线性级、几何级与大块
+- large：32K~256K，超出内存池上限
+场景：
+- churn：每个线程持有WORKING_SET个块，每次操作释放其中一个再按分布分配一个新块(稳定状态的分配/释放)
+- burst：每次操作连续分配BURST个块再全部释放，一次操作计为BURST次分配 + 释放，考察refill与批量归还
+- handoff：线程t分配的块交给线程t + 1释放(环形)，每次操作分配一个块并释放一个收到的块，考察跨线程释放；单线程时交给自己
+分配器：
+- 每个AllocatorType(simple即malloc，default即operator new)
+- std::pmr资源对比：std::pmr的unsynchronized/synchronized_pool_resource、monotonic_buffer_resource
+  与Cat的pool_resource<false>/<true>、arena_resource(见Cat++_memory_resource.h)；非同步的资源只测单线程
+arena与monotonic不逐块释放：churn每轮(WORKING_SET次操作)、burst每次操作后整体回收一次，handoff不适用
+线程扩展性扫描：pool与default(std::allocator即operator new)在1、2、4……N个线程(N默认为硬件线程数，--sweep-max指定)上
+  各跑一遍small、mixed分布的churn与handoff，行名为sweep/场景/分布/分配器，--threads不影响这一组
+--baseline读取之前--csv保存的结果，吞吐下降或p99上升超过阈值时列出并以返回值1退出
+--counters在每行追加每次操作的cycles/instructions/L1d、LLC、dTLB缺失/分支预测失败(perf_event_open)，不可用时显示"-"
+refill策略：pool_fixed_refill与pool_adaptive_refill两种pool_config除Refill(fixed_refill / adaptive_refill)外参数相同，
+  只在mixed分布上跑churn、burst、handoff
+分派方式：dispatch/churn/分布/<分配器>_static直接调用分配器(CRTP静态路径)，_virtual经virtual_allocator与
+  allocator_interface的虚函数调用，两行负载完全相同(pool与simple各一组)
+批量接口：batch/<大小>/pool_batch每次操作用allocate_batch取BURST个16/64/256/1K字节的块、deallocate_batch一次归还，
+  pool_single以逐个allocate/deallocate完成同样的工作，一次操作计为BURST次分配 + 释放
+指针追逐(chase/64/pool_<页来源>)：CHASE_NODES个64字节节点从malloc、mmap、huge三种页来源的pool_allocator分配，
+  按随机排列串成环，每次操作走一步；这一组单独成表并总是统计硬件事件，对比各页来源的dTLB/op
+与LD_PRELOAD=libcat_malloc.so一起运行时，simple(malloc)与default(operator new)两行即为替换后的malloc
+*/
+
+namespace {
+
+using Cat::AllocatorType;
+
+constexpr size_t SIZE_TABLE = 4096;
+constexpr size_t WORKING_SET = 1024;
+constexpr size_t BURST = 256;
+constexpr size_t HANDOFF_CAPACITY = 1024;
+constexpr size_t CHASE_NODES = 1 << 20;          // 64MB，远超4K页下dTLB的覆盖范围
+
+struct size_mix {
+    const char* name;
+    std::vector<size_t> sizes;
+};
+
+// 固定种子的xorshift，生成可重复的大小表
+uint64_t next_random(uint64_t& state) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+size_t uniform(uint64_t& state, size_t low, size_t high) {
+    return low + (size_t)(next_random(state) % (high - low + 1));
+}
+
+std::vector<size_mix> make_mixes() {
+    std::vector<size_mix> mixes;
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    auto build = [&](const char* name, auto pick) {
+        size_mix mix{name, {}};
+        mix.sizes.reserve(SIZE_TABLE);
+        for(size_t i = 0; i < SIZE_TABLE; i++) {
+            mix.sizes.push_back(pick());
+        }
+        mixes.push_back(std::move(mix));
+    };
+    build("fixed16", [] { return size_t(16); });
+    build("small", [&] { return uniform(state, 8, 128); });
+    build("medium", [&] { return uniform(state, 128, 4096); });
+    build("mixed", [&] {
+        uint64_t roll = next_random(state) % 100;
+        if(roll < 90) {
+            return uniform(state, 8, 256);
+        }
+        return roll < 99 ? uniform(state, 256, 8192) : uniform(state, 8192, 65536);
+    });
+    build("large", [&] { return uniform(state, 32768, 262144); });
+    return mixes;
+}
+
+// 分配策略：allocate/deallocate/reset，REGION表示靠reset()整体回收，SHARED表示可以多线程使用
+template<AllocatorType Type>
+struct byte_alloc {
+    using alloc = Cat::alloc_t<std::byte, Type>;
+    static constexpr bool REGION = Type == AllocatorType::ARENA;
+    static constexpr bool SHARED = true;
+
+    static std::byte* allocate(size_t bytes) {
+        std::byte* ptr = alloc().allocate(bytes);
+        if(ptr == nullptr) {
+            fprintf(stderr, "allocation of %zu bytes failed\n", bytes);
+            std::abort();
+        }
+        ptr[0] = std::byte{1};
+        return ptr;
+    }
+    static void deallocate(std::byte* ptr, size_t bytes) { alloc().deallocate(ptr, bytes); }
+    static void reset() {
+        if constexpr (REGION) {
+            Cat::arena::get_default<true>().reset();
+        }
+    }
+};
+
+// 指定Config的内存池：只有refill策略不同的两种配置是两个独立的内存池
+template<class Config>
+struct config_alloc {
+    using alloc = Cat::pool_allocator<true, std::byte, Cat::malloc_page_source, Config>;
+    static constexpr bool REGION = false;
+    static constexpr bool SHARED = true;
+
+    static std::byte* allocate(size_t bytes) {
+        std::byte* ptr = alloc().allocate(bytes);
+        if(ptr == nullptr) {
+            fprintf(stderr, "allocation of %zu bytes failed\n", bytes);
+            std::abort();
+        }
+        ptr[0] = std::byte{1};
+        return ptr;
+    }
+    static void deallocate(std::byte* ptr, size_t bytes) { alloc().deallocate(ptr, bytes); }
+    static void reset() {}
+};
+
+// 同一分配器经virtual_allocator包装后通过allocator_interface的虚函数调用，与byte_alloc的静态(CRTP)路径对比
+template<AllocatorType Type>
+struct virtual_byte_alloc {
+    using alloc = Cat::alloc_t<std::byte, Type>;
+    using interface = Cat::allocator_interface<alloc::thread_safe, std::byte>;
+    static constexpr bool REGION = Type == AllocatorType::ARENA;
+    static constexpr bool SHARED = true;
+
+    // 经volatile指针取得实例，编译器无法得知动态类型，每次调用都是真正的虚调用
+    static interface* instance() {
+        static Cat::virtual_allocator<alloc> wrapped;
+        static interface* volatile pointer = &wrapped;
+        return pointer;
+    }
+    static std::byte* allocate(size_t bytes) {
+        std::byte* ptr = instance()->allocate(bytes);
+        if(ptr == nullptr) {
+            fprintf(stderr, "allocation of %zu bytes failed\n", bytes);
+            std::abort();
+        }
+        ptr[0] = std::byte{1};
+        return ptr;
+    }
+    static void deallocate(std::byte* ptr, size_t bytes) { instance()->deallocate(ptr, bytes); }
+    static void reset() { byte_alloc<Type>::reset(); }
+};
+
+// std::pmr资源：每种资源一个进程内实例
+template<class Resource, bool Region, bool Shared>
+struct resource_alloc {
+    static constexpr bool REGION = Region;
+    static constexpr bool SHARED = Shared;
+
+    static Resource& resource() {
+        static Resource instance;
+        return instance;
+    }
+    static std::byte* allocate(size_t bytes) {
+        std::byte* ptr = static_cast<std::byte*>(resource().allocate(bytes));
+        ptr[0] = std::byte{1};
+        return ptr;
+    }
+    static void deallocate(std::byte* ptr, size_t bytes) { resource().deallocate(ptr, bytes); }
+    static void reset() {
+        if constexpr (Region) {
+            if constexpr (requires(Resource& r) { r.reset(); }) {
+                resource().reset();
+            }
+            else {
+                resource().release();
+            }
+        }
+    }
+};
+
+// 每个线程的状态，按缓存行对齐避免伪共享
+struct alignas(64) thread_state {
+    std::byte* blocks[WORKING_SET] = {};
+    size_t sizes[WORKING_SET] = {};
+    size_t cursor = 0;           // 下一个要替换的块
+    size_t next_size = 0;        // 大小表位置
+};
+
+// 单生产者单消费者的定长环，handoff场景中线程t -> t + 1
+struct alignas(64) handoff_ring {
+    struct entry {
+        std::byte* ptr;
+        size_t bytes;
+    };
+    entry slots[HANDOFF_CAPACITY];
+    alignas(64) std::atomic<size_t> head{0};   // 生产者写
+    alignas(64) std::atomic<size_t> tail{0};   // 消费者写
+
+    bool push(entry value) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if(h - tail.load(std::memory_order_acquire) == HANDOFF_CAPACITY) {
+            return false;
+        }
+        slots[h % HANDOFF_CAPACITY] = value;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+    bool pop(entry& value) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if(t == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = slots[t % HANDOFF_CAPACITY];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+template<class A>
+Cat::TestResult run_churn(const std::string& name, const size_mix& mix, const Cat::BenchmarkConfig& config) {
+    std::unique_ptr<thread_state[]> states(new thread_state[config.threads]);
+    const std::vector<size_t>& sizes = mix.sizes;
+    Cat::TestResult result = Cat::Benchmark::run(name, [&](int thread) {
+        thread_state& state = states[thread];
+        size_t slot = state.cursor;
+        if(state.blocks[slot]) {
+            A::deallocate(state.blocks[slot], state.sizes[slot]);
+        }
+        size_t bytes = sizes[state.next_size++ % SIZE_TABLE];
+        state.blocks[slot] = A::allocate(bytes);
+        state.sizes[slot] = bytes;
+        if(++state.cursor == WORKING_SET) {
+            state.cursor = 0;
+            if constexpr (A::REGION) {
+                A::reset();
+                std::fill(std::begin(state.blocks), std::end(state.blocks), nullptr);
+            }
+        }
+    }, config);
+    // 释放剩余的块：arena/monotonic的块随整体回收，不逐块释放
+    for(int t = 0; t < config.threads; t++) {
+        for(size_t i = 0; i < WORKING_SET; i++) {
+            if(states[t].blocks[i] && !A::REGION) {
+                A::deallocate(states[t].blocks[i], states[t].sizes[i]);
+            }
+        }
+    }
+    return result;
+}
+
+template<class A>
+Cat::TestResult run_burst(const std::string& name, const size_mix& mix, const Cat::BenchmarkConfig& config) {
+    std::unique_ptr<thread_state[]> states(new thread_state[config.threads]);
+    const std::vector<size_t>& sizes = mix.sizes;
+    Cat::TestResult result = Cat::Benchmark::run(name, [&](int thread) {
+        thread_state& state = states[thread];
+        for(size_t i = 0; i < BURST; i++) {
+            size_t bytes = sizes[state.next_size++ % SIZE_TABLE];
+            state.blocks[i] = A::allocate(bytes);
+            state.sizes[i] = bytes;
+        }
+        for(size_t i = 0; i < BURST; i++) {
+            A::deallocate(state.blocks[i], state.sizes[i]);
+        }
+        A::reset();
+    }, config);
+    return result;
+}
+
+template<class A>
+Cat::TestResult run_handoff(const std::string& name, const size_mix& mix, const Cat::BenchmarkConfig& config) {
+    const int threads = config.threads;
+    std::unique_ptr<thread_state[]> states(new thread_state[threads]);
+    std::unique_ptr<handoff_ring[]> rings(new handoff_ring[threads]);    // rings[t]：线程t发往t + 1
+    const std::vector<size_t>& sizes = mix.sizes;
+    Cat::TestResult result = Cat::Benchmark::run(name, [&](int thread) {
+        thread_state& state = states[thread];
+        size_t bytes = sizes[state.next_size++ % SIZE_TABLE];
+        handoff_ring::entry block = {A::allocate(bytes), bytes};
+        if(!rings[thread].push(block)) {
+            A::deallocate(block.ptr, block.bytes);               // 接收方落后：本地释放，不阻塞
+        }
+        handoff_ring::entry received;
+        if(rings[(thread + threads - 1) % threads].pop(received)) {
+            A::deallocate(received.ptr, received.bytes);
+        }
+    }, config);
+    handoff_ring::entry leftover;
+    for(int t = 0; t < threads; t++) {
+        while(rings[t].pop(leftover)) {
+            A::deallocate(leftover.ptr, leftover.bytes);
+        }
+    }
+    return result;
+}
+
+// 批量接口：每次操作取BURST个同样大小的块再全部归还，batch走allocate_batch/deallocate_batch，single逐个调用
+template<bool Batch>
+Cat::TestResult run_batch(const std::string& name, size_t bytes, const Cat::BenchmarkConfig& config) {
+    using alloc = Cat::pool_allocator<true, std::byte>;
+    std::unique_ptr<thread_state[]> states(new thread_state[config.threads]);
+    return Cat::Benchmark::run(name, [&](int thread) {
+        std::byte** blocks = states[thread].blocks;
+        if constexpr (Batch) {
+            if(alloc().allocate_batch(bytes, BURST, blocks) != BURST) {
+                fprintf(stderr, "batch allocation of %zu bytes failed\n", bytes);
+                std::abort();
+            }
+        }
+        else {
+            for(size_t i = 0; i < BURST; i++) {
+                blocks[i] = alloc().allocate(bytes);
+            }
+        }
+        for(size_t i = 0; i < BURST; i++) {
+            blocks[i][0] = std::byte{1};
+        }
+        if constexpr (Batch) {
+            alloc().deallocate_batch(bytes, BURST, blocks);
+        }
+        else {
+            for(size_t i = 0; i < BURST; i++) {
+                alloc().deallocate(blocks[i], bytes);
+            }
+        }
+    }, config);
+}
+
+// 指针追逐：链表节点从内存池分配，按随机排列串成一个环，每次操作沿next走一步
+// 相邻两步几乎总落在不同的页上，dTLB缺失取决于chunk所在页的大小
+struct chase_node {
+    chase_node* next;
+    uint64_t payload[7];         // 凑满64字节，每个节点独占一条缓存行
+};
+
+template<class PageSource>
+Cat::TestResult run_chase(const std::string& name, size_t nodes, const Cat::BenchmarkConfig& config) {
+    using alloc = Cat::pool_allocator<true, chase_node, PageSource>;
+    std::vector<chase_node*> order(nodes);
+    for(chase_node*& node : order) {
+        node = alloc().allocate(1);
+        node->payload[0] = 0;
+    }
+    std::vector<chase_node*> allocated = order;
+    uint64_t state = 0x9E3779B97F4A7C15ull;
+    for(size_t i = nodes - 1; i > 0; i--) {
+        std::swap(order[i], order[next_random(state) % (i + 1)]);
+    }
+    for(size_t i = 0; i < nodes; i++) {
+        order[i]->next = order[(i + 1) % nodes];
+    }
+    chase_node* cursor = order[0];
+    Cat::TestResult result = Cat::Benchmark::run(name, [&] {
+        cursor = cursor->next;
+        Cat::doNotOptimize(cursor);
+    }, config);
+    for(chase_node* node : allocated) {
+        alloc().deallocate(node, 1);
+    }
+    Cat::alloc_pool<true, PageSource>::trim();
+    return result;
+}
+
+struct options {
+    std::vector<int> threads = {1, 4};
+    int sweep_max = 0;            // 线程扩展性扫描的上限，0表示硬件线程数
+    std::string only;
+    std::string csv;
+    std::string json;
+    std::string baseline;
+    double threshold = 5.0;
+    bool quick = false;
+    bool counters = false;
+};
+
+Cat::BenchmarkConfig make_config(int threads, const options& opts) {
+    Cat::BenchmarkConfig config;
+    config.threads = threads;
+    config.hardwareCounters = opts.counters;
+    if(opts.quick) {
+        config.warmupMs = 10;
+        config.durationMs = 50;
+        config.latencyMs = 30;
+        config.latencyOps = 20000;
+    }
+    return config;
+}
+
+bool selected(const std::string& name, const options& opts) {
+    return opts.only.empty() || name.find(opts.only) != std::string::npos;
+}
+
+void record(Cat::TestResult result, const options& opts, std::vector<Cat::TestResult>& results) {
+    result.printRow(opts.counters);
+    fflush(stdout);
+    results.push_back(std::move(result));
+}
+
+template<class A>
+Cat::TestResult run_scenario(const char* scenario, const std::string& name, const size_mix& mix, const Cat::BenchmarkConfig& config) {
+    return strcmp(scenario, "churn") == 0 ? run_churn<A>(name, mix, config)
+         : strcmp(scenario, "burst") == 0 ? run_burst<A>(name, mix, config)
+         : run_handoff<A>(name, mix, config);
+}
+
+template<class A>
+void run_allocator(const char* allocator, const std::vector<size_mix>& mixes, const options& opts, std::vector<Cat::TestResult>& results) {
+    for(int threads : opts.threads) {
+        if(threads > 1 && !A::SHARED) {
+            continue;
+        }
+        Cat::BenchmarkConfig config = make_config(threads, opts);
+        for(const size_mix& mix : mixes) {
+            const char* scenarios[] = {"churn", "burst", "handoff"};
+            for(const char* scenario : scenarios) {
+                std::string name = std::string(scenario) + "/" + mix.name + "/" + allocator;
+                if(!selected(name, opts)) {
+                    continue;
+                }
+                if(strcmp(scenario, "handoff") == 0 && A::REGION) {
+                    continue;
+                }
+                record(run_scenario<A>(scenario, name, mix, config), opts, results);
+            }
+        }
+    }
+}
+
+// 静态与虚函数分派：同一分配器、同一churn负载，行名为dispatch/churn/分布/分配器_static或_virtual
+template<AllocatorType Type>
+void run_dispatch(const char* allocator, const std::vector<size_mix>& mixes, const options& opts, std::vector<Cat::TestResult>& results) {
+    for(int threads : opts.threads) {
+        Cat::BenchmarkConfig config = make_config(threads, opts);
+        for(const size_mix& mix : mixes) {
+            std::string name = std::string("dispatch/churn/") + mix.name + "/" + allocator;
+            if(selected(name + "_static", opts)) {
+                record(run_churn<byte_alloc<Type>>(name + "_static", mix, config), opts, results);
+            }
+            if(selected(name + "_virtual", opts)) {
+                record(run_churn<virtual_byte_alloc<Type>>(name + "_virtual", mix, config), opts, results);
+            }
+        }
+    }
+}
+
+// 批量与逐个：行名为batch/块大小/pool_batch或pool_single
+void run_batches(const options& opts, std::vector<Cat::TestResult>& results) {
+    const size_t sizes[] = {16, 64, 256, 1024};
+    for(int threads : opts.threads) {
+        Cat::BenchmarkConfig config = make_config(threads, opts);
+        for(size_t bytes : sizes) {
+            std::string name = "batch/" + std::to_string(bytes) + "/pool_";
+            if(selected(name + "single", opts)) {
+                record(run_batch<false>(name + "single", bytes, config), opts, results);
+            }
+            if(selected(name + "batch", opts)) {
+                record(run_batch<true>(name + "batch", bytes, config), opts, results);
+            }
+        }
+    }
+}
+
+// 线程扩展性：1、2、4……直到上限(默认硬件线程数)
+std::vector<int> sweep_threads(int max_threads) {
+    if(max_threads <= 0) {
+        max_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::vector<int> counts;
+    for(int t = 1; t < max_threads; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(max_threads);
+    return counts;
+}
+
+// 在给定线程数上跑churn与handoff(small、mixed)，行名为sweep/场景/分布/分配器
+template<class A>
+void run_sweep(const char* allocator, int threads, const std::vector<size_mix>& mixes, const options& opts, std::vector<Cat::TestResult>& results) {
+    Cat::BenchmarkConfig config = make_config(threads, opts);
+    for(const size_mix& mix : mixes) {
+        if(strcmp(mix.name, "small") != 0 && strcmp(mix.name, "mixed") != 0) {
+            continue;
+        }
+        const char* scenarios[] = {"churn", "handoff"};
+        for(const char* scenario : scenarios) {
+            std::string name = std::string("sweep/") + scenario + "/" + mix.name + "/" + allocator;
+            if(selected(name, opts)) {
+                record(run_scenario<A>(scenario, name, mix, config), opts, results);
+            }
+        }
+    }
+}
+
+std::vector<int> parse_threads(const char* text) {
+    std::vector<int> threads;
+    for(const char* p = text; *p;) {
+        int value = atoi(p);
+        if(value > 0) {
+            threads.push_back(value);
+        }
+        const char* comma = strchr(p, ',');
+        if(comma == nullptr) {
+            break;
+        }
+        p = comma + 1;
+    }
+    return threads;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    options opts;
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(strcmp(arg, "--threads") == 0 && has_value) {
+            opts.threads = parse_threads(argv[++i]);
+        }
+        else if(strcmp(arg, "--sweep-max") == 0 && has_value) {
+            opts.sweep_max = atoi(argv[++i]);
+        }
+        else if(strcmp(arg, "--only") == 0 && has_value) {
+            opts.only = argv[++i];
+        }
+        else if(strcmp(arg, "--csv") == 0 && has_value) {
+            opts.csv = argv[++i];
+        }
+        else if(strcmp(arg, "--json") == 0 && has_value) {
+            opts.json = argv[++i];
+        }
+        else if(strcmp(arg, "--baseline") == 0 && has_value) {
+            opts.baseline = argv[++i];
+        }
+        else if(strcmp(arg, "--threshold") == 0 && has_value) {
+            opts.threshold = atof(argv[++i]);
+        }
+        else if(strcmp(arg, "--quick") == 0) {
+            opts.quick = true;
+        }
+        else if(strcmp(arg, "--counters") == 0) {
+            opts.counters = true;
+        }
+        else {
+            fprintf(stderr, "usage: %s [--threads 1,4] [--sweep-max n] [--only substring] [--quick] [--counters] [--csv file] [--json file] "
+                            "[--baseline file] [--threshold pct]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(opts.threads.empty()) {
+        opts.threads = {1};
+    }
+
+    std::vector<size_mix> mixes = make_mixes();
+    std::vector<Cat::TestResult> results;
+    Cat::TestResult::printRowHeader(opts.counters);
+    run_allocator<byte_alloc<AllocatorType::DEFAULT>>("default", mixes, opts, results);
+    run_allocator<byte_alloc<AllocatorType::SIMPLE>>("simple", mixes, opts, results);
+    run_allocator<byte_alloc<AllocatorType::POOL>>("pool", mixes, opts, results);
+    run_allocator<byte_alloc<AllocatorType::POOL_SIMD>>("pool_simd", mixes, opts, results);
+    run_allocator<byte_alloc<AllocatorType::POOL_TINY>>("pool_tiny", mixes, opts, results);
+    run_allocator<byte_alloc<AllocatorType::ARENA>>("arena", mixes, opts, results);
+
+    run_allocator<resource_alloc<std::pmr::unsynchronized_pool_resource, false, false>>("pmr_std_unsync", mixes, opts, results);
+    run_allocator<resource_alloc<std::pmr::synchronized_pool_resource, false, true>>("pmr_std_sync", mixes, opts, results);
+    run_allocator<resource_alloc<std::pmr::monotonic_buffer_resource, true, false>>("pmr_std_monotonic", mixes, opts, results);
+    run_allocator<resource_alloc<Cat::unsynchronized_pool_resource, false, false>>("pmr_cat_unsync", mixes, opts, results);
+    run_allocator<resource_alloc<Cat::synchronized_pool_resource, false, true>>("pmr_cat_sync", mixes, opts, results);
+    run_allocator<resource_alloc<Cat::arena_resource, true, false>>("pmr_cat_arena", mixes, opts, results);
+
+    // refill策略：两种pool_config只有Refill不同，在mixed分布上对比
+    std::vector<size_mix> mixed_only;
+    std::copy_if(mixes.begin(), mixes.end(), std::back_inserter(mixed_only),
+                 [](const size_mix& mix) { return strcmp(mix.name, "mixed") == 0; });
+    run_allocator<config_alloc<Cat::pool_config<8, 128, 32 * 1024, 8, 20, Cat::fixed_refill>>>("pool_fixed_refill", mixed_only, opts, results);
+    run_allocator<config_alloc<Cat::pool_config<8, 128, 32 * 1024, 8, 20, Cat::adaptive_refill>>>("pool_adaptive_refill", mixed_only, opts, results);
+
+    // 静态(CRTP)与虚函数(virtual_allocator)分派的对比
+    run_dispatch<AllocatorType::POOL>("pool", mixes, opts, results);
+    run_dispatch<AllocatorType::SIMPLE>("simple", mixes, opts, results);
+
+    // allocate_batch/deallocate_batch与逐个调用的对比
+    run_batches(opts, results);
+
+    // 指针追逐：同一链表分别放在malloc、mmap、大页三种页来源的内存池里，总是统计硬件事件(看dTLB/op)
+    Cat::BenchmarkConfig chase_config = make_config(1, opts);
+    chase_config.hardwareCounters = true;
+    size_t chase_nodes = opts.quick ? CHASE_NODES / 4 : CHASE_NODES;
+    std::vector<Cat::TestResult> chase_results;
+    auto chase = [&](const char* source, auto run) {
+        std::string name = std::string("chase/64/pool_") + source;
+        if(selected(name, opts)) {
+            chase_results.push_back(run(name, chase_nodes, chase_config));
+        }
+    };
+    chase("malloc", run_chase<Cat::malloc_page_source>);
+#if CAT_HAS_MMAP
+    chase("mmap", run_chase<Cat::mmap_page_source>);
+    chase("huge", run_chase<Cat::huge_page_source>);
+#endif
+    if(!chase_results.empty()) {
+        printf("\n");
+        Cat::TestResult::printRowHeader(true);
+        for(Cat::TestResult& result : chase_results) {
+            result.printRow(true);
+            results.push_back(std::move(result));
+        }
+        printf("\n");
+        Cat::TestResult::printRowHeader(opts.counters);
+    }
+
+    // 线程扩展性扫描：内存池与std::allocator(operator new)在1~N个线程上的对比
+    for(int threads : sweep_threads(opts.sweep_max)) {
+        run_sweep<byte_alloc<AllocatorType::DEFAULT>>("default", threads, mixes, opts, results);
+        run_sweep<byte_alloc<AllocatorType::POOL>>("pool", threads, mixes, opts, results);
+    }
+
+    if(!opts.csv.empty()) {
+        Cat::saveCsv(opts.csv, results);
+    }
+    if(!opts.json.empty()) {
+        Cat::saveJson(opts.json, results);
+    }
+    if(!opts.baseline.empty()) {
+        Cat::BenchmarkBaseline baseline;
+        if(!baseline.load(opts.baseline)) {
+            return 2;
+        }
+        printf("\n");
+        int regressions = baseline.compare(results, opts.threshold);
+        printf("%d regression(s) beyond %.1f%%\n", regressions, opts.threshold);
+        return regressions ? 1 : 0;
+    }
+    return 0;
+}
@@ -0,0 +1,270 @@
+#include "algorithm/Cat++_parallel_algorithm.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+//并行算法扩展性基准测试
+/*
+用法：bench_parallel [--sizes 1e6,1e7] [--threads 1,2,4] [--runs R] [--only 子串] [--quick] [--csv 文件]
+每个规模 × 算法先测串行的std::版本，再在1~N个工作线程的thread_pool上测Cat::parallel_*，取RUNS次的中位数：
+- sort：parallel_sort对比std::sort(随机uint64，每次从原始数据拷贝，拷贝不计时)
+- for_each：原地做一次整数混合(mix)，对比std::for_each
+- transform：out[i] = mix(in[i])，对比std::transform
+- reduce：求和，对比std::reduce
+- scan：前缀和，对比std::inclusive_scan
+默认线程数为1、2、4……直到硬件线程数；规模可到1e9(输入与输出各8GB，另加排序的原始数据与归并缓冲区，需确认内存充足)
+每行输出：耗时(毫秒)、每元素纳秒、相对串行的加速比；并行结果与串行结果不一致时报错并返回1
+*/
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+struct options {
+    std::vector<size_t> sizes = {1000000, 10000000};
+    std::vector<unsigned> threads;
+    int runs = 5;
+    std::string only;
+    std::string csv;
+};
+
+struct row {
+    std::string name;
+    size_t size;
+    unsigned threads;                  // 0表示串行版本
+    double ms;
+    double speedup;
+};
+
+struct workload {
+    std::vector<uint64_t> input;       // 原始数据，不修改
+    std::vector<uint64_t> data;        // 每次运行前从input恢复
+    std::vector<uint64_t> output;
+};
+
+// 运行runs次取中位数(毫秒)，prepare不计时
+template<typename Prepare, typename Body>
+double measure(int runs, Prepare prepare, Body body) {
+    std::vector<double> times;
+    for(int r = 0; r < runs; r++) {
+        prepare();
+        clock_type::time_point begin = clock_type::now();
+        body();
+        times.push_back(std::chrono::duration<double, std::milli>(clock_type::now() - begin).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// 一种算法：serial与parallel各自运行并返回结果摘要，摘要不一致视为错误
+struct algorithm_case {
+    const char* name;
+    bool restore;                      // 每次运行前把data恢复为input
+    uint64_t (*serial)(workload&);
+    uint64_t (*parallel)(Cat::thread_pool&, workload&);
+};
+
+const algorithm_case CASES[] = {
+    {"sort", true,
+     [](workload& w) {
+         std::sort(w.data.begin(), w.data.end());
+         return w.data[w.data.size() / 2] ^ w.data.back();
+     },
+     [](Cat::thread_pool& pool, workload& w) {
+         Cat::parallel_sort(pool, w.data.begin(), w.data.end());
+         return w.data[w.data.size() / 2] ^ w.data.back();
+     }},
+    {"for_each", true,
+     [](workload& w) {
+         std::for_each(w.data.begin(), w.data.end(), [](uint64_t& x) { x = mix(x); });
+         return w.data.front() ^ w.data.back();
+     },
+     [](Cat::thread_pool& pool, workload& w) {
+         Cat::parallel_for_each(pool, w.data.begin(), w.data.end(), [](uint64_t& x) { x = mix(x); });
+         return w.data.front() ^ w.data.back();
+     }},
+    {"transform", false,
+     [](workload& w) {
+         std::transform(w.input.begin(), w.input.end(), w.output.begin(), mix);
+         return w.output.front() ^ w.output.back();
+     },
+     [](Cat::thread_pool& pool, workload& w) {
+         Cat::parallel_transform(pool, w.input.begin(), w.input.end(), w.output.begin(), mix);
+         return w.output.front() ^ w.output.back();
+     }},
+    {"reduce", false,
+     [](workload& w) {
+         return std::reduce(w.input.begin(), w.input.end(), uint64_t(0));
+     },
+     [](Cat::thread_pool& pool, workload& w) {
+         return Cat::parallel_reduce(pool, w.input.begin(), w.input.end(), uint64_t(0));
+     }},
+    {"scan", false,
+     [](workload& w) {
+         std::inclusive_scan(w.input.begin(), w.input.end(), w.output.begin());
+         return w.output[w.output.size() / 2] ^ w.output.back();
+     },
+     [](Cat::thread_pool& pool, workload& w) {
+         Cat::parallel_inclusive_scan(pool, w.input.begin(), w.input.end(), w.output.begin());
+         return w.output[w.output.size() / 2] ^ w.output.back();
+     }},
+};
+
+void print_row(const row& r) {
+    char threads[16];
+    if(r.threads == 0) {
+        snprintf(threads, sizeof(threads), "serial");
+    }
+    else {
+        snprintf(threads, sizeof(threads), "%u", r.threads);
+    }
+    printf("%-10s %12zu %7s %12.2f %10.3f %8.2fx\n", r.name.c_str(), r.size, threads, r.ms,
+           r.ms * 1e6 / (double)r.size, r.speedup);
+    fflush(stdout);
+}
+
+bool save_csv(const std::string& path, const std::vector<row>& rows) {
+    FILE* out = fopen(path.c_str(), "w");
+    if(out == nullptr) {
+        fprintf(stderr, "cannot write %s\n", path.c_str());
+        return false;
+    }
+    fprintf(out, "name,size,threads,ms,ns_per_element,speedup\n");
+    for(const row& r : rows) {
+        fprintf(out, "%s,%zu,%u,%.3f,%.4f,%.3f\n", r.name.c_str(), r.size, r.threads, r.ms,
+                r.ms * 1e6 / (double)r.size, r.speedup);
+    }
+    fclose(out);
+    return true;
+}
+
+template<typename T>
+std::vector<T> parse_list(const char* text) {
+    std::vector<T> values;
+    for(const char* p = text; *p;) {
+        double value = strtod(p, nullptr);              // 接受1e6这样的写法
+        if(value >= 1) {
+            values.push_back((T)value);
+        }
+        const char* comma = strchr(p, ',');
+        if(comma == nullptr) {
+            break;
+        }
+        p = comma + 1;
+    }
+    return values;
+}
+
+std::vector<unsigned> default_threads() {
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for(unsigned t = 1; t < hardware; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(hardware);
+    return counts;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    options opts;
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(strcmp(arg, "--sizes") == 0 && has_value) {
+            opts.sizes = parse_list<size_t>(argv[++i]);
+        }
+        else if(strcmp(arg, "--threads") == 0 && has_value) {
+            opts.threads = parse_list<unsigned>(argv[++i]);
+        }
+        else if(strcmp(arg, "--runs") == 0 && has_value) {
+            opts.runs = std::max(1, atoi(argv[++i]));
+        }
+        else if(strcmp(arg, "--only") == 0 && has_value) {
+            opts.only = argv[++i];
+        }
+        else if(strcmp(arg, "--csv") == 0 && has_value) {
+            opts.csv = argv[++i];
+        }
+        else if(strcmp(arg, "--quick") == 0) {
+            opts.sizes = {1000000};
+            opts.runs = 3;
+        }
+        else {
+            fprintf(stderr, "usage: %s [--sizes 1e6,1e7] [--threads 1,2,4] [--runs r] [--only substring] [--quick] [--csv file]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(opts.threads.empty()) {
+        opts.threads = default_threads();
+    }
+
+    // 各线程数的线程池先建好，空闲的工作线程会进入休眠，不干扰计时
+    std::vector<std::unique_ptr<Cat::thread_pool>> pools;
+    for(unsigned t : opts.threads) {
+        pools.push_back(std::make_unique<Cat::thread_pool>(t));
+    }
+
+    std::vector<row> rows;
+    bool mismatch = false;
+    printf("%-10s %12s %7s %12s %10s %9s\n", "algorithm", "n", "threads", "ms", "ns/elem", "speedup");
+    for(size_t n : opts.sizes) {
+        workload w;
+        w.input.resize(n);
+        std::mt19937_64 rng(n);
+        for(uint64_t& x : w.input) {
+            x = rng();
+        }
+        w.data.resize(n);
+        w.output.resize(n);
+
+        for(const algorithm_case& c : CASES) {
+            if(!opts.only.empty() && std::string(c.name).find(opts.only) == std::string::npos) {
+                continue;
+            }
+            auto prepare = [&] {
+                if(c.restore) {
+                    std::copy(w.input.begin(), w.input.end(), w.data.begin());
+                }
+            };
+            uint64_t expected = 0;
+            double serial_ms = measure(opts.runs, prepare, [&] { expected = c.serial(w); });
+            rows.push_back({c.name, n, 0, serial_ms, 1.0});
+            print_row(rows.back());
+
+            for(std::unique_ptr<Cat::thread_pool>& pool : pools) {
+                uint64_t result = 0;
+                double ms = measure(opts.runs, prepare, [&] { result = c.parallel(*pool, w); });
+                if(result != expected) {
+                    fprintf(stderr, "%s n=%zu threads=%zu: result differs from serial version\n", c.name, n, pool->size());
+                    mismatch = true;
+                }
+                rows.push_back({c.name, n, (unsigned)pool->size(), ms, ms > 0 ? serial_ms / ms : 0});
+                print_row(rows.back());
+            }
+        }
+    }
+
+    if(!opts.csv.empty()) {
+        save_csv(opts.csv, rows);
+    }
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,317 @@
+#include "container/Cat++_mpmc_queue.h"
+#include "container/Cat++_spsc_ring.h"
+#include "dev_dependency/Cat++_test/Cat++_PerformanceTest.h"
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+//线程间队列基准测试
+/*
+用法：bench_queue [--pairs 1x1,2x2,4x4,1x4,4x1] [--items N] [--only 子串] [--quick] [--csv 文件]
+P个生产者共发送items条消息，C个消费者取完为止，每种队列 × 批量(1与BATCH) × PxC运行RUNS次，取吞吐的中位数：
+- mutex：std::mutex保护的std::queue(现有流水线的做法)，批量时一次加锁处理整批
+- mpmc：Cat::mpmc_queue(有界数组，容量CAPACITY)
+- linked：Cat::linked_mpmc_queue(无界链表，节点来自pool_allocator<true>)
+- spsc：Cat::spsc_ring(容量CAPACITY)，只测1x1
+消息带入队时刻，消费者取出时记录端到端延迟(含排队时间，填入LatencyHistogram)；
+队列满或空时让出CPU(yield)，线程数超过核数时仍能推进
+每行输出：吞吐(条/秒)、每条耗时、端到端延迟分位数
+*/
+
+namespace {
+
+constexpr size_t CAPACITY = 1024;
+constexpr size_t BATCH = 32;
+
+struct message {
+    int64_t stamp;                     // 入队时刻(纳秒)
+    uint64_t sequence;
+};
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 队列适配：push/pop按批量处理，返回成功的条数
+struct mutex_queue {
+    static constexpr const char* NAME = "mutex";
+    static constexpr bool SPSC_ONLY = false;
+
+    std::mutex mutex;
+    std::queue<message> queue;
+
+    size_t push(const message* items, size_t count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for(size_t i = 0; i < count; i++) {
+            queue.push(items[i]);
+        }
+        return count;
+    }
+    size_t pop(message* out, size_t max_count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t n = 0;
+        while(n < max_count && !queue.empty()) {
+            out[n++] = queue.front();
+            queue.pop();
+        }
+        return n;
+    }
+};
+
+struct bounded_queue {
+    static constexpr const char* NAME = "mpmc";
+    static constexpr bool SPSC_ONLY = false;
+
+    Cat::mpmc_queue<message> queue{CAPACITY};
+
+    size_t push(const message* items, size_t count) {
+        return count == 1 ? (queue.try_push(items[0]) ? 1 : 0) : queue.try_push_batch(items, count);
+    }
+    size_t pop(message* out, size_t max_count) {
+        return max_count == 1 ? (queue.try_pop(out[0]) ? 1 : 0) : queue.try_pop_batch(out, max_count);
+    }
+};
+
+struct linked_queue {
+    static constexpr const char* NAME = "linked";
+    static constexpr bool SPSC_ONLY = false;
+
+    Cat::linked_mpmc_queue<message> queue;
+
+    size_t push(const message* items, size_t count) {
+        if(count == 1) {
+            queue.push(items[0]);
+        }
+        else {
+            queue.push_batch(items, count);
+        }
+        return count;
+    }
+    size_t pop(message* out, size_t max_count) {
+        return max_count == 1 ? (queue.try_pop(out[0]) ? 1 : 0) : queue.try_pop_batch(out, max_count);
+    }
+};
+
+struct ring_queue {
+    static constexpr const char* NAME = "spsc";
+    static constexpr bool SPSC_ONLY = true;
+
+    Cat::spsc_ring<message> queue{CAPACITY};
+
+    size_t push(const message* items, size_t count) {
+        return count == 1 ? (queue.try_push(items[0]) ? 1 : 0) : queue.try_push_batch(items, count);
+    }
+    size_t pop(message* out, size_t max_count) {
+        return max_count == 1 ? (queue.try_pop(out[0]) ? 1 : 0) : queue.try_pop_batch(out, max_count);
+    }
+};
+
+struct run_result {
+    double messages_per_sec;
+    Cat::LatencyHistogram latency;
+};
+
+// 一轮：producers个线程共发送items条，consumers个线程取完
+template<class Q>
+run_result run_once(int producers, int consumers, size_t items, size_t batch) {
+    Q q;
+    std::barrier start(producers + consumers + 1);
+    std::atomic<size_t> consumed{0};
+    std::vector<Cat::LatencyHistogram> latency(consumers);
+    std::vector<std::thread> threads;
+
+    for(int p = 0; p < producers; p++) {
+        size_t quota = items / producers + ((size_t)p < items % producers ? 1 : 0);
+        threads.emplace_back([&, quota] {
+            message buffer[BATCH];
+            start.arrive_and_wait();
+            for(size_t sent = 0; sent < quota;) {
+                size_t n = std::min(batch, quota - sent);
+                int64_t stamp = now_ns();
+                for(size_t i = 0; i < n; i++) {
+                    buffer[i] = {stamp, sent + i};
+                }
+                for(size_t done = 0; done < n;) {
+                    size_t pushed = q.push(buffer + done, n - done);
+                    if(pushed == 0) {
+                        std::this_thread::yield();
+                    }
+                    done += pushed;
+                }
+                sent += n;
+            }
+        });
+    }
+    for(int c = 0; c < consumers; c++) {
+        threads.emplace_back([&, c] {
+            message buffer[BATCH];
+            Cat::LatencyHistogram& histogram = latency[c];
+            start.arrive_and_wait();
+            while(consumed.load(std::memory_order_relaxed) < items) {
+                size_t n = q.pop(buffer, batch);
+                if(n == 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                int64_t now = now_ns();
+                for(size_t i = 0; i < n; i++) {
+                    histogram.record((uint64_t)std::max<int64_t>(0, now - buffer[i].stamp));
+                }
+                consumed.fetch_add(n, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    start.arrive_and_wait();
+    int64_t begin = now_ns();
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+    int64_t elapsed = now_ns() - begin;
+
+    run_result result;
+    result.messages_per_sec = elapsed > 0 ? (double)items * 1e9 / (double)elapsed : 0;
+    for(const Cat::LatencyHistogram& histogram : latency) {
+        result.latency.merge(histogram);
+    }
+    return result;
+}
+
+struct options {
+    std::vector<std::pair<int, int>> pairs = {{1, 1}, {2, 2}, {4, 4}, {1, 4}, {4, 1}};
+    size_t items = 2000000;
+    int runs = 3;
+    std::string only;
+    std::string csv;
+};
+
+struct row {
+    std::string name;
+    int producers;
+    int consumers;
+    size_t batch;
+    double messages_per_sec;
+    uint64_t p50, p90, p99, p999, max;
+};
+
+template<class Q>
+void run_queue(const options& opts, std::vector<row>& rows) {
+    for(auto [producers, consumers] : opts.pairs) {
+        if(Q::SPSC_ONLY && (producers != 1 || consumers != 1)) {
+            continue;
+        }
+        for(size_t batch : {size_t(1), BATCH}) {
+            std::string name = std::string(Q::NAME) + (batch > 1 ? "/b" + std::to_string(batch) : "");
+            std::string label = name + "/" + std::to_string(producers) + "x" + std::to_string(consumers);
+            if(!opts.only.empty() && label.find(opts.only) == std::string::npos) {
+                continue;
+            }
+            // 预热一轮(分配线程缓存、链表节点)，不计入结果
+            run_once<Q>(producers, consumers, opts.items / 10, batch);
+            std::vector<run_result> runs;
+            for(int r = 0; r < opts.runs; r++) {
+                runs.push_back(run_once<Q>(producers, consumers, opts.items, batch));
+            }
+            std::sort(runs.begin(), runs.end(), [](const run_result& a, const run_result& b) {
+                return a.messages_per_sec < b.messages_per_sec;
+            });
+            const run_result& median = runs[runs.size() / 2];
+            row result = {name, producers, consumers, batch, median.messages_per_sec,
+                          median.latency.percentile(0.5), median.latency.percentile(0.9), median.latency.percentile(0.99),
+                          median.latency.percentile(0.999), median.latency.max()};
+            printf("%-16s %3d %3d %14.0f %10.2f %10llu %10llu %10llu %10llu %12llu\n",
+                   result.name.c_str(), producers, consumers, result.messages_per_sec, 1e9 / result.messages_per_sec,
+                   (unsigned long long)result.p50, (unsigned long long)result.p90, (unsigned long long)result.p99,
+                   (unsigned long long)result.p999, (unsigned long long)result.max);
+            fflush(stdout);
+            rows.push_back(result);
+        }
+    }
+}
+
+bool save_csv(const std::string& path, const std::vector<row>& rows) {
+    FILE* out = fopen(path.c_str(), "w");
+    if(out == nullptr) {
+        fprintf(stderr, "cannot write %s\n", path.c_str());
+        return false;
+    }
+    fprintf(out, "name,producers,consumers,batch,messages_per_sec,p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n");
+    for(const row& r : rows) {
+        fprintf(out, "%s,%d,%d,%zu,%.1f,%llu,%llu,%llu,%llu,%llu\n", r.name.c_str(), r.producers, r.consumers, r.batch,
+                r.messages_per_sec, (unsigned long long)r.p50, (unsigned long long)r.p90, (unsigned long long)r.p99,
+                (unsigned long long)r.p999, (unsigned long long)r.max);
+    }
+    fclose(out);
+    return true;
+}
+
+std::vector<std::pair<int, int>> parse_pairs(const char* text) {
+    std::vector<std::pair<int, int>> pairs;
+    for(const char* p = text; *p;) {
+        int producers = atoi(p);
+        const char* x = strchr(p, 'x');
+        int consumers = x ? atoi(x + 1) : 0;
+        if(producers > 0 && consumers > 0) {
+            pairs.push_back({producers, consumers});
+        }
+        const char* comma = strchr(p, ',');
+        if(comma == nullptr) {
+            break;
+        }
+        p = comma + 1;
+    }
+    return pairs;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    options opts;
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(strcmp(arg, "--pairs") == 0 && has_value) {
+            opts.pairs = parse_pairs(argv[++i]);
+        }
+        else if(strcmp(arg, "--items") == 0 && has_value) {
+            opts.items = (size_t)std::max(1LL, atoll(argv[++i]));
+        }
+        else if(strcmp(arg, "--only") == 0 && has_value) {
+            opts.only = argv[++i];
+        }
+        else if(strcmp(arg, "--csv") == 0 && has_value) {
+            opts.csv = argv[++i];
+        }
+        else if(strcmp(arg, "--quick") == 0) {
+            opts.items = 200000;
+            opts.runs = 1;
+        }
+        else {
+            fprintf(stderr, "usage: %s [--pairs 1x1,2x2] [--items n] [--only substring] [--quick] [--csv file]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<row> rows;
+    printf("%-16s %3s %3s %14s %10s %10s %10s %10s %10s %12s\n",
+           "queue", "P", "C", "msgs/s", "ns/msg", "p50", "p90", "p99", "p99.9", "max");
+    run_queue<mutex_queue>(opts, rows);
+    run_queue<bounded_queue>(opts, rows);
+    run_queue<linked_queue>(opts, rows);
+    run_queue<ring_queue>(opts, rows);
+
+    if(!opts.csv.empty()) {
+        save_csv(opts.csv, rows);
+    }
+    return 0;
+}
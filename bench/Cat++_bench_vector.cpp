@@ -0,0 +1,159 @@
+#include "Cat++_config.h"
+#include "container/Cat++_vector.h"
+#include "dev_dependency/Cat++_test/Cat++_PerformanceTest.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+//vector push_back基准测试
+/*
+用法：bench_vector [--sizes 1000,1000000] [--only 子串] [--quick] [--csv 文件] [--json 文件]
+每次操作从空容器开始逐个push_back n个元素(不预留容量)，再析构容器；Cat::vector与std::vector各用每个AllocatorType：
+- u64：uint64_t，可平凡重定位；分配器提供reallocate时Cat::vector扩容直接调用reallocate(RELOCATE_BY_REALLOC)，
+  行名末尾标出+realloc，default(std::allocator)没有reallocate，仍是申请 + 移动 + 释放
+- string：std::string(短字符串)，不可平凡重定位，两种vector都逐个移动构造
+行名为vec/元素类型/n/cat或std_分配器，ns/op是填满一个容器的耗时；arena每次操作后整体回收
+--quick把规模换成1000、100000并缩短计时
+*/
+
+namespace {
+
+using Cat::AllocatorType;
+
+struct options {
+    std::vector<size_t> sizes = {1000, 1000000};
+    std::string only;
+    std::string csv;
+    std::string json;
+    bool quick = false;
+};
+
+template<typename T>
+T make_value(size_t i) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return std::string(8, char('a' + i % 26));
+    }
+    else {
+        return (T)i;
+    }
+}
+
+template<typename Vector>
+Cat::TestResult run_push_back(const std::string& name, size_t n, AllocatorType type, const Cat::BenchmarkConfig& config) {
+    using T = typename Vector::value_type;
+    return Cat::Benchmark::run(name, [&] {
+        {
+            Vector v;
+            for(size_t i = 0; i < n; i++) {
+                v.push_back(make_value<T>(i));
+            }
+            Cat::doNotOptimize(v.data());
+        }
+        if(type == AllocatorType::ARENA) {
+            Cat::arena::get_default<true>().reset();
+        }
+    }, config);
+}
+
+template<typename T, AllocatorType Type>
+void run_type(const char* element, const char* allocator, const options& opts, std::vector<Cat::TestResult>& results) {
+    using alloc = Cat::alloc_t<T, Type>;
+    constexpr bool by_realloc = Cat::is_trivially_relocatable_v<T> && Cat::reallocating_allocator<alloc>;
+    Cat::BenchmarkConfig config;
+    config.latencyOps = 1000;
+    if(opts.quick) {
+        config.warmupMs = 10;
+        config.durationMs = 50;
+        config.latencyMs = 30;
+    }
+    for(size_t n : opts.sizes) {
+        std::string prefix = std::string("vec/") + element + "/" + std::to_string(n) + "/";
+        std::string cat_name = prefix + "cat_" + allocator + (by_realloc ? "+realloc" : "");
+        std::string std_name = prefix + "std_" + allocator;
+        if(opts.only.empty() || cat_name.find(opts.only) != std::string::npos) {
+            results.push_back(run_push_back<Cat::vector<T, alloc>>(cat_name, n, Type, config));
+            results.back().printRow();
+            fflush(stdout);
+        }
+        if(opts.only.empty() || std_name.find(opts.only) != std::string::npos) {
+            results.push_back(run_push_back<std::vector<T, alloc>>(std_name, n, Type, config));
+            results.back().printRow();
+            fflush(stdout);
+        }
+    }
+}
+
+template<typename T>
+void run_element(const char* element, const options& opts, std::vector<Cat::TestResult>& results) {
+    run_type<T, AllocatorType::DEFAULT>(element, "default", opts, results);
+    run_type<T, AllocatorType::SIMPLE>(element, "simple", opts, results);
+    run_type<T, AllocatorType::POOL>(element, "pool", opts, results);
+    run_type<T, AllocatorType::POOL_SIMD>(element, "pool_simd", opts, results);
+    run_type<T, AllocatorType::POOL_TINY>(element, "pool_tiny", opts, results);
+    run_type<T, AllocatorType::ARENA>(element, "arena", opts, results);
+}
+
+std::vector<size_t> parse_sizes(const char* text) {
+    std::vector<size_t> sizes;
+    for(const char* p = text; *p;) {
+        double value = strtod(p, nullptr);              // 接受1e6这样的写法
+        if(value >= 1) {
+            sizes.push_back((size_t)value);
+        }
+        const char* comma = strchr(p, ',');
+        if(comma == nullptr) {
+            break;
+        }
+        p = comma + 1;
+    }
+    return sizes;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    options opts;
+    for(int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(strcmp(arg, "--sizes") == 0 && has_value) {
+            opts.sizes = parse_sizes(argv[++i]);
+        }
+        else if(strcmp(arg, "--only") == 0 && has_value) {
+            opts.only = argv[++i];
+        }
+        else if(strcmp(arg, "--csv") == 0 && has_value) {
+            opts.csv = argv[++i];
+        }
+        else if(strcmp(arg, "--json") == 0 && has_value) {
+            opts.json = argv[++i];
+        }
+        else if(strcmp(arg, "--quick") == 0) {
+            opts.sizes = {1000, 100000};
+            opts.quick = true;
+        }
+        else {
+            fprintf(stderr, "usage: %s [--sizes 1000,1000000] [--only substring] [--quick] [--csv file] [--json file]\n", argv[0]);
+            return 2;
+        }
+    }
+    if(opts.sizes.empty()) {
+        opts.sizes = {1000};
+    }
+
+    std::vector<Cat::TestResult> results;
+    Cat::TestResult::printRowHeader();
+    run_element<uint64_t>("u64", opts, results);
+    run_element<std::string>("string", opts, results);
+
+    if(!opts.csv.empty()) {
+        Cat::saveCsv(opts.csv, results);
+    }
+    if(!opts.json.empty()) {
+        Cat::saveJson(opts.json, results);
+    }
+    return 0;
+}
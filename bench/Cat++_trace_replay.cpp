@@ -0,0 +1,395 @@
+#include "Cat++_config.h"
+#include "alloc/Cat++_alloc_trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "trace replay measures peak memory in forked child processes and needs POSIX"
+#endif
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+//分配轨迹重放
+/*
+用法：trace_replay [--threads] [--no-latency] [--only name,...] trace.bin
+把alloc_trace记录的轨迹(见Cat++_alloc_trace.h)对系统malloc与每个AllocatorType重放，每行输出一个分配器：
+- 吞吐：操作数 / 重放总时间
+- 延迟分位数：每次操作前后各取一次steady_clock，p50/p90/p99/p99.9/max(纳秒)，计时开销对所有分配器相同
+  --no-latency时不计时，吞吐不含计时开销
+- 峰值内存：每个分配器在fork出的子进程中重放，峰值RSS(getrusage)减去重放前的RSS
+重放方式：
+1）默认单线程按时间戳顺序重放全部操作，结果确定
+2）--threads：每个记录线程对应一个重放线程，各自按原顺序执行；释放其他线程分配的块时等待该分配完成，
+   依赖都指向时间更早的操作，不会死锁
+每次分配写入首字节并每隔4K写一个字节，使RSS反映实际占用；记录开始前分配的块的释放被忽略
+*/
+
+namespace {
+
+using namespace std::chrono;
+
+// 预处理后的操作：地址换成对象编号
+struct replay_op {
+    uint32_t object;        // 本次分配(或realloc结果)的对象编号
+    uint32_t old_object;    // 释放/realloc的对象编号
+    uint64_t size;
+    uint32_t thread;        // 重放线程下标
+    uint8_t op;             // Cat::trace_op
+    uint8_t align_shift;
+};
+
+constexpr uint32_t NO_OBJECT = UINT32_MAX;
+
+struct replay_plan {
+    std::vector<replay_op> ops;                        // 全部操作，按时间顺序
+    std::vector<std::vector<uint32_t>> thread_ops;     // 每个重放线程的操作下标
+    uint32_t objects = 0;
+    uint64_t peak_live_bytes = 0;                      // 按请求大小计的在用字节数峰值
+    uint64_t skipped = 0;                              // 无法配对而忽略的释放
+};
+
+// 按地址配对分配与释放，给每个对象一个编号
+replay_plan build_plan(const std::vector<Cat::trace_record>& records) {
+    replay_plan plan;
+    std::unordered_map<uint64_t, uint32_t> live;       // 地址 -> 对象编号
+    std::unordered_map<uint32_t, uint32_t> threads;    // 记录线程 -> 重放线程
+    std::vector<uint64_t> sizes;
+    uint64_t live_bytes = 0;
+    plan.ops.reserve(records.size());
+    for(const Cat::trace_record& record : records) {
+        replay_op op = {NO_OBJECT, NO_OBJECT, record.size, 0, record.op, record.align_shift};
+        auto inserted = threads.emplace(record.thread, (uint32_t)threads.size());
+        op.thread = inserted.first->second;
+
+        if(record.op == (uint8_t)Cat::trace_op::DEALLOCATE || record.op == (uint8_t)Cat::trace_op::REALLOCATE) {
+            uint64_t old_ptr = record.op == (uint8_t)Cat::trace_op::DEALLOCATE ? record.ptr : record.old_ptr;
+            auto found = old_ptr ? live.find(old_ptr) : live.end();
+            if(found != live.end()) {
+                op.old_object = found->second;
+                live_bytes -= sizes[found->second];
+                live.erase(found);
+            }
+            else if(record.op == (uint8_t)Cat::trace_op::DEALLOCATE) {
+                plan.skipped++;
+                continue;
+            }
+            else {
+                op.op = (uint8_t)Cat::trace_op::ALLOCATE;     // 原块在记录开始前分配：按新分配处理
+            }
+        }
+        if(op.op != (uint8_t)Cat::trace_op::DEALLOCATE) {
+            op.object = plan.objects++;
+            sizes.push_back(record.size);
+            live[record.ptr] = op.object;
+            live_bytes += record.size;
+            plan.peak_live_bytes = std::max(plan.peak_live_bytes, live_bytes);
+        }
+        plan.ops.push_back(op);
+    }
+    plan.thread_ops.resize(threads.size());
+    for(uint32_t i = 0; i < plan.ops.size(); i++) {
+        plan.thread_ops[plan.ops[i].thread].push_back(i);
+    }
+    return plan;
+}
+
+// 系统malloc
+struct system_target {
+    static void* allocate(size_t bytes, size_t align) {
+        if(align <= alignof(max_align_t)) {
+            return malloc(bytes);
+        }
+        return aligned_alloc(align, (bytes + align - 1) & ~(align - 1));
+    }
+    static void deallocate(void* ptr, size_t, size_t) { free(ptr); }
+    static void* reallocate(void* ptr, size_t, size_t new_bytes) { return realloc(ptr, new_bytes); }
+};
+
+// AllocatorType对应的分配器，以std::byte为元素；不支持的操作用分配 + 复制 + 释放代替
+template<Cat::AllocatorType Type>
+struct allocator_target {
+    using alloc = Cat::alloc_t<std::byte, Type>;
+
+    static void* allocate(size_t bytes, size_t align) {
+        if constexpr (requires(alloc a) { a.allocate(bytes, align); }) {
+            return align ? alloc().allocate(bytes, align) : alloc().allocate(bytes);
+        }
+        else {
+            return align ? ::operator new(bytes, std::align_val_t(align)) : alloc().allocate(bytes);
+        }
+    }
+    static void deallocate(void* ptr, size_t bytes, size_t align) {
+        if constexpr (requires(alloc a) { a.deallocate((std::byte*)ptr, bytes, align); }) {
+            align ? alloc().deallocate((std::byte*)ptr, bytes, align) : alloc().deallocate((std::byte*)ptr, bytes);
+        }
+        else if(align) {
+            ::operator delete(ptr, std::align_val_t(align));
+        }
+        else {
+            alloc().deallocate((std::byte*)ptr, bytes);
+        }
+    }
+    // 显式对齐的块只在对齐为0时用分配器自己的reallocate(它按默认对齐计算大小类)
+    static void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes) {
+        if constexpr (requires(alloc a) { a.reallocate((std::byte*)ptr, old_bytes, new_bytes); }) {
+            return alloc().reallocate((std::byte*)ptr, old_bytes, new_bytes);
+        }
+        else {
+            void* result = alloc().allocate(new_bytes);
+            memcpy(result, ptr, std::min(old_bytes, new_bytes));
+            alloc().deallocate((std::byte*)ptr, old_bytes);
+            return result;
+        }
+    }
+};
+
+// 每次分配后写入的字节：首字节与之后每页一个字节
+inline void touch(void* ptr, size_t bytes) {
+    char* p = static_cast<char*>(ptr);
+    for(size_t offset = 0; offset < bytes; offset += 4096) {
+        p[offset] = 1;
+    }
+}
+
+struct replay_options {
+    bool threads = false;
+    bool latency = true;
+};
+
+struct object_slot {
+    std::atomic<void*> ptr{nullptr};
+    uint64_t size = 0;
+    size_t align = 0;
+};
+
+template<class Target>
+class replayer {
+private:
+    const replay_plan& plan;
+    replay_options options;
+    std::unique_ptr<object_slot[]> slots;
+
+    // 等待其他重放线程完成该对象的分配
+    void* wait_for(uint32_t object) {
+        void* ptr;
+        while((ptr = slots[object].ptr.load(std::memory_order_acquire)) == nullptr) {
+            std::this_thread::yield();
+        }
+        return ptr;
+    }
+
+    // old_ptr为释放/realloc的原块，调用前已等到它分配完成
+    void execute(const replay_op& op, void* old_ptr) {
+        size_t align = op.align_shift ? size_t(1) << op.align_shift : 0;
+        switch((Cat::trace_op)op.op) {
+        case Cat::trace_op::ALLOCATE: {
+            void* ptr = Target::allocate(op.size ? op.size : 1, align);
+            store(op, ptr, op.size, align);
+            break;
+        }
+        case Cat::trace_op::DEALLOCATE: {
+            object_slot& slot = slots[op.old_object];
+            Target::deallocate(old_ptr, slot.size ? slot.size : 1, slot.align);
+            break;
+        }
+        case Cat::trace_op::REALLOCATE: {
+            object_slot& slot = slots[op.old_object];
+            void* ptr;
+            if(slot.align == 0) {
+                ptr = Target::reallocate(old_ptr, slot.size ? slot.size : 1, op.size ? op.size : 1);
+            }
+            else {
+                ptr = Target::allocate(op.size ? op.size : 1, slot.align);
+                if(ptr) {
+                    memcpy(ptr, old_ptr, std::min(slot.size, op.size));
+                    Target::deallocate(old_ptr, slot.size ? slot.size : 1, slot.align);
+                }
+            }
+            store(op, ptr, op.size, slot.align);
+            break;
+        }
+        }
+    }
+
+    void store(const replay_op& op, void* ptr, uint64_t size, size_t align) {
+        if(ptr == nullptr) {
+            fprintf(stderr, "replay: allocation of %llu bytes failed\n", (unsigned long long)size);
+            std::_Exit(2);
+        }
+        touch(ptr, size);
+        object_slot& slot = slots[op.object];
+        slot.size = size;
+        slot.align = align;
+        slot.ptr.store(ptr, std::memory_order_release);
+    }
+
+    // 按indices(为nullptr时为全部操作)顺序重放，等待依赖的时间不计入延迟
+    void run_ops(const std::vector<uint32_t>* indices) {
+        size_t count = indices ? indices->size() : plan.ops.size();
+        for(size_t i = 0; i < count; i++) {
+            uint32_t index = indices ? (*indices)[i] : (uint32_t)i;
+            const replay_op& op = plan.ops[index];
+            void* old_ptr = op.old_object != NO_OBJECT ? wait_for(op.old_object) : nullptr;
+            if(options.latency) {
+                auto begin = steady_clock::now();
+                execute(op, old_ptr);
+                latencies[index] = (uint32_t)std::min<int64_t>(duration_cast<nanoseconds>(steady_clock::now() - begin).count(), UINT32_MAX);
+            }
+            else {
+                execute(op, old_ptr);
+            }
+        }
+    }
+
+public:
+    std::vector<uint32_t> latencies;                   // 按操作下标记录的延迟，构造时即分配好，不计入峰值内存
+
+    replayer(const replay_plan& p, replay_options o)
+        : plan(p), options(o), slots(new object_slot[p.objects ? p.objects : 1]), latencies(o.latency ? p.ops.size() : 0) {}
+
+    // 返回重放耗时(秒)
+    double run() {
+        auto begin = steady_clock::now();
+        if(!options.threads || plan.thread_ops.size() <= 1) {
+            run_ops(nullptr);
+        }
+        else {
+            std::vector<std::thread> workers;
+            for(size_t t = 0; t < plan.thread_ops.size(); t++) {
+                workers.emplace_back([this, t] { run_ops(&plan.thread_ops[t]); });
+            }
+            for(std::thread& worker : workers) {
+                worker.join();
+            }
+        }
+        return duration<double>(steady_clock::now() - begin).count();
+    }
+};
+
+long current_rss_kb() {
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if(statm == nullptr) {
+        return 0;
+    }
+    long pages = 0, resident = 0;
+    if(fscanf(statm, "%ld %ld", &pages, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(statm);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+uint32_t percentile(std::vector<uint32_t>& values, double p) {
+    if(values.empty()) {
+        return 0;
+    }
+    size_t index = std::min(values.size() - 1, (size_t)(p * (double)values.size()));
+    std::nth_element(values.begin(), values.begin() + (ptrdiff_t)index, values.end());
+    return values[index];
+}
+
+// 在子进程中重放并输出一行结果
+template<class Target>
+void replay_in_child(const char* name, const replay_plan& plan, replay_options options) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if(pid < 0) {
+        perror("fork");
+        return;
+    }
+    if(pid > 0) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            printf("%-10s replay failed\n", name);
+        }
+        return;
+    }
+
+    replayer<Target> replay(plan, options);
+    long baseline = current_rss_kb();
+    double seconds = replay.run();
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    long peak = usage.ru_maxrss - baseline;
+    std::vector<uint32_t>& latencies = replay.latencies;
+
+    printf("%-10s %12.0f", name, (double)plan.ops.size() / seconds);
+    if(options.latency) {
+        printf(" %8u %8u %8u %8u %10u", percentile(latencies, 0.5), percentile(latencies, 0.9),
+               percentile(latencies, 0.99), percentile(latencies, 0.999), percentile(latencies, 1.0));
+    }
+    printf(" %12ld\n", peak > 0 ? peak : 0);
+    fflush(stdout);
+    std::_Exit(0);
+}
+
+bool selected(const std::string& only, const char* name) {
+    if(only.empty()) {
+        return true;
+    }
+    std::string list = "," + only + ",";
+    return list.find("," + std::string(name) + ",") != std::string::npos;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    replay_options options;
+    std::string only;
+    const char* path = nullptr;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--threads") == 0) {
+            options.threads = true;
+        }
+        else if(strcmp(argv[i], "--no-latency") == 0) {
+            options.latency = false;
+        }
+        else if(strcmp(argv[i], "--only") == 0 && i + 1 < argc) {
+            only = argv[++i];
+        }
+        else {
+            path = argv[i];
+        }
+    }
+    if(path == nullptr) {
+        fprintf(stderr, "usage: %s [--threads] [--no-latency] [--only system,default,...] trace.bin\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Cat::trace_record> records;
+    if(!Cat::read_trace(path, records)) {
+        return 1;
+    }
+    replay_plan plan = build_plan(records);
+    records = std::vector<Cat::trace_record>();
+    printf("trace: %zu ops, %u objects, %zu threads, peak live %llu bytes, %llu unmatched frees skipped\n",
+           plan.ops.size(), plan.objects, plan.thread_ops.size(),
+           (unsigned long long)plan.peak_live_bytes, (unsigned long long)plan.skipped);
+    printf("replay: %s\n", options.threads ? "one thread per recorded thread" : "single thread, trace order");
+
+    printf("%-10s %12s", "allocator", "ops/s");
+    if(options.latency) {
+        printf(" %8s %8s %8s %8s %10s", "p50(ns)", "p90", "p99", "p99.9", "max");
+    }
+    printf(" %12s\n", "peak_rss_kb");
+
+    using Cat::AllocatorType;
+    if(selected(only, "system"))    replay_in_child<system_target>("system", plan, options);
+    if(selected(only, "default"))   replay_in_child<allocator_target<AllocatorType::DEFAULT>>("default", plan, options);
+    if(selected(only, "simple"))    replay_in_child<allocator_target<AllocatorType::SIMPLE>>("simple", plan, options);
+    if(selected(only, "pool"))      replay_in_child<allocator_target<AllocatorType::POOL>>("pool", plan, options);
+    if(selected(only, "pool_simd")) replay_in_child<allocator_target<AllocatorType::POOL_SIMD>>("pool_simd", plan, options);
+    if(selected(only, "pool_tiny")) replay_in_child<allocator_target<AllocatorType::POOL_TINY>>("pool_tiny", plan, options);
+    if(selected(only, "arena"))     replay_in_child<allocator_target<AllocatorType::ARENA>>("arena", plan, options);
+    return 0;
+}
@@ -0,0 +1,354 @@
+#include "alloc/Cat++_alloc_trace.h"
+#include "alloc/Cat++_page_source.h"
+#include "alloc/Cat++_pool_alloc.h"
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <pthread.h>
+#include <sys/mman.h>
+#if !defined(__linux__)
+#error "the malloc shim targets Linux/glibc"
+#endif
+//malloc替换(LD_PRELOAD)
+/*
+用内存池实现libc的分配函数和全局operator new/delete，编译为libcat_malloc.so：
+    LD_PRELOAD=/path/to/libcat_malloc.so ./program
+不需要重新编译即可在现有程序上对比内存池与glibc malloc
+1）覆盖malloc/free/calloc/realloc/reallocarray/posix_memalign/aligned_alloc/memalign/valloc/pvalloc/malloc_usable_size，
+   以及operator new/delete的全部变体(数组、nothrow、sized、aligned)，任何一个漏掉都会让glibc的free拿到内存池的指针
+2）free不带大小：每个块前放16字节块头，记录向后端申请的字节数与用户指针相对原始块的偏移
+3）后端：块头 + 请求不超过MAX_BYTES时来自alloc_pool<true, mmap_page_source>(按16字节对齐)，更大的块直接mmap，
+   realloc大块之间用mremap搬动页表；内存池不能再用malloc_page_source，否则会递归到自己
+4）对齐请求多申请align - 16字节，把用户指针推到对齐位置，偏移记在块头中
+
+早期初始化与fork：
+- 内存池的状态全部是常量初始化的静态/thread_local变量，动态链接器与其他库的构造函数在本库构造函数之前调用malloc也是安全的
+- 必须以-ftls-model=initial-exec编译：动态TLS模型首次访问时会调用malloc，造成递归
+- 线程注册时libc为thread_local析构函数申请内存会重入内存池，见alloc_pool::register_thread
+- 构造函数用pthread_atfork注册alloc_pool::fork_prepare/fork_parent/fork_child，子进程中内存池可以继续使用
+内存池的chunk不会主动归还系统(不调用trim)
+
+分配轨迹：设置环境变量CAT_MALLOC_TRACE=文件路径时，构造函数调用alloc_trace::start，记录全部分配/释放/realloc(见Cat++_alloc_trace.h)，
+进程退出时写出；malloc系列按默认对齐记录，显式对齐的请求记录其对齐
+*/
+
+namespace {
+
+using pool = Cat::alloc_pool<true, Cat::mmap_page_source>;
+
+constexpr size_t HEADER = 16;           // 块头大小，也是malloc保证的对齐(alignof(max_align_t))
+constexpr size_t PAGE = 4096;
+static_assert(HEADER >= alignof(std::max_align_t), "malloc must return max_align_t aligned blocks");
+
+// 块头，位于返回给用户的指针之前
+struct block_header {
+    size_t bytes;                       // 向后端申请的字节数
+    size_t offset;                      // 用户指针相对原始块起点的偏移
+};
+static_assert(sizeof(block_header) == HEADER, "block header must keep user pointers 16-byte aligned");
+
+inline block_header* header_of(void* ptr) noexcept {
+    return reinterpret_cast<block_header*>(static_cast<char*>(ptr) - HEADER);
+}
+
+inline size_t page_round(size_t bytes) noexcept {
+    return (bytes + PAGE - 1) & ~(PAGE - 1);
+}
+
+inline bool pooled(size_t bytes) noexcept {
+    return bytes <= pool::get_max_bytes();
+}
+
+// 后端申请/归还：小块来自内存池，大块直接mmap(新映射的页全为0)
+void* raw_allocate(size_t bytes) noexcept {
+    if(pooled(bytes)) {
+        try {
+            return pool::allocate(bytes, HEADER);
+        } catch (...) {
+            return nullptr;
+        }
+    }
+    void* result = mmap(nullptr, page_round(bytes), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return result == MAP_FAILED ? nullptr : result;
+}
+
+void raw_release(void* raw, size_t bytes) noexcept {
+    if(pooled(bytes)) {
+        pool::deallocate(raw, bytes, HEADER);
+    }
+    else {
+        munmap(raw, page_round(bytes));
+    }
+}
+
+// 后端块的实际字节数：内存池按大小类取整，mmap按页取整
+size_t raw_capacity(size_t bytes) noexcept {
+    return pooled(bytes) ? pool::get_node_size(pool::get_free_serial_index(bytes, HEADER)) : page_round(bytes);
+}
+
+// 分配size字节、按align(2的幂，>= HEADER)对齐的块，失败时置errno为ENOMEM并返回nullptr
+void* allocate_block(size_t size, size_t align) noexcept {
+    size_t pad = align - HEADER;        // 原始块按HEADER对齐，用户指针最多再后移align - HEADER字节
+    if(size > SIZE_MAX - HEADER - pad - PAGE) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    size_t bytes = HEADER + pad + size;
+    char* raw = static_cast<char*>(raw_allocate(bytes));
+    if(raw == nullptr) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    char* user = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(raw) + HEADER + align - 1) & ~(uintptr_t)(align - 1));
+    block_header* header = header_of(user);
+    header->bytes = bytes;
+    header->offset = user - raw;
+    return user;
+}
+
+void release_block(void* ptr) noexcept {
+    block_header* header = header_of(ptr);
+    raw_release(static_cast<char*>(ptr) - header->offset, header->bytes);
+}
+
+// 对外的分配/释放：在块操作之外记录分配轨迹
+void* allocate(size_t size, size_t align) noexcept {
+    void* result = allocate_block(size, align);
+    if(result) {
+        Cat::alloc_trace::record(Cat::trace_op::ALLOCATE, result, nullptr, size, align > HEADER ? align : 0);
+    }
+    return result;
+}
+
+void release(void* ptr) noexcept {
+    if(ptr == nullptr) {
+        return;
+    }
+    Cat::alloc_trace::record(Cat::trace_op::DEALLOCATE, ptr, nullptr, 0);
+    release_block(ptr);
+}
+
+size_t usable_size(void* ptr) noexcept {
+    block_header* header = header_of(ptr);
+    return raw_capacity(header->bytes) - header->offset;
+}
+
+void* reallocate(void* ptr, size_t size) noexcept {
+    if(ptr == nullptr) {
+        return allocate(size, HEADER);
+    }
+    if(size == 0) {
+        release(ptr);
+        return nullptr;
+    }
+    // 新大小仍在容量内且没有缩小一半以上：原地返回
+    size_t usable = usable_size(ptr);
+    if(size <= usable && size >= usable / 2) {
+        Cat::alloc_trace::record(Cat::trace_op::REALLOCATE, ptr, ptr, size);
+        return ptr;
+    }
+    // 大块到大块：mremap搬动页表，不复制数据，偏移在页内保持不变
+    block_header* header = header_of(ptr);
+    size_t offset = header->offset;
+    void* result;
+    if(!pooled(header->bytes) && size <= SIZE_MAX - offset - PAGE && !pooled(offset + size)) {
+        void* moved = mremap(static_cast<char*>(ptr) - offset, page_round(header->bytes), page_round(offset + size), MREMAP_MAYMOVE);
+        if(moved == MAP_FAILED) {
+            errno = ENOMEM;
+            return nullptr;
+        }
+        result = static_cast<char*>(moved) + offset;
+        header_of(result)->bytes = offset + size;
+    }
+    else {
+        result = allocate_block(size, HEADER);
+        if(result == nullptr) {
+            return nullptr;
+        }
+        memcpy(result, ptr, size < usable ? size : usable);
+        release_block(ptr);
+    }
+    Cat::alloc_trace::record(Cat::trace_op::REALLOCATE, result, ptr, size);
+    return result;
+}
+
+inline bool power_of_two(size_t value) noexcept {
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+inline size_t effective_align(size_t align) noexcept {
+    return align < HEADER ? HEADER : align;
+}
+
+// operator new：失败时调用new_handler，没有new_handler时抛出std::bad_alloc
+void* new_allocate(size_t size, size_t align) {
+    for(;;) {
+        if(void* result = allocate(size, effective_align(align))) {
+            return result;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if(handler == nullptr) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void* new_allocate_nothrow(size_t size, size_t align) noexcept {
+    try {
+        return new_allocate(size, align);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+__attribute__((constructor)) void register_fork_handlers() {
+    pthread_atfork(pool::fork_prepare, pool::fork_parent, pool::fork_child);
+    // 后注册的prepare先执行：轨迹的锁在内存池的锁之前取得，fclose/fwrite可以在持有它时调用free
+    pthread_atfork(Cat::alloc_trace::fork_prepare, Cat::alloc_trace::fork_parent, Cat::alloc_trace::fork_child);
+    if(const char* path = getenv("CAT_MALLOC_TRACE")) {
+        Cat::alloc_trace::start(path);
+    }
+}
+
+__attribute__((destructor)) void stop_trace() {
+    if(Cat::alloc_trace::is_enabled()) {
+        Cat::alloc_trace::stop();
+    }
+}
+
+} // namespace
+
+#define CAT_SHIM_EXPORT __attribute__((visibility("default")))
+
+extern "C" {
+
+CAT_SHIM_EXPORT void* malloc(size_t size) noexcept {
+    return allocate(size, HEADER);
+}
+
+CAT_SHIM_EXPORT void free(void* ptr) noexcept {
+    release(ptr);
+}
+
+CAT_SHIM_EXPORT void* calloc(size_t count, size_t size) noexcept {
+    size_t total;
+    if(__builtin_mul_overflow(count, size, &total)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    void* result = allocate(total, HEADER);
+    // mmap得到的大块已经是0
+    if(result && pooled(header_of(result)->bytes)) {
+        memset(result, 0, total);
+    }
+    return result;
+}
+
+CAT_SHIM_EXPORT void* realloc(void* ptr, size_t size) noexcept {
+    return reallocate(ptr, size);
+}
+
+CAT_SHIM_EXPORT void* reallocarray(void* ptr, size_t count, size_t size) noexcept {
+    size_t total;
+    if(__builtin_mul_overflow(count, size, &total)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return reallocate(ptr, total);
+}
+
+CAT_SHIM_EXPORT int posix_memalign(void** out, size_t align, size_t size) noexcept {
+    if(!power_of_two(align) || align % sizeof(void*) != 0) {
+        return EINVAL;
+    }
+    int saved = errno;
+    void* result = allocate(size, effective_align(align));
+    errno = saved;
+    if(result == nullptr) {
+        return ENOMEM;
+    }
+    *out = result;
+    return 0;
+}
+
+CAT_SHIM_EXPORT void* aligned_alloc(size_t align, size_t size) noexcept {
+    if(!power_of_two(align)) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return allocate(size, effective_align(align));
+}
+
+// glibc的memalign把非2的幂的对齐向上取整
+CAT_SHIM_EXPORT void* memalign(size_t align, size_t size) noexcept {
+    if(align > SIZE_MAX / 2 + 1) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    size_t rounded = HEADER;
+    while(rounded < align) {
+        rounded <<= 1;
+    }
+    return allocate(size, rounded);
+}
+
+CAT_SHIM_EXPORT void* valloc(size_t size) noexcept {
+    return allocate(size, PAGE);
+}
+
+CAT_SHIM_EXPORT void* pvalloc(size_t size) noexcept {
+    if(size > SIZE_MAX - PAGE) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return allocate(page_round(size ? size : 1), PAGE);
+}
+
+CAT_SHIM_EXPORT size_t malloc_usable_size(void* ptr) noexcept {
+    return ptr ? usable_size(ptr) : 0;
+}
+
+} // extern "C"
+
+CAT_SHIM_EXPORT void* operator new(size_t size) {
+    return new_allocate(size, HEADER);
+}
+CAT_SHIM_EXPORT void* operator new[](size_t size) {
+    return new_allocate(size, HEADER);
+}
+CAT_SHIM_EXPORT void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return new_allocate_nothrow(size, HEADER);
+}
+CAT_SHIM_EXPORT void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return new_allocate_nothrow(size, HEADER);
+}
+CAT_SHIM_EXPORT void* operator new(size_t size, std::align_val_t align) {
+    return new_allocate(size, static_cast<size_t>(align));
+}
+CAT_SHIM_EXPORT void* operator new[](size_t size, std::align_val_t align) {
+    return new_allocate(size, static_cast<size_t>(align));
+}
+CAT_SHIM_EXPORT void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return new_allocate_nothrow(size, static_cast<size_t>(align));
+}
+CAT_SHIM_EXPORT void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return new_allocate_nothrow(size, static_cast<size_t>(align));
+}
+
+// 大小与对齐都记在块头中，delete的各个变体统一按块头释放
+CAT_SHIM_EXPORT void operator delete(void* ptr) noexcept { release(ptr); }
+CAT_SHIM_EXPORT void operator delete[](void* ptr) noexcept { release(ptr); }
+CAT_SHIM_EXPORT void operator delete(void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+CAT_SHIM_EXPORT void operator delete[](void* ptr, const std::nothrow_t&) noexcept { release(ptr); }
+CAT_SHIM_EXPORT void operator delete(void* ptr, size_t) noexcept { release(ptr); }
+CAT_SHIM_EXPORT void operator delete[](void* ptr, size_t) noexcept { release(ptr); }
+CAT_SHIM_EXPORT void operator delete(void* ptr, std::align_val_t) noexcept { release(ptr); }
+CAT_SHIM_EXPORT void operator delete[](void* ptr, std::align_val_t) noexcept { release(ptr); }
+CAT_SHIM_EXPORT void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { release(ptr); }
+CAT_SHIM_EXPORT void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { release(ptr); }
+CAT_SHIM_EXPORT void operator delete(void* ptr, size_t, std::align_val_t) noexcept { release(ptr); }
+CAT_SHIM_EXPORT void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { release(ptr); }
@@ -1,5 +1,6 @@
 #pragma once
 #include "./alloc/Cat++_allocator.h"
+#include "./alloc/Cat++_arena_alloc.h"
 #include "./alloc/Cat++_pool_alloc.h"
 #include <memory>
 
@@ -9,7 +10,10 @@ namespace Cat {
 enum class AllocatorType {
     DEFAULT,    // 使用STL默认配置器
     SIMPLE,     // 使用Cat++_allocator
-    POOL        // 使用Cat++_pool_allocator
+    POOL,       // 使用Cat++_pool_allocator
+    POOL_SIMD,  // 使用Cat++_pool_allocator，独立的16字节对齐内存池(simd_pool_config)
+    POOL_TINY,  // 使用Cat++_pool_allocator，独立的8~32字节小对象内存池(tiny_pool_config)
+    ARENA       // 使用Cat++_arena_allocator(线程默认arena，由arena::reset()整体回收)
 };
 
 // 配置器选择器
@@ -22,7 +26,19 @@ public:
         typename std::conditional<
             Type == AllocatorType::SIMPLE,
             allocator<true, T>,//true则选择allocator<true, T>
-            pool_allocator<true, T>
+            typename std::conditional<
+                Type == AllocatorType::POOL,
+                pool_allocator<true, T>,
+                typename std::conditional<
+                    Type == AllocatorType::POOL_SIMD,
+                    pool_allocator<true, T, malloc_page_source, simd_pool_config>,
+                    typename std::conditional<
+                        Type == AllocatorType::POOL_TINY,
+                        pool_allocator<true, T, malloc_page_source, tiny_pool_config>,
+                        arena_allocator<true, T>
+                    >::type
+                >::type
+            >::type
         >::type
     >::type;
 };
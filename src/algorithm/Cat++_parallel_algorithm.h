@@ -0,0 +1,328 @@
+#pragma once
+#include "../Cat++_config.h"
+#include "../execption/allocator_exception.h"
+#include "../thread/Cat++_thread_pool.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <type_traits>
+#include <utility>
+//并行算法
+/*
+基于thread_pool(工作窃取)的并行算法，作用于随机访问区间，第一个参数可传入线程池，省略时使用thread_pool::get_default()：
+1）parallel_for_each / parallel_transform：区间二分到粒度以下后串行处理
+2）parallel_reduce：分段归约后按原顺序合并(op只需满足结合律，不要求交换律)
+3）parallel_inclusive_scan：分块三趟——各块并行归约、串行求块前缀、各块并行扫描；输出可与输入是同一区间
+4）parallel_sort / parallel_stable_sort：并行归并排序，叶子用std::sort / std::stable_sort，
+   合并时按较长一段的中点二分切开、两半并行归并(保持稳定)；在原区间与临时缓冲区之间来回归并，不做额外拷贝
+临时内存经由alloc_t取得：排序的归并缓冲区默认来自内存池(AllocatorType::POOL，可改为ARENA等)，
+扫描的块前缀来自调用线程的arena(arena_scope内，返回时整体回收)；分配器返回nullptr时抛出OutOfMemoryException
+粒度：每个工作线程约分到GRAIN_SPLIT段，且每段不少于MIN_GRAIN个元素；元素过少或线程池只有一个线程时直接串行执行
+*/
+
+namespace Cat {
+
+namespace parallel_detail {
+
+constexpr size_t MIN_GRAIN = 4096;              // 分段的最小元素数
+constexpr size_t GRAIN_SPLIT = 8;               // 每个工作线程分到的段数
+constexpr size_t MIN_SORT_LEAF = 8192;          // 排序叶子的最小元素数
+constexpr size_t MIN_MERGE_GRAIN = 16384;       // 不再切分的归并长度
+
+inline size_t grain_for(const thread_pool& pool, size_t n, size_t split = GRAIN_SPLIT, size_t minimum = MIN_GRAIN) {
+    size_t grain = n / (pool.size() * split);
+    return grain < minimum ? minimum : grain;
+}
+
+inline bool run_serial(const thread_pool& pool, size_t n, size_t minimum = MIN_GRAIN) {
+    return pool.size() < 2 || n <= minimum;
+}
+
+// 串行归并：比较左值、再移动到out(std::merge配move_iterator时比较的是右值，比较器未必接受)
+template<typename In, typename Out, typename Comp>
+Out move_merge(In l1, In r1, In l2, In r2, Out out, Comp& comp) {
+    while(l1 != r1 && l2 != r2) {
+        if(comp(*l2, *l1)) {
+            *out = std::move(*l2);
+            ++l2;
+        }
+        else {
+            *out = std::move(*l1);
+            ++l1;
+        }
+        ++out;
+    }
+    out = std::move(l1, r1, out);
+    return std::move(l2, r2, out);
+}
+
+// 把[l1, r1)与[l2, r2)归并(移动)到out；二者取自同一序列，相等元素前一段优先
+template<typename In, typename Out, typename Comp>
+void merge_into(thread_pool& pool, In l1, In r1, In l2, In r2, Out out, Comp& comp) {
+    size_t n1 = (size_t)(r1 - l1);
+    size_t n2 = (size_t)(r2 - l2);
+    if(n1 + n2 <= MIN_MERGE_GRAIN) {
+        move_merge(l1, r1, l2, r2, out, comp);
+        return;
+    }
+    size_t m1, m2;
+    if(n1 >= n2) {
+        m1 = n1 / 2;
+        m2 = (size_t)(std::lower_bound(l2, r2, l1[m1], comp) - l2);       // 后一段中小于l1[m1]的排在它前面
+    }
+    else {
+        m2 = n2 / 2;
+        m1 = (size_t)(std::upper_bound(l1, r1, l2[m2], comp) - l1);       // 前一段中不大于l2[m2]的排在它前面
+    }
+    pool.fork_join([&] { merge_into(pool, l1, l1 + m1, l2, l2 + m2, out, comp); },
+                   [&] { merge_into(pool, l1 + m1, r1, l2 + m2, r2, out + (m1 + m2), comp); });
+}
+
+// 排序data[0, n)；to_buffer为true时结果放在buffer，否则留在data，子问题的结果放在另一侧再归并回来
+template<bool stable, typename It, typename Buf, typename Comp>
+void sort_into(thread_pool& pool, It data, Buf buffer, size_t n, size_t leaf, bool to_buffer, Comp& comp) {
+    if(n <= leaf) {
+        if constexpr (stable) {
+            std::stable_sort(data, data + n, comp);
+        }
+        else {
+            std::sort(data, data + n, comp);
+        }
+        if(to_buffer) {
+            std::move(data, data + n, buffer);
+        }
+        return;
+    }
+    size_t half = n / 2;
+    pool.fork_join([&] { sort_into<stable>(pool, data, buffer, half, leaf, !to_buffer, comp); },
+                   [&] { sort_into<stable>(pool, data + half, buffer + half, n - half, leaf, !to_buffer, comp); });
+    if(to_buffer) {
+        merge_into(pool, data, data + half, data + half, data + n, buffer, comp);
+    }
+    else {
+        merge_into(pool, buffer, buffer + half, buffer + half, buffer + n, data, comp);
+    }
+}
+
+template<bool stable, AllocatorType Type, typename It, typename Comp>
+void merge_sort(thread_pool& pool, It first, It last, Comp comp) {
+    using T = typename std::iterator_traits<It>::value_type;
+    using Alloc = alloc_t<T, Type>;
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    size_t n = (size_t)(last - first);
+    size_t leaf = grain_for(pool, n, 4, MIN_SORT_LEAF);
+    // 移动可能抛出时无法在两处之间安全地来回归并，退回串行排序
+    constexpr bool nothrow_move = std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>;
+    if(!nothrow_move || run_serial(pool, n, MIN_SORT_LEAF)) {
+        if constexpr (stable) {
+            std::stable_sort(first, last, comp);
+        }
+        else {
+            std::sort(first, last, comp);
+        }
+        return;
+    }
+
+    // ARENA：缓冲区取自调用线程的arena，返回时回收
+    std::optional<arena_scope> scope;
+    if constexpr (Type == AllocatorType::ARENA) {
+        scope.emplace(arena::get_default<true>());
+    }
+    Alloc alloc;
+    T* buffer = alloc_traits::allocate(alloc, n);
+    if(buffer == nullptr) {
+        throw OutOfMemoryException();
+    }
+    // 归并只做移动赋值：平凡类型直接使用未初始化的缓冲区；
+    // 否则先把元素移动构造到缓冲区(不会抛出)，改为在缓冲区上排序，结果归并回原区间
+    constexpr bool trivial = std::is_trivially_copyable_v<T>;
+    struct buffer_guard {
+        Alloc& alloc;
+        T* buffer;
+        size_t n;
+        ~buffer_guard() {
+            if constexpr (!trivial) {
+                std::destroy(buffer, buffer + n);
+            }
+            alloc_traits::deallocate(alloc, buffer, n);
+        }
+    } guard{alloc, buffer, n};
+    if constexpr (trivial) {
+        pool.run([&] { sort_into<stable>(pool, first, buffer, n, leaf, false, comp); });
+    }
+    else {
+        pool.run([&] {
+            pool.parallel_for(0, n, grain_for(pool, n), [&](size_t lo, size_t hi) {
+                std::uninitialized_move(first + lo, first + hi, buffer + lo);
+            });
+            sort_into<stable>(pool, buffer, first, n, leaf, true, comp);
+        });
+    }
+}
+
+} // namespace parallel_detail
+
+// 对每个元素调用f
+template<std::random_access_iterator It, typename F>
+void parallel_for_each(thread_pool& pool, It first, It last, F f) {
+    size_t n = (size_t)(last - first);
+    if(parallel_detail::run_serial(pool, n)) {
+        std::for_each(first, last, f);
+        return;
+    }
+    pool.parallel_for(0, n, parallel_detail::grain_for(pool, n), [&](size_t lo, size_t hi) {
+        std::for_each(first + lo, first + hi, f);
+    });
+}
+
+template<std::random_access_iterator It, typename F>
+void parallel_for_each(It first, It last, F f) {
+    parallel_for_each(thread_pool::get_default(), first, last, std::move(f));
+}
+
+// d_first[i] = op(first[i])，返回输出区间的末尾
+template<std::random_access_iterator It, std::random_access_iterator Out, typename F>
+Out parallel_transform(thread_pool& pool, It first, It last, Out d_first, F op) {
+    size_t n = (size_t)(last - first);
+    if(parallel_detail::run_serial(pool, n)) {
+        return std::transform(first, last, d_first, op);
+    }
+    pool.parallel_for(0, n, parallel_detail::grain_for(pool, n), [&](size_t lo, size_t hi) {
+        std::transform(first + lo, first + hi, d_first + lo, op);
+    });
+    return d_first + n;
+}
+
+template<std::random_access_iterator It, std::random_access_iterator Out, typename F>
+Out parallel_transform(It first, It last, Out d_first, F op) {
+    return parallel_transform(thread_pool::get_default(), first, last, d_first, std::move(op));
+}
+
+// 按顺序归约：init op first[0] op first[1] ...，op须满足结合律
+template<std::random_access_iterator It, typename T, typename Op = std::plus<>>
+T parallel_reduce(thread_pool& pool, It first, It last, T init, Op op = Op()) {
+    size_t n = (size_t)(last - first);
+    if(parallel_detail::run_serial(pool, n)) {
+        return std::accumulate(first, last, std::move(init), op);
+    }
+    size_t grain = parallel_detail::grain_for(pool, n);
+    // [lo, hi)的归约结果；每段以首元素为初值，不需要单位元
+    auto reduce_range = [&](auto& self, size_t lo, size_t hi) -> T {
+        if(hi - lo <= grain) {
+            T sum = first[lo];
+            for(size_t i = lo + 1; i < hi; i++) {
+                sum = op(std::move(sum), first[i]);
+            }
+            return sum;
+        }
+        size_t middle = lo + (hi - lo) / 2;
+        std::optional<T> left, right;
+        pool.fork_join([&] { left.emplace(self(self, lo, middle)); },
+                       [&] { right.emplace(self(self, middle, hi)); });
+        return op(std::move(*left), std::move(*right));
+    };
+    std::optional<T> total;
+    pool.run([&] { total.emplace(reduce_range(reduce_range, 0, n)); });
+    return op(std::move(init), std::move(*total));
+}
+
+template<std::random_access_iterator It, typename T, typename Op = std::plus<>>
+T parallel_reduce(It first, It last, T init, Op op = Op()) {
+    return parallel_reduce(thread_pool::get_default(), first, last, std::move(init), std::move(op));
+}
+
+// d_first[i] = first[0] op ... op first[i]，返回输出区间的末尾；op须满足结合律
+template<std::random_access_iterator It, std::random_access_iterator Out, typename Op = std::plus<>>
+Out parallel_inclusive_scan(thread_pool& pool, It first, It last, Out d_first, Op op = Op()) {
+    using T = typename std::iterator_traits<It>::value_type;
+    using Alloc = alloc_t<T, AllocatorType::ARENA>;
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    size_t n = (size_t)(last - first);
+    if(parallel_detail::run_serial(pool, n)) {
+        return std::inclusive_scan(first, last, d_first, op);
+    }
+    // 块数取线程数的GRAIN_SPLIT倍(块前缀串行计算，块不宜过多)
+    size_t grain = parallel_detail::grain_for(pool, n);
+    size_t blocks = (n + grain - 1) / grain;
+
+    arena_scope scope(arena::get_default<true>());
+    Alloc alloc;
+    T* sums = alloc_traits::allocate(alloc, blocks - 1);
+    if(sums == nullptr) {
+        throw OutOfMemoryException();
+    }
+    // 第一趟：各块(最后一块除外)的归约，先以块首元素构造再并行填入
+    size_t constructed = 0;
+    struct sums_guard {
+        T* sums;
+        size_t& count;
+        ~sums_guard() { std::destroy(sums, sums + count); }
+    } guard{sums, constructed};
+    for(size_t b = 0; b + 1 < blocks; b++) {
+        alloc_traits::construct(alloc, sums + b, first[b * grain]);
+        constructed++;
+    }
+    pool.parallel_for(0, blocks - 1, 1, [&](size_t lo, size_t hi) {
+        for(size_t b = lo; b < hi; b++) {
+            T sum = first[b * grain];
+            size_t end = (b + 1) * grain;
+            for(size_t i = b * grain + 1; i < end; i++) {
+                sum = op(std::move(sum), first[i]);
+            }
+            sums[b] = std::move(sum);
+        }
+    });
+    // 第二趟：块前缀，sums[b]变为前b + 1块的归约
+    for(size_t b = 1; b + 1 < blocks; b++) {
+        sums[b] = op(sums[b - 1], std::move(sums[b]));
+    }
+    // 第三趟：各块以前面各块的归约为起点扫描
+    pool.parallel_for(0, blocks, 1, [&](size_t lo, size_t hi) {
+        for(size_t b = lo; b < hi; b++) {
+            size_t begin = b * grain;
+            size_t end = std::min(n, begin + grain);
+            if(b == 0) {
+                std::inclusive_scan(first, first + end, d_first, op);
+            }
+            else {
+                std::inclusive_scan(first + begin, first + end, d_first + begin, op, sums[b - 1]);
+            }
+        }
+    });
+    return d_first + n;
+}
+
+template<std::random_access_iterator It, std::random_access_iterator Out, typename Op = std::plus<>>
+Out parallel_inclusive_scan(It first, It last, Out d_first, Op op = Op()) {
+    return parallel_inclusive_scan(thread_pool::get_default(), first, last, d_first, std::move(op));
+}
+
+// 并行归并排序(不稳定)，归并缓冲区来自alloc_t<value_type, Type>
+template<AllocatorType Type = AllocatorType::POOL, std::random_access_iterator It, typename Comp = std::less<>>
+void parallel_sort(thread_pool& pool, It first, It last, Comp comp = Comp()) {
+    parallel_detail::merge_sort<false, Type>(pool, first, last, comp);
+}
+
+template<AllocatorType Type = AllocatorType::POOL, std::random_access_iterator It, typename Comp = std::less<>>
+void parallel_sort(It first, It last, Comp comp = Comp()) {
+    parallel_detail::merge_sort<false, Type>(thread_pool::get_default(), first, last, comp);
+}
+
+// 并行归并排序(稳定)
+template<AllocatorType Type = AllocatorType::POOL, std::random_access_iterator It, typename Comp = std::less<>>
+void parallel_stable_sort(thread_pool& pool, It first, It last, Comp comp = Comp()) {
+    parallel_detail::merge_sort<true, Type>(pool, first, last, comp);
+}
+
+template<AllocatorType Type = AllocatorType::POOL, std::random_access_iterator It, typename Comp = std::less<>>
+void parallel_stable_sort(It first, It last, Comp comp = Comp()) {
+    parallel_detail::merge_sort<true, Type>(thread_pool::get_default(), first, last, comp);
+}
+
+} // namespace Cat
@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+//分配器统计
+/*
+计数方式：
+1）热路径(分配/释放)只改本线程的计数器，relaxed读+relaxed写，不带lock前缀，代价约等于普通自增
+2）慢路径(refill、chunk_alloc、归还中心池)改全局原子计数器
+3）snapshot时合并全部线程的计数器；线程退出时其计数器并入retired汇总
+4）高水位在慢路径按线程增量发布，snapshot时再用精确值校正，误差不超过每线程一批节点
+编译时定义CAT_POOL_STATS=0可去掉全部计数
+*/
+
+#ifndef CAT_POOL_STATS
+#define CAT_POOL_STATS 1
+#endif
+
+namespace Cat {
+
+// 单写者计数器：只有所属线程写入，其他线程只读
+class stat_counter {
+private:
+    std::atomic<uint64_t> value{0};
+
+public:
+    constexpr stat_counter() noexcept = default;
+
+    void add(uint64_t delta) noexcept {
+        value.store(value.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+    uint64_t load() const noexcept { return value.load(std::memory_order_relaxed); }
+};
+
+// 单个大小类的统计
+struct size_class_stats {
+    size_t node_size = 0;              // 节点大小
+    uint64_t allocations = 0;          // 分配次数
+    uint64_t frees = 0;                // 释放次数
+    uint64_t live_bytes = 0;           // 当前在用字节数(按节点大小)
+    uint64_t requested_bytes = 0;      // 当前在用字节数(按请求大小)
+    uint64_t high_water_bytes = 0;     // 在用字节数高水位
+    uint64_t free_nodes = 0;           // 空闲节点数(中心池 + 线程缓存)
+    uint64_t remote_frees = 0;         // 归还到其他线程堆的次数(跨线程释放)
+    uint64_t refills = 0;              // refill次数(线程缓存/中心池为空)
+    uint64_t chunk_allocs = 0;         // chunk_alloc次数
+    uint64_t system_bytes = 0;         // 为该级向系统申请的字节数(累计)
+
+    // 内部碎片：节点大小向上取整浪费的字节数
+    uint64_t fragmentation_bytes() const { return live_bytes - requested_bytes; }
+};
+
+// 内存池统计快照
+struct pool_stats {
+    std::vector<size_class_stats> classes;
+    uint64_t large_allocations = 0;    // 大块(绕过内存池)分配次数
+    uint64_t large_frees = 0;          // 大块释放次数
+    uint64_t large_live_bytes = 0;     // 大块当前在用字节数
+    uint64_t large_total_bytes = 0;    // 大块累计分配字节数
+    uint64_t pool_bytes = 0;           // 内存池当前持有的系统内存
+    uint64_t system_bytes = 0;         // 累计向系统申请的字节数
+    uint64_t released_bytes = 0;       // 累计trim归还的字节数
+
+    void dump(FILE* out = stdout) const {
+        fprintf(out, "%10s %12s %12s %12s %12s %12s %10s %12s %8s %8s %12s\n",
+                "size", "allocs", "frees", "live", "high_water", "frag", "free_nodes", "remote", "refills", "chunks", "system");
+        for(const size_class_stats& row : classes) {
+            if(row.allocations == 0 && row.system_bytes == 0) {
+                continue;
+            }
+            fprintf(out, "%10zu %12llu %12llu %12llu %12llu %12llu %10llu %12llu %8llu %8llu %12llu\n",
+                    row.node_size,
+                    (unsigned long long)row.allocations, (unsigned long long)row.frees,
+                    (unsigned long long)row.live_bytes, (unsigned long long)row.high_water_bytes,
+                    (unsigned long long)row.fragmentation_bytes(), (unsigned long long)row.free_nodes,
+                    (unsigned long long)row.remote_frees, (unsigned long long)row.refills,
+                    (unsigned long long)row.chunk_allocs, (unsigned long long)row.system_bytes);
+        }
+        fprintf(out, "large: allocs %llu, frees %llu, live %llu, total %llu\n",
+                (unsigned long long)large_allocations, (unsigned long long)large_frees,
+                (unsigned long long)large_live_bytes, (unsigned long long)large_total_bytes);
+        fprintf(out, "pool: holding %llu, fetched %llu, released %llu\n",
+                (unsigned long long)pool_bytes, (unsigned long long)system_bytes, (unsigned long long)released_bytes);
+    }
+
+    std::string to_json() const {
+        std::string json = "{\"classes\":[";
+        char buffer[512];
+        bool first = true;
+        for(const size_class_stats& row : classes) {
+            snprintf(buffer, sizeof(buffer),
+                     "%s{\"size\":%zu,\"allocations\":%llu,\"frees\":%llu,\"live_bytes\":%llu,"
+                     "\"requested_bytes\":%llu,\"high_water_bytes\":%llu,\"fragmentation_bytes\":%llu,"
+                     "\"free_nodes\":%llu,\"remote_frees\":%llu,\"refills\":%llu,\"chunk_allocs\":%llu,\"system_bytes\":%llu}",
+                     first ? "" : ",", row.node_size,
+                     (unsigned long long)row.allocations, (unsigned long long)row.frees,
+                     (unsigned long long)row.live_bytes, (unsigned long long)row.requested_bytes,
+                     (unsigned long long)row.high_water_bytes, (unsigned long long)row.fragmentation_bytes(),
+                     (unsigned long long)row.free_nodes, (unsigned long long)row.remote_frees,
+                     (unsigned long long)row.refills,
+                     (unsigned long long)row.chunk_allocs, (unsigned long long)row.system_bytes);
+            json += buffer;
+            first = false;
+        }
+        snprintf(buffer, sizeof(buffer),
+                 "],\"large\":{\"allocations\":%llu,\"frees\":%llu,\"live_bytes\":%llu,\"total_bytes\":%llu},"
+                 "\"pool_bytes\":%llu,\"system_bytes\":%llu,\"released_bytes\":%llu}",
+                 (unsigned long long)large_allocations, (unsigned long long)large_frees,
+                 (unsigned long long)large_live_bytes, (unsigned long long)large_total_bytes,
+                 (unsigned long long)pool_bytes, (unsigned long long)system_bytes, (unsigned long long)released_bytes);
+        json += buffer;
+        return json;
+    }
+};
+
+} // namespace Cat
@@ -0,0 +1,292 @@
+#pragma once
+#include "Cat++_allocator.h"
+#include "Cat++_page_source.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+//分配轨迹记录
+/*
+记录真实负载的每一次allocate/deallocate/reallocate，写成紧凑的二进制文件，再由bench/Cat++_trace_replay.cpp
+对各个AllocatorType与系统malloc重放，比较吞吐、延迟分位数与峰值内存
+记录来源：
+1）tracing_allocator<Alloc>：包装任一static_allocator，容器换成它即记录该容器的全部分配
+2）malloc替换库(shim/Cat++_malloc_shim.cpp)：设置环境变量CAT_MALLOC_TRACE=文件路径，记录整个进程的malloc/free/new/delete
+
+alloc_trace::start(path)开始记录，stop()写出全部缓冲并关闭文件：
+1）每个线程一块固定大小的记录缓冲(BUFFER_RECORDS条，来自mmap_page_source，不经过malloc)，记录只写本线程缓冲，不加锁
+2）缓冲写满时由所属线程加锁整块写入文件(一次fwrite)，线程退出时写出剩余记录并归还缓冲
+3）记录过程中再次进入分配函数(例如注册线程退出回调时libc申请内存)不记录，避免递归
+4）stop()写出其他线程缓冲时不与它们同步，应在其他线程停止分配后调用；之后仍在分配的线程的记录可能丢失
+5）fork出的子进程不再记录(fork_child)
+文件中的记录按线程分块、块内按时间有序，读取时按时间戳稳定排序(read_trace)
+*/
+
+/*
+文件布局：[trace_file_header | trace_record ...]
+- ptr/old_ptr只用于配对：重放时按地址把释放与分配对应起来，同一地址释放后可以再次出现
+- align为0表示按分配器默认对齐，否则为显式对齐
+- 释放记录的size可以为0(free不带大小)，重放时以分配时的大小为准
+*/
+
+namespace Cat {
+
+enum class trace_op : uint8_t {
+    ALLOCATE = 1,
+    DEALLOCATE = 2,
+    REALLOCATE = 3       // ptr为新地址，old_ptr为原地址，size为新大小
+};
+
+struct trace_record {
+    uint64_t time;       // 距start()的纳秒数
+    uint64_t ptr;
+    uint64_t old_ptr;
+    uint64_t size;
+    uint32_t thread;     // 记录线程的序号(从1开始)
+    uint8_t op;          // trace_op
+    uint8_t align_shift; // 对齐为1 << align_shift，0表示默认对齐
+    uint16_t reserved;
+};
+static_assert(sizeof(trace_record) == 40, "trace records are written to files as-is");
+
+struct trace_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+class alloc_trace final {
+public:
+    static constexpr char MAGIC[8] = {'C', 'A', 'T', 'T', 'R', 'A', 'C', 'E'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t BUFFER_RECORDS = 4096;           // 每线程缓冲的记录数(160K)
+
+private:
+    alloc_trace() = delete;
+
+    struct thread_buffer {
+        trace_record* records;
+        size_t count;
+        uint32_t thread;
+        bool busy;                                           // 正在记录，期间的分配不记录
+        thread_buffer* next;                                 // buffers链表
+    };
+    static inline thread_local thread_buffer local = {};
+
+    static inline std::atomic<bool> enabled{false};
+    static inline std::mutex file_mutex;                     // 保护file与buffers
+    static inline FILE* file = nullptr;
+    static inline thread_buffer* buffers = nullptr;          // 已注册线程的缓冲
+    static inline std::atomic<uint32_t> next_thread{1};
+    static inline std::chrono::steady_clock::time_point origin;
+
+    struct buffer_guard {
+        ~buffer_guard() {
+            std::lock_guard<std::mutex> lock(file_mutex);
+            flush_locked(local);
+            for(thread_buffer** link = &buffers; *link; link = &(*link)->next) {
+                if(*link == &local) {
+                    *link = local.next;
+                    break;
+                }
+            }
+            mmap_page_source::release(local.records, BUFFER_RECORDS * sizeof(trace_record));
+            local.records = nullptr;
+            local.busy = true;                               // 线程退出过程中的分配不再记录
+        }
+    };
+
+    static void flush_locked(thread_buffer& buffer) noexcept {
+        if(file && buffer.count) {
+            fwrite(buffer.records, sizeof(trace_record), buffer.count, file);
+        }
+        buffer.count = 0;
+    }
+
+    // 首次记录：申请缓冲并注册线程退出回调，失败时本线程不再记录
+    static bool register_thread() noexcept {
+        local.records = static_cast<trace_record*>(mmap_page_source::allocate(BUFFER_RECORDS * sizeof(trace_record)));
+        if(local.records == nullptr) {
+            return false;
+        }
+        static thread_local buffer_guard guard;
+        (void)guard;
+        local.thread = next_thread.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(file_mutex);
+        local.next = buffers;
+        buffers = &local;
+        return true;
+    }
+
+public:
+    // 开始记录到path(覆盖已有文件)，已在记录或无法打开文件时返回false
+    static bool start(const char* path) noexcept {
+        std::lock_guard<std::mutex> lock(file_mutex);
+        if(file) {
+            return false;
+        }
+        file = fopen(path, "wb");
+        if(file == nullptr) {
+            fprintf(stderr, "alloc trace: cannot open %s\n", path);
+            return false;
+        }
+        setvbuf(file, nullptr, _IONBF, 0);                   // 记录已在线程缓冲中成块，stdio不再申请缓冲
+        trace_file_header header = {};
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.record_size = sizeof(trace_record);
+        fwrite(&header, sizeof(header), 1, file);
+        origin = std::chrono::steady_clock::now();
+        enabled.store(true, std::memory_order_release);
+        return true;
+    }
+
+    // 停止记录，写出全部线程缓冲并关闭文件
+    static void stop() noexcept {
+        enabled.store(false, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(file_mutex);
+        for(thread_buffer* buffer = buffers; buffer; buffer = buffer->next) {
+            flush_locked(*buffer);
+        }
+        if(file) {
+            fclose(file);
+            file = nullptr;
+        }
+    }
+
+    static bool is_enabled() noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    // fork前后调用(pthread_atfork)：fork时持有file_mutex，子进程停止记录，不与父进程写同一个文件
+    static void fork_prepare() noexcept { file_mutex.lock(); }
+    static void fork_parent() noexcept { file_mutex.unlock(); }
+    static void fork_child() noexcept {
+        enabled.store(false, std::memory_order_relaxed);
+        if(file) {
+            fclose(file);
+            file = nullptr;
+        }
+        file_mutex.unlock();
+    }
+
+    // 记录一次操作，未开始记录时只有一次relaxed读
+    static void record(trace_op op, const void* ptr, const void* old_ptr, size_t size, size_t align = 0) noexcept {
+        if(!enabled.load(std::memory_order_relaxed)) {
+            return;
+        }
+        thread_buffer& buffer = local;
+        if(buffer.busy) {
+            return;
+        }
+        buffer.busy = true;
+        if(buffer.records != nullptr || register_thread()) {
+            trace_record& entry = buffer.records[buffer.count++];
+            entry.time = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - origin).count();
+            entry.ptr = (uint64_t)(uintptr_t)ptr;
+            entry.old_ptr = (uint64_t)(uintptr_t)old_ptr;
+            entry.size = size;
+            entry.thread = buffer.thread;
+            entry.op = (uint8_t)op;
+            entry.align_shift = align ? (uint8_t)std::countr_zero(align) : 0;
+            entry.reserved = 0;
+            if(buffer.count == BUFFER_RECORDS) {
+                std::lock_guard<std::mutex> lock(file_mutex);
+                flush_locked(buffer);
+            }
+            buffer.busy = false;
+        }
+        // 申请缓冲失败时保持busy，本线程之后不再记录
+    }
+};
+
+// 读取轨迹文件并按时间戳稳定排序，文件不存在或格式不符时返回false
+inline bool read_trace(const char* path, std::vector<trace_record>& records) {
+    FILE* in = fopen(path, "rb");
+    if(in == nullptr) {
+        fprintf(stderr, "alloc trace: cannot open %s\n", path);
+        return false;
+    }
+    trace_file_header header;
+    if(fread(&header, sizeof(header), 1, in) != 1 || memcmp(header.magic, alloc_trace::MAGIC, sizeof(header.magic)) != 0
+       || header.version != alloc_trace::VERSION || header.record_size != sizeof(trace_record)) {
+        fprintf(stderr, "alloc trace: %s is not a version %u trace\n", path, alloc_trace::VERSION);
+        fclose(in);
+        return false;
+    }
+    trace_record buffer[1024];
+    size_t count;
+    while((count = fread(buffer, sizeof(trace_record), 1024, in)) > 0) {
+        records.insert(records.end(), buffer, buffer + count);
+    }
+    fclose(in);
+    std::stable_sort(records.begin(), records.end(), [](const trace_record& a, const trace_record& b) {
+        return a.time < b.time;
+    });
+    return true;
+}
+
+// 记录分配的包装器：转发给被包装的static_allocator，并把每次操作写入alloc_trace
+template<static_allocator Alloc>
+class tracing_allocator : public allocator_base<tracing_allocator<Alloc>, Alloc::thread_safe, typename Alloc::value_type> {
+private:
+    using T = typename Alloc::value_type;
+
+    template<static_allocator>
+    friend class tracing_allocator;
+
+    [[no_unique_address]] Alloc alloc;
+
+public:
+    template<typename U>
+    struct rebind {
+        using other = tracing_allocator<typename Alloc::template rebind<U>::other>;
+    };
+
+    tracing_allocator() = default;
+    explicit tracing_allocator(const Alloc& other) : alloc(other) {}
+    template<static_allocator Other>
+    tracing_allocator(const tracing_allocator<Other>& other) : alloc(other.alloc) {}
+
+    const Alloc& get_allocator() const noexcept { return alloc; }
+
+    T* allocate(size_t n) {
+        T* result = alloc.allocate(n);
+        if(result) {
+            alloc_trace::record(trace_op::ALLOCATE, result, nullptr, n * sizeof(T));
+        }
+        return result;
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept {
+        if(ptr) {
+            alloc_trace::record(trace_op::DEALLOCATE, ptr, nullptr, n * sizeof(T));
+        }
+        alloc.deallocate(ptr, n);
+    }
+
+    T* reallocate(T* ptr, size_t old_size, size_t new_size) {
+        T* result = alloc.reallocate(ptr, old_size, new_size);
+        if(result) {
+            alloc_trace::record(trace_op::REALLOCATE, result, ptr, new_size * sizeof(T));
+        }
+        return result;
+    }
+};
+
+template<static_allocator A1, static_allocator A2>
+bool operator==(const tracing_allocator<A1>& a, const tracing_allocator<A2>& b) noexcept {
+    return a.get_allocator() == b.get_allocator();
+}
+
+template<static_allocator A1, static_allocator A2>
+bool operator!=(const tracing_allocator<A1>& a, const tracing_allocator<A2>& b) noexcept {
+    return !(a == b);
+}
+
+} // namespace Cat
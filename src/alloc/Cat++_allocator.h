@@ -2,14 +2,31 @@
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <concepts>
+#include <new>
+#include <utility>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
 
 #include "../execption/allocator_exception.h"
+#include "Cat++_heap_profile.h"
 //allocator interface
 
 //线程安全
 //尽量兼容STL接口规范
 //异常处理
 
+/*
+静态分派与运行时多态：
+1）allocator、pool_allocator、arena_allocator都继承CRTP基类allocator_base，不含虚函数，
+   容器按具体类型调用allocate/deallocate，空闲链表的弹出/压入可以完全内联；
+   无状态的分配器是空类，容器可通过空基类优化(EBO)或[[no_unique_address]]不占空间
+2）static_allocator概念约束"分配器"应提供的接口，替代原先由虚基类约束的接口
+3）需要运行时多态时，用virtual_allocator<Alloc>把任一static_allocator包装成allocator_interface的实现
+4）allocator与pool_allocator内置采样堆分析(见Cat++_heap_profile.h)，heap_profiler::start()后生效
+*/
 
 namespace Cat {
     
@@ -41,19 +58,91 @@ public:
     virtual ~allocator_interface() = default;
 };
 
+// 静态分配器概念：与allocator_interface相同的接口，但不要求虚函数
+template<typename A>
+concept static_allocator = requires(A a, const A ca, typename A::value_type* p, size_t n) {
+    typename A::value_type;
+    { a.allocate(n) } -> std::same_as<typename A::value_type*>;
+    { a.deallocate(p, n) } noexcept;
+    { a.reallocate(p, n, n) } -> std::same_as<typename A::value_type*>;
+    { ca.max_size() } -> std::convertible_to<size_t>;
+    { A::thread_safe } -> std::convertible_to<bool>;
+};
+
+// CRTP基类：公共类型、构造/析构、按复制实现的重分配
+template<class Derived, bool threads, class T>
+class allocator_base {
+public:
+    // 向外传递类型
+    typedef T           value_type;
+    typedef T*          pointer;
+    typedef const T*    const_pointer;
+    typedef T&          reference;
+    typedef const T&    const_reference;
+    typedef size_t      size_type;
+    typedef ptrdiff_t   difference_type;
+
+    static constexpr bool thread_safe = threads;
+
+    //可分配最大成员数：分配内存的最大值是size_t(-1)（如32位系统上是 2^32-1）；
+    size_t max_size() const noexcept {
+        return size_t(-1) / sizeof(T);
+    }
+
+    //虽然是按T类型分配的空间，但构造时用U指定类型更灵活，允许在容器内构造不同类型的对象（如迭代器）
+    //typename... Args支持构造时参数指定任意类型，事实上泛型函数可根据入参自动推导泛型，所以调用时不用显式指定
+    //变量传递时会发生值拷贝，但左右值引用都是0拷贝的，const var&声明则用指针读取值，不拷贝；声明var&&传递右值则直接用右值
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args) {//&&接受右值，或右值引用变量，但为了避免再写一个左值引用的版本，&&语法实际允许左值和左值引用输入
+        try {
+            ::new((void*)p) U(std::forward<Args>(args)...);//Args&&... args声明了函数内部形参args值传递是0拷贝的，但形参args又变成了左值，std::forward<Args>(args)用于恢复值原始类型
+        } catch (const std::exception& e) {
+            fprintf(stderr, "construct failed: %s\n", e.what());
+        }
+    }
+    
+    template<typename U>
+    void destroy(U* p) {
+        try {
+            p->~U();
+        } catch (const std::exception& e) {
+            fprintf(stderr, "destroy failed: %s\n", e.what());
+        }
+    }
+
+protected:
+    allocator_base() noexcept = default;
+
+    Derived& derived() noexcept { return static_cast<Derived&>(*this); }
+
+    // 用派生类的allocate/deallocate实现重分配：申请新块，复制较小的一段，释放旧块
+    T* relocate(T* ptr, size_t old_size, size_t new_size) {
+        T* result = derived().allocate(new_size);
+        if(result == nullptr) {
+            return nullptr;
+        }
+        if(ptr) {
+            memcpy((void*)result, (void*)ptr, (old_size < new_size ? old_size : new_size) * sizeof(T));
+            derived().deallocate(ptr, old_size);
+        }
+        return result;
+    }
+};
+
 // 基础实现
 template<bool threads, class T>
-class allocator : public allocator_interface<threads, T> {
+class allocator : public allocator_base<allocator<threads, T>, threads, T> {
 public:
-    // 继承接口的类型
-    using typename allocator_interface<threads, T>::value_type;//不这样外部使用时，需要写allocator<false, int>::allocator_interface<false, int>::value_type
-    using typename allocator_interface<threads, T>::pointer;
-    using typename allocator_interface<threads, T>::const_pointer;
-    using typename allocator_interface<threads, T>::reference;
-    using typename allocator_interface<threads, T>::const_reference;
-    using typename allocator_interface<threads, T>::size_type;
-    using typename allocator_interface<threads, T>::difference_type;
-    using typename allocator_interface<threads, T>::exception_handler;
+    typedef void(*exception_handler)();
+
+    template<typename U>
+    struct rebind {
+        using other = allocator<threads, U>;
+    };
+
+    allocator() noexcept = default;
+    template<typename U>
+    allocator(const allocator<threads, U>&) noexcept {}
 
     // 异常处理
     static exception_handler set_exception_handler(exception_handler f) {
@@ -62,18 +151,45 @@ public:
         return old;
     }
 
+    // malloc保证的对齐，超过它的alignof(T)或显式对齐走对齐分配
+    static constexpr size_t MALLOC_ALIGN = alignof(max_align_t);
+
 private:
     static inline exception_handler alloc_oom_handler = nullptr;
-    
-    static T* oom_malloc(size_t bytes) { 
-        T* result = static_cast<T*>(malloc(bytes));
+
+    // 按align(2的幂)向系统申请/归还内存，align不超过MALLOC_ALIGN时就是malloc/free
+    static void* system_malloc(size_t bytes, size_t align) noexcept {
+        if(align <= MALLOC_ALIGN) {
+            return malloc(bytes);
+        }
+#if defined(_WIN32)
+        return _aligned_malloc(bytes, align);
+#else
+        void* result = nullptr;
+        return posix_memalign(&result, align, bytes) == 0 ? result : nullptr;
+#endif
+    }
+
+    static void system_free(void* ptr, size_t align) noexcept {
+#if defined(_WIN32)
+        if(align > MALLOC_ALIGN) {
+            _aligned_free(ptr);
+            return;
+        }
+#endif
+        (void)align;
+        ::free(ptr);
+    }
+
+    static T* oom_malloc(size_t bytes, size_t align = alignof(T)) { 
+        T* result = static_cast<T*>(system_malloc(bytes, align));
         if(result == nullptr) {
             for(;;) {
                 if(alloc_oom_handler == nullptr) {
                     throw OutOfMemoryException();
                 }
                 alloc_oom_handler();
-                result = static_cast<T*>(malloc(bytes));
+                result = static_cast<T*>(system_malloc(bytes, align));
                 if(result) {
                     return result;
                 }
@@ -82,82 +198,119 @@ private:
         return result;
     }
     
+    // realloc失败时ptr仍然有效，处理OOM后以同一地址重试
     static T* oom_realloc(T* ptr, size_t new_size) {
-        T* result = static_cast<T*>(realloc(ptr, new_size));
-        if(result == nullptr) {
-            for(;;) {
-                if(alloc_oom_handler == nullptr) {
-                    throw OutOfMemoryException();
-                }
-                alloc_oom_handler();
-                result = static_cast<T*>(realloc(ptr, new_size));
-                if(result) {
-                    return result;
-                }
+        for(;;) {
+            T* result = static_cast<T*>(realloc((void*)ptr, new_size));
+            if(result) {
+                return result;
+            }
+            if(alloc_oom_handler == nullptr) {
+                throw OutOfMemoryException();
             }
+            alloc_oom_handler();
         }
-        return result;
     }
     
 public:
-    //虽然这些函数不绑定实例数据，但它们需要支持多态，所以不用static
-    T* allocate(size_t n) override {
+    //虽然这些函数不绑定实例数据，但为了与标准分配器的调用形式一致，不用static；无状态且非虚，调用可完全内联
+    T* allocate(size_t n) {
+        return allocate(n, alignof(T));
+    }
+
+    // 按align对齐分配，align小于alignof(T)时按alignof(T)
+    T* allocate(size_t n, size_t align) {
         try {
-            return oom_malloc(n * sizeof(T));
+            T* result = oom_malloc(n * sizeof(T), align > alignof(T) ? align : alignof(T));
+            heap_profiler::on_allocate(result, n * sizeof(T));
+            return result;
         } catch (const std::exception& e) {
             fprintf(stderr, "alloc failed: %s\n", e.what());
             return nullptr;
         }
     }
 
-    void deallocate(T* ptr, size_t n) noexcept override {//显式声明不抛异常，可安全调用
-        ::free(ptr);
+    void deallocate(T* ptr, size_t) noexcept {//显式声明不抛异常，可安全调用
+        heap_profiler::on_deallocate(ptr);
+        system_free(ptr, alignof(T));
     }
 
-    T* reallocate(T* ptr, size_t old_size, size_t new_size) override {
+    // align须与分配时相同
+    void deallocate(T* ptr, size_t, size_t align) noexcept {
+        heap_profiler::on_deallocate(ptr);
+        system_free(ptr, align > alignof(T) ? align : alignof(T));
+    }
+
+    T* reallocate(T* ptr, size_t old_size, size_t new_size) {
+        // realloc不保证超过MALLOC_ALIGN的对齐，只能重新分配再复制
+        if constexpr (alignof(T) > MALLOC_ALIGN) {
+            return this->relocate(ptr, old_size, new_size);
+        }
+        // 先取出旧地址的样本：realloc之后它可能立刻被其他线程重新分配并采样；失败时旧块仍在用，样本放回
+        heap_profiler::detached_sample sample = heap_profiler::on_reallocate(ptr);
         try {
-            return oom_realloc(ptr, new_size * sizeof(T));
+            T* result = oom_realloc(ptr, new_size * sizeof(T));
+            heap_profiler::on_allocate(result, new_size * sizeof(T));
+            return result;
         } catch (const std::exception& e) {
+            heap_profiler::on_reallocate_failed(sample);
             fprintf(stderr, "reallocate failed: %s\n", e.what());
             return nullptr;
         }   
     }
+};
 
-    //可分配最大成员数：分配内存的最大值是size_t(-1)（如32位系统上是 2^32-1）；
-    size_t max_size() const noexcept override {
-        return size_t(-1) / sizeof(T);
-    }
+// allocator是无状态的，所有allocator都相等
+// 定义在命名空间作用域：写成类内friend模板时，每实例化一个allocator<threads, T>都会重复定义一次
+template<bool threads, typename T1, typename T2>
+bool operator==(const allocator<threads, T1>&, const allocator<threads, T2>&) noexcept {
+    return true;
+}
 
-    //虽然是按T类型分配的空间，但构造时用U指定类型更灵活，允许在容器内构造不同类型的对象（如迭代器）
-    //typename... Args支持构造时参数指定任意类型，事实上泛型函数可根据入参自动推导泛型，所以调用时不用显式指定
-    //变量传递时会发生值拷贝，但左右值引用都是0拷贝的，const var&声明则用指针读取值，不拷贝；声明var&&传递右值则直接用右值
-    template<typename U, typename... Args>
-    void construct(U* p, Args&&... args) {//&&接受右值，或右值引用变量，但为了避免再写一个左值引用的版本，&&语法实际允许左值和左值引用输入
-        try {
-            ::new((void*)p) U(std::forward<Args>(args)...);//Args&&... args声明了函数内部形参args值传递是0拷贝的，但形参args又变成了左值，std::forward<Args>(args)用于恢复值原始类型
-        } catch (const std::exception& e) {
-            fprintf(stderr, "construct failed: %s\n", e.what());
-        }
-    }
-    
+template<bool threads, typename T1, typename T2>
+bool operator!=(const allocator<threads, T1>&, const allocator<threads, T2>&) noexcept {
+    return false;
+}
+
+// 运行时多态(可选)：把静态分配器包装成allocator_interface，按值持有被包装的分配器
+template<static_allocator Alloc>
+class virtual_allocator : public allocator_interface<Alloc::thread_safe, typename Alloc::value_type> {
+private:
+    using T = typename Alloc::value_type;
+
+    [[no_unique_address]] Alloc alloc;
+
+public:
     template<typename U>
-    void destroy(U* p) {
-        try {
-            p->~U();
-        } catch (const std::exception& e) {
-            fprintf(stderr, "destroy failed: %s\n", e.what());
-        }
-    }
+    struct rebind {
+        using other = virtual_allocator<typename Alloc::template rebind<U>::other>;
+    };
 
-    // allocator是无状态的，所有allocator都相等
-    template<typename T1, typename T2>
-    friend bool operator==(const allocator<threads, T1>&, const allocator<threads, T2>&) noexcept {
-        return true;
-    }
+    virtual_allocator() = default;
+    explicit virtual_allocator(const Alloc& other) : alloc(other) {}
+    template<static_allocator Other>
+    virtual_allocator(const virtual_allocator<Other>& other) : alloc(other.get_allocator()) {}
 
-    template<typename T1, typename T2>
-    friend bool operator!=(const allocator<threads, T1>&, const allocator<threads, T2>&) noexcept {
-        return false;
-    }
+    const Alloc& get_allocator() const noexcept { return alloc; }
+
+    T* allocate(size_t n) override { return alloc.allocate(n); }
+    void deallocate(T* ptr, size_t n) noexcept override { alloc.deallocate(ptr, n); }
+    T* reallocate(T* ptr, size_t old_size, size_t new_size) override { return alloc.reallocate(ptr, old_size, new_size); }
+    size_t max_size() const noexcept override { return alloc.max_size(); }
+
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args) { alloc.construct(p, std::forward<Args>(args)...); }
+    template<typename U>
+    void destroy(U* p) { alloc.destroy(p); }
 };
+
+template<static_allocator A1, static_allocator A2>
+bool operator==(const virtual_allocator<A1>& a, const virtual_allocator<A2>& b) noexcept {
+    return a.get_allocator() == b.get_allocator();
+}
+
+template<static_allocator A1, static_allocator A2>
+bool operator!=(const virtual_allocator<A1>& a, const virtual_allocator<A2>& b) noexcept {
+    return !(a == b);
+}
 }
\ No newline at end of file
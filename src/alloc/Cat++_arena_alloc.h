@@ -0,0 +1,278 @@
+#pragma once
+#include "Cat++_allocator.h"
+#include "Cat++_page_source.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+//区域分配器(arena)
+/*
+适用场景：一次请求内创建大量临时小对象，它们同时死亡
+1）分配只推进指针(bump pointer)，没有空闲链表
+2）deallocate不归还内存(只有释放最后一次分配的块时回退指针)，整个区域由reset()一次性回收，O(1)
+3）reset()/rewind()后已申请的block保留复用，release()才把block还给系统
+4）get_checkpoint()记录当前位置，rewind()回到该位置；arena_scope在析构时自动rewind，可任意嵌套
+arena本身不加锁，同一个arena只能由一个线程使用
+*/
+
+/*
+block布局：[block_header | 已分配区域 ... | ptr → 未分配区域 → end)
+- 全部block串成单链表，current之前为已用block，之后为reset/rewind后留待复用的空闲block
+- 当前block空间不足时，先尝试复用current之后的空闲block，不够大再向系统申请新block插到current之后
+- 新block大小从BLOCK_BYTES开始每次翻倍，不超过MAX_BLOCK_BYTES；超大的请求单独占一个block
+*/
+
+namespace Cat {
+
+class arena {
+private:
+    struct block_header {
+        block_header* next;                                  // block链表
+        size_t size;                                         // block总字节数(含头部)
+    };
+    static constexpr size_t HEADER_SIZE = (sizeof(block_header) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+
+    block_header* head = nullptr;                            // 第一个block
+    block_header* current = nullptr;                         // 正在分配的block
+    char* ptr = nullptr;                                     // 当前block的未分配区域起始位置
+    char* end = nullptr;                                     // 当前block结束位置
+    char* last = nullptr;                                    // 最后一次分配的起始位置，用于回退与原地扩展
+    size_t next_block_bytes;                                 // 下一个新block的大小
+    size_t reserved_bytes = 0;                               // 已向系统申请的字节数
+
+public:
+    static constexpr size_t BLOCK_BYTES = 64 * 1024;         // 默认首个block大小
+    static constexpr size_t MAX_BLOCK_BYTES = 4 * 1024 * 1024; // 翻倍增长的上限
+
+    // 位置标记：rewind()回到此处，之后的分配全部作废
+    struct checkpoint {
+        block_header* block;
+        char* ptr;
+    };
+
+    explicit arena(size_t block_bytes = BLOCK_BYTES) noexcept
+        : next_block_bytes(block_bytes < HEADER_SIZE * 2 ? HEADER_SIZE * 2 : block_bytes) {}
+    ~arena() { release(); }
+
+    // 禁止拷贝和移动：arena_allocator持有arena的地址
+    arena(const arena&) = delete;
+    arena& operator=(const arena&) = delete;
+    arena(arena&&) = delete;
+    arena& operator=(arena&&) = delete;
+
+    // 本线程(threads == true)或全局(threads == false)的默认arena，默认构造的arena_allocator使用它
+    template<bool threads>
+    static arena& get_default() {
+        if constexpr (threads) {
+            static thread_local arena instance;
+            return instance;
+        }
+        else {
+            static arena instance;
+            return instance;
+        }
+    }
+
+    // 分配bytes字节，按align(2的幂)对齐，系统内存不足时抛出OutOfMemoryException
+    void* allocate(size_t bytes, size_t align = alignof(max_align_t)) {
+        char* result = (char*)(((uintptr_t)ptr + align - 1) & ~(uintptr_t)(align - 1));
+        if(ptr == nullptr || result > end || (size_t)(end - result) < bytes) {
+            result = next_block(bytes, align);
+        }
+        ptr = result + bytes;
+        last = result;
+        return result;
+    }
+
+    // 只有释放最后一次分配的块时回退指针，其余情况什么也不做
+    void deallocate(void* p, size_t bytes) noexcept {
+        if(p != nullptr && p == last && (char*)p + bytes == ptr) {
+            ptr = last;
+            last = nullptr;
+        }
+    }
+
+    // 最后一次分配的块且当前block放得下时原地扩展/收缩，否则分配新块并复制
+    void* reallocate(void* p, size_t old_bytes, size_t new_bytes, size_t align = alignof(max_align_t)) {
+        if(p == nullptr) {
+            return allocate(new_bytes, align);
+        }
+        if(p == last && (char*)p + old_bytes == ptr && (size_t)(end - last) >= new_bytes) {
+            ptr = last + new_bytes;
+            return p;
+        }
+        if(new_bytes <= old_bytes) {
+            return p;
+        }
+        void* result = allocate(new_bytes, align);
+        memcpy(result, p, old_bytes);
+        return result;
+    }
+
+    checkpoint get_checkpoint() const noexcept { return {current, ptr}; }
+
+    // 回到cp记录的位置，cp之后申请的block留待复用
+    void rewind(const checkpoint& cp) noexcept {
+        if(cp.block == nullptr) {
+            reset();
+            return;
+        }
+        current = cp.block;
+        ptr = cp.ptr;
+        end = (char*)cp.block + cp.block->size;
+        last = nullptr;
+    }
+
+    // 作废全部分配，保留全部block，O(1)
+    void reset() noexcept {
+        current = head;
+        ptr = head ? (char*)head + HEADER_SIZE : nullptr;
+        end = head ? (char*)head + head->size : nullptr;
+        last = nullptr;
+    }
+
+    // 作废全部分配并把全部block还给系统
+    void release() noexcept {
+        for(block_header* block = head, *next; block; block = next) {
+            next = block->next;
+            malloc_page_source::release(block, block->size);
+        }
+        head = current = nullptr;
+        ptr = end = last = nullptr;
+        reserved_bytes = 0;
+    }
+
+    // 已向系统申请的字节数
+    size_t get_reserved_bytes() const noexcept { return reserved_bytes; }
+
+    // 已分配的字节数：current之前的block按容量计，current按已推进的位置计
+    size_t get_used_bytes() const noexcept {
+        size_t used = 0;
+        for(block_header* block = head; block; block = block->next) {
+            if(block == current) {
+                return used + (size_t)(ptr - ((char*)block + HEADER_SIZE));
+            }
+            used += block->size - HEADER_SIZE;
+        }
+        return used;
+    }
+
+private:
+    // 当前block不足：复用current之后足够大的空闲block，否则申请新block插到current之后
+    char* next_block(size_t bytes, size_t align) {
+        size_t need = bytes + (align > alignof(max_align_t) ? align : 0);
+        block_header* block = current ? current->next : head;
+        if(block == nullptr || block->size - HEADER_SIZE < need) {
+            size_t size = next_block_bytes;
+            if(size - HEADER_SIZE < need) {
+                size = HEADER_SIZE + need;
+            }
+            else if(next_block_bytes < MAX_BLOCK_BYTES) {
+                next_block_bytes *= 2;
+            }
+            block_header* fresh = (block_header*)malloc_page_source::allocate(size);
+            if(fresh == nullptr) {
+                throw OutOfMemoryException();
+            }
+            fresh->size = size;
+            reserved_bytes += size;
+            if(current) {
+                fresh->next = current->next;
+                current->next = fresh;
+            }
+            else {
+                fresh->next = head;
+                head = fresh;
+            }
+            block = fresh;
+        }
+        current = block;
+        end = (char*)block + block->size;
+        return (char*)(((uintptr_t)block + HEADER_SIZE + align - 1) & ~(uintptr_t)(align - 1));
+    }
+};
+
+// 作用域：构造时记录位置，析构时rewind，可嵌套
+class arena_scope {
+private:
+    arena& region;
+    arena::checkpoint mark;
+
+public:
+    explicit arena_scope(arena& target) noexcept : region(target), mark(target.get_checkpoint()) {}
+    ~arena_scope() { region.rewind(mark); }
+
+    arena_scope(const arena_scope&) = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
+};
+
+// 区域分配器类
+// 持有arena的地址，默认构造时使用arena::get_default<threads>()；rebind后的分配器共用同一个arena
+template<bool threads, typename T>
+class arena_allocator : public allocator_base<arena_allocator<threads, T>, threads, T> {
+private:
+    template<bool, typename>
+    friend class arena_allocator;
+
+    arena* region;
+
+public:
+    template<typename U>
+    struct rebind {
+        using other = arena_allocator<threads, U>;
+    };
+
+    // 构造函数和析构函数
+    arena_allocator() noexcept : region(&arena::get_default<threads>()) {}
+    explicit arena_allocator(arena& target) noexcept : region(&target) {}
+    template<typename U>
+    arena_allocator(const arena_allocator<threads, U>& other) noexcept : region(other.region) {}
+
+    arena& get_arena() const noexcept { return *region; }
+
+public:
+    // 内存分配：从arena推进指针，系统内存不足时返回nullptr
+    T* allocate(size_t n) {
+        return allocate(n, alignof(T));
+    }
+
+    // 按align(小于alignof(T)时按alignof(T))对齐分配
+    T* allocate(size_t n, size_t align) {
+        try {
+            return static_cast<T*>(region->allocate(n * sizeof(T), align > alignof(T) ? align : alignof(T)));
+        } catch (const std::exception& e) {
+            fprintf(stderr, "arena alloc failed: %s\n", e.what());
+            return nullptr;
+        }
+    }
+
+    // 内存释放：由arena整体回收，这里只回退最后一次分配
+    void deallocate(T* ptr, size_t n) noexcept {
+        region->deallocate(ptr, n * sizeof(T));
+    }
+    void deallocate(T* ptr, size_t n, size_t) noexcept {
+        region->deallocate(ptr, n * sizeof(T));
+    }
+
+    // 内存重分配：最后一次分配的块原地扩展，否则复制到新块
+    T* reallocate(T* ptr, size_t old_size, size_t new_size) {
+        try {
+            return static_cast<T*>(region->reallocate(ptr, old_size * sizeof(T), new_size * sizeof(T), alignof(T)));
+        } catch (const std::exception& e) {
+            fprintf(stderr, "arena realloc failed: %s\n", e.what());
+            return nullptr;
+        }
+    }
+};
+
+// 使用同一个arena的arena_allocator相等，可以互相释放对方分配的内存
+template<bool threads, typename T1, typename T2>
+bool operator==(const arena_allocator<threads, T1>& a, const arena_allocator<threads, T2>& b) noexcept {
+    return &a.get_arena() == &b.get_arena();
+}
+
+template<bool threads, typename T1, typename T2>
+bool operator!=(const arena_allocator<threads, T1>& a, const arena_allocator<threads, T2>& b) noexcept {
+    return !(a == b);
+}
+
+} // namespace Cat
@@ -0,0 +1,179 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+//空闲链表
+/*
+内存池的中心空闲链表：
+1）threads == false：普通单链表，头指针即栈顶
+2）threads == true：无锁Treiber栈，头指针附带版本号(tag)，每次成功修改tag加1，
+   避免ABA问题：线程A读到head = X、next = Y后被挂起，其他线程弹出X、Y再压回X，
+   此时head仍是X但next已不是Y，不带版本号的CAS会把已分配出去的Y重新挂回链表
+3）push_chain挂回已知首尾的一段；push_all挂回只知道开头的整条链(如pop_all摘下后截去一部分剩下的)，
+   栈为空时不遍历链
+*/
+
+/*
+带版本号的头指针编码(64位)：
+- 节点地址按8字节对齐，低3位恒为0；用户态地址不超过48位
+- 地址右移3位后只需45位，剩余19位存放版本号
+- 编码：(addr >> 3) << 19 | tag
+- 解码：addr = (value >> 19) << 3
+这样一次64位CAS即可同时比较指针与版本号，无需双字CAS(cmpxchg16b)
+*/
+
+namespace Cat {
+
+// 内存池节点
+union free_list_node {
+    free_list_node* block;      // 当块空闲时，作为指针类型指向下一个空闲块
+    char client_data[1];        // 当块分配出去时，作为一个灵活数组类型供用户使用
+};
+
+template<bool threads>
+class free_list;
+
+// 单线程：普通单链表
+template<>
+class free_list<false> {
+private:
+    free_list_node* head = nullptr;
+
+public:
+    constexpr free_list() noexcept = default;
+
+    free_list_node* top() const noexcept { return head; }
+    bool empty() const noexcept { return head == nullptr; }
+
+    void push(free_list_node* node) noexcept {
+        node->block = head;
+        head = node;
+    }
+
+    // 把first...last整段挂到栈顶，last->block由本函数改写
+    void push_chain(free_list_node* first, free_list_node* last) noexcept {
+        last->block = head;
+        head = first;
+    }
+
+    // 把以first开头、以nullptr结尾的整条链挂回，不需要知道链尾；栈为空时直接成为整个栈
+    void push_all(free_list_node* first) noexcept {
+        if(head == nullptr) {
+            head = first;
+            return;
+        }
+        free_list_node* last = head;
+        while(last->block) {
+            last = last->block;
+        }
+        last->block = first;
+    }
+
+    free_list_node* pop() noexcept {
+        free_list_node* node = head;
+        if(node) {
+            head = node->block;
+        }
+        return node;
+    }
+
+    // 取走整条链表
+    free_list_node* pop_all() noexcept {
+        free_list_node* node = head;
+        head = nullptr;
+        return node;
+    }
+};
+
+// 多线程：带版本号的无锁Treiber栈
+template<>
+class free_list<true> {
+private:
+    static constexpr unsigned TAG_BITS = 19;
+    static constexpr uint64_t TAG_MASK = (uint64_t(1) << TAG_BITS) - 1;
+
+    std::atomic<uint64_t> head{0};
+
+    static free_list_node* decode(uint64_t value) noexcept {
+        return reinterpret_cast<free_list_node*>((value >> TAG_BITS) << 3);
+    }
+    static uint64_t encode(free_list_node* node, uint64_t old_value) noexcept {
+        return (reinterpret_cast<uint64_t>(node) >> 3) << TAG_BITS | ((old_value + 1) & TAG_MASK);
+    }
+
+    // 读取可能正被其他线程改写的next指针：节点可能已被别的线程弹出并写入用户数据，
+    // 读到的值只会让随后的CAS因版本号变化而失败，但读取本身必须是原子的
+    static free_list_node* load_next(free_list_node* node) noexcept {
+        return __atomic_load_n(&node->block, __ATOMIC_RELAXED);
+    }
+
+public:
+    constexpr free_list() noexcept = default;
+
+    free_list_node* top() const noexcept { return decode(head.load(std::memory_order_acquire)); }
+    bool empty() const noexcept { return top() == nullptr; }
+
+    void push(free_list_node* node) noexcept {
+        push_chain(node, node);
+    }
+
+    // 把first...last整段挂到栈顶，只需一次CAS
+    void push_chain(free_list_node* first, free_list_node* last) noexcept {
+        uint64_t old_value = head.load(std::memory_order_relaxed);
+        do {
+            // 旧栈顶的pop可能正在load_next读取last->block，写入也须是原子的
+            __atomic_store_n(&last->block, decode(old_value), __ATOMIC_RELAXED);
+        } while(!head.compare_exchange_weak(old_value, encode(first, old_value),
+                                            std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // 把以first开头、以nullptr结尾的整条链挂回，不需要知道链尾：栈为空时一次CAS换上整条链；
+    // 否则摘下其他线程刚挂上的节点(通常很少)，接到链前再试，只遍历摘下的这一段
+    void push_all(free_list_node* first) noexcept {
+        uint64_t old_value = head.load(std::memory_order_relaxed);
+        for(;;) {
+            if(decode(old_value) == nullptr) {
+                if(head.compare_exchange_weak(old_value, encode(first, old_value),
+                                              std::memory_order_release, std::memory_order_relaxed)) {
+                    return;
+                }
+                continue;
+            }
+            if(free_list_node* taken = pop_all()) {
+                free_list_node* last = taken;
+                while(last->block) {
+                    last = last->block;
+                }
+                // 摘下前的pop可能正在load_next读取last->block
+                __atomic_store_n(&last->block, first, __ATOMIC_RELAXED);
+                first = taken;
+            }
+            old_value = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    free_list_node* pop() noexcept {
+        uint64_t old_value = head.load(std::memory_order_acquire);
+        for(;;) {
+            free_list_node* node = decode(old_value);
+            if(node == nullptr) {
+                return nullptr;
+            }
+            if(head.compare_exchange_weak(old_value, encode(load_next(node), old_value),
+                                          std::memory_order_acquire, std::memory_order_acquire)) {
+                return node;
+            }
+        }
+    }
+
+    // 取走整条链表
+    free_list_node* pop_all() noexcept {
+        uint64_t old_value = head.load(std::memory_order_relaxed);
+        while(!head.compare_exchange_weak(old_value, encode(nullptr, old_value),
+                                          std::memory_order_acquire, std::memory_order_relaxed)) {
+        }
+        return decode(old_value);
+    }
+};
+
+} // namespace Cat
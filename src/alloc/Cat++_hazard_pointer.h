@@ -0,0 +1,180 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+//危险指针(hazard pointer)
+/*
+无锁链式结构(例如linked_mpmc_queue)中，一个线程摘下的节点可能仍被其他线程读取，不能立即归还分配器；
+内存池会把归还的节点立刻分给下一次分配，既会让读取者读到别人的数据，也会让CAS遇到ABA
+1）读取共享指针前先把它登记到本线程的危险指针槽(protect)，登记后再次读取确认未变，之后该节点不会被释放
+2）摘下的节点交给retire，记入本线程的待回收列表；列表超过阈值时扫描全部线程的危险指针，
+   未被任何线程登记的节点调用回收函数归还分配器
+3）每个线程第一次使用时取得一条记录(SLOTS个槽)，线程退出时交还记录，未回收的节点转入全局列表，由之后的扫描接手
+全局只有一个域，所有结构共用；回收函数是不带上下文的函数指针，因此节点的分配器须可以默认构造(无状态)
+*/
+
+namespace Cat {
+
+class hazard_pointers final {
+public:
+    static constexpr int SLOTS = 2;                          // 每个线程同时登记的指针数
+    static constexpr size_t MIN_SCAN = 64;                   // 待回收节点达到该数且超过2倍槽总数时扫描
+
+    using reclaim_function = void(*)(void*);
+
+private:
+    hazard_pointers() = delete;
+
+    struct record {
+        std::atomic<void*> slots[SLOTS];
+        std::atomic<bool> active;
+        record* next;
+    };
+
+    struct retired {
+        void* ptr;
+        reclaim_function reclaim;
+    };
+
+    struct thread_state {
+        record* owned = nullptr;
+        std::vector<retired> pending;
+
+        ~thread_state() {
+            if(owned) {
+                for(std::atomic<void*>& slot : owned->slots) {
+                    slot.store(nullptr, std::memory_order_relaxed);
+                }
+                owned->active.store(false, std::memory_order_release);
+            }
+            if(!pending.empty()) {
+                std::lock_guard<std::mutex> lock(orphan_mutex);
+                orphans.insert(orphans.end(), pending.begin(), pending.end());
+                orphan_count.store(orphans.size(), std::memory_order_relaxed);
+            }
+        }
+    };
+
+    static inline std::atomic<record*> records{nullptr};
+    static inline std::atomic<size_t> record_count{0};
+    static inline std::mutex orphan_mutex;                   // 保护orphans
+    static inline std::vector<retired> orphans;              // 已退出线程留下的待回收节点
+    static inline std::atomic<size_t> orphan_count{0};
+
+    static thread_state& local() noexcept {
+        static thread_local thread_state state;
+        return state;
+    }
+
+    // 复用已退出线程交还的记录，没有时新建一条挂到全局链表(记录不释放)
+    static record* acquire_record() {
+        for(record* r = records.load(std::memory_order_acquire); r; r = r->next) {
+            bool expected = false;
+            if(!r->active.load(std::memory_order_relaxed)
+               && r->active.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return r;
+            }
+        }
+        record* r = new record;
+        for(std::atomic<void*>& slot : r->slots) {
+            slot.store(nullptr, std::memory_order_relaxed);
+        }
+        r->active.store(true, std::memory_order_relaxed);
+        r->next = records.load(std::memory_order_relaxed);
+        while(!records.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed)) {}
+        record_count.fetch_add(1, std::memory_order_relaxed);
+        return r;
+    }
+
+    static record& own_record() {
+        thread_state& state = local();
+        if(state.owned == nullptr) {
+            state.owned = acquire_record();
+        }
+        return *state.owned;
+    }
+
+public:
+    // 读取source并登记到slot，返回登记后确认未变的值
+    template<typename T>
+    static T* protect(int slot, const std::atomic<T*>& source) {
+        std::atomic<void*>& hazard = own_record().slots[slot];
+        T* ptr = source.load(std::memory_order_relaxed);
+        for(;;) {
+            hazard.store(ptr, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);     // 登记先于再次读取，与scan的栅栏配对
+            T* again = source.load(std::memory_order_acquire);
+            if(again == ptr) {
+                return ptr;
+            }
+            ptr = again;
+        }
+    }
+
+    // 直接登记ptr；调用者随后须自行确认ptr仍可达
+    static void set(int slot, void* ptr) {
+        own_record().slots[slot].store(ptr, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    static void clear(int slot) noexcept {
+        record* r = local().owned;
+        if(r) {
+            r->slots[slot].store(nullptr, std::memory_order_release);
+        }
+    }
+
+    static void clear_all() noexcept {
+        for(int slot = 0; slot < SLOTS; slot++) {
+            clear(slot);
+        }
+    }
+
+    // 登记已从结构中摘下的节点，不再被任何线程登记后调用reclaim(ptr)
+    static void retire(void* ptr, reclaim_function reclaim) {
+        thread_state& state = local();
+        state.pending.push_back({ptr, reclaim});
+        size_t threshold = std::max(MIN_SCAN, 2 * SLOTS * record_count.load(std::memory_order_relaxed));
+        if(state.pending.size() >= threshold) {
+            scan();
+        }
+    }
+
+    // 立即扫描：回收本线程(及已退出线程留下的)未被登记的节点
+    static void scan() {
+        thread_state& state = local();
+        if(orphan_count.load(std::memory_order_relaxed) != 0) {
+            std::lock_guard<std::mutex> lock(orphan_mutex);
+            state.pending.insert(state.pending.end(), orphans.begin(), orphans.end());
+            orphans.clear();
+            orphan_count.store(0, std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::vector<void*> hazards;
+        hazards.reserve(SLOTS * record_count.load(std::memory_order_relaxed));
+        for(record* r = records.load(std::memory_order_acquire); r; r = r->next) {
+            for(const std::atomic<void*>& slot : r->slots) {
+                if(void* ptr = slot.load(std::memory_order_acquire)) {
+                    hazards.push_back(ptr);
+                }
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+
+        std::vector<retired> keep;
+        for(const retired& node : state.pending) {
+            if(std::binary_search(hazards.begin(), hazards.end(), node.ptr)) {
+                keep.push_back(node);
+            }
+            else {
+                node.reclaim(node.ptr);
+            }
+        }
+        state.pending.swap(keep);
+    }
+};
+
+} // namespace Cat
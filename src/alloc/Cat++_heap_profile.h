@@ -0,0 +1,539 @@
+#pragma once
+#include "Cat++_page_source.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+//采样堆分析
+/*
+不记录每一次分配，而是平均每SAMPLE_BYTES字节采样一次调用栈，按调用点(site)汇总分配量与在用量，
+用于在线上找出分配量最大的调用点，开销远小于分配轨迹(见Cat++_alloc_trace.h)
+接入：allocator与pool_allocator的allocate/deallocate调用on_allocate/on_deallocate，
+reallocate在调用前用on_reallocate取出旧块的样本，失败时用on_reallocate_failed放回
+
+采样：
+1）每个线程一个字节计数器，每次分配减去分配字节数，减到0以下时采样这次分配；
+   未触发时热路径只有一次线程局部的减法和一次分支
+2）采样间隔取均值为SAMPLE_BYTES的几何(指数)分布随机数，大小为s的样本代表s / (1 - e^(-s / SAMPLE_BYTES))字节，
+   估计值无偏，不会与分配模式的周期同步
+3）未开启时计数器每RECHECK_BYTES字节进一次慢路径检查开关，start()后至多这么多字节开始采样
+4）采样时用backtrace()取调用栈(glibc/macOS，其他平台只记录空栈)，在全局锁下累加到调用点
+5）采样中、输出中再次进入分配函数(例如backtrace首次调用时加载libgcc)不采样，避免递归与死锁
+
+释放：
+1）被采样的地址记在哈希表中，释放时从调用点的在用量中减去
+2）有在用样本时，释放先查一张按地址哈希的计数表(无锁读)，命中才加锁查哈希表；没有在用样本时只有一次原子读
+
+输出：
+- dump_pprof：gperftools的heap profile文本格式(heap_v2)，附/proc/self/maps，可直接用pprof查看，
+  pprof按采样间隔自行换算
+- dump_folded：folded stack格式("外层;...;内层 字节数")，可直接交给flamegraph.pl等工具，值为换算后的估计字节数
+- snapshot：按调用点返回估计的分配量/在用量
+
+编译时定义CAT_HEAP_PROFILE=0可去掉全部采样代码
+*/
+
+#ifndef CAT_HEAP_PROFILE
+#define CAT_HEAP_PROFILE 1
+#endif
+
+#if CAT_HEAP_PROFILE && (defined(__GLIBC__) || defined(__APPLE__))
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#define CAT_HAS_BACKTRACE 1
+#else
+#define CAT_HAS_BACKTRACE 0
+#endif
+
+namespace Cat {
+
+// 单个调用点的估计值(按采样间隔换算)
+struct heap_site {
+    std::vector<void*> frames;         // 调用栈(返回地址)，frames[0]为最内层，即调用分配器的函数
+    uint64_t samples = 0;              // 样本数
+    double allocated_bytes = 0;        // 累计分配字节数
+    double allocated_objects = 0;      // 累计分配次数
+    double live_bytes = 0;             // 当前在用字节数
+    double live_objects = 0;           // 当前在用对象数
+};
+
+class heap_profiler final {
+public:
+    static constexpr size_t DEFAULT_SAMPLE_BYTES = 512 * 1024;
+    static constexpr int64_t RECHECK_BYTES = 1 << 20;       // 未开启时进入慢路径的间隔
+    static constexpr int MAX_DEPTH = 32;                     // 调用栈最大深度
+    static constexpr size_t MAX_SITES = 4096;                // 调用点上限，超出后的样本计入dropped
+    static constexpr size_t LIVE_SLOTS = 1 << 16;            // 在用样本哈希表，至多装一半
+    static constexpr size_t FILTER_SLOTS = 1 << 18;          // 释放时的地址计数表
+
+private:
+    heap_profiler() = delete;
+
+    struct site_entry {
+        uint64_t hash;
+        int depth;
+        void* frames[MAX_DEPTH];
+        uint64_t samples;
+        uint64_t sampled_bytes;        // 样本的原始字节数(pprof自行换算)
+        uint64_t live_samples;
+        uint64_t live_sampled_bytes;
+        double allocated_bytes;        // 换算后的估计值
+        double allocated_objects;
+        double live_bytes;
+        double live_objects;
+    };
+
+    struct live_entry {
+        uintptr_t ptr;                 // 0表示空槽
+        uint32_t site;
+        uint64_t bytes;
+        double weight;                 // 该样本代表的字节数
+    };
+
+    struct tables {
+        site_entry sites[MAX_SITES];
+        uint32_t site_slots[MAX_SITES * 2];                  // 调用点哈希表，值为下标 + 1，0表示空槽
+        live_entry live[LIVE_SLOTS];
+        uint16_t filter[FILTER_SLOTS];                       // 按地址哈希的在用样本数，用atomic_ref读写
+    };
+
+    static inline thread_local int64_t bytes_until_sample = RECHECK_BYTES;
+    static inline thread_local uint64_t random_state = 0;
+    static inline thread_local bool busy = false;
+
+    static inline std::atomic<bool> enabled{false};
+    static inline std::atomic<uint64_t> live_count{0};      // 在用样本数，为0时释放不查表
+    static inline std::atomic<size_t> sample_bytes{DEFAULT_SAMPLE_BYTES};
+    static inline std::mutex mutex;                          // 保护data的调用点与在用样本表
+    static inline tables* data = nullptr;                    // 第一次start()时申请，之后不释放
+    static inline size_t site_count = 0;
+    static inline uint64_t dropped = 0;                      // 调用点或在用样本表已满而丢弃的样本
+
+    static size_t hash_ptr(uintptr_t ptr) noexcept {
+        uint64_t h = (uint64_t)ptr * 0x9E3779B97F4A7C15ull;
+        return (size_t)(h >> 32);
+    }
+
+    // 均值为sample_bytes的指数分布随机数
+    static int64_t next_interval() noexcept {
+        if(random_state == 0) {
+            random_state = (uint64_t)(uintptr_t)&random_state * 0x9E3779B97F4A7C15ull | 1;
+        }
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 7;
+        random_state ^= random_state << 17;
+        double u = (double)((random_state >> 11) + 1) * (1.0 / 9007199254740992.0);   // (0, 1]
+        return (int64_t)(-std::log(u) * (double)sample_bytes.load(std::memory_order_relaxed)) + 1;
+    }
+
+    [[gnu::noinline]] static int capture(void** frames) noexcept {
+#if CAT_HAS_BACKTRACE
+        void* buffer[MAX_DEPTH + 2];
+        int depth = backtrace(buffer, MAX_DEPTH + 2);
+        // 跳过capture与sample(二者不内联)，frames[0]为调用on_allocate的分配函数(或把它内联进来的调用者)
+        int skip = depth > 2 ? 2 : depth;
+        memcpy(frames, buffer + skip, sizeof(void*) * (size_t)(depth - skip));
+        return depth - skip;
+#else
+        (void)frames;
+        return 0;
+#endif
+    }
+
+    static uint32_t find_site(void* const* frames, int depth) noexcept {
+        uint64_t hash = 0xCBF29CE484222325ull;
+        for(int i = 0; i < depth; i++) {
+            hash = (hash ^ (uint64_t)(uintptr_t)frames[i]) * 0x100000001B3ull;
+        }
+        constexpr size_t mask = MAX_SITES * 2 - 1;
+        for(size_t slot = (size_t)hash & mask;; slot = (slot + 1) & mask) {
+            uint32_t index = data->site_slots[slot];
+            if(index == 0) {
+                if(site_count == MAX_SITES) {
+                    return UINT32_MAX;
+                }
+                site_entry& site = data->sites[site_count];
+                memset(&site, 0, sizeof(site));
+                site.hash = hash;
+                site.depth = depth;
+                memcpy(site.frames, frames, sizeof(void*) * (size_t)depth);
+                data->site_slots[slot] = (uint32_t)++site_count;
+                return (uint32_t)(site_count - 1);
+            }
+            const site_entry& site = data->sites[index - 1];
+            if(site.hash == hash && site.depth == depth && memcmp(site.frames, frames, sizeof(void*) * (size_t)depth) == 0) {
+                return index - 1;
+            }
+        }
+    }
+
+    static std::atomic_ref<uint16_t> filter_of(uintptr_t ptr) noexcept {
+        return std::atomic_ref<uint16_t>(data->filter[hash_ptr(ptr) & (FILTER_SLOTS - 1)]);
+    }
+
+    // 在用样本表的查找与删除(持有mutex)：线性探测，删除时后移补位，不留墓碑
+    static size_t find_live(uintptr_t ptr) noexcept {
+        constexpr size_t mask = LIVE_SLOTS - 1;
+        for(size_t slot = hash_ptr(ptr) & mask;; slot = (slot + 1) & mask) {
+            if(data->live[slot].ptr == ptr || data->live[slot].ptr == 0) {
+                return slot;
+            }
+        }
+    }
+
+    static void erase_live(size_t slot) noexcept {
+        constexpr size_t mask = LIVE_SLOTS - 1;
+        live_entry& entry = data->live[slot];
+        site_entry& site = data->sites[entry.site];
+        site.live_samples--;
+        site.live_sampled_bytes -= entry.bytes;
+        site.live_bytes -= entry.weight;
+        site.live_objects -= entry.weight / (double)entry.bytes;
+        filter_of(entry.ptr).fetch_sub(1, std::memory_order_relaxed);
+        live_count.fetch_sub(1, std::memory_order_relaxed);
+
+        size_t hole = slot;
+        for(size_t next = (slot + 1) & mask; data->live[next].ptr != 0; next = (next + 1) & mask) {
+            size_t home = hash_ptr(data->live[next].ptr) & mask;
+            if(((next - home) & mask) >= ((next - hole) & mask)) {
+                data->live[hole] = data->live[next];
+                hole = next;
+            }
+        }
+        data->live[hole].ptr = 0;
+    }
+
+    // 登记一个在用样本(持有mutex，表未满)
+    static void insert_live(const live_entry& entry) noexcept {
+        size_t slot = find_live(entry.ptr);
+        if(data->live[slot].ptr == entry.ptr) {
+            // 旧样本的释放没有经过on_deallocate(例如被其他途径释放)，先作废
+            erase_live(slot);
+            slot = find_live(entry.ptr);
+        }
+        data->live[slot] = entry;
+        site_entry& site = data->sites[entry.site];
+        site.live_samples++;
+        site.live_sampled_bytes += entry.bytes;
+        site.live_bytes += entry.weight;
+        site.live_objects += entry.weight / (double)entry.bytes;
+        filter_of(entry.ptr).fetch_add(1, std::memory_order_relaxed);
+        live_count.fetch_add(1, std::memory_order_release);
+    }
+
+    [[gnu::noinline]] static void sample(void* ptr, size_t bytes) noexcept {
+        if(!enabled.load(std::memory_order_relaxed)) {
+            bytes_until_sample = RECHECK_BYTES;
+            return;
+        }
+        bytes_until_sample = next_interval();
+        if(busy || ptr == nullptr || bytes == 0) {
+            return;
+        }
+        busy = true;
+        void* frames[MAX_DEPTH];
+        int depth = capture(frames);
+        double period = (double)sample_bytes.load(std::memory_order_relaxed);
+        double weight = (double)bytes / (1.0 - std::exp(-(double)bytes / period));
+
+        std::lock_guard<std::mutex> lock(mutex);
+        uint32_t index = find_site(frames, depth);
+        if(index == UINT32_MAX || live_count.load(std::memory_order_relaxed) >= LIVE_SLOTS / 2) {
+            dropped++;
+            busy = false;
+            return;
+        }
+        site_entry& site = data->sites[index];
+        site.samples++;
+        site.sampled_bytes += bytes;
+        site.allocated_bytes += weight;
+        site.allocated_objects += weight / (double)bytes;
+
+        insert_live({(uintptr_t)ptr, index, bytes, weight});
+        busy = false;
+    }
+
+    // 从在用样本表取出address的样本并返回(没有时ptr为0)
+    [[gnu::noinline]] static live_entry take(uintptr_t address) noexcept {
+        live_entry entry{};
+        if(busy) {
+            return entry;                                    // 采样或输出中释放的内存不会是样本
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t slot = find_live(address);
+        if(data->live[slot].ptr != 0) {
+            entry = data->live[slot];
+            erase_live(slot);
+        }
+        return entry;
+    }
+
+    // 放回take取出的样本
+    [[gnu::noinline]] static void put_back(const live_entry& entry) noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+        // 期间reset()过(调用点已清空)或表已满时丢弃
+        if(entry.site >= site_count || live_count.load(std::memory_order_relaxed) >= LIVE_SLOTS / 2) {
+            dropped++;
+            return;
+        }
+        insert_live(entry);
+    }
+
+    // 符号名：dladdr + 反修饰，失败时为"模块+偏移"或地址
+    static void symbolize(void* frame, char* out, size_t size) noexcept {
+#if CAT_HAS_BACKTRACE
+        Dl_info info;
+        if(dladdr(frame, &info) != 0 && info.dli_sname != nullptr) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            snprintf(out, size, "%s", status == 0 && demangled ? demangled : info.dli_sname);
+            free(demangled);
+            return;
+        }
+        if(info.dli_fname != nullptr && info.dli_fbase != nullptr) {
+            const char* module = strrchr(info.dli_fname, '/');
+            snprintf(out, size, "%s+0x%zx", module ? module + 1 : info.dli_fname,
+                     (size_t)((uintptr_t)frame - (uintptr_t)info.dli_fbase));
+            return;
+        }
+#endif
+        snprintf(out, size, "%p", frame);
+    }
+
+public:
+    // 开始采样，平均每bytes_per_sample字节采样一次；第一次调用时申请记录表，失败时返回false
+    static bool start(size_t bytes_per_sample = DEFAULT_SAMPLE_BYTES) noexcept {
+#if CAT_HEAP_PROFILE
+        std::lock_guard<std::mutex> lock(mutex);
+        if(data == nullptr) {
+            data = static_cast<tables*>(mmap_page_source::allocate(sizeof(tables)));
+            if(data == nullptr) {
+                fprintf(stderr, "heap profiler: cannot allocate %zu bytes of tables\n", sizeof(tables));
+                return false;
+            }
+            memset((void*)data, 0, sizeof(tables));
+        }
+#if CAT_HAS_BACKTRACE
+        // backtrace首次调用时可能加载libgcc并分配内存，提前在采样之外完成
+        void* warmup[1];
+        bool was_busy = busy;
+        busy = true;
+        backtrace(warmup, 1);
+        busy = was_busy;
+#endif
+        sample_bytes.store(bytes_per_sample ? bytes_per_sample : 1, std::memory_order_relaxed);
+        enabled.store(true, std::memory_order_relaxed);
+        bytes_until_sample = next_interval();
+        return true;
+#else
+        (void)bytes_per_sample;
+        return false;
+#endif
+    }
+
+    // 停止采样，已有样本保留，在用样本的释放仍然记账
+    static void stop() noexcept { enabled.store(false, std::memory_order_relaxed); }
+
+    static bool is_enabled() noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    // 清空全部调用点与在用样本
+    static void reset() noexcept {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(data == nullptr) {
+            return;
+        }
+        live_count.store(0, std::memory_order_relaxed);
+        for(size_t i = 0; i < FILTER_SLOTS; i++) {
+            std::atomic_ref<uint16_t>(data->filter[i]).store(0, std::memory_order_relaxed);
+        }
+        memset(data->live, 0, sizeof(data->live));
+        memset(data->site_slots, 0, sizeof(data->site_slots));
+        site_count = 0;
+        dropped = 0;
+    }
+
+    // fork前后调用(pthread_atfork)：fork时持有mutex，父子进程各自释放，子进程保留已有样本
+    static void fork_prepare() noexcept { mutex.lock(); }
+    static void fork_parent() noexcept { mutex.unlock(); }
+    static void fork_child() noexcept { mutex.unlock(); }
+
+    // reallocate前从在用样本表取出的样本，ptr为0表示旧块没有被采样
+    using detached_sample = live_entry;
+
+    // 分配器在分配成功后调用：未触发采样时只有一次减法和一次分支
+    static void on_allocate(void* ptr, size_t bytes) noexcept {
+#if CAT_HEAP_PROFILE
+        if((bytes_until_sample -= (int64_t)bytes) < 0) [[unlikely]] {
+            sample(ptr, bytes);
+        }
+#else
+        (void)ptr;
+        (void)bytes;
+#endif
+    }
+
+    // 分配器在释放前调用：没有在用样本时只有一次原子读
+    static void on_deallocate(const void* ptr) noexcept {
+#if CAT_HEAP_PROFILE
+        if(live_count.load(std::memory_order_acquire) != 0 && ptr != nullptr) [[unlikely]] {
+            if(filter_of((uintptr_t)ptr).load(std::memory_order_relaxed) != 0) {
+                take((uintptr_t)ptr);
+            }
+        }
+#else
+        (void)ptr;
+#endif
+    }
+
+    // 分配器在reallocate前调用：取出旧块的样本并按值保存
+    /*
+    旧地址必须在realloc之前注销：realloc移动了块时旧地址已释放，可能立刻被其他线程重新分配并采样，
+    之后再注销会删掉那个线程的样本。失败时把取出的样本交给on_reallocate_failed放回，
+    成功时丢弃它、对新块调用on_allocate；两者都不再用到旧指针
+    */
+    static detached_sample on_reallocate(const void* ptr) noexcept {
+#if CAT_HEAP_PROFILE
+        if(live_count.load(std::memory_order_acquire) != 0 && ptr != nullptr) [[unlikely]] {
+            if(filter_of((uintptr_t)ptr).load(std::memory_order_relaxed) != 0) {
+                return take((uintptr_t)ptr);
+            }
+        }
+#else
+        (void)ptr;
+#endif
+        return detached_sample{};
+    }
+
+    // reallocate失败、旧块仍在用时调用：放回on_reallocate取出的样本
+    static void on_reallocate_failed(const detached_sample& sample) noexcept {
+#if CAT_HEAP_PROFILE
+        if(sample.ptr != 0) [[unlikely]] {
+            put_back(sample);
+        }
+#else
+        (void)sample;
+#endif
+    }
+
+    // 按调用点的估计值，按在用字节数从大到小排列
+    static std::vector<heap_site> snapshot() {
+        std::vector<heap_site> result;
+        bool was_busy = busy;
+        busy = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for(size_t i = 0; i < site_count; i++) {
+                const site_entry& entry = data->sites[i];
+                heap_site site;
+                site.frames.assign(entry.frames, entry.frames + entry.depth);
+                site.samples = entry.samples;
+                site.allocated_bytes = entry.allocated_bytes;
+                site.allocated_objects = entry.allocated_objects;
+                site.live_bytes = entry.live_bytes > 0 ? entry.live_bytes : 0;
+                site.live_objects = entry.live_objects > 0 ? entry.live_objects : 0;
+                result.push_back(std::move(site));
+            }
+        }
+        busy = was_busy;
+        std::sort(result.begin(), result.end(), [](const heap_site& a, const heap_site& b) {
+            return a.live_bytes > b.live_bytes;
+        });
+        return result;
+    }
+
+    // gperftools heap profile(heap_v2)：在用/累计的样本数与原始字节数，pprof按采样间隔换算
+    static void dump_pprof(FILE* out) noexcept {
+        bool was_busy = busy;
+        busy = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            uint64_t live_samples = 0, live_bytes = 0, samples = 0, bytes = 0;
+            for(size_t i = 0; i < site_count; i++) {
+                live_samples += data->sites[i].live_samples;
+                live_bytes += data->sites[i].live_sampled_bytes;
+                samples += data->sites[i].samples;
+                bytes += data->sites[i].sampled_bytes;
+            }
+            fprintf(out, "heap profile: %llu: %llu [%llu: %llu] @ heap_v2/%zu\n",
+                    (unsigned long long)live_samples, (unsigned long long)live_bytes,
+                    (unsigned long long)samples, (unsigned long long)bytes, sample_bytes.load(std::memory_order_relaxed));
+            for(size_t i = 0; i < site_count; i++) {
+                const site_entry& site = data->sites[i];
+                fprintf(out, "%llu: %llu [%llu: %llu] @",
+                        (unsigned long long)site.live_samples, (unsigned long long)site.live_sampled_bytes,
+                        (unsigned long long)site.samples, (unsigned long long)site.sampled_bytes);
+                for(int f = 0; f < site.depth; f++) {
+                    fprintf(out, " %p", site.frames[f]);
+                }
+                fprintf(out, "\n");
+            }
+        }
+        fprintf(out, "\nMAPPED_LIBRARIES:\n");
+        if(FILE* maps = fopen("/proc/self/maps", "r")) {
+            char line[4096];
+            while(fgets(line, sizeof(line), maps)) {
+                fputs(line, out);
+            }
+            fclose(maps);
+        }
+        busy = was_busy;
+    }
+
+    // folded stack：每个调用点一行，外层在前，值为估计的在用字节数(live)或累计分配字节数
+    static void dump_folded(FILE* out, bool live = true) noexcept {
+        bool was_busy = busy;
+        busy = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            char name[512];
+            for(size_t i = 0; i < site_count; i++) {
+                const site_entry& site = data->sites[i];
+                double value = live ? site.live_bytes : site.allocated_bytes;
+                if(value < 0.5) {
+                    continue;
+                }
+                for(int f = site.depth - 1; f >= 0; f--) {
+                    // 返回地址指向call的下一条指令，减1落回call所在的函数与行
+                    symbolize((char*)site.frames[f] - 1, name, sizeof(name));
+                    for(char* c = name; *c; c++) {
+                        if(*c == ';' || *c == '\n') {
+                            *c = ':';
+                        }
+                    }
+                    fprintf(out, "%s%s", name, f ? ";" : "");
+                }
+                fprintf(out, " %.0f\n", value);
+            }
+            if(dropped) {
+                fprintf(out, "[dropped samples] %llu\n", (unsigned long long)dropped);
+            }
+        }
+        busy = was_busy;
+    }
+
+    // 输出到文件，pprof为false时输出folded stack(在用字节数)
+    static bool dump(const char* path, bool pprof = true) noexcept {
+        FILE* out = fopen(path, "w");
+        if(out == nullptr) {
+            fprintf(stderr, "heap profiler: cannot open %s\n", path);
+            return false;
+        }
+        if(pprof) {
+            dump_pprof(out);
+        }
+        else {
+            dump_folded(out);
+        }
+        fclose(out);
+        return true;
+    }
+};
+
+} // namespace Cat
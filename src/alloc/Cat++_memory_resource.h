@@ -0,0 +1,100 @@
+#pragma once
+#include "Cat++_arena_alloc.h"
+#include "Cat++_pool_alloc.h"
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+//std::pmr适配
+/*
+把内存池与arena包装成std::pmr::memory_resource，已有的std::pmr::vector/unordered_map等代码
+只需换一个memory_resource指针即可使用Cat的内存，不用改容器类型
+1）pool_resource<threads, PageSource, Config>：转发给pool_allocator，大块与超大对齐同样交给malloc或页来源
+   - threads == true：synchronized_pool_resource，可在任意线程并发使用(线程缓存 + 无锁中心池)
+   - threads == false：unsynchronized_pool_resource，与单线程内存池相同，只能在一个线程使用
+   内存池是全局共享的，同一实例化的pool_resource都相等，可以互相释放对方分配的内存
+2）arena_resource：monotonic_buffer_resource的替代，分配只推进指针，deallocate只回退最后一次分配，
+   release()/reset()整体回收；可以自带arena，也可以借用外部的arena(与arena_allocator共用)
+   arena不加锁，同一个arena_resource只能由一个线程使用；使用同一个arena的arena_resource相等
+memory_resource约定分配失败时抛出异常，这里统一抛出std::bad_alloc，而不是像分配器那样返回nullptr
+*/
+
+namespace Cat {
+
+template<bool threads, class PageSource = malloc_page_source, class Config = default_pool_config>
+class pool_resource : public std::pmr::memory_resource {
+private:
+    using byte_allocator = pool_allocator<threads, std::byte, PageSource, Config>;
+
+public:
+    pool_resource() noexcept = default;
+
+    // 进程内共用的实例，pool_resource无状态，通常直接用它即可
+    static pool_resource& get_default() noexcept {
+        static pool_resource instance;
+        return instance;
+    }
+
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        void* result = byte_allocator().allocate(bytes, align);
+        if(result == nullptr) {
+            throw std::bad_alloc();
+        }
+        return result;
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t align) override {
+        byte_allocator().deallocate(static_cast<std::byte*>(ptr), bytes, align);
+    }
+
+    // 同一实例化的pool_resource共用同一个内存池
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return dynamic_cast<const pool_resource*>(&other) != nullptr;
+    }
+};
+
+using synchronized_pool_resource = pool_resource<true>;
+using unsynchronized_pool_resource = pool_resource<false>;
+
+class arena_resource : public std::pmr::memory_resource {
+private:
+    arena owned;                                             // 自带的arena，借用外部arena时不申请任何block
+    arena* region;
+
+public:
+    explicit arena_resource(size_t block_bytes = arena::BLOCK_BYTES) noexcept
+        : owned(block_bytes), region(&owned) {}
+    explicit arena_resource(arena& target) noexcept : region(&target) {}
+
+    arena_resource(const arena_resource&) = delete;
+    arena_resource& operator=(const arena_resource&) = delete;
+
+    arena& get_arena() const noexcept { return *region; }
+
+    // 作废全部分配，保留block复用
+    void reset() noexcept { region->reset(); }
+
+    // 作废全部分配并把block还给系统，与monotonic_buffer_resource::release()相同
+    void release() noexcept { region->release(); }
+
+protected:
+    void* do_allocate(size_t bytes, size_t align) override {
+        try {
+            return region->allocate(bytes, align);
+        } catch (const OutOfMemoryException&) {
+            throw std::bad_alloc();
+        }
+    }
+
+    // 只回退最后一次分配，其余由reset()/release()整体回收
+    void do_deallocate(void* ptr, size_t bytes, size_t) override {
+        region->deallocate(ptr, bytes);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        const arena_resource* resource = dynamic_cast<const arena_resource*>(&other);
+        return resource != nullptr && resource->region == region;
+    }
+};
+
+} // namespace Cat
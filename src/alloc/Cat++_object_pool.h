@@ -0,0 +1,324 @@
+#pragma once
+#include "Cat++_free_list.h"
+#include "Cat++_pool_alloc.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+//对象池
+/*
+适用场景：构造/析构代价高的对象(内部持有缓冲区的对象、解析器状态等)反复创建销毁
+1）acquire()优先返回空闲的已构造对象，没有时才申请内存并默认构造
+2）release()不析构对象，而是调用重置钩子(Reset)后挂回空闲栈，下次acquire()直接复用，对象内部已申请的内存随之保留
+3）max_objects限制已构造对象总数(在用 + 空闲)，达到上限时acquire()返回nullptr
+   max_idle限制空闲对象数，超过时release()直接析构对象并归还内存
+4）reserve(n)预先构造对象直到空闲数达到n；shrink(keep)析构空闲对象直到只剩keep个
+对象的内存来自pool_allocator，即与其他容器共用内存池的chunk
+threads == true时acquire/release可在任意线程并发调用：空闲栈是无锁栈(见Cat++_free_list.h)，计数为原子变量，
+上限在并发时是近似的(可能短暂超出几个)
+析构对象池前须归还全部对象
+*/
+
+/*
+空闲栈的内存回收(threads == true)：
+pop要读取栈顶节点的next，而该节点可能已被其他线程弹出、析构，slot内存还给内存池后又被trim还给系统；
+与alloc_pool的中心池访问相同，用奇偶两个纪元计数：
+1）每次弹出都在pop_guard内进行，登记到当前纪元
+2）归还slot内存前先推进纪元，等待旧纪元的弹出全部结束(wait_pop_quiescent)，之后不会再有线程读取这些slot
+shrink析构的对象攒成一批再等待一次
+*/
+
+/*
+slot布局：[free_list_node | 对象]
+- 空闲时free_list_node链入空闲栈，对象保持已构造状态
+- 使用中free_list_node不被访问，对象地址减去固定偏移即得slot
+*/
+
+namespace Cat {
+
+// 默认重置钩子：什么也不做，对象按上次使用后的状态复用
+// 需要重置的类型可特化本模板，或向object_pool传入自定义的Reset
+template<typename T>
+struct object_reset {
+    void operator()(T&) const noexcept {}
+};
+
+template<bool threads, typename T, typename Reset = object_reset<T>>
+class object_pool {
+private:
+    struct slot {
+        free_list_node link;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    static_assert(std::is_default_constructible_v<T>, "object_pool constructs objects with T()");
+
+    using slot_allocator = pool_allocator<threads, slot>;
+    using counter = std::conditional_t<threads, std::atomic<size_t>, size_t>;
+
+    static constexpr size_t RESERVE_BATCH = 32;              // reserve()一次批量申请的slot数
+    static constexpr size_t RETIRE_BATCH = 32;               // shrink()攒够这么多slot等待一次再归还
+
+    free_list<threads> idle_slots;                           // 空闲对象栈
+    counter idle_count{0};                                   // 空闲对象数
+    counter total_count{0};                                  // 已构造对象数(在用 + 空闲)
+    size_t max_idle;                                         // 空闲对象数上限
+    size_t max_objects;                                      // 已构造对象数上限
+    [[no_unique_address]] Reset reset;
+
+    std::atomic<uint64_t> pop_epoch{0};                      // 空闲栈弹出纪元(threads == true)
+    std::atomic<size_t> pop_users[2] = {};                   // 奇偶纪元各自的在途弹出数
+    std::mutex retire_mutex;                                 // 同一时刻只允许一个线程等待纪元
+
+    // 弹出守卫：登记到当前纪元，登记后纪元已变化则重新登记
+    struct pop_guard {
+        object_pool& pool;
+        size_t parity = 0;
+        explicit pop_guard(object_pool& owner) noexcept : pool(owner) {
+            if constexpr (threads) {
+                for(;;) {
+                    uint64_t epoch = pool.pop_epoch.load();
+                    parity = epoch & 1;
+                    pool.pop_users[parity].fetch_add(1);
+                    if(pool.pop_epoch.load() == epoch) {
+                        break;
+                    }
+                    pool.pop_users[parity].fetch_sub(1);
+                }
+            }
+        }
+        ~pop_guard() {
+            if constexpr (threads) {
+                pool.pop_users[parity].fetch_sub(1, std::memory_order_release);
+            }
+        }
+    };
+
+    static T* object_of(slot* s) noexcept {
+        return std::launder(reinterpret_cast<T*>(s->storage));
+    }
+    static slot* slot_of(T* obj) noexcept {
+        return reinterpret_cast<slot*>(reinterpret_cast<unsigned char*>(obj) - offsetof(slot, storage));
+    }
+
+    // 计数加减，返回修改前的值
+    static size_t add(counter& c, size_t delta) noexcept {
+        if constexpr (threads) {
+            return c.fetch_add(delta, std::memory_order_relaxed);
+        }
+        else {
+            size_t old = c;
+            c += delta;
+            return old;
+        }
+    }
+    static size_t sub(counter& c, size_t delta) noexcept {
+        if constexpr (threads) {
+            return c.fetch_sub(delta, std::memory_order_relaxed);
+        }
+        else {
+            size_t old = c;
+            c -= delta;
+            return old;
+        }
+    }
+    static size_t load(const counter& c) noexcept {
+        if constexpr (threads) {
+            return c.load(std::memory_order_relaxed);
+        }
+        else {
+            return c;
+        }
+    }
+
+public:
+    // 归还器：配合std::unique_ptr，析构时把对象还给对象池
+    struct recycler {
+        object_pool* pool;
+        void operator()(T* obj) const noexcept { pool->release(obj); }
+    };
+    using handle = std::unique_ptr<T, recycler>;
+
+    // 构造函数和析构函数
+    explicit object_pool(size_t idle_limit = size_t(-1), size_t object_limit = size_t(-1), Reset hook = Reset())
+        : max_idle(idle_limit), max_objects(object_limit), reset(std::move(hook)) {}
+    ~object_pool() {
+        shrink(0);
+    }
+
+    object_pool(const object_pool&) = delete;
+    object_pool& operator=(const object_pool&) = delete;
+
+    // 取一个已构造的对象：优先复用空闲对象；达到max_objects或内存不足时返回nullptr，T()抛出的异常原样抛出
+    T* acquire() {
+        if(free_list_node* node = pop_idle()) {
+            sub(idle_count, 1);
+            return object_of(reinterpret_cast<slot*>(node));
+        }
+        return create();
+    }
+
+    handle acquire_handle() {
+        return handle(acquire(), recycler{this});
+    }
+
+    // 归还对象：调用重置钩子后挂回空闲栈；空闲数已达max_idle或钩子抛出异常时析构对象
+    void release(T* obj) noexcept {
+        if(obj == nullptr) {
+            return;
+        }
+        slot* s = slot_of(obj);
+        try {
+            reset(*obj);
+        } catch (...) {
+            destroy(s);
+            return;
+        }
+        if(load(idle_count) >= max_idle) {
+            destroy(s);
+            return;
+        }
+        add(idle_count, 1);
+        idle_slots.push(&s->link);
+    }
+
+    // 预先构造对象，直到空闲数达到n(受max_objects限制)，返回新构造的个数
+    size_t reserve(size_t n) {
+        size_t created = 0;
+        slot* batch[RESERVE_BATCH];
+        while(load(idle_count) < n) {
+            size_t want = n - load(idle_count);
+            want = want < RESERVE_BATCH ? want : RESERVE_BATCH;
+            size_t room = claim(want);
+            if(room == 0) {
+                break;
+            }
+            size_t got = slot_allocator().allocate_batch(1, room, batch);
+            if(got < room) {
+                sub(total_count, room - got);
+            }
+            if(got == 0) {
+                break;
+            }
+            for(size_t i = 0; i < got; i++) {
+                try {
+                    ::new((void*)batch[i]->storage) T();
+                } catch (...) {
+                    sub(total_count, got - i);
+                    slot_allocator().deallocate_batch(1, got - i, batch + i);
+                    throw;
+                }
+                add(idle_count, 1);
+                idle_slots.push(&batch[i]->link);
+                created++;
+            }
+        }
+        return created;
+    }
+
+    // 析构空闲对象并归还内存，直到空闲数不超过keep
+    void shrink(size_t keep = 0) noexcept {
+        slot* batch[RETIRE_BATCH];
+        size_t count = 0;
+        while(load(idle_count) > keep) {
+            free_list_node* node = pop_idle();
+            if(node == nullptr) {
+                break;
+            }
+            sub(idle_count, 1);
+            slot* s = reinterpret_cast<slot*>(node);
+            object_of(s)->~T();
+            batch[count++] = s;
+            if(count == RETIRE_BATCH) {
+                retire(batch, count);
+                count = 0;
+            }
+        }
+        retire(batch, count);
+    }
+
+    size_t idle() const noexcept { return load(idle_count); }
+    size_t live() const noexcept { return load(total_count) - load(idle_count); }
+    size_t total() const noexcept { return load(total_count); }
+
+    size_t get_max_idle() const noexcept { return max_idle; }
+    size_t get_max_objects() const noexcept { return max_objects; }
+    // 调低上限不会析构在用对象，多余的空闲对象立即析构
+    void set_max_idle(size_t limit) noexcept {
+        max_idle = limit;
+        shrink(limit);
+    }
+    void set_max_objects(size_t limit) noexcept {
+        max_objects = limit;
+    }
+
+private:
+    // 在max_objects内预占至多want个名额，返回实际预占的个数
+    size_t claim(size_t want) noexcept {
+        size_t before = add(total_count, want);
+        if(before >= max_objects) {
+            sub(total_count, want);
+            return 0;
+        }
+        if(max_objects - before < want) {
+            sub(total_count, want - (max_objects - before));
+            return max_objects - before;
+        }
+        return want;
+    }
+
+    T* create() {
+        if(claim(1) == 0) {
+            return nullptr;
+        }
+        slot* s = slot_allocator().allocate(1);
+        if(s == nullptr) {
+            sub(total_count, 1);
+            return nullptr;
+        }
+        try {
+            ::new((void*)s->storage) T();
+        } catch (...) {
+            slot_allocator().deallocate(s, 1);
+            sub(total_count, 1);
+            throw;
+        }
+        return object_of(s);
+    }
+
+    free_list_node* pop_idle() noexcept {
+        pop_guard guard(*this);
+        return idle_slots.pop();
+    }
+
+    // 推进纪元并等待旧纪元的弹出全部结束
+    void wait_pop_quiescent() noexcept {
+        std::lock_guard<std::mutex> lock(retire_mutex);
+        uint64_t epoch = pop_epoch.fetch_add(1);
+        while(pop_users[epoch & 1].load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    // 归还已析构对象的slot内存：多线程时先等待可能仍在读取这些slot的弹出结束
+    void retire(slot** slots, size_t count) noexcept {
+        if(count == 0) {
+            return;
+        }
+        if constexpr (threads) {
+            wait_pop_quiescent();
+        }
+        slot_allocator().deallocate_batch(1, count, slots);
+        sub(total_count, count);
+    }
+
+    void destroy(slot* s) noexcept {
+        object_of(s)->~T();
+        retire(&s, 1);
+    }
+};
+
+} // namespace Cat
@@ -0,0 +1,150 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define CAT_HAS_MMAP 1
+#else
+#define CAT_HAS_MMAP 0
+#endif
+//页来源(page source)
+/*
+内存池chunk与绕过内存池的大块从哪里拿内存：
+1）malloc_page_source：malloc/free，chunk落在libc堆中间，按4K页映射
+2）mmap_page_source：匿名mmap，按2MB对齐，内核可以用透明大页(THP)整块映射，free时munmap直接还给系统
+3）huge_page_source：优先MAP_HUGETLB显式大页，大页池不足或不支持时退回2MB对齐的mmap + MADV_HUGEPAGE
+
+接口(全部为静态函数，失败返回nullptr，不抛异常)：
+- GRANULARITY：分配粒度，申请字节数向上取整到它的倍数，chunk可把多出的部分用于切分
+- USES_HEAP：是否来自libc堆(trim后需要malloc_trim，大块沿用allocator的OOM处理)
+- allocate(bytes) / release(ptr, bytes) / reallocate(ptr, old_bytes, new_bytes)
+  release/reallocate的bytes须与allocate时相同(取整前后均可)
+非POSIX平台没有mmap，后两者退化为malloc
+*/
+
+namespace Cat {
+
+struct malloc_page_source {
+    static constexpr size_t GRANULARITY = 16;
+    static constexpr bool USES_HEAP = true;
+
+    static constexpr size_t round_up(size_t bytes) { return (bytes + GRANULARITY - 1) & ~(GRANULARITY - 1); }
+
+    static void* allocate(size_t bytes) noexcept { return malloc(bytes); }
+    static void release(void* ptr, size_t) noexcept { free(ptr); }
+    static void* reallocate(void* ptr, size_t, size_t new_bytes) noexcept { return realloc(ptr, new_bytes); }
+};
+
+#if CAT_HAS_MMAP
+
+struct mmap_page_source {
+    static constexpr size_t GRANULARITY = 4096;
+    static constexpr size_t ALIGNMENT = 2 * 1024 * 1024;     // 大页大小，映射起点按它对齐
+    static constexpr bool USES_HEAP = false;
+
+    static constexpr size_t round_up(size_t bytes) { return (bytes + GRANULARITY - 1) & ~(GRANULARITY - 1); }
+
+    // 多映射ALIGNMENT字节，再把首尾不对齐的部分munmap掉
+    static void* map_aligned(size_t bytes, int extra_flags = 0) noexcept {
+        size_t length = bytes + ALIGNMENT;
+        void* raw = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | extra_flags, -1, 0);
+        if(raw == MAP_FAILED) {
+            return nullptr;
+        }
+        uintptr_t begin = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = (begin + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        if(aligned > begin) {
+            munmap(raw, aligned - begin);
+        }
+        size_t tail = (begin + length) - (aligned + bytes);
+        if(tail > 0) {
+            munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+        }
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    static void* allocate(size_t bytes) noexcept {
+        return map_aligned(round_up(bytes));
+    }
+    static void release(void* ptr, size_t bytes) noexcept {
+        if(ptr) {
+            munmap(ptr, round_up(bytes));
+        }
+    }
+    static void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes) noexcept {
+        if(ptr == nullptr) {
+            return allocate(new_bytes);
+        }
+        if(round_up(old_bytes) == round_up(new_bytes)) {
+            return ptr;
+        }
+#if defined(__linux__)
+        // mremap直接搬动页表，不复制数据
+        void* result = mremap(ptr, round_up(old_bytes), round_up(new_bytes), MREMAP_MAYMOVE);
+        return result == MAP_FAILED ? nullptr : result;
+#else
+        void* result = allocate(new_bytes);
+        if(result) {
+            memcpy(result, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+            release(ptr, old_bytes);
+        }
+        return result;
+#endif
+    }
+};
+
+struct huge_page_source {
+    static constexpr size_t GRANULARITY = mmap_page_source::ALIGNMENT;
+    static constexpr bool USES_HEAP = false;
+
+    static constexpr size_t round_up(size_t bytes) { return (bytes + GRANULARITY - 1) & ~(GRANULARITY - 1); }
+
+    static void* allocate(size_t bytes) noexcept {
+        size_t length = round_up(bytes);
+#if defined(MAP_HUGETLB)
+        // 显式大页：系统未预留大页时立即失败，不会阻塞
+        void* result = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(result != MAP_FAILED) {
+            return result;
+        }
+#endif
+        void* fallback = mmap_page_source::map_aligned(length);
+#if defined(MADV_HUGEPAGE)
+        if(fallback) {
+            madvise(fallback, length, MADV_HUGEPAGE);
+        }
+#endif
+        return fallback;
+    }
+    static void release(void* ptr, size_t bytes) noexcept {
+        if(ptr) {
+            munmap(ptr, round_up(bytes));
+        }
+    }
+    static void* reallocate(void* ptr, size_t old_bytes, size_t new_bytes) noexcept {
+        if(ptr == nullptr) {
+            return allocate(new_bytes);
+        }
+        if(round_up(old_bytes) == round_up(new_bytes)) {
+            return ptr;
+        }
+        void* result = allocate(new_bytes);
+        if(result) {
+            memcpy(result, ptr, old_bytes < new_bytes ? old_bytes : new_bytes);
+            release(ptr, old_bytes);
+        }
+        return result;
+    }
+};
+
+#else
+
+using mmap_page_source = malloc_page_source;
+using huge_page_source = malloc_page_source;
+
+#endif
+
+} // namespace Cat
@@ -1,7 +1,23 @@
 #pragma once
 #include "Cat++_allocator.h"
+#include "Cat++_alloc_stats.h"
+#include "Cat++_free_list.h"
+#include "Cat++_page_source.h"
+#include "Cat++_pool_config.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
 //线程安全
 //尽量兼容STL接口规范
 //异常处理
@@ -12,21 +28,71 @@
 3）提高内存利用率：malloc头部有一块小内存，用于管理分配的内存，在大量分配小内存时，会造成内存浪费
 */
 
-//直觉思路是模8+1：(bytes % __ALIGN == 0) ? bytes : (bytes / __ALIGN + 1) * __ALIGN
-//(bytes + __ALIGN - 1) & ~(__ALIGN - 1)
-//__ALIGN - 1低位都是1，~(__ALIGN - 1)为低位清零掩码
-//需求：bytes 未对齐，输入bytes = k * __ALIGN + remainder；输出(k+1) * __ALIGN
-//需求：bytes 对齐，输入bytes = k * __ALIGN；输出k * __ALIGN
+/*
+大小类(见Cat++_size_class.h，以下为默认配置)：
+- (0, 128]按8字节等距，沿用SGI的做法，所有线性级共用一个chunk，按需切分
+- (128, 32K]按12.5%几何递增，每一级有自己的span(专用chunk)，span内只切同一种大小的节点
+- 超过32K的大块由pool_allocator直接交给allocator(malloc)，或交给页来源(非malloc来源时)
 
-namespace Cat {
+对齐：
+- 第i级节点按size_class::node_align(i)对齐(节点大小的最低位2的幂，不超过64)，切分时把起点推到对齐位置，
+  跳过的字节与chunk尾部残余一样按对齐拆成小节点挂回空闲链表
+- >= 64字节的节点只占用最少的缓存行(见Cat++_size_class.h)
+- allocate(bytes, align)取node_align >= align的大小类，align <= MAX_ALIGN(最大一级的节点对齐，默认配置为64)时由内存池满足，
+  更大的对齐由pool_allocator交给allocator的对齐分配
 
-// 内存池节点
-union free_list_node {
-    free_list_node* block;      // 当块空闲时，作为指针类型指向下一个空闲块
-    char client_data[1];        // 当块分配出去时，作为一个灵活数组类型供用户使用
-};
+页来源(见Cat++_page_source.h)：模板参数PageSource决定chunk从哪里申请
+- malloc_page_source(默认)：malloc/free
+- mmap_page_source：2MB对齐的匿名mmap，可由透明大页映射，trim时munmap直接归还
+- huge_page_source：优先显式大页(MAP_HUGETLB)，失败时退回mmap_page_source + MADV_HUGEPAGE
+不同PageSource的alloc_pool是相互独立的内存池
+
+配置(见Cat++_pool_config.h)：模板参数Config给出大小类表、基准批量、refill策略，每种Config是一个独立的内存池
+refill策略(见Cat++_refill_policy.h)：Config::refill决定每次搬运多少节点、每次申请多大的chunk
+- adaptive_refill(默认)：批量按需求慢启动增长、闲置时减半；chunk大小逐级翻倍，申请失败时减半退避
+- fixed_refill：固定批量与增长方式
+
+多线程模式(threads == true)：
+1）每个线程持有一份线程缓存(thread_cache)，每个大小类一条私有空闲链表，常规的分配/释放只操作私有链表，不加锁
+2）私有链表为空时，从中心池一次搬运一批节点；私有链表超过上限(2倍批量)时，归还到只剩一批
+   批量由Refill按本线程该级的需求调整，基准为batch_nodes(index)
+3）中心池不加锁：空闲链表是带版本号的无锁栈(见Cat++_free_list.h)，chunk内的切分位置start用CAS原子推进
+4）线程退出时，线程缓存中的节点全部归还中心池
+单线程模式(threads == false)：不使用线程缓存，直接操作中心池
+
+跨线程释放(仅多线程模式)：
+生产者/消费者模式下一个线程分配、另一个线程释放，节点会一直流向消费者的缓存和中心池，生产者只能从中心池搬回来
+1）每个线程注册时取得一个线程堆(thread_heap)，从自己的current/spans切分，切出的chunk归该堆所有
+2）归属的chunk按FRAME_BYTES(64K)对齐、大小取整到FRAME_BYTES的倍数，登记到两级页表(page_root)，释放时两次查表即得所属chunk
+3）释放的节点属于其他仍在运行的线程堆时，压入该堆的remote空闲链表(无锁栈，一次CAS)，不进入本线程缓存；
+   批量归还时连续同属一个堆的一段节点一次压入
+4）所属线程下次私有链表为空(或批量分配时私有链表不够)时，先整条摘下自己的remote链表，再访问中心池
+5）线程退出时remote链表归还中心池，线程堆标记为空闲，由之后注册的线程接管；线程堆不释放
+对齐失败(非POSIX平台的malloc来源)或页表申请失败的chunk不登记归属，按原方式处理
+
+chunk布局：[chunk_header | 已切出的节点 ... | start → 未切分区域 → end)
+- 线程堆的current指向线性级共用的chunk，spans[index]指向第index级的span，切完后由抢到新chunk的线程CAS替换
+- 单线程模式只有shared_heap；多线程模式下未取得线程堆的线程也使用shared_heap，其chunk不登记归属
+- 所有chunk经chunks串成链表，记录内存池向系统申请过的全部内存
+
+归还系统内存(trim)：
+1）各线程堆的remote链表先归还中心池，再摘下全部中心空闲链表和chunk链表，统计每个chunk落在空闲链表中的字节数
+2）空闲字节 + 未切分字节 + 切分残余(waste) == 可切分字节 的chunk完全空闲，正在切分的chunk除外
+3）保留至多retain_bytes字节的空闲chunk，其余chunk连同其节点一起free，剩下的节点挂回空闲链表
+多线程模式下，其他线程可能刚读到旧的链表头或chunk指针，还没来得及访问：
+中心池的访问(fetch_from_central)都在central_guard内进行，trim在摘链后推进central_epoch，
+等待旧纪元的访问全部结束后才释放chunk；线程缓存中的节点不属于中心池，对应的chunk不会被回收
+后台回收线程(scavenger)按固定间隔调用trim，仅多线程模式可用
+
+统计(见Cat++_alloc_stats.h)：
+- 分配/释放次数、请求字节数、大块流量记在thread_stats中，多线程模式每线程一份，线程注册时挂入stats_threads
+- refill、chunk_alloc、系统内存、已切分节点数、在用高水位记在全局class_counters中，只在慢路径更新
+- get_stats()合并以上计数得到快照
+*/
+
+namespace Cat {
 
-template<bool threads>
+template<bool threads, class PageSource = malloc_page_source, class Config = default_pool_config>
 class alloc_pool final {
 private:
     // 禁止实例化、拷贝和移动
@@ -38,53 +104,306 @@ private:
     alloc_pool& operator=(alloc_pool&&) = delete;
 
     // 内存池配置
-    static constexpr size_t ALIGN = 8;                       // 最小分配单元
-    static constexpr size_t MAX_BYTES = 128;                 // 小块大小上限
-    static constexpr size_t NUM_OF_NODES = MAX_BYTES / ALIGN;// 空闲数组节点数量(128/8)
+    using size_class = typename Config::size_class;
+    using Refill = typename Config::refill;
+    static constexpr size_t ALIGN = size_class::ALIGN;                // 最小分配单元
+    static constexpr size_t MAX_BYTES = size_class::MAX_BYTES;        // 池化大小上限
+    static constexpr size_t NUM_OF_NODES = size_class::NUM_CLASSES;   // 空闲数组节点数量(大小类级数)
+    static constexpr size_t MAX_ALIGN = size_class::node_align(NUM_OF_NODES - 1); // 内存池可满足的最大对齐(最大一级的节点对齐)
+    static constexpr size_t SHARED_CLASSES = size_class::index(size_class::LINEAR_BYTES) + 1; // 共用chunk的线性级数
+    static constexpr size_t REFILL_NODES = Config::REFILL_NODES;      // 基准批量的节点数上限
+    static constexpr size_t BATCH_BYTES = Config::BATCH_BYTES;        // 基准批量的字节数上限
+    static constexpr size_t SPAN_BYTES = 64 * 1024;                   // span最小字节数
+    static constexpr size_t SPAN_MIN_NODES = 8;                       // span至少容纳的节点数
+    static constexpr size_t MAX_CHUNK_GROWTH = 1024 * 1024;           // 共用chunk的增长上限
+    static constexpr size_t MAX_SPAN_BYTES = 256 * 1024;              // span的增长上限
+
+    // 第index级的基准批量：小节点REFILL_NODES个，大节点按BATCH_BYTES折算，至少2个；实际批量由Refill在此基础上调整
+    static constexpr size_t batch_nodes(size_t index) {
+        size_t nodes = BATCH_BYTES / size_class::class_size(index);
+        return nodes > REFILL_NODES ? REFILL_NODES : (nodes < 2 ? 2 : nodes);
+    }
+
+    struct thread_heap;
+
+    // 中心空闲链表：多线程模式下每条独占一个缓存行，不同大小类的CAS互不干扰
+    struct alignas(size_class::CACHE_LINE) padded_list : free_list<threads> {};
+    using central_list = std::conditional_t<threads, padded_list, free_list<threads>>;
+
+    // chunk头部，位于每个chunk起始处
+    struct chunk_header {
+        std::atomic<char*> start;                            // 未切分区域起始位置，CAS推进
+        char* end;                                           // chunk结束位置
+        size_t size;                                         // chunk总字节数(含头部)
+        std::atomic<size_t> waste;                           // 切分残余中无法挂回空闲链表的字节数
+        chunk_header* next;                                  // chunk链表
+        thread_heap* owner;                                  // 所属线程堆，未登记归属时为nullptr
+    };
+    static constexpr size_t CHUNK_HEADER_SIZE = (sizeof(chunk_header) + ALIGN - 1) & ~(ALIGN - 1);
+
+    // 线程堆：切分用的chunk，以及其他线程归还的节点
+    struct thread_heap {
+        std::atomic<chunk_header*> current{nullptr};         // 线性级共用的chunk
+        std::atomic<chunk_header*> spans[NUM_OF_NODES] = {}; // 几何级各自的span
+        std::atomic<size_t> chunk_bytes[NUM_OF_NODES] = {};  // 各级上次申请的chunk字节数，共用chunk记在第0级
+        free_list<threads> remote[NUM_OF_NODES];             // 其他线程释放的本堆节点
+        std::atomic<bool> active{false};                     // 是否有线程正在使用
+        thread_heap* next = nullptr;                         // heaps链表
+    };
+
+    // 页表：地址第16~31位、第32~47位两级索引，每项记录覆盖该64K帧的chunk；叶子按需calloc，不释放
+    static constexpr size_t FRAME_SHIFT = 16;
+    static constexpr size_t FRAME_BYTES = size_t(1) << FRAME_SHIFT;  // 归属chunk的对齐与取整单位
+    static constexpr size_t LEAF_BITS = 16;
+    static constexpr size_t ROOT_BITS = 48 - FRAME_SHIFT - LEAF_BITS;
+    struct page_leaf {
+        chunk_header* frames[size_t(1) << LEAF_BITS];
+    };
+    static inline page_leaf* page_root[size_t(1) << ROOT_BITS] = {};
 
     // 内存池状态
-    static inline char* start = nullptr;                     // 内存池起始位置
-    static inline char* end = nullptr;                       // 内存池结束位置
-    static inline size_t pool_size = 0;                      // 内存池大小
-    static inline free_list_node* free_serial[NUM_OF_NODES] = {nullptr}; // 空闲链表数组
+    static inline thread_heap shared_heap;                                  // 单线程模式的堆，多线程模式的后备堆
+    static inline std::atomic<thread_heap*> heaps{nullptr};                 // 已创建的线程堆
+    static inline std::atomic<chunk_header*> chunks{nullptr};               // 已申请的全部chunk
+    static inline std::atomic<size_t> pool_size{0};                         // 内存池大小
+    static inline size_t global_batch[NUM_OF_NODES] = {};                   // 单线程模式各级的批量，0表示尚未refill
+    static inline central_list free_serial[NUM_OF_NODES];                   // 空闲链表数组
+
+    // 回收状态
+    static inline std::mutex trim_mutex;                                    // 同一时刻只允许一个trim
+    static inline std::atomic<uint64_t> central_epoch{0};                   // 中心池访问纪元
+    static inline std::atomic<size_t> central_users[2] = {};                // 奇偶纪元各自的在途访问数
+
+    // 中心池访问守卫：登记到当前纪元，登记后纪元已变化则重新登记
+    struct central_guard {
+        size_t slot = 0;
+        central_guard() noexcept {
+            if constexpr (threads) {
+                for(;;) {
+                    uint64_t epoch = central_epoch.load();
+                    slot = epoch & 1;
+                    central_users[slot].fetch_add(1);
+                    if(central_epoch.load() == epoch) {
+                        break;
+                    }
+                    central_users[slot].fetch_sub(1);
+                }
+            }
+        }
+        ~central_guard() {
+            if constexpr (threads) {
+                central_users[slot].fetch_sub(1, std::memory_order_release);
+            }
+        }
+    };
+
+    // 推进纪元并等待旧纪元的中心池访问全部结束
+    static void wait_central_quiescent() {
+        uint64_t epoch = central_epoch.fetch_add(1);
+        while(central_users[epoch & 1].load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    // 后台回收线程状态
+    static inline std::mutex scavenger_mutex;
+    static inline std::condition_variable scavenger_cv;
+    static inline std::thread* scavenger = nullptr;
+    static inline bool scavenger_stop = false;
+    static inline bool scavenger_registered = false;
+
+    // 线程缓存：平凡析构，线程退出时由cache_guard归还节点
+    struct thread_cache {
+        free_list_node* free_serial[NUM_OF_NODES];           // 私有空闲链表
+        size_t length[NUM_OF_NODES];                         // 私有链表长度
+        size_t limit[NUM_OF_NODES];                          // 私有链表长度上限，线程退出后置0，之后的释放直接归还中心池
+        size_t batch[NUM_OF_NODES];                          // 本线程各级的批量
+        bool registered;                                     // 是否已注册cache_guard
+        thread_heap* heap;                                   // 本线程的堆，未取得时为nullptr(使用shared_heap)
+    };
+    static constexpr thread_cache initial_cache() {
+        thread_cache result = {};
+        for(size_t i = 0; i < NUM_OF_NODES; i++) {
+            result.limit[i] = 2 * batch_nodes(i);
+        }
+        return result;
+    }
+    static inline thread_local thread_cache cache = {};   // 未注册时上限为0，首次释放即进入慢路径完成注册
+
+    struct cache_guard {
+        ~cache_guard() {
+            for(size_t i = 0; i < NUM_OF_NODES; i++) {
+                release_to_central(i, cache.length[i]);
+                cache.limit[i] = 0;
+            }
+            // 线程堆交还给之后注册的线程，之后本线程的释放按普通节点处理
+            if(thread_heap* heap = cache.heap) {
+                cache.heap = nullptr;
+                for(size_t i = 0; i < NUM_OF_NODES; i++) {
+                    drain_remote(*heap, i);
+                }
+                heap->active.store(false, std::memory_order_release);
+            }
+            retire_thread_stats();
+        }
+    };
+
+    // 统计计数器：多线程模式每线程一份，单线程模式全局一份；只有所属线程写入
+    static constexpr bool STATS = CAT_POOL_STATS;
+    struct thread_stats {
+        stat_counter allocations[NUM_OF_NODES];              // 分配次数
+        stat_counter frees[NUM_OF_NODES];                    // 释放次数
+        stat_counter requested_allocated[NUM_OF_NODES];      // 累计分配的请求字节数
+        stat_counter requested_freed[NUM_OF_NODES];          // 累计释放的请求字节数
+        stat_counter remote_frees[NUM_OF_NODES];             // 归还到其他线程堆的次数
+        stat_counter large_allocations;                      // 大块分配次数
+        stat_counter large_frees;                            // 大块释放次数
+        stat_counter large_allocated_bytes;                  // 大块累计分配字节数
+        stat_counter large_freed_bytes;                      // 大块累计释放字节数
+        int64_t published_live[NUM_OF_NODES] = {};           // 已发布到class_counters的在用节点数
+        thread_stats* next = nullptr;                        // stats_threads链表
+    };
+    static inline thread_local thread_stats local_stats;     // 多线程模式：本线程计数器
+    static inline thread_stats global_stats;                 // 单线程模式：全局计数器；多线程模式：已退出线程的汇总
+    static inline thread_stats* stats_threads = nullptr;     // 已注册线程的计数器
+    static inline std::mutex stats_mutex;                    // 保护stats_threads与global_stats的合并
+
+    // 慢路径计数器
+    struct class_counters {
+        std::atomic<uint64_t> refills{0};                    // refill次数
+        std::atomic<uint64_t> chunk_allocs{0};               // chunk_alloc次数
+        std::atomic<uint64_t> system_bytes{0};               // 为该级申请的系统内存
+        std::atomic<int64_t> carved_nodes{0};                // 已切分出的节点数(在用 + 空闲)
+        std::atomic<int64_t> live_nodes{0};                  // 各线程已发布的在用节点数
+        std::atomic<uint64_t> high_water_bytes{0};           // 在用字节数高水位
+    };
+    static inline class_counters class_stats[NUM_OF_NODES];
+    static inline std::atomic<uint64_t> system_bytes_total{0};   // 累计申请的系统内存
+    static inline std::atomic<uint64_t> released_bytes_total{0}; // 累计trim归还的系统内存
+
+    static thread_stats& stats() noexcept {
+        if constexpr (threads) {
+            return local_stats;
+        }
+        else {
+            return global_stats;
+        }
+    }
+
+    // 调用线程切分所用的堆
+    static thread_heap& local_heap() noexcept {
+        if constexpr (threads) {
+            thread_heap* heap = cache.heap;
+            return heap ? *heap : shared_heap;
+        }
+        else {
+            return shared_heap;
+        }
+    }
+
+    // 取第index级本次refill的批量，并按Refill::on_refill更新；多线程模式下缓存上限随之调整(线程退出后保持为0)
+    static size_t next_batch(size_t index) noexcept {
+        size_t* slot;
+        if constexpr (threads) {
+            slot = &cache.batch[index];
+        }
+        else {
+            slot = &global_batch[index];
+        }
+        size_t& batch = *slot;
+        size_t current = batch ? batch : Refill::initial_batch(batch_nodes(index));
+        batch = Refill::on_refill(current, batch_nodes(index));
+        if constexpr (threads) {
+            if(cache.limit[index]) {
+                cache.limit[index] = 2 * batch;
+            }
+        }
+        return current;
+    }
+
+    static void count_carved(size_t index, int64_t nodes) noexcept {
+        if constexpr (STATS) {
+            class_stats[index].carved_nodes.fetch_add(nodes, std::memory_order_relaxed);
+        }
+    }
 
 public:
     // 配置访问接口
     static constexpr size_t get_align() { return ALIGN; }
     static constexpr size_t get_max_bytes() { return MAX_BYTES; }
+    static constexpr size_t get_max_align() { return MAX_ALIGN; }
     static constexpr size_t get_num_of_nodes() { return NUM_OF_NODES; }
+    static constexpr size_t get_refill_nodes() { return REFILL_NODES; }
+    static constexpr size_t get_node_size(size_t index) { return size_class::class_size(index); }
 
     // 内存池状态访问接口
-    static char* get_start() { return start; }
-    static void set_start(char* ptr) { start = ptr; }
-    static char* get_end() { return end; }
-    static void set_end(char* ptr) { end = ptr; }
-    static size_t get_pool_size() { return pool_size; }
-    static void set_pool_size(size_t size) { pool_size = size; }
-    
-    // 空闲链表操作接口
-    static free_list_node* get_free_list(size_t index) { return free_serial[index]; }
-    static void set_free_list(size_t index, free_list_node* node) { free_serial[index] = node; }
-};
+    // 调用线程所用线性级chunk的未切分区域
+    static char* get_start() {
+        chunk_header* chunk = local_heap().current.load(std::memory_order_acquire);
+        return chunk ? chunk->start.load(std::memory_order_relaxed) : nullptr;
+    }
+    static char* get_end() {
+        chunk_header* chunk = local_heap().current.load(std::memory_order_acquire);
+        return chunk ? chunk->end : nullptr;
+    }
+    static size_t get_pool_size() { return pool_size.load(std::memory_order_relaxed); }
 
-// 内存池分配器类
-template<bool threads, typename T>
-class pool_allocator : public allocator<threads, T> {
-private:
-    alloc_pool<threads> entity;
+    // 空闲链表访问接口
+    static free_list_node* get_free_list(size_t index) { return free_serial[index].top(); }
 
-    // 内存池管理方法
-    /*
-     * 内存对齐计算：
-     * 1. 未对齐情况：bytes = k * ALIGN + remainder
-     *    计算：(bytes + ALIGN - 1) / ALIGN - 1
-     *    结果：k
-     * 2. 已对齐情况：bytes = k * ALIGN
-     *    计算：(bytes + ALIGN - 1) / ALIGN - 1
-     *    结果：k - 1
-     */
-    size_t get_free_serial_index(size_t bytes) const {
-        return (bytes + entity.get_align() - 1) / entity.get_align() - 1;
+    // 把完全空闲的chunk还给系统，保留至多retain_bytes字节，返回释放的字节数
+    // 多线程模式下调用线程的线程缓存先归还中心池
+    static size_t trim(size_t retain_bytes = 0);
+
+    // 启动/停止后台回收线程：每隔interval调用一次trim(retain_bytes)，仅多线程模式可用
+    static void start_scavenger(std::chrono::milliseconds interval, size_t retain_bytes = 0);
+    static void stop_scavenger();
+
+    // 统计快照：合并全部线程的计数器，可dump()输出文本或to_json()输出JSON
+    static pool_stats get_stats();
+
+    // fork支持(多线程模式)，供pthread_atfork注册：fork_prepare持有内部锁，fork_parent/fork_child在父子进程中各自释放
+    // 子进程只剩调用fork的线程：在途的中心池访问计数清零，其他线程的线程堆交给之后注册的线程，它们缓存中的节点不再回收，
+    // 后台回收线程需在子进程中重新启动
+    static void fork_prepare() noexcept;
+    static void fork_parent() noexcept;
+    static void fork_child() noexcept;
+
+    // 记录绕过内存池的大块分配/释放
+    static void note_large_allocate(size_t bytes) noexcept {
+        if constexpr (STATS) {
+            if constexpr (threads) {
+                if(!cache.registered) {
+                    register_thread();
+                }
+            }
+            stats().large_allocations.add(1);
+            stats().large_allocated_bytes.add(bytes);
+        }
+    }
+    static void note_large_deallocate(size_t bytes) noexcept {
+        if constexpr (STATS) {
+            if constexpr (threads) {
+                if(!cache.registered) {
+                    register_thread();
+                }
+            }
+            stats().large_frees.add(1);
+            stats().large_freed_bytes.add(bytes);
+        }
+    }
+
+    // 大小类下标：编译期生成的查表，bytes为0时按最小一级处理
+    static constexpr size_t get_free_serial_index(size_t bytes) {
+        return size_class::index(bytes);
+    }
+    static constexpr size_t get_free_serial_index(size_t bytes, size_t align) {
+        return size_class::index(bytes, align);
+    }
+
+    // 向上取整到所在大小类的节点大小
+    static constexpr size_t round_up(size_t bytes) {
+        return size_class::round_up(bytes);
     }
 
     /*
@@ -95,163 +414,1179 @@ private:
      * 2. 已对齐情况：bytes = k * ALIGN
      *    计算：(bytes + ALIGN - 1) & ~(ALIGN - 1)
      *    结果：k * ALIGN
-     * 
+     *
      * 原理：
      * - ALIGN - 1 的低位都是1
      * - ~(ALIGN - 1) 是低位清零掩码
      * - 通过位运算实现向上取整到ALIGN的倍数
      */
-    size_t round_up(size_t bytes) const {
-        return (bytes + entity.get_align() - 1) & ~(entity.get_align() - 1);
+    static constexpr size_t align_up(size_t bytes) {
+        return (bytes + ALIGN - 1) & ~(ALIGN - 1);
+    }
+
+    // 分配bytes(<= MAX_BYTES)大小的块，内存耗尽时抛出OutOfMemoryException
+    static void* allocate(size_t bytes) {
+        return allocate_class(get_free_serial_index(bytes), bytes);
+    }
+
+    // 分配bytes(<= MAX_BYTES)大小、按align(<= MAX_ALIGN)对齐的块
+    static void* allocate(size_t bytes, size_t align) {
+        return allocate_class(get_free_serial_index(bytes, align), bytes);
+    }
+
+    // 归还bytes(<= MAX_BYTES)大小的块，align须与分配时相同
+    static void deallocate(void* ptr, size_t bytes) noexcept {
+        deallocate_class(get_free_serial_index(bytes), ptr, bytes);
+    }
+    static void deallocate(void* ptr, size_t bytes, size_t align) noexcept {
+        deallocate_class(get_free_serial_index(bytes, align), ptr, bytes);
+    }
+
+    // 批量分配count个bytes大小、按align对齐的块写入out，全部成功返回count，内存耗尽时抛出OutOfMemoryException(已取得的块先归还)
+    // 依次取自：线程缓存整段、本线程堆的remote链表、中心空闲链表整段摘下后按需截取、chunk一次切出剩余个数
+    static size_t allocate_batch(size_t bytes, size_t count, void** out, size_t align = ALIGN);
+
+    // 批量归还count个bytes大小的块：先串成一条链，再一次挂到线程缓存或中心空闲链表；
+    // 属于其他线程堆的块与deallocate同样归还给所属线程堆
+    static void deallocate_batch(size_t bytes, size_t count, void** ptrs, size_t align = ALIGN) noexcept;
+
+private:
+    static void* allocate_class(size_t index, size_t bytes) {
+        if constexpr (STATS) {
+            stats().allocations[index].add(1);
+            stats().requested_allocated[index].add(bytes);
+        }
+        if constexpr (threads) {
+            thread_cache& local = cache;
+            free_list_node* block = local.free_serial[index];
+            if(block) {
+                local.free_serial[index] = block->block;
+                local.length[index]--;
+                return block;
+            }
+            return fetch_from_central(index);
+        }
+        else {
+            free_list_node* block = free_serial[index].pop();
+            if(block) {
+                return block;
+            }
+            return refill(index);
+        }
+    }
+
+    static void deallocate_class(size_t index, void* ptr, size_t bytes) noexcept {
+        free_list_node* node = static_cast<free_list_node*>(ptr);
+        if constexpr (STATS) {
+            stats().frees[index].add(1);
+            stats().requested_freed[index].add(bytes);
+        }
+        if constexpr (threads) {
+            thread_cache& local = cache;
+            // 属于其他仍在运行的线程堆：压入其remote链表，由所属线程取回
+            chunk_header* chunk = chunk_of(node);
+            if(chunk && chunk->owner != local.heap && chunk->owner->active.load(std::memory_order_relaxed)) {
+                chunk->owner->remote[index].push(node);
+                if constexpr (STATS) {
+                    stats().remote_frees[index].add(1);
+                }
+                return;
+            }
+            node->block = local.free_serial[index];
+            local.free_serial[index] = node;
+            if(++local.length[index] > local.limit[index]) {
+                flush_cache(index);
+            }
+        }
+        else {
+            free_serial[index].push(node);
+        }
     }
 
     // 内存池管理
-    void* refill(size_t node_size, const size_t& nodes = 20);
-    char* chunk_alloc(size_t node_size, unsigned int& nodes);
+    static void* refill(size_t index);
+    static char* chunk_alloc(size_t index, size_t& nodes);
+    static chunk_header* new_chunk(size_t bytes, thread_heap* owner);
+    static void free_chunk(chunk_header* chunk) noexcept;
+    static char* borrow_larger(size_t index);
+    static void recycle(chunk_header* chunk, char* rest, size_t bytes) noexcept;
+    static void link_nodes(char* chunk, size_t node_size, size_t nodes) noexcept;
+
+    // 线程缓存与中心池之间的批量搬运
+    static void* fetch_from_central(size_t index);
+    static size_t take_from_central(size_t index, size_t count, void** out);
+    static void flush_cache(size_t index) noexcept;
+    static void release_to_central(size_t index, size_t count) noexcept;
+
+    // 线程堆与跨线程释放
+    static thread_heap* acquire_heap() noexcept;
+    static void drain_remote(thread_heap& heap, size_t index) noexcept;
+    static bool map_chunk(chunk_header* chunk, chunk_header* value) noexcept;
+    static chunk_header* chunk_of(const void* ptr) noexcept {
+        uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+        if(address >> 48) {
+            return nullptr;
+        }
+        page_leaf* leaf = __atomic_load_n(&page_root[address >> (FRAME_SHIFT + LEAF_BITS)], __ATOMIC_ACQUIRE);
+        if(leaf == nullptr) {
+            return nullptr;
+        }
+        return __atomic_load_n(&leaf->frames[(address >> FRAME_SHIFT) & ((size_t(1) << LEAF_BITS) - 1)], __ATOMIC_ACQUIRE);
+    }
+
+    // 线程注册与统计发布
+    static void register_thread() noexcept;
+    static void retire_thread_stats() noexcept;
+    static void publish_live(size_t index) noexcept;
+};
+
+// 内存池分配器类
+// PageSource同时决定大块的来源：malloc来源沿用allocator(含OOM处理)，其他来源直接向页来源申请
+// 无状态：空类，全部调用静态分派到alloc_pool
+template<bool threads, typename T, class PageSource = malloc_page_source, class Config = default_pool_config>
+class pool_allocator : public allocator_base<pool_allocator<threads, T, PageSource, Config>, threads, T> {
+private:
+    using pool = alloc_pool<threads, PageSource, Config>;
+    using system_allocator = allocator<threads, T>;                // 大块与超大对齐的分配器
 
 public:
     // 模板构造函数，允许从其他类型的allocator构造
     template<typename U>
     struct rebind {
-        using other = pool_allocator<threads, U>;
+        using other = pool_allocator<threads, U, PageSource, Config>;
     };
 
     // 构造函数和析构函数
     pool_allocator() noexcept = default;
     template<typename U>
-    pool_allocator(const pool_allocator<threads, U>&) noexcept {}
-    ~pool_allocator() noexcept override = default;
+    pool_allocator(const pool_allocator<threads, U, PageSource, Config>&) noexcept {}
+
+private:
+    // 不超过MAX_BYTES且对齐不超过MAX_ALIGN的请求由内存池满足
+    static constexpr bool pooled(size_t bytes, size_t align) {
+        return bytes <= pool::get_max_bytes() && align <= pool::get_max_align();
+    }
 
 public:
-    // 内存分配：优先使用内存池，大块内存直接使用malloc
-    T* allocate(size_t n) override {
-        if(n * sizeof(T) > entity.max_bytes()) {
-            return static_cast<T*>(malloc(n * sizeof(T)));
-        }
+    // 内存分配：按alignof(T)对齐
+    T* allocate(size_t n) {
+        return allocate(n, alignof(T));
+    }
 
-        free_list_node* block = entity.get_free_list(get_free_serial_index(n * sizeof(T)));
-        if(block) {
-            entity.set_free_list(get_free_serial_index(n * sizeof(T)), block->block);
-            return static_cast<T*>(block);
+    // 内存分配：按align(小于alignof(T)时按alignof(T))对齐，优先使用内存池，大块或超大对齐直接使用malloc或页来源
+    T* allocate(size_t n, size_t align) {
+        align = align > alignof(T) ? align : alignof(T);
+        if(!pooled(n * sizeof(T), align)) {
+            pool::note_large_allocate(n * sizeof(T));
+            if constexpr (PageSource::USES_HEAP) {
+                return system_allocator().allocate(n, align);
+            }
+            else {
+                // 页来源按页对齐，足以满足常见的对齐要求
+                T* result = static_cast<T*>(PageSource::allocate(n * sizeof(T)));
+                if(result == nullptr) {
+                    fprintf(stderr, "page source alloc failed: %zu bytes\n", n * sizeof(T));
+                }
+                heap_profiler::on_allocate(result, n * sizeof(T));
+                return result;
+            }
         }
 
-        return static_cast<T*>(refill(round_up(n * sizeof(T))));
+        try {
+            T* result = static_cast<T*>(pool::allocate(n * sizeof(T), align));
+            heap_profiler::on_allocate(result, n * sizeof(T));
+            return result;
+        } catch (const std::exception& e) {
+            fprintf(stderr, "pool alloc failed: %s\n", e.what());
+            return nullptr;
+        }
     }
 
     // 内存释放：优先使用内存池，大块内存直接使用free
-    void deallocate(T* ptr, size_t n) noexcept override {
-        if(n * sizeof(T) > entity.get_max_bytes()) {
-            free(ptr);
+    void deallocate(T* ptr, size_t n) noexcept {
+        deallocate(ptr, n, alignof(T));
+    }
+
+    // align须与分配时相同
+    void deallocate(T* ptr, size_t n, size_t align) noexcept {
+        align = align > alignof(T) ? align : alignof(T);
+        if(!pooled(n * sizeof(T), align)) {
+            if(ptr) {
+                pool::note_large_deallocate(n * sizeof(T));
+            }
+            if constexpr (PageSource::USES_HEAP) {
+                system_allocator().deallocate(ptr, n, align);
+            }
+            else {
+                heap_profiler::on_deallocate(ptr);
+                PageSource::release(ptr, n * sizeof(T));
+            }
             return;
         }
-        
+
         if(ptr) {
-            free_list_node* my_free_list = entity.get_free_list(get_free_serial_index(n * sizeof(T)));
-            ((free_list_node*)ptr)->block = my_free_list;
-            entity.set_free_list(get_free_serial_index(n * sizeof(T)), (free_list_node*)ptr);
+            heap_profiler::on_deallocate(ptr);
+            pool::deallocate(ptr, n * sizeof(T), align);
         }
     }
 
-    // 内存重分配：优先使用内存池，大块内存直接使用realloc
-    T* reallocate(T* ptr, size_t old_size, size_t new_size) override {
-        if(old_size * sizeof(T) > entity.get_max_bytes() && new_size * sizeof(T) > entity.get_max_bytes()) {
-            return static_cast<T*>(realloc(ptr, new_size * sizeof(T)));
+    // 批量分配count个n元素的块写入out，返回成功分配的个数；内存池耗尽时返回0
+    size_t allocate_batch(size_t n, size_t count, T** out) {
+        if(!pooled(n * sizeof(T), alignof(T))) {
+            size_t filled = 0;
+            while(filled < count && (out[filled] = allocate(n)) != nullptr) {
+                filled++;
+            }
+            return filled;
         }
-        if(round_up(old_size * sizeof(T)) == round_up(new_size * sizeof(T))) {
-            return ptr;
+        try {
+            size_t filled = pool::allocate_batch(n * sizeof(T), count, (void**)out, alignof(T));
+            for(size_t i = 0; i < filled; i++) {
+                heap_profiler::on_allocate(out[i], n * sizeof(T));
+            }
+            return filled;
+        } catch (const std::exception& e) {
+            fprintf(stderr, "pool batch alloc failed: %s\n", e.what());
+            return 0;
         }
+    }
 
-        T* result = allocate(new_size);
-        size_t copy_sz = new_size > old_size ? old_size : new_size;
-        memcpy(result, ptr, copy_sz * sizeof(T));
-        deallocate(ptr, old_size);
-        return result;
+    // 批量归还count个n元素的块，ptrs中不能有nullptr
+    void deallocate_batch(size_t n, size_t count, T** ptrs) noexcept {
+        if(!pooled(n * sizeof(T), alignof(T))) {
+            for(size_t i = 0; i < count; i++) {
+                deallocate(ptrs[i], n);
+            }
+            return;
+        }
+        for(size_t i = 0; i < count; i++) {
+            heap_profiler::on_deallocate(ptrs[i]);
+        }
+        pool::deallocate_batch(n * sizeof(T), count, (void**)ptrs, alignof(T));
     }
 
-    size_t max_size() const noexcept override {
-        return size_t(-1) / sizeof(T);
+    // 内存重分配：优先使用内存池，大块内存直接使用realloc(mmap来源为mremap)
+    T* reallocate(T* ptr, size_t old_size, size_t new_size) {
+        if(ptr == nullptr) {
+            return allocate(new_size);
+        }
+        bool old_pooled = pooled(old_size * sizeof(T), alignof(T));
+        bool new_pooled = pooled(new_size * sizeof(T), alignof(T));
+        if(!old_pooled && !new_pooled) {
+            T* result;
+            if constexpr (PageSource::USES_HEAP) {
+                result = system_allocator().reallocate(ptr, old_size, new_size);
+            }
+            else {
+                // 与allocator::reallocate相同：先取出旧样本，失败时放回
+                heap_profiler::detached_sample sample = heap_profiler::on_reallocate(ptr);
+                result = static_cast<T*>(PageSource::reallocate(ptr, old_size * sizeof(T), new_size * sizeof(T)));
+                if(result == nullptr) {
+                    heap_profiler::on_reallocate_failed(sample);
+                    fprintf(stderr, "page source realloc failed: %zu bytes\n", new_size * sizeof(T));
+                    return nullptr;
+                }
+                heap_profiler::on_allocate(result, new_size * sizeof(T));
+            }
+            if(result) {
+                pool::note_large_deallocate(old_size * sizeof(T));
+                pool::note_large_allocate(new_size * sizeof(T));
+            }
+            return result;
+        }
+        if(old_pooled && new_pooled
+           && pool::get_free_serial_index(old_size * sizeof(T), alignof(T))
+              == pool::get_free_serial_index(new_size * sizeof(T), alignof(T))) {
+            return ptr;
+        }
+        return this->relocate(ptr, old_size, new_size);
     }
 };
 
+// 内存池是全局共享的，所有pool_allocator都相等
+template<bool threads, typename T1, typename T2, class PageSource, class Config>
+bool operator==(const pool_allocator<threads, T1, PageSource, Config>&, const pool_allocator<threads, T2, PageSource, Config>&) noexcept {
+    return true;
+}
+
+template<bool threads, typename T1, typename T2, class PageSource, class Config>
+bool operator!=(const pool_allocator<threads, T1, PageSource, Config>&, const pool_allocator<threads, T2, PageSource, Config>&) noexcept {
+    return false;
+}
+
+// 把chunk之后的nodes - 1个节点串成以nullptr结尾的链表(第一个节点留给调用者)
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::link_nodes(char* chunk, size_t node_size, size_t nodes) noexcept {
+    free_list_node* current_node = (free_list_node*)(chunk + node_size);
+    for(size_t i = 1; i < nodes - 1; i++) {
+        free_list_node* next_node = (free_list_node*)((char*)current_node + node_size);
+        current_node->block = next_node;
+        current_node = next_node;
+    }
+    current_node->block = nullptr;
+}
+
 // 实现refill和chunk_alloc方法
-template<bool threads, typename T>
-void* pool_allocator<threads, T>::refill(size_t node_size, const size_t& nodes) {
-    unsigned int nobjs = nodes;
-    char* chunk = chunk_alloc(node_size, nobjs);
-    if(nobjs == 1)
+// refill：从chunk中切出一批第index级节点，返回第一个，其余挂到中心池空闲链表
+template<bool threads, class PageSource, class Config>
+void* alloc_pool<threads, PageSource, Config>::refill(size_t index) {
+    size_t node_size = size_class::class_size(index);
+    size_t nodes = next_batch(index);
+    if constexpr (STATS) {
+        class_stats[index].refills.fetch_add(1, std::memory_order_relaxed);
+        publish_live(index);
+    }
+    char* chunk = chunk_alloc(index, nodes);
+    if(nodes == 1)
         return chunk;
 
-    free_list_node* my_free_list = entity.get_free_list(get_free_serial_index(node_size));
-    my_free_list->block = (free_list_node*)chunk;
+    link_nodes(chunk, node_size, nodes);
+    free_serial[index].push_chain(
+        (free_list_node*)(chunk + node_size), (free_list_node*)(chunk + (nodes - 1) * node_size));
+    return chunk;
+}
 
-    free_list_node* current_node = (free_list_node*)((char*)chunk + node_size);
-    free_list_node* next_node = (free_list_node*)((char*)current_node + node_size);
-    if(next_node > (free_list_node*)((char*)entity.get_end()-node_size)) {
-        return chunk;
+// chunk_alloc：从第index级所用chunk的[start, end)切出node_size * nodes字节，不足时缩减nodes，仍不足一个节点时换上新的chunk
+// 线性级共用调用线程堆的current，几何级各用spans[index]；切分用CAS推进start，多个线程可同时从同一个chunk切分
+template<bool threads, class PageSource, class Config>
+char* alloc_pool<threads, PageSource, Config>::chunk_alloc(size_t index, size_t& nodes) {
+    size_t node_size = size_class::class_size(index);
+    uintptr_t node_align = size_class::node_align(index);
+    thread_heap& heap = local_heap();
+    std::atomic<chunk_header*>& region = index < SHARED_CLASSES ? heap.current : heap.spans[index];
+    if constexpr (STATS) {
+        class_stats[index].chunk_allocs.fetch_add(1, std::memory_order_relaxed);
     }
+    for(;;) {
+        chunk_header* chunk = region.load(std::memory_order_acquire);
+        if(chunk) {
+            char* result = chunk->start.load(std::memory_order_relaxed);
+            for(;;) {
+                // 起点推到node_align的倍数，跳过的字节由切分成功的线程回收
+                char* aligned = (char*)(((uintptr_t)result + node_align - 1) & ~(node_align - 1));
+                if(aligned > chunk->end || (size_t)(chunk->end - aligned) < node_size) {
+                    break;
+                }
+                size_t bytes_left = chunk->end - aligned;
+                size_t carve = bytes_left >= node_size * nodes ? nodes : bytes_left / node_size;
+                if(chunk->start.compare_exchange_weak(result, aligned + carve * node_size, std::memory_order_relaxed)) {
+                    recycle(chunk, result, aligned - result);
+                    nodes = carve;
+                    count_carved(index, carve);
+                    return aligned;
+                }
+            }
 
-    for(int i = 1; i < nobjs - 1; i++) {
-        current_node->block = next_node;
-        if(i == nobjs - 2) {
-            next_node->block = nullptr;
-            break;
+            // 残余空间拆成节点挂回空闲链表，由把start推到end的线程负责
+            if(result < chunk->end) {
+                if(!chunk->start.compare_exchange_strong(result, chunk->end, std::memory_order_relaxed)) {
+                    continue;
+                }
+                recycle(chunk, result, chunk->end - result);
+            }
         }
 
-        if((free_list_node*)((char*)next_node + node_size) > (free_list_node*)((char*)entity.get_end()-node_size)) {
-            next_node->block = nullptr;
-            break;
+        // 大小由Refill决定：共用chunk至少容纳两批，span至少SPAN_BYTES且容纳SPAN_MIN_NODES个节点
+        bool shared = index < SHARED_CLASSES;
+        std::atomic<size_t>& last = heap.chunk_bytes[shared ? 0 : index];
+        size_t minimum = shared ? 2 * node_size * nodes
+                                : (SPAN_MIN_NODES * node_size > SPAN_BYTES ? SPAN_MIN_NODES * node_size : SPAN_BYTES);
+        size_t bytes_to_get = align_up(Refill::next_chunk(last.load(std::memory_order_relaxed), minimum,
+                                                          shared ? MAX_CHUNK_GROWTH : MAX_SPAN_BYTES, get_pool_size(), shared));
+        chunk_header* fresh = new_chunk(bytes_to_get, &heap == &shared_heap ? nullptr : &heap);
+        // 申请失败时按Refill退避重试，退到需求以下才从更大的空闲链表借用
+        while(fresh == nullptr) {
+            bytes_to_get = align_up(Refill::backoff_chunk(bytes_to_get, minimum));
+            if(bytes_to_get < minimum) {
+                nodes = 1;
+                return borrow_larger(index);
+            }
+            fresh = new_chunk(bytes_to_get, &heap == &shared_heap ? nullptr : &heap);
         }
+        last.store(bytes_to_get, std::memory_order_relaxed);
 
-        current_node = next_node;
-        next_node = (free_list_node*)((char*)next_node + node_size);
+        // 其他线程已换上新chunk时放弃自己申请的，重新切分
+        if(!region.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            free_chunk(fresh);
+            continue;
+        }
+        pool_size.fetch_add(fresh->size, std::memory_order_relaxed);
+        if constexpr (STATS) {
+            class_stats[index].system_bytes.fetch_add(fresh->size, std::memory_order_relaxed);
+            system_bytes_total.fetch_add(fresh->size, std::memory_order_relaxed);
+        }
+        fresh->next = chunks.load(std::memory_order_relaxed);
+        while(!chunks.compare_exchange_weak(fresh->next, fresh, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+// 向系统申请一个可切分bytes字节的chunk，失败返回nullptr
+// owner非空时chunk按FRAME_BYTES对齐、取整并登记到页表，对齐或登记失败时不记归属
+template<bool threads, class PageSource, class Config>
+typename alloc_pool<threads, PageSource, Config>::chunk_header* alloc_pool<threads, PageSource, Config>::new_chunk(size_t bytes, thread_heap* owner) {
+    // 按页来源的粒度取整，多出的部分同样用于切分
+    size_t size = PageSource::round_up(CHUNK_HEADER_SIZE + bytes);
+    char* memory;
+    if(owner) {
+        size = (size + FRAME_BYTES - 1) & ~(FRAME_BYTES - 1);
+#if !defined(_WIN32)
+        // libc堆按帧对齐申请，free照常归还；mmap来源本身按2MB对齐
+        if constexpr (PageSource::USES_HEAP) {
+            void* aligned = nullptr;
+            memory = posix_memalign(&aligned, FRAME_BYTES, size) == 0 ? (char*)aligned : nullptr;
+        }
+        else
+#endif
+        {
+            memory = (char*)PageSource::allocate(size);
+        }
+    }
+    else {
+        memory = (char*)PageSource::allocate(size);
+    }
+    if(memory == nullptr) {
+        return nullptr;
+    }
+    chunk_header* chunk = ::new(memory) chunk_header;
+    chunk->start.store(memory + CHUNK_HEADER_SIZE, std::memory_order_relaxed);
+    chunk->end = memory + size;
+    chunk->size = size;
+    chunk->waste.store(0, std::memory_order_relaxed);
+    chunk->next = nullptr;
+    chunk->owner = nullptr;
+    if(owner && ((uintptr_t)memory & (FRAME_BYTES - 1)) == 0) {
+        chunk->owner = owner;
+        if(!map_chunk(chunk, chunk)) {
+            map_chunk(chunk, nullptr);
+            chunk->owner = nullptr;
+        }
     }
     return chunk;
 }
 
-template<bool threads, typename T>
-char* pool_allocator<threads, T>::chunk_alloc(size_t node_size, unsigned int& nodes) {
-    char* result;
-    size_t need_bytes = node_size * nodes;
-    size_t bytes_left = entity.get_end() - entity.get_start();
+// 归还chunk：先从页表注销
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::free_chunk(chunk_header* chunk) noexcept {
+    if(chunk->owner) {
+        map_chunk(chunk, nullptr);
+    }
+    PageSource::release(chunk, chunk->size);
+}
 
-    if(bytes_left >= need_bytes) {
-        result = entity.get_start();
-        entity.set_start(entity.get_start() + need_bytes);
-        return result;
+// 把chunk覆盖的每个帧在页表中记为value，缺少叶子时按需申请；申请失败返回false
+template<bool threads, class PageSource, class Config>
+bool alloc_pool<threads, PageSource, Config>::map_chunk(chunk_header* chunk, chunk_header* value) noexcept {
+    for(uintptr_t frame = (uintptr_t)chunk; frame < (uintptr_t)chunk->end; frame += FRAME_BYTES) {
+        if(frame >> 48) {
+            return false;
+        }
+        page_leaf*& slot = page_root[frame >> (FRAME_SHIFT + LEAF_BITS)];
+        page_leaf* leaf = __atomic_load_n(&slot, __ATOMIC_ACQUIRE);
+        if(leaf == nullptr) {
+            if(value == nullptr) {
+                continue;
+            }
+            // 叶子512K，calloc得到的零页在写入前不占物理内存
+            page_leaf* fresh = (page_leaf*)calloc(1, sizeof(page_leaf));
+            if(fresh == nullptr) {
+                return false;
+            }
+            if(__atomic_compare_exchange_n(&slot, &leaf, fresh, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                leaf = fresh;
+            }
+            else {
+                free(fresh);
+            }
+        }
+        __atomic_store_n(&leaf->frames[(frame >> FRAME_SHIFT) & ((size_t(1) << LEAF_BITS) - 1)], value, __ATOMIC_RELEASE);
+    }
+    return true;
+}
+
+// 系统内存不足：从更大的空闲链表中借一个地址满足对齐的节点，多出的部分拆成节点挂回空闲链表
+template<bool threads, class PageSource, class Config>
+char* alloc_pool<threads, PageSource, Config>::borrow_larger(size_t index) {
+    size_t node_size = size_class::class_size(index);
+    uintptr_t node_align = size_class::node_align(index);
+    for(size_t i = index + 1; i < NUM_OF_NODES; i++) {
+        free_list_node* block = free_serial[i].pop();
+        if(block == nullptr) {
+            continue;
+        }
+        if((uintptr_t)block & (node_align - 1)) {
+            free_serial[i].push(block);
+            continue;
+        }
+        count_carved(i, -1);
+        count_carved(index, 1);
+        recycle(nullptr, (char*)block + node_size, size_class::class_size(i) - node_size);
+        return (char*)block;
+    }
+    throw OutOfMemoryException();
+}
+
+// 把[rest, rest + bytes)拆成起点对齐的节点挂回空闲链表：每次取起点满足对齐、不超过剩余字节的最大一级，
+// 不足最小一级的部分计入chunk的waste
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::recycle(chunk_header* chunk, char* rest, size_t bytes) noexcept {
+    while(bytes >= ALIGN) {
+        size_t rest_index = size_class::floor_index(bytes);
+        while((uintptr_t)rest & (size_class::node_align(rest_index) - 1)) {
+            rest_index--;
+        }
+        free_serial[rest_index].push((free_list_node*)rest);
+        count_carved(rest_index, 1);
+        rest += size_class::class_size(rest_index);
+        bytes -= size_class::class_size(rest_index);
     }
-    else if(bytes_left >= node_size) {
-        nodes = bytes_left / node_size;
-        result = entity.get_start();
-        entity.set_start(entity.get_start() + nodes * node_size);
+    if(chunk && bytes > 0) {
+        chunk->waste.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+// 线程缓存为空：从中心池搬运一批节点，中心池也为空时直接从chunk切出一批
+template<bool threads, class PageSource, class Config>
+void* alloc_pool<threads, PageSource, Config>::fetch_from_central(size_t index) {
+    thread_cache& local = cache;
+    if(!local.registered) {
+        register_thread();
+    }
+    if constexpr (STATS) {
+        class_stats[index].refills.fetch_add(1, std::memory_order_relaxed);
+        publish_live(index);
+    }
+
+    // 先取回其他线程释放的本堆节点：remote链表只有本线程和trim摘取，整条摘下后可以遍历
+    if(local.heap) {
+        if(free_list_node* result = local.heap->remote[index].pop_all()) {
+            size_t count = 0;
+            free_list_node* tail = result->block;
+            if(tail) {
+                count = 1;
+                while(tail->block) {
+                    tail = tail->block;
+                    count++;
+                }
+                tail->block = local.free_serial[index];
+                local.free_serial[index] = result->block;
+                local.length[index] += count;
+                if(local.length[index] > local.limit[index]) {
+                    release_to_central(index, local.length[index] - local.limit[index]);
+                }
+            }
+            return result;
+        }
+    }
+    central_guard guard;
+    size_t nodes = next_batch(index);
+
+    // 中心链表逐个弹出：整段摘取需要遍历其他线程可能正在复用的节点，不安全
+    free_list_node* result = free_serial[index].pop();
+    if(result) {
+        size_t count = 0;
+        free_list_node* node;
+        while(count < nodes - 1 && (node = free_serial[index].pop()) != nullptr) {
+            node->block = local.free_serial[index];
+            local.free_serial[index] = node;
+            count++;
+        }
+        local.length[index] += count;
         return result;
     }
-    else {
-        size_t bytes_to_get = 2 * need_bytes + round_up(entity.get_pool_size()>>4);
-
-        if(bytes_left > 0) {
-            free_list_node* my_free_list = entity.get_free_list(get_free_serial_index(bytes_left));
-            ((free_list_node*)entity.get_start())->block = my_free_list;
-            entity.set_free_list(get_free_serial_index(bytes_left), (free_list_node*)entity.get_start());
-        }
-
-        entity.set_start((char*)malloc(bytes_to_get));
-        if(!entity.get_start()) {
-            for(int i = node_size; i < entity.get_num_of_nodes(); i++) {
-                if(entity.get_free_list(i)) {
-                    entity.set_free_list(i, entity.get_free_list(i)->block);
-                    entity.set_start((char*)entity.get_free_list(i));
-                    entity.set_end(entity.get_start() + node_size);
-                    return chunk_alloc(node_size, nodes);
+
+    size_t node_size = size_class::class_size(index);
+    char* chunk = chunk_alloc(index, nodes);
+    if(nodes > 1) {
+        link_nodes(chunk, node_size, nodes);
+        ((free_list_node*)(chunk + (nodes - 1) * node_size))->block = local.free_serial[index];
+        local.free_serial[index] = (free_list_node*)(chunk + node_size);
+        local.length[index] += nodes - 1;
+    }
+    return chunk;
+}
+
+// 线程缓存超过上限：未注册的线程先完成注册，否则按Refill::on_flush缩小批量，归还到只剩一批
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::flush_cache(size_t index) noexcept {
+    thread_cache& local = cache;
+    if(!local.registered) {
+        register_thread();
+        return;
+    }
+    if constexpr (STATS) {
+        publish_live(index);
+    }
+    size_t keep = 0;
+    if(local.limit[index]) {
+        local.batch[index] = Refill::on_flush(local.batch[index], batch_nodes(index));
+        local.limit[index] = 2 * local.batch[index];
+        keep = local.batch[index];
+    }
+    release_to_central(index, local.length[index] > keep ? local.length[index] - keep : 0);
+}
+
+// 线程缓存过长或线程退出：把私有链表头部count个节点整段归还中心池，一次CAS
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::release_to_central(size_t index, size_t count) noexcept {
+    if(count == 0) {
+        return;
+    }
+    thread_cache& local = cache;
+    free_list_node* head = local.free_serial[index];
+    free_list_node* tail = head;
+    for(size_t i = 1; i < count; i++) {
+        tail = tail->block;
+    }
+    local.free_serial[index] = tail->block;
+    local.length[index] -= count;
+    free_serial[index].push_chain(head, tail);
+}
+
+// 线程堆的remote链表整条归还中心池
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::drain_remote(thread_heap& heap, size_t index) noexcept {
+    if(free_list_node* head = heap.remote[index].pop_all()) {
+        free_serial[index].push_all(head);
+    }
+}
+
+// 取得一个线程堆：优先接管已退出线程留下的堆，否则向页来源申请一个新堆；申请失败返回nullptr
+template<bool threads, class PageSource, class Config>
+typename alloc_pool<threads, PageSource, Config>::thread_heap* alloc_pool<threads, PageSource, Config>::acquire_heap() noexcept {
+    for(thread_heap* heap = heaps.load(std::memory_order_acquire); heap; heap = heap->next) {
+        bool idle = false;
+        if(!heap->active.load(std::memory_order_relaxed)
+           && heap->active.compare_exchange_strong(idle, true, std::memory_order_acq_rel)) {
+            return heap;
+        }
+    }
+    // 不经过operator new：内存池可能正被用来实现它
+    void* memory = PageSource::allocate(sizeof(thread_heap));
+    if(memory == nullptr) {
+        return nullptr;
+    }
+    thread_heap* heap = ::new(memory) thread_heap;
+    heap->active.store(true, std::memory_order_relaxed);
+    heap->next = heaps.load(std::memory_order_relaxed);
+    while(!heaps.compare_exchange_weak(heap->next, heap, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return heap;
+}
+
+// 批量分配：中心空闲链表不能整段弹出(需要遍历其他线程可能正在复用的节点)，因此整条摘下，
+// 摘下后节点归本线程所有，截取所需的部分后用push_all把剩余部分挂回，不遍历剩余部分找链尾
+template<bool threads, class PageSource, class Config>
+size_t alloc_pool<threads, PageSource, Config>::take_from_central(size_t index, size_t count, void** out) {
+    if constexpr (STATS) {
+        class_stats[index].refills.fetch_add(1, std::memory_order_relaxed);
+    }
+    central_guard guard;
+    free_list_node* node = free_serial[index].pop_all();
+    size_t taken = 0;
+    while(node && taken < count) {
+        out[taken++] = node;
+        node = node->block;
+    }
+    if(node) {
+        free_serial[index].push_all(node);
+    }
+
+    // 不足的部分直接从chunk切出，一次CAS切出剩余个数(受chunk剩余空间限制)
+    size_t node_size = size_class::class_size(index);
+    try {
+        while(taken < count) {
+            size_t nodes = count - taken;
+            char* chunk = chunk_alloc(index, nodes);
+            for(size_t i = 0; i < nodes; i++) {
+                out[taken++] = chunk + i * node_size;
+            }
+        }
+    } catch (...) {
+        for(size_t i = 0; i < taken; i++) {
+            free_serial[index].push((free_list_node*)out[i]);
+        }
+        throw;
+    }
+    return taken;
+}
+
+template<bool threads, class PageSource, class Config>
+size_t alloc_pool<threads, PageSource, Config>::allocate_batch(size_t bytes, size_t count, void** out, size_t align) {
+    size_t index = get_free_serial_index(bytes, align);
+    size_t taken = 0;
+    if constexpr (threads) {
+        thread_cache& local = cache;
+        if(!local.registered) {
+            register_thread();
+        }
+        free_list_node* node = local.free_serial[index];
+        while(node && taken < count) {
+            out[taken++] = node;
+            node = node->block;
+        }
+        local.free_serial[index] = node;
+        local.length[index] -= taken;
+
+        // 其他线程归还的本堆节点：整条摘下，截取所需的部分，剩余挂到线程缓存
+        if(taken < count && local.heap) {
+            node = local.heap->remote[index].pop_all();
+            while(node && taken < count) {
+                out[taken++] = node;
+                node = node->block;
+            }
+            if(node) {
+                free_list_node* tail = node;
+                size_t rest = 1;
+                while(tail->block) {
+                    tail = tail->block;
+                    rest++;
                 }
+                tail->block = local.free_serial[index];
+                local.free_serial[index] = node;
+                local.length[index] += rest;
+                if(local.length[index] > local.limit[index]) {
+                    release_to_central(index, local.length[index] - local.limit[index]);
+                }
+            }
+        }
+    }
+    if(taken < count) {
+        try {
+            take_from_central(index, count - taken, out + taken);
+        } catch (...) {
+            for(size_t i = 0; i < taken; i++) {
+                free_serial[index].push((free_list_node*)out[i]);
             }
+            throw;
+        }
+    }
+    if constexpr (STATS) {
+        stats().allocations[index].add(count);
+        stats().requested_allocated[index].add(bytes * count);
+        publish_live(index);
+    }
+    return count;
+}
+
+// 多线程模式下与deallocate_class相同地检查归属：属于其他仍在运行的线程堆的节点，连续同属一个堆的一段
+// 一次压入其remote链表，其余节点串成一条链挂到线程缓存或中心空闲链表
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::deallocate_batch(size_t bytes, size_t count, void** ptrs, size_t align) noexcept {
+    if(count == 0) {
+        return;
+    }
+    size_t index = get_free_serial_index(bytes, align);
+    if constexpr (STATS) {
+        stats().frees[index].add(count);
+        stats().requested_freed[index].add(bytes * count);
+    }
+    free_list_node* head = nullptr;
+    free_list_node* tail = nullptr;
+    size_t kept = 0;
+    auto append = [&](free_list_node* node) {
+        if(tail) {
+            tail->block = node;
+        }
+        else {
+            head = node;
+        }
+        tail = node;
+        kept++;
+    };
+    if constexpr (threads) {
+        thread_cache& local = cache;
+        if(!local.registered) {
+            register_thread();
+        }
+        if constexpr (STATS) {
+            publish_live(index);
+        }
+        thread_heap* run_owner = nullptr;
+        free_list_node* run_head = nullptr;
+        free_list_node* run_tail = nullptr;
+        size_t run_length = 0;
+        auto flush_run = [&] {
+            if(run_owner) {
+                run_owner->remote[index].push_chain(run_head, run_tail);
+                if constexpr (STATS) {
+                    stats().remote_frees[index].add(run_length);
+                }
+            }
+        };
+        for(size_t i = 0; i < count; i++) {
+            free_list_node* node = (free_list_node*)ptrs[i];
+            chunk_header* chunk = chunk_of(node);
+            if(chunk && chunk->owner != local.heap && chunk->owner->active.load(std::memory_order_relaxed)) {
+                if(chunk->owner != run_owner) {
+                    flush_run();
+                    run_owner = chunk->owner;
+                    run_head = node;
+                    run_length = 0;
+                }
+                else {
+                    run_tail->block = node;
+                }
+                run_tail = node;
+                run_length++;
+                continue;
+            }
+            append(node);
+        }
+        flush_run();
+        if(head == nullptr) {
+            return;
+        }
+        // 放得下就挂到线程缓存，否则整段归还中心池
+        if(local.length[index] + kept <= local.limit[index]) {
+            tail->block = local.free_serial[index];
+            local.free_serial[index] = head;
+            local.length[index] += kept;
+            return;
+        }
+    }
+    else {
+        for(size_t i = 0; i < count; i++) {
+            append((free_list_node*)ptrs[i]);
+        }
+    }
+    free_serial[index].push_chain(head, tail);
+}
+
+template<bool threads, class PageSource, class Config>
+size_t alloc_pool<threads, PageSource, Config>::trim(size_t retain_bytes) {
+    struct chunk_record {
+        chunk_header* chunk;
+        size_t free_bytes;
+        bool in_use;        // 正在切分的chunk
+        bool release;
+    };
+
+    std::lock_guard<std::mutex> trim_lock(trim_mutex);
+    if constexpr (threads) {
+        for(size_t i = 0; i < NUM_OF_NODES; i++) {
+            release_to_central(i, cache.length[i]);
+        }
+        for(thread_heap* heap = heaps.load(std::memory_order_acquire); heap; heap = heap->next) {
+            for(size_t i = 0; i < NUM_OF_NODES; i++) {
+                drain_remote(*heap, i);
+            }
+        }
+    }
+
+    // 摘下中心空闲链表和chunk链表，记录正在切分的chunk，再等待在途访问结束
+    free_list_node* lists[NUM_OF_NODES];
+    for(size_t i = 0; i < NUM_OF_NODES; i++) {
+        lists[i] = free_serial[i].pop_all();
+    }
+    std::vector<chunk_record> records;
+    for(chunk_header* chunk = chunks.exchange(nullptr, std::memory_order_acquire); chunk; chunk = chunk->next) {
+        records.push_back({chunk, 0, false, false});
+    }
+    std::sort(records.begin(), records.end(), [](const chunk_record& a, const chunk_record& b) {
+        return a.chunk < b.chunk;
+    });
+    auto find_record = [&records](const void* ptr) -> chunk_record* {
+        auto it = std::upper_bound(records.begin(), records.end(), ptr, [](const void* p, const chunk_record& r) {
+            return p < (const void*)r.chunk;
+        });
+        if(it == records.begin() || ptr >= (const void*)(--it)->chunk->end) {
             return nullptr;
         }
+        return &*it;
+    };
+    auto mark_in_use = [&find_record](const thread_heap& heap) {
+        for(size_t i = 0; i <= NUM_OF_NODES; i++) {
+            chunk_header* chunk = (i == NUM_OF_NODES ? heap.current : heap.spans[i]).load(std::memory_order_acquire);
+            if(chunk_record* record = chunk ? find_record(chunk) : nullptr) {
+                record->in_use = true;
+            }
+        }
+    };
+    mark_in_use(shared_heap);
+    for(thread_heap* heap = heaps.load(std::memory_order_acquire); heap; heap = heap->next) {
+        mark_in_use(*heap);
+    }
+    if constexpr (threads) {
+        wait_central_quiescent();
+    }
 
-        entity.set_pool_size(entity.get_pool_size() + bytes_to_get);
-        entity.set_end(entity.get_start() + bytes_to_get);
-        return chunk_alloc(node_size, nodes);
+    // 统计空闲字节，挑出完全空闲的chunk
+    for(size_t i = 0; i < NUM_OF_NODES; i++) {
+        for(free_list_node* node = lists[i]; node; node = node->block) {
+            if(chunk_record* record = find_record(node)) {
+                record->free_bytes += size_class::class_size(i);
+            }
+        }
+    }
+    size_t retained = 0;
+    size_t released = 0;
+    for(chunk_record& record : records) {
+        chunk_header* chunk = record.chunk;
+        size_t unused = record.free_bytes + (chunk->end - chunk->start.load(std::memory_order_relaxed))
+                      + chunk->waste.load(std::memory_order_relaxed);
+        if(record.in_use || unused != chunk->size - CHUNK_HEADER_SIZE) {
+            continue;
+        }
+        if(retained + chunk->size <= retain_bytes) {
+            retained += chunk->size;
+            continue;
+        }
+        record.release = true;
+        released += chunk->size;
     }
+
+    // 节点挂回空闲链表，保留的chunk挂回chunk链表
+    for(size_t i = 0; i < NUM_OF_NODES; i++) {
+        free_list_node* head = nullptr;
+        free_list_node* tail = nullptr;
+        int64_t removed = 0;
+        for(free_list_node* node = lists[i], *next; node; node = next) {
+            next = node->block;
+            chunk_record* record = find_record(node);
+            if(record && record->release) {
+                removed++;
+                continue;
+            }
+            node->block = head;
+            head = node;
+            if(tail == nullptr) {
+                tail = node;
+            }
+        }
+        if(head) {
+            free_serial[i].push_chain(head, tail);
+        }
+        count_carved(i, -removed);
+    }
+    for(chunk_record& record : records) {
+        chunk_header* chunk = record.chunk;
+        if(record.release) {
+            free_chunk(chunk);
+            continue;
+        }
+        chunk->next = chunks.load(std::memory_order_relaxed);
+        while(!chunks.compare_exchange_weak(chunk->next, chunk, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+    pool_size.fetch_sub(released, std::memory_order_relaxed);
+    released_bytes_total.fetch_add(released, std::memory_order_relaxed);
+#if defined(__GLIBC__)
+    // glibc不会主动把堆中间的空闲页还给系统，free之后需要malloc_trim；mmap来源已由munmap归还
+    if(PageSource::USES_HEAP && released > 0) {
+        malloc_trim(0);
+    }
+#endif
+    return released;
 }
 
-} // namespace Cat
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::fork_prepare() noexcept {
+    scavenger_mutex.lock();
+    trim_mutex.lock();
+    stats_mutex.lock();
+}
+
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::fork_parent() noexcept {
+    stats_mutex.unlock();
+    trim_mutex.unlock();
+    scavenger_mutex.unlock();
+}
+
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::fork_child() noexcept {
+    central_users[0].store(0, std::memory_order_relaxed);
+    central_users[1].store(0, std::memory_order_relaxed);
+    if constexpr (threads) {
+        for(thread_heap* heap = heaps.load(std::memory_order_acquire); heap; heap = heap->next) {
+            if(heap != cache.heap) {
+                heap->active.store(false, std::memory_order_release);
+            }
+        }
+    }
+    if constexpr (STATS) {
+        // 已消失线程的计数器仍挂在统计链表中，摘下后不再合并(其计数随之丢失)
+        for(thread_stats** link = &stats_threads; *link;) {
+            if(*link != &local_stats) {
+                *link = (*link)->next;
+            }
+            else {
+                link = &(*link)->next;
+            }
+        }
+    }
+    // 后台回收线程没有被复制到子进程，丢弃其std::thread对象(不能join)
+    scavenger = nullptr;
+    stats_mutex.unlock();
+    trim_mutex.unlock();
+    scavenger_mutex.unlock();
+}
+
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::start_scavenger(std::chrono::milliseconds interval, size_t retain_bytes) {
+    static_assert(threads, "scavenger needs the thread-safe pool");
+    std::lock_guard<std::mutex> lock(scavenger_mutex);
+    if(scavenger) {
+        return;
+    }
+    if(!scavenger_registered) {
+        std::atexit(stop_scavenger);
+        scavenger_registered = true;
+    }
+    scavenger_stop = false;
+    scavenger = new std::thread([interval, retain_bytes] {
+        std::unique_lock<std::mutex> wait_lock(scavenger_mutex);
+        while(!scavenger_cv.wait_for(wait_lock, interval, [] { return scavenger_stop; })) {
+            wait_lock.unlock();
+            trim(retain_bytes);
+            wait_lock.lock();
+        }
+    });
+}
+
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::stop_scavenger() {
+    std::thread* worker;
+    {
+        std::lock_guard<std::mutex> lock(scavenger_mutex);
+        worker = scavenger;
+        scavenger = nullptr;
+        scavenger_stop = true;
+    }
+    scavenger_cv.notify_all();
+    if(worker) {
+        worker->join();
+        delete worker;
+    }
+}
+
+// 线程首次进入慢路径：注册cache_guard(线程退出时归还缓存)，设置缓存上限，挂入统计链表
+// 先置registered：注册thread_local析构函数时libc会申请内存，内存池替换了malloc时会重入这里
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::register_thread() noexcept {
+    thread_cache& local = cache;
+    local.registered = true;
+    static thread_local cache_guard guard;
+    (void)guard;
+    for(size_t i = 0; i < NUM_OF_NODES; i++) {
+        local.batch[i] = Refill::initial_batch(batch_nodes(i));
+        local.limit[i] = 2 * local.batch[i];
+    }
+    local.heap = acquire_heap();
+    if constexpr (STATS) {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        local_stats.next = stats_threads;
+        stats_threads = &local_stats;
+    }
+}
 
+// 线程退出：发布在用节点数，计数器并入global_stats并移出统计链表
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::retire_thread_stats() noexcept {
+    if constexpr (STATS) {
+        for(size_t i = 0; i < NUM_OF_NODES; i++) {
+            publish_live(i);
+        }
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        for(thread_stats** link = &stats_threads; *link; link = &(*link)->next) {
+            if(*link == &local_stats) {
+                *link = local_stats.next;
+                break;
+            }
+        }
+        for(size_t i = 0; i < NUM_OF_NODES; i++) {
+            global_stats.allocations[i].add(local_stats.allocations[i].load());
+            global_stats.frees[i].add(local_stats.frees[i].load());
+            global_stats.requested_allocated[i].add(local_stats.requested_allocated[i].load());
+            global_stats.requested_freed[i].add(local_stats.requested_freed[i].load());
+            global_stats.remote_frees[i].add(local_stats.remote_frees[i].load());
+        }
+        global_stats.large_allocations.add(local_stats.large_allocations.load());
+        global_stats.large_frees.add(local_stats.large_frees.load());
+        global_stats.large_allocated_bytes.add(local_stats.large_allocated_bytes.load());
+        global_stats.large_freed_bytes.add(local_stats.large_freed_bytes.load());
+    }
+}
+
+// 把本线程自上次发布以来的在用节点增量并入全局计数，顺带更新高水位
+template<bool threads, class PageSource, class Config>
+void alloc_pool<threads, PageSource, Config>::publish_live(size_t index) noexcept {
+    thread_stats& local = stats();
+    int64_t live = (int64_t)(local.allocations[index].load() - local.frees[index].load());
+    int64_t delta = live - local.published_live[index];
+    if(delta == 0) {
+        return;
+    }
+    local.published_live[index] = live;
+    int64_t total = class_stats[index].live_nodes.fetch_add(delta, std::memory_order_relaxed) + delta;
+    uint64_t bytes = total > 0 ? (uint64_t)total * size_class::class_size(index) : 0;
+    uint64_t high = class_stats[index].high_water_bytes.load(std::memory_order_relaxed);
+    while(bytes > high && !class_stats[index].high_water_bytes.compare_exchange_weak(high, bytes, std::memory_order_relaxed)) {
+    }
+}
+
+template<bool threads, class PageSource, class Config>
+pool_stats alloc_pool<threads, PageSource, Config>::get_stats() {
+    pool_stats result;
+    result.classes.resize(NUM_OF_NODES);
+    for(size_t i = 0; i < NUM_OF_NODES; i++) {
+        result.classes[i].node_size = size_class::class_size(i);
+    }
+    result.pool_bytes = get_pool_size();
+    if constexpr (!STATS) {
+        return result;
+    }
+
+    uint64_t requested_freed[NUM_OF_NODES] = {};
+    uint64_t remote_frees[NUM_OF_NODES] = {};
+    uint64_t large_freed_bytes = 0;
+    auto merge = [&](const thread_stats& block) {
+        for(size_t i = 0; i < NUM_OF_NODES; i++) {
+            result.classes[i].allocations += block.allocations[i].load();
+            result.classes[i].frees += block.frees[i].load();
+            result.classes[i].requested_bytes += block.requested_allocated[i].load();
+            requested_freed[i] += block.requested_freed[i].load();
+            remote_frees[i] += block.remote_frees[i].load();
+        }
+        result.large_allocations += block.large_allocations.load();
+        result.large_frees += block.large_frees.load();
+        result.large_total_bytes += block.large_allocated_bytes.load();
+        large_freed_bytes += block.large_freed_bytes.load();
+    };
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        merge(global_stats);
+        for(thread_stats* block = stats_threads; block; block = block->next) {
+            merge(*block);
+        }
+    }
+
+    // 各线程计数并非同一时刻读出，差值可能短暂为负，按0处理
+    auto difference = [](uint64_t a, uint64_t b) { return a > b ? a - b : 0; };
+    for(size_t i = 0; i < NUM_OF_NODES; i++) {
+        size_class_stats& row = result.classes[i];
+        uint64_t live_nodes = difference(row.allocations, row.frees);
+        int64_t carved = class_stats[i].carved_nodes.load(std::memory_order_relaxed);
+        row.live_bytes = live_nodes * row.node_size;
+        row.requested_bytes = difference(row.requested_bytes, requested_freed[i]);
+        if(row.requested_bytes > row.live_bytes) {
+            row.requested_bytes = row.live_bytes;
+        }
+        row.high_water_bytes = class_stats[i].high_water_bytes.load(std::memory_order_relaxed);
+        if(row.live_bytes > row.high_water_bytes) {
+            row.high_water_bytes = row.live_bytes;
+        }
+        row.free_nodes = difference(carved > 0 ? (uint64_t)carved : 0, live_nodes);
+        row.remote_frees = remote_frees[i];
+        row.refills = class_stats[i].refills.load(std::memory_order_relaxed);
+        row.chunk_allocs = class_stats[i].chunk_allocs.load(std::memory_order_relaxed);
+        row.system_bytes = class_stats[i].system_bytes.load(std::memory_order_relaxed);
+    }
+    result.large_live_bytes = difference(result.large_total_bytes, large_freed_bytes);
+    result.system_bytes = system_bytes_total.load(std::memory_order_relaxed);
+    result.released_bytes = released_bytes_total.load(std::memory_order_relaxed);
+    return result;
+}
+
+} // namespace Cat
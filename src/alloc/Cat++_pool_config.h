@@ -0,0 +1,43 @@
+#pragma once
+#include "Cat++_refill_policy.h"
+#include "Cat++_size_class.h"
+#include <cstddef>
+//内存池配置
+/*
+alloc_pool / pool_allocator的Config模板参数，集中原先写死在内存池中的常量：
+- Align / LinearBytes / MaxBytes / StepsPerDoubling：大小类表参数(见Cat++_size_class.h)，表在编译期生成，
+  最小分配单元、池化上限、级数都由它决定；内存池可满足的最大对齐取最大一级的节点对齐(不超过64)
+- RefillNodes：基准批量的节点数上限(大节点另按BATCH_BYTES折算)
+- Refill：refill策略(见Cat++_refill_policy.h)
+- Tag：区分参数相同的配置
+
+独立存储：alloc_pool的状态(中心空闲链表、chunk、线程缓存、线程堆、统计)都是静态成员，
+每种Config实例化出一个独立的内存池，不同子系统用不同的Config(或不同的Tag)即不共享空闲链表；
+多线程模式下每条中心空闲链表独占一个缓存行
+
+预置配置：
+- default_pool_config：8字节对齐，池化(0, 32K]
+- simd_pool_config：16字节对齐，所有节点至少按16字节对齐，适合SSE向量等需要16字节对齐的节点
+- tiny_pool_config：只池化8~32字节的小节点，只有4级且共用一个chunk，批量更大；超过32字节的请求走大块路径
+*/
+
+namespace Cat {
+
+template<size_t Align = 8, size_t LinearBytes = 128, size_t MaxBytes = 32 * 1024, size_t StepsPerDoubling = 8,
+         size_t RefillNodes = 20, class Refill = adaptive_refill, typename Tag = void>
+struct pool_config {
+    static_assert(RefillNodes >= 2, "a refill must move at least two nodes");
+
+    using size_class = size_class_table<Align, LinearBytes, MaxBytes, StepsPerDoubling>;
+    using refill = Refill;
+    using tag = Tag;
+
+    static constexpr size_t REFILL_NODES = RefillNodes;          // 基准批量的节点数上限
+    static constexpr size_t BATCH_BYTES = 64 * 1024;             // 基准批量的字节数上限
+};
+
+using default_pool_config = pool_config<>;
+using simd_pool_config = pool_config<16>;
+using tiny_pool_config = pool_config<8, 32, 32, 8, 64>;
+
+} // namespace Cat
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+//refill策略
+/*
+内存池向中心池/chunk要节点、向页来源要chunk时一次要多少，由alloc_pool的模板参数Refill决定：
+1）fixed_refill：固定批量，每级始终搬运base个节点；共用chunk按2倍需求 + pool_size / 16(封顶)追加，span固定为最小大小
+2）adaptive_refill(默认)：每级各自调整批量与chunk大小
+   - 批量从base / 4起步，每次refill翻倍(慢启动)，上限4 * base，持续有需求的热门级很快用大批量
+   - 线程缓存溢出(节点闲置)时减半，下限仍为起步值，冷门级只切出少量节点
+   - chunk大小：每级(共用chunk算作一级)记录上次申请的字节数，下一次翻倍直至上限；
+     向系统申请失败时减半重试(退避)，减到需求以下才放弃，之后从上次成功的大小继续增长
+
+接口(全部为静态函数)：
+- initial_batch(base) / max_batch(base)：起步批量与批量上限，base为该级的基准批量(见alloc_pool::batch_nodes)
+- on_refill(batch, base)：一次refill之后的批量
+- on_flush(batch, base)：线程缓存溢出之后的批量
+- next_chunk(last, minimum, limit, pool_size, shared)：下一个chunk的可切分字节数，last为该级上次申请的字节数(首次为0)，
+  返回值不小于minimum；limit为增长上限(minimum更大时以minimum为准)，shared表示线性级共用的chunk
+- backoff_chunk(failed, minimum)：申请failed字节失败后重试的字节数，小于minimum表示放弃
+批量以线程缓存为单位记录(单线程模式全局一份)，chunk大小以线程堆为单位记录(见Cat++_pool_alloc.h)
+*/
+
+namespace Cat {
+
+struct fixed_refill {
+    static constexpr size_t initial_batch(size_t base) { return base; }
+    static constexpr size_t max_batch(size_t base) { return base; }
+    static constexpr size_t on_refill(size_t, size_t base) { return base; }
+    static constexpr size_t on_flush(size_t, size_t base) { return base; }
+
+    // pool_size包含各span，追加量需封顶，避免大节点把小节点chunk撑大
+    static constexpr size_t next_chunk(size_t, size_t minimum, size_t limit, size_t pool_size, bool shared) {
+        size_t growth = pool_size >> 4;
+        return shared ? minimum + (growth > limit ? limit : growth) : minimum;
+    }
+    static constexpr size_t backoff_chunk(size_t, size_t) { return 0; }
+};
+
+struct adaptive_refill {
+    static constexpr size_t MIN_BATCH = 2;
+    static constexpr size_t BATCH_GROWTH = 4;        // 批量上限相对base的倍数
+
+    static constexpr size_t initial_batch(size_t base) { return base / 4 > MIN_BATCH ? base / 4 : MIN_BATCH; }
+    static constexpr size_t max_batch(size_t base) { return BATCH_GROWTH * base; }
+    static constexpr size_t on_refill(size_t batch, size_t base) {
+        return 2 * batch < max_batch(base) ? 2 * batch : max_batch(base);
+    }
+    static constexpr size_t on_flush(size_t batch, size_t base) {
+        return batch / 2 > initial_batch(base) ? batch / 2 : initial_batch(base);
+    }
+
+    static constexpr size_t next_chunk(size_t last, size_t minimum, size_t limit, size_t, bool) {
+        size_t bytes = 2 * last < limit ? 2 * last : limit;
+        return bytes > minimum ? bytes : minimum;
+    }
+    static constexpr size_t backoff_chunk(size_t failed, size_t) { return failed / 2; }
+};
+
+} // namespace Cat
@@ -0,0 +1,147 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+//大小类(size class)表
+/*
+分级大小类：
+1）线性段：(0, LinearBytes]按Align等距划分，8、16、24 ... 128，与SGI的16条空闲链表一致(跨多余缓存行的级除外，见下)
+2）几何段：(LinearBytes, MaxBytes]每翻一倍划分StepsPerDoubling级，
+   默认8级，相邻两级相差1/8，向上取整造成的内部碎片不超过12.5%
+   例：128之后依次为144、160 ... 256、288、320 ... 512、576 ... 32768
+整张表在编译期生成，index()只做一次比较和一次查表，没有循环和除法以外的分支
+*/
+
+/*
+对齐与缓存行：
+- 节点对齐node_align(i)：节点大小的最低位2的幂，不超过CACHE_LINE，例如24→8、48→16、96→32、192→64
+  内存池保证第i级节点的地址是node_align(i)的倍数
+- 不跨多余的缓存行：大小s >= CACHE_LINE的节点占用的缓存行数恰为ceil(s / CACHE_LINE)
+  节点起点在缓存行内的偏移是node_align的倍数，最坏偏移为CACHE_LINE - node_align，
+  因此要求 s % CACHE_LINE == 0 或 s % CACHE_LINE <= node_align，不满足的级(88、104、112、120、176、240)不生成，
+  这些请求落到上一级，内部碎片仍不超过25%
+- 带对齐要求的请求index(bytes, align)：取大小 >= bytes且node_align >= align的最小一级，align须 <= CACHE_LINE
+*/
+
+/*
+下标查表：
+- fine表：bytes <= FINE_LIMIT时，以Align为步长，fine[(bytes + Align - 1) / Align]即大小类下标
+- coarse表：bytes > FINE_LIMIT时，以COARSE_GRAIN为步长，coarse[(bytes + COARSE_GRAIN - 1) / COARSE_GRAIN]
+FINE_LIMIT之后几何段的级差都是COARSE_GRAIN的整数倍，因此按COARSE_GRAIN取整后查表结果是精确的
+*/
+
+namespace Cat {
+
+template<size_t Align = 8, size_t LinearBytes = 128, size_t MaxBytes = 32 * 1024, size_t StepsPerDoubling = 8>
+class size_class_table {
+    static_assert((Align & (Align - 1)) == 0 && Align >= sizeof(void*), "Align must be a power of two holding a pointer");
+    static_assert((LinearBytes & (LinearBytes - 1)) == 0 && LinearBytes % Align == 0, "LinearBytes must be a power of two multiple of Align");
+    static_assert(MaxBytes >= LinearBytes, "MaxBytes must not be below LinearBytes");
+    static_assert(MaxBytes == LinearBytes || LinearBytes / StepsPerDoubling >= Align, "geometric steps must not be finer than Align");
+
+public:
+    static constexpr size_t ALIGN = Align;
+    static constexpr size_t LINEAR_BYTES = LinearBytes;
+    static constexpr size_t MAX_BYTES = MaxBytes;
+    static constexpr size_t COARSE_GRAIN = LinearBytes;
+    static constexpr size_t FINE_LIMIT = COARSE_GRAIN * StepsPerDoubling < MaxBytes ? COARSE_GRAIN * StepsPerDoubling : MaxBytes;
+    static constexpr size_t CACHE_LINE = 64;
+
+private:
+    static constexpr size_t lowest_bit(size_t bytes) { return bytes & (~bytes + 1); }
+    static constexpr size_t align_of_size(size_t bytes) { return lowest_bit(bytes) < CACHE_LINE ? lowest_bit(bytes) : CACHE_LINE; }
+
+    // 大小为bytes的节点按align_of_size对齐后，是否只占用最少的缓存行
+    static constexpr bool fits_lines(size_t bytes) {
+        return bytes < CACHE_LINE || bytes % CACHE_LINE == 0 || bytes % CACHE_LINE <= align_of_size(bytes);
+    }
+
+    // 按生成规则依次产出每一级大小，返回级数；sizes为nullptr时只计数
+    static constexpr size_t generate(size_t* sizes) {
+        size_t count = 0;
+        for(size_t bytes = Align; bytes <= LinearBytes; bytes += Align) {
+            if(!fits_lines(bytes)) continue;
+            if(sizes) sizes[count] = bytes;
+            count++;
+        }
+        for(size_t base = LinearBytes; base < MaxBytes; base *= 2) {
+            size_t step = base / StepsPerDoubling;
+            for(size_t bytes = base + step; bytes <= base * 2 && bytes <= MaxBytes; bytes += step) {
+                if(!fits_lines(bytes)) continue;
+                if(sizes) sizes[count] = bytes;
+                count++;
+            }
+        }
+        return count;
+    }
+
+public:
+    static constexpr size_t NUM_CLASSES = generate(nullptr);
+    static_assert(NUM_CLASSES <= 256, "class index must fit in a byte");
+
+private:
+    struct tables {
+        size_t size[NUM_CLASSES] = {};
+        uint8_t fine[FINE_LIMIT / Align + 1] = {};
+        uint8_t coarse[MaxBytes / COARSE_GRAIN + 1] = {};
+    };
+
+    static constexpr tables make_tables() {
+        tables result;
+        generate(result.size);
+        size_t index = 0;
+        for(size_t slot = 0; slot <= FINE_LIMIT / Align; slot++) {
+            while(result.size[index] < slot * Align) index++;
+            result.fine[slot] = static_cast<uint8_t>(index);
+        }
+        index = 0;
+        for(size_t slot = 0; slot <= MaxBytes / COARSE_GRAIN; slot++) {
+            while(result.size[index] < slot * COARSE_GRAIN) index++;
+            result.coarse[slot] = static_cast<uint8_t>(index);
+        }
+        return result;
+    }
+
+    static constexpr tables table = make_tables();
+
+public:
+    // 大小类下标，bytes须 <= MAX_BYTES，bytes为0时按最小一级处理
+    static constexpr size_t index(size_t bytes) {
+        return bytes <= FINE_LIMIT ? table.fine[(bytes + Align - 1) / Align]
+                                   : table.coarse[(bytes + COARSE_GRAIN - 1) / COARSE_GRAIN];
+    }
+
+    // 带对齐要求的大小类下标，align须 <= CACHE_LINE
+    static constexpr size_t index(size_t bytes, size_t align) {
+        if(align <= Align) {
+            return index(bytes);
+        }
+        size_t result = index((bytes + align - 1) & ~(align - 1));
+        while(node_align(result) < align) {
+            result++;
+        }
+        return result;
+    }
+
+    // 第index级的节点大小
+    static constexpr size_t class_size(size_t index) { return table.size[index]; }
+
+    // 第index级的节点对齐
+    static constexpr size_t node_align(size_t index) { return align_of_size(class_size(index)); }
+
+    // 向上取整到所在大小类
+    static constexpr size_t round_up(size_t bytes) { return class_size(index(bytes)); }
+
+    // 不超过bytes的最大一级下标，bytes小于最小一级时返回NUM_CLASSES
+    static constexpr size_t floor_index(size_t bytes) {
+        if(bytes < Align) {
+            return NUM_CLASSES;
+        }
+        if(bytes >= MaxBytes) {
+            return NUM_CLASSES - 1;
+        }
+        size_t result = index(bytes);
+        return class_size(result) > bytes ? result - 1 : result;
+    }
+};
+
+} // namespace Cat
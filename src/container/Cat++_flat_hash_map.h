@@ -0,0 +1,764 @@
+#pragma once
+#include "../Cat++_config.h"
+#include "Cat++_vector.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+// 编译时定义CAT_HASH_SSE2=0可强制使用逐字节比较(测试用)
+#ifndef CAT_HASH_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CAT_HASH_SSE2 1
+#else
+#define CAT_HASH_SSE2 0
+#endif
+#endif
+#if CAT_HASH_SSE2
+#include <emmintrin.h>
+#endif
+//flat_hash_map
+/*
+开放寻址哈希表(SwissTable做法)，接口与std::unordered_map一致
+- 键值对连续存放在slot数组中，不再每个元素一个节点
+- 每个slot对应一个控制字节：EMPTY(空)、DELETED(墓碑)或FULL(最高位为0，低7位为哈希值的高7位h2)
+- 控制字节16个一组，按组探测：一次SSE2比较得到组内16个h2的匹配位图，只有h2相同的slot才比较键
+  控制字节数组按16字节对齐，一组不跨cache line；命中时通常只访问控制字节与目标slot两条cache line
+- 组按二次探测(步长1,2,3...)遍历，组内出现EMPTY即可停止；最大负载7/8
+- 没有SSE2时退化为逐字节比较
+
+扩容(reserve/rehash/插入时负载已满)：
+1）元素可平凡重定位且分配器提供reallocate时，slot数组直接reallocate到新容量(常可原地扩展)，
+   然后在新数组内原地重排(把需要移动的元素交换到新位置)，不申请第二个slot数组
+2）其他情况申请新数组，逐个移动构造后释放旧数组
+墓碑过多(元素数不超过容量的25/32)时不扩容，只在原容量内清除墓碑：
+元素可平凡重定位或移动不抛异常时原地重排(逐字节复制或移动构造)，否则逐个移动到同样大小的新数组
+
+Hash与KeyEqual都带is_transparent时，find/contains/count/erase接受与键可比较的任意类型
+分配器返回nullptr时抛出OutOfMemoryException
+*/
+
+namespace Cat {
+
+// 一组控制字节
+struct probe_group {
+    using ctrl_t = signed char;
+
+    static constexpr size_t WIDTH = 16;                      // 一组的控制字节数
+    static constexpr ctrl_t EMPTY = -128;                    // 空slot：0b10000000
+    static constexpr ctrl_t DELETED = -2;                    // 墓碑：0b11111110
+    static constexpr ctrl_t SENTINEL = -1;                   // 数组末尾哨兵，供迭代器停止：0b11111111
+
+#if CAT_HASH_SSE2
+    __m128i bytes;
+
+    explicit probe_group(const ctrl_t* ctrl) noexcept : bytes(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+    // 等于h2的控制字节位图
+    uint32_t match(ctrl_t h2) const noexcept {
+        return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), bytes));
+    }
+    // EMPTY与DELETED最高位为1，FULL最高位为0
+    uint32_t match_free() const noexcept {
+        return (uint32_t)_mm_movemask_epi8(bytes);
+    }
+#else
+    ctrl_t bytes[WIDTH];
+
+    explicit probe_group(const ctrl_t* ctrl) noexcept { memcpy(bytes, ctrl, WIDTH); }
+
+    uint32_t match(ctrl_t h2) const noexcept {
+        uint32_t mask = 0;
+        for(size_t i = 0; i < WIDTH; i++) {
+            mask |= uint32_t(bytes[i] == h2) << i;
+        }
+        return mask;
+    }
+    uint32_t match_free() const noexcept {
+        uint32_t mask = 0;
+        for(size_t i = 0; i < WIDTH; i++) {
+            mask |= uint32_t(bytes[i] < 0) << i;
+        }
+        return mask;
+    }
+#endif
+
+    uint32_t match_empty() const noexcept { return match(EMPTY); }
+};
+
+template<typename Value, bool Const>
+class flat_hash_iterator {
+private:
+    template<typename, typename, typename, typename, typename>
+    friend class flat_hash_map;
+    template<typename, bool>
+    friend class flat_hash_iterator;
+
+    using ctrl_t = probe_group::ctrl_t;
+
+    const ctrl_t* ctrl = nullptr;
+    Value* slot = nullptr;
+
+    flat_hash_iterator(const ctrl_t* c, Value* s) noexcept : ctrl(c), slot(s) {}
+
+    // 跳过EMPTY与DELETED，停在FULL或SENTINEL
+    void skip_free() noexcept {
+        while(*ctrl < probe_group::SENTINEL) {
+            ++ctrl;
+            ++slot;
+        }
+    }
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Value;
+    using difference_type = ptrdiff_t;
+    using pointer = std::conditional_t<Const, const Value*, Value*>;
+    using reference = std::conditional_t<Const, const Value&, Value&>;
+
+    flat_hash_iterator() noexcept = default;
+    template<bool OtherConst> requires (Const && !OtherConst)
+    flat_hash_iterator(const flat_hash_iterator<Value, OtherConst>& other) noexcept : ctrl(other.ctrl), slot(other.slot) {}
+
+    reference operator*() const noexcept { return *slot; }
+    pointer operator->() const noexcept { return slot; }
+
+    flat_hash_iterator& operator++() noexcept {
+        ++ctrl;
+        ++slot;
+        skip_free();
+        return *this;
+    }
+    flat_hash_iterator operator++(int) noexcept { flat_hash_iterator old = *this; ++*this; return old; }
+
+    template<bool OtherConst>
+    bool operator==(const flat_hash_iterator<Value, OtherConst>& other) const noexcept { return ctrl == other.ctrl; }
+};
+
+template<typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>,
+         typename Alloc = alloc_t<std::pair<const Key, T>>>
+class flat_hash_map {
+public:
+    typedef Key                                     key_type;
+    typedef T                                       mapped_type;
+    typedef std::pair<const Key, T>                 value_type;
+    typedef size_t                                  size_type;
+    typedef ptrdiff_t                               difference_type;
+    typedef Hash                                    hasher;
+    typedef KeyEqual                                key_equal;
+    typedef Alloc                                   allocator_type;
+    typedef value_type&                             reference;
+    typedef const value_type&                       const_reference;
+    typedef flat_hash_iterator<value_type, false>   iterator;
+    typedef flat_hash_iterator<value_type, true>    const_iterator;
+
+private:
+    using ctrl_t = probe_group::ctrl_t;
+    using slot_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<value_type>;
+    using slot_traits = std::allocator_traits<slot_alloc>;
+    using ctrl_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<ctrl_t>;
+
+    static constexpr size_t GROUP = probe_group::WIDTH;
+
+    // 扩容时能否reallocate slot数组并原地重排
+    static constexpr bool RELOCATE_BY_REALLOC = is_trivially_relocatable_v<value_type> && reallocating_allocator<slot_alloc>;
+    // 清除墓碑时能否原地重排：搬动元素不能抛异常(std::string作键时pair<const Key, T>的移动会复制键，可能抛异常)
+    static constexpr bool IN_PLACE_REHASH = is_trivially_relocatable_v<value_type> || std::is_nothrow_move_constructible_v<value_type>;
+    // 分配器能否按指定对齐申请控制字节数组(std::allocator由operator new保证16字节对齐)
+    static constexpr bool ALIGNED_ALLOC = requires(ctrl_alloc a, ctrl_t* p, size_t n) {
+        a.allocate(n, n);
+        a.deallocate(p, n, n);
+    };
+    static constexpr bool TRANSPARENT = requires {
+        typename Hash::is_transparent;
+        typename KeyEqual::is_transparent;
+    };
+
+    // 容量为0时ctrl指向它，使begin() == end()且迭代器不必判空
+    static constexpr ctrl_t EMPTY_TABLE[1] = {probe_group::SENTINEL};
+
+    ctrl_t* ctrl = const_cast<ctrl_t*>(EMPTY_TABLE);         // capacity个控制字节 + SENTINEL
+    value_type* slots = nullptr;                             // capacity个slot
+    size_t slot_count = 0;                                   // 容量：0或16的2的幂倍
+    size_t element_count = 0;                                // 元素个数
+    size_t growth_left = 0;                                  // 负载达到7/8之前还能占用的EMPTY slot数
+    [[no_unique_address]] Hash hash_fn;
+    [[no_unique_address]] KeyEqual equal_fn;
+    [[no_unique_address]] slot_alloc alloc;
+
+public:
+    // 构造函数和析构函数
+    flat_hash_map() = default;
+    explicit flat_hash_map(size_t bucket_count, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual(),
+                           const Alloc& a = Alloc())
+        : hash_fn(hash), equal_fn(equal), alloc(a) {
+        reserve(bucket_count);
+    }
+    explicit flat_hash_map(const Alloc& a) : alloc(a) {}
+    template<std::input_iterator InputIt>
+    flat_hash_map(InputIt first, InputIt last, size_t bucket_count = 0, const Hash& hash = Hash(),
+                  const KeyEqual& equal = KeyEqual(), const Alloc& a = Alloc())
+        : flat_hash_map(bucket_count, hash, equal, a) {
+        insert(first, last);
+    }
+    flat_hash_map(std::initializer_list<value_type> init, size_t bucket_count = 0, const Hash& hash = Hash(),
+                  const KeyEqual& equal = KeyEqual(), const Alloc& a = Alloc())
+        : flat_hash_map(init.begin(), init.end(), bucket_count, hash, equal, a) {}
+    flat_hash_map(const flat_hash_map& other)
+        : hash_fn(other.hash_fn), equal_fn(other.equal_fn),
+          alloc(slot_traits::select_on_container_copy_construction(other.alloc)) {
+        try {
+            reserve(other.element_count);
+            for(const value_type& value : other) {
+                emplace_new(hash_of(value.first), value);
+            }
+        } catch (...) {
+            destroy();
+            throw;
+        }
+    }
+    flat_hash_map(flat_hash_map&& other) noexcept
+        : ctrl(other.ctrl), slots(other.slots), slot_count(other.slot_count), element_count(other.element_count),
+          growth_left(other.growth_left), hash_fn(std::move(other.hash_fn)), equal_fn(std::move(other.equal_fn)),
+          alloc(std::move(other.alloc)) {
+        other.reset_empty();
+    }
+    ~flat_hash_map() {
+        destroy();
+    }
+
+    flat_hash_map& operator=(const flat_hash_map& other) {
+        if(this != &other) {
+            flat_hash_map copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+    flat_hash_map& operator=(flat_hash_map&& other) noexcept {
+        if(this != &other) {
+            destroy();
+            reset_empty();
+            swap(other);
+        }
+        return *this;
+    }
+    flat_hash_map& operator=(std::initializer_list<value_type> init) {
+        clear();
+        insert(init.begin(), init.end());
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return Alloc(alloc); }
+    hasher hash_function() const { return hash_fn; }
+    key_equal key_eq() const { return equal_fn; }
+
+    // 迭代器
+    iterator begin() noexcept {
+        iterator it(ctrl, slots);
+        it.skip_free();
+        return it;
+    }
+    const_iterator begin() const noexcept { return const_cast<flat_hash_map*>(this)->begin(); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    iterator end() noexcept { return iterator(ctrl + slot_count, slots + slot_count); }
+    const_iterator end() const noexcept { return const_cast<flat_hash_map*>(this)->end(); }
+    const_iterator cend() const noexcept { return end(); }
+
+    // 容量
+    bool empty() const noexcept { return element_count == 0; }
+    size_t size() const noexcept { return element_count; }
+    size_t max_size() const noexcept { return slot_traits::max_size(alloc) / 2; }
+    size_t bucket_count() const noexcept { return slot_count; }
+    float load_factor() const noexcept { return slot_count ? float(element_count) / float(slot_count) : 0.0f; }
+    float max_load_factor() const noexcept { return 0.875f; }
+
+    // 保证插入n个元素前不再扩容
+    void reserve(size_t n) {
+        size_t need = capacity_for(n);
+        if(need > slot_count) {
+            resize(need);
+        }
+    }
+
+    // 容量调整为不小于n且能容纳当前元素的最小值，同时清除墓碑；n与元素数都为0时释放全部内存
+    void rehash(size_t n) {
+        if(n == 0 && element_count == 0) {
+            destroy();
+            reset_empty();
+            return;
+        }
+        size_t need = std::max(capacity_for(element_count), n <= GROUP ? GROUP : std::bit_ceil(n));
+        resize(need);
+    }
+
+    // 修改
+    void clear() noexcept {
+        if(slot_count == 0) {
+            return;
+        }
+        destroy_elements();
+        memset(ctrl, probe_group::EMPTY, slot_count);
+        element_count = 0;
+        growth_left = max_load(slot_count);
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return try_emplace_impl(value.first, value); }
+    std::pair<iterator, bool> insert(value_type&& value) { return try_emplace_impl(value.first, std::move(value)); }
+    template<typename P> requires std::is_constructible_v<value_type, P&&>
+    std::pair<iterator, bool> insert(P&& value) { return emplace(std::forward<P>(value)); }
+    iterator insert(const_iterator, const value_type& value) { return insert(value).first; }
+    iterator insert(const_iterator, value_type&& value) { return insert(std::move(value)).first; }
+    template<std::input_iterator InputIt>
+    void insert(InputIt first, InputIt last) {
+        if constexpr (std::forward_iterator<InputIt>) {
+            reserve(element_count + std::distance(first, last));
+        }
+        for(; first != last; ++first) {
+            insert(*first);
+        }
+    }
+    void insert(std::initializer_list<value_type> init) { insert(init.begin(), init.end()); }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj) {
+        auto result = try_emplace(key, std::forward<M>(obj));
+        if(!result.second) {
+            result.first->second = std::forward<M>(obj);
+        }
+        return result;
+    }
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj) {
+        auto result = try_emplace(std::move(key), std::forward<M>(obj));
+        if(!result.second) {
+            result.first->second = std::forward<M>(obj);
+        }
+        return result;
+    }
+
+    // 键已存在时不构造值
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        return try_emplace_impl(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        return try_emplace_impl(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    // 先在栈上构造出键值再查找，键已存在时丢弃
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) {
+        std::pair<Key, T> temp(std::forward<Args>(args)...);
+        return try_emplace_impl(temp.first, std::move(temp.first), std::move(temp.second));
+    }
+    template<typename... Args>
+    iterator emplace_hint(const_iterator, Args&&... args) { return emplace(std::forward<Args>(args)...).first; }
+
+    iterator erase(iterator pos) noexcept {
+        erase_at(pos.slot - slots);
+        ++pos;
+        return pos;
+    }
+    iterator erase(const_iterator pos) noexcept { return erase(iterator(pos.ctrl, pos.slot)); }
+    iterator erase(const_iterator first, const_iterator last) noexcept {
+        while(first != last) {
+            first = erase(first);
+        }
+        return iterator(last.ctrl, last.slot);
+    }
+    size_t erase(const Key& key) { return erase_key(key); }
+    template<typename K> requires TRANSPARENT
+    size_t erase(const K& key) { return erase_key(key); }
+
+    void swap(flat_hash_map& other) noexcept {
+        using std::swap;
+        swap(ctrl, other.ctrl);
+        swap(slots, other.slots);
+        swap(slot_count, other.slot_count);
+        swap(element_count, other.element_count);
+        swap(growth_left, other.growth_left);
+        swap(hash_fn, other.hash_fn);
+        swap(equal_fn, other.equal_fn);
+        swap(alloc, other.alloc);
+    }
+
+    // 元素访问
+    T& at(const Key& key) {
+        iterator it = find(key);
+        if(it == end()) {
+            throw std::out_of_range("Cat::flat_hash_map::at");
+        }
+        return it->second;
+    }
+    const T& at(const Key& key) const {
+        const_iterator it = find(key);
+        if(it == end()) {
+            throw std::out_of_range("Cat::flat_hash_map::at");
+        }
+        return it->second;
+    }
+    T& operator[](const Key& key) { return try_emplace(key).first->second; }
+    T& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+
+    // 查找
+    iterator find(const Key& key) { return iterator_at(find_index(key, hash_of(key))); }
+    const_iterator find(const Key& key) const { return const_cast<flat_hash_map*>(this)->find(key); }
+    template<typename K> requires TRANSPARENT
+    iterator find(const K& key) { return iterator_at(find_index(key, hash_of(key))); }
+    template<typename K> requires TRANSPARENT
+    const_iterator find(const K& key) const { return const_cast<flat_hash_map*>(this)->find(key); }
+
+    bool contains(const Key& key) const { return find(key) != end(); }
+    template<typename K> requires TRANSPARENT
+    bool contains(const K& key) const { return find(key) != end(); }
+    size_t count(const Key& key) const { return contains(key) ? 1 : 0; }
+    template<typename K> requires TRANSPARENT
+    size_t count(const K& key) const { return contains(key) ? 1 : 0; }
+
+    std::pair<iterator, iterator> equal_range(const Key& key) {
+        iterator it = find(key);
+        return {it, it == end() ? it : std::next(it)};
+    }
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+        const_iterator it = find(key);
+        return {it, it == end() ? it : std::next(it)};
+    }
+
+private:
+    static size_t max_load(size_t capacity) noexcept { return capacity - capacity / 8; }
+
+    // 负载不超过7/8时容纳n个元素所需的最小容量
+    static size_t capacity_for(size_t n) noexcept {
+        if(n == 0) {
+            return 0;
+        }
+        size_t need = n + (n + 6) / 7;
+        return need <= GROUP ? GROUP : std::bit_ceil(need);
+    }
+
+    // std::hash对整数是恒等映射，乘法后高低位折叠，让低位(组下标)与高7位(h2)都受全部输入位影响
+    template<typename K>
+    size_t hash_of(const K& key) const {
+        uint64_t h = (uint64_t)hash_fn(key) * 0x9E3779B97F4A7C15ull;
+        return (size_t)(h ^ (h >> 32));
+    }
+    static ctrl_t h2(size_t hash) noexcept { return ctrl_t(hash >> (sizeof(size_t) * 8 - 7)); }
+
+    size_t group_mask() const noexcept { return slot_count / GROUP - 1; }
+
+    iterator iterator_at(size_t index) noexcept { return iterator(ctrl + index, slots + index); }
+
+    // 返回键所在slot的下标，不存在时返回slot_count
+    template<typename K>
+    size_t find_index(const K& key, size_t hash) const {
+        if(slot_count == 0) {
+            return 0;
+        }
+        size_t mask = group_mask();
+        size_t group = hash & mask;
+        ctrl_t tag = h2(hash);
+        for(size_t step = 1;; step++) {
+            size_t base = group * GROUP;
+            probe_group bytes(ctrl + base);
+            for(uint32_t match = bytes.match(tag); match; match &= match - 1) {
+                size_t index = base + std::countr_zero(match);
+                if(equal_fn(slots[index].first, key)) {
+                    return index;
+                }
+            }
+            if(bytes.match_empty()) {
+                return slot_count;
+            }
+            group = (group + step) & mask;
+        }
+    }
+
+    // 探测序列上第一个EMPTY或DELETED的slot
+    size_t find_free(size_t hash) const noexcept {
+        size_t mask = group_mask();
+        size_t group = hash & mask;
+        for(size_t step = 1;; step++) {
+            uint32_t match = probe_group(ctrl + group * GROUP).match_free();
+            if(match) {
+                return group * GROUP + std::countr_zero(match);
+            }
+            group = (group + step) & mask;
+        }
+    }
+
+    // 为新元素占一个slot并写入控制字节，负载已满时先扩容或清除墓碑
+    size_t prepare_insert(size_t hash) {
+        size_t index = slot_count ? find_free(hash) : 0;
+        if(growth_left == 0 && (slot_count == 0 || ctrl[index] != probe_group::DELETED)) {
+            rehash_and_grow();
+            index = find_free(hash);
+        }
+        growth_left -= ctrl[index] == probe_group::EMPTY;
+        ctrl[index] = h2(hash);
+        element_count++;
+        return index;
+    }
+
+    template<typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace_impl(const K& key, Args&&... args) {
+        size_t hash = hash_of(key);
+        size_t index = find_index(key, hash);
+        if(index != slot_count) {
+            return {iterator_at(index), false};
+        }
+        return {iterator_at(emplace_new(hash, std::forward<Args>(args)...)), true};
+    }
+
+    // 插入已知不存在的键，构造失败时撤销占位
+    template<typename... Args>
+    size_t emplace_new(size_t hash, Args&&... args) {
+        size_t index = prepare_insert(hash);
+        try {
+            ::new((void*)(slots + index)) value_type(std::forward<Args>(args)...);
+        } catch (...) {
+            release_slot(index);
+            throw;
+        }
+        return index;
+    }
+
+    template<typename K>
+    size_t erase_key(const K& key) {
+        size_t index = find_index(key, hash_of(key));
+        if(index == slot_count) {
+            return 0;
+        }
+        erase_at(index);
+        return 1;
+    }
+
+    void erase_at(size_t index) noexcept {
+        slots[index].~value_type();
+        release_slot(index);
+    }
+
+    // 所在组有EMPTY时，任何探测都会停在这一组，可以直接置EMPTY；否则留下墓碑以免截断探测序列
+    void release_slot(size_t index) noexcept {
+        element_count--;
+        if(probe_group(ctrl + (index & ~(GROUP - 1))).match_empty()) {
+            ctrl[index] = probe_group::EMPTY;
+            growth_left++;
+        }
+        else {
+            ctrl[index] = probe_group::DELETED;
+        }
+    }
+
+    // 负载已满：墓碑过多时按原容量重排，否则容量翻倍
+    void rehash_and_grow() {
+        if(slot_count > 0 && element_count * 32 <= slot_count * 25) {
+            if constexpr (IN_PLACE_REHASH) {
+                ctrl_t* end_ctrl = ctrl + slot_count;
+                for(ctrl_t* c = ctrl; c != end_ctrl; ++c) {
+                    *c = *c >= 0 ? probe_group::DELETED : probe_group::EMPTY;
+                }
+                rehash_marked();
+            }
+            else {
+                resize(slot_count);                          // 移动可能抛异常，逐个移动到同样大小的新数组
+            }
+            return;
+        }
+        resize(slot_count ? slot_count * 2 : GROUP);
+    }
+
+    void resize(size_t new_count) {
+        if constexpr (RELOCATE_BY_REALLOC) {
+            if(slot_count > 0 && new_count > slot_count) {
+                grow_in_place(new_count);
+                return;
+            }
+        }
+        ctrl_t* new_ctrl = allocate_ctrl(new_count);
+        value_type* new_slots;
+        try {
+            new_slots = allocate_slots(new_count);
+        } catch (...) {
+            deallocate_ctrl(new_ctrl, new_count);
+            throw;
+        }
+        ctrl_t* old_ctrl = ctrl;
+        value_type* old_slots = slots;
+        size_t old_count = slot_count;
+        ctrl = new_ctrl;
+        slots = new_slots;
+        slot_count = new_count;
+        for(size_t i = 0; i < old_count; i++) {
+            if(old_ctrl[i] >= 0) {
+                size_t hash = hash_of(old_slots[i].first);
+                size_t index = find_free(hash);
+                ctrl[index] = h2(hash);
+                ::new((void*)(slots + index)) value_type(std::move(old_slots[i]));
+                old_slots[i].~value_type();
+            }
+        }
+        growth_left = max_load(slot_count) - element_count;
+        if(old_count > 0) {
+            deallocate_ctrl(old_ctrl, old_count);
+            alloc.deallocate(old_slots, old_count);
+        }
+    }
+
+    // slot数组reallocate到新容量，原有元素留在前old个slot，标记为DELETED(待重排)后原地重排
+    void grow_in_place(size_t new_count) {
+        ctrl_t* new_ctrl = allocate_ctrl(new_count);
+        value_type* new_slots = alloc.reallocate(slots, slot_count, new_count);
+        if(new_slots == nullptr) {
+            deallocate_ctrl(new_ctrl, new_count);
+            throw OutOfMemoryException();
+        }
+        for(size_t i = 0; i < slot_count; i++) {
+            new_ctrl[i] = ctrl[i] >= 0 ? probe_group::DELETED : probe_group::EMPTY;
+        }
+        deallocate_ctrl(ctrl, slot_count);
+        ctrl = new_ctrl;
+        slots = new_slots;
+        slot_count = new_count;
+        rehash_marked();
+    }
+
+    // 原地重排所有标记为DELETED的元素(SwissTable的drop_deletes做法)：
+    // 目标位置与当前位置在同一组时不动；目标为EMPTY时搬过去；目标为待重排元素时两者交换，再处理换来的元素
+    void rehash_marked() noexcept {
+        alignas(value_type) unsigned char buffer[sizeof(value_type)];
+        value_type* temp = reinterpret_cast<value_type*>(buffer);
+        for(size_t i = 0; i < slot_count; i++) {
+            if(ctrl[i] != probe_group::DELETED) {
+                continue;
+            }
+            size_t hash = hash_of(slots[i].first);
+            size_t target = find_free(hash);
+            if(target / GROUP == i / GROUP) {
+                ctrl[i] = h2(hash);
+                continue;
+            }
+            if(ctrl[target] == probe_group::EMPTY) {
+                ctrl[target] = h2(hash);
+                relocate_slot(slots + target, slots + i);
+                ctrl[i] = probe_group::EMPTY;
+            }
+            else {
+                ctrl[target] = h2(hash);
+                relocate_slot(temp, slots + i);
+                relocate_slot(slots + i, slots + target);
+                relocate_slot(slots + target, temp);
+                --i;
+            }
+        }
+        growth_left = max_load(slot_count) - element_count;
+    }
+
+    // 把src处的元素搬到未构造的dst：可平凡重定位时逐字节复制，否则移动构造后析构src
+    static void relocate_slot(value_type* dst, value_type* src) noexcept {
+        if constexpr (is_trivially_relocatable_v<value_type>) {
+            memcpy((void*)dst, (const void*)src, sizeof(value_type));
+        }
+        else {
+            ::new((void*)dst) value_type(std::move(*src));
+            src->~value_type();
+        }
+    }
+
+    // 控制字节数组：slot_count个EMPTY + SENTINEL，按组宽对齐
+    ctrl_t* allocate_ctrl(size_t n) {
+        ctrl_alloc bytes(alloc);
+        ctrl_t* result;
+        if constexpr (ALIGNED_ALLOC) {
+            result = bytes.allocate(n + 1, GROUP);
+        }
+        else {
+            result = bytes.allocate(n + 1);
+        }
+        if(result == nullptr) {
+            throw OutOfMemoryException();
+        }
+        memset(result, probe_group::EMPTY, n);
+        result[n] = probe_group::SENTINEL;
+        return result;
+    }
+
+    void deallocate_ctrl(ctrl_t* p, size_t n) noexcept {
+        ctrl_alloc bytes(alloc);
+        if constexpr (ALIGNED_ALLOC) {
+            bytes.deallocate(p, n + 1, GROUP);
+        }
+        else {
+            bytes.deallocate(p, n + 1);
+        }
+    }
+
+    value_type* allocate_slots(size_t n) {
+        value_type* result = slot_traits::allocate(alloc, n);
+        if(result == nullptr) {
+            throw OutOfMemoryException();
+        }
+        return result;
+    }
+
+    void destroy_elements() noexcept {
+        if constexpr (!std::is_trivially_destructible_v<value_type>) {
+            for(size_t i = 0; i < slot_count; i++) {
+                if(ctrl[i] >= 0) {
+                    slots[i].~value_type();
+                }
+            }
+        }
+    }
+
+    void destroy() noexcept {
+        if(slot_count > 0) {
+            destroy_elements();
+            deallocate_ctrl(ctrl, slot_count);
+            alloc.deallocate(slots, slot_count);
+        }
+    }
+
+    void reset_empty() noexcept {
+        ctrl = const_cast<ctrl_t*>(EMPTY_TABLE);
+        slots = nullptr;
+        slot_count = 0;
+        element_count = 0;
+        growth_left = 0;
+    }
+};
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Alloc>
+bool operator==(const flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& a, const flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& b) {
+    if(a.size() != b.size()) {
+        return false;
+    }
+    for(const auto& value : a) {
+        auto it = b.find(value.first);
+        if(it == b.end() || !(it->second == value.second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Alloc>
+bool operator!=(const flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& a, const flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& b) {
+    return !(a == b);
+}
+
+template<typename Key, typename T, typename Hash, typename KeyEqual, typename Alloc>
+void swap(flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& a, flat_hash_map<Key, T, Hash, KeyEqual, Alloc>& b) noexcept {
+    a.swap(b);
+}
+
+} // namespace Cat
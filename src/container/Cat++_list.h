@@ -0,0 +1,588 @@
+#pragma once
+#include "../Cat++_config.h"
+#include "Cat++_node_cache.h"
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+//list
+/*
+带哨兵节点的环形双向链表，接口与std::list一致
+- 节点经allocator_traits::rebind_alloc从分配器申请，配合pool_allocator时节点来自内存池
+- 删除的节点进入容器自带的节点缓存(见Cat++_node_cache.h)，clear后再插入不访问分配器
+- splice/merge/sort只改指针，不申请也不释放节点；两个链表的分配器须相等
+哨兵节点是容器对象的成员，移动/交换容器时需要修正首尾节点指向哨兵的指针
+*/
+
+namespace Cat {
+
+struct list_node_base {
+    list_node_base* prev;
+    list_node_base* next;
+
+    // 把[first, last)从原位置摘下，插到this之前
+    void transfer(list_node_base* first, list_node_base* last) noexcept {
+        if(this == last) {
+            return;
+        }
+        last->prev->next = this;
+        first->prev->next = last;
+        prev->next = first;
+        list_node_base* old_prev = prev;
+        prev = last->prev;
+        last->prev = first->prev;
+        first->prev = old_prev;
+    }
+};
+
+template<typename T>
+struct list_node : list_node_base {
+    T value;
+};
+
+template<typename T, bool Const>
+class list_iterator {
+private:
+    template<typename, typename>
+    friend class list;
+    template<typename, bool>
+    friend class list_iterator;
+
+    using node_base = list_node_base;
+    node_base* node = nullptr;
+
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T*, T*>;
+    using reference = std::conditional_t<Const, const T&, T&>;
+
+    list_iterator() noexcept = default;
+    explicit list_iterator(const node_base* target) noexcept : node(const_cast<node_base*>(target)) {}
+    // iterator可隐式转换为const_iterator
+    template<bool OtherConst> requires (Const && !OtherConst)
+    list_iterator(const list_iterator<T, OtherConst>& other) noexcept : node(other.node) {}
+
+    reference operator*() const noexcept { return static_cast<list_node<T>*>(node)->value; }
+    pointer operator->() const noexcept { return &static_cast<list_node<T>*>(node)->value; }
+
+    list_iterator& operator++() noexcept { node = node->next; return *this; }
+    list_iterator operator++(int) noexcept { list_iterator old = *this; node = node->next; return old; }
+    list_iterator& operator--() noexcept { node = node->prev; return *this; }
+    list_iterator operator--(int) noexcept { list_iterator old = *this; node = node->prev; return old; }
+
+    template<bool OtherConst>
+    bool operator==(const list_iterator<T, OtherConst>& other) const noexcept { return node == other.node; }
+};
+
+template<typename T, typename Alloc = alloc_t<T>>
+class list {
+private:
+    using node_type = list_node<T>;
+    using node_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<node_type>;
+    using node_alloc_traits = std::allocator_traits<node_alloc>;
+
+public:
+    typedef T                                       value_type;
+    typedef Alloc                                   allocator_type;
+    typedef size_t                                  size_type;
+    typedef ptrdiff_t                               difference_type;
+    typedef T&                                      reference;
+    typedef const T&                                const_reference;
+    typedef T*                                      pointer;
+    typedef const T*                                const_pointer;
+    typedef list_iterator<T, false>                 iterator;
+    typedef list_iterator<T, true>                  const_iterator;
+    typedef std::reverse_iterator<iterator>         reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>   const_reverse_iterator;
+
+private:
+    list_node_base sentinel;                                 // 哨兵节点：next为首元素，prev为尾元素
+    size_t count = 0;                                        // 元素个数
+    node_cache<node_type, node_alloc> cache;                 // 节点缓存(含分配器)
+
+public:
+    // 构造函数和析构函数
+    list() : list(Alloc()) {}
+    explicit list(const Alloc& a) : cache(node_alloc(a)) {
+        reset_sentinel();
+    }
+    explicit list(size_t n, const Alloc& a = Alloc()) : list(a) {
+        resize(n);
+    }
+    list(size_t n, const T& value, const Alloc& a = Alloc()) : list(a) {
+        insert(end(), n, value);
+    }
+    template<std::input_iterator InputIt>
+    list(InputIt first, InputIt last, const Alloc& a = Alloc()) : list(a) {
+        insert(end(), first, last);
+    }
+    list(std::initializer_list<T> init, const Alloc& a = Alloc()) : list(a) {
+        insert(end(), init.begin(), init.end());
+    }
+    list(const list& other)
+        : list(std::allocator_traits<Alloc>::select_on_container_copy_construction(Alloc(other.cache.get_allocator()))) {
+        insert(end(), other.begin(), other.end());
+    }
+    list(list&& other) noexcept : cache(std::move(other.cache)) {
+        reset_sentinel();
+        take_nodes(other);
+    }
+    ~list() {
+        clear();
+    }
+
+    list& operator=(const list& other) {
+        if(this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+    list& operator=(list&& other) noexcept {
+        if(this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+    list& operator=(std::initializer_list<T> init) {
+        assign(init.begin(), init.end());
+        return *this;
+    }
+
+    // 复用已有节点赋值，多余的删除，不足的追加
+    template<std::input_iterator InputIt>
+    void assign(InputIt first, InputIt last) {
+        iterator cursor = begin();
+        for(; first != last && cursor != end(); ++first, ++cursor) {
+            *cursor = *first;
+        }
+        if(first == last) {
+            erase(cursor, end());
+        }
+        else {
+            insert(end(), first, last);
+        }
+    }
+    void assign(size_t n, const T& value) {
+        iterator cursor = begin();
+        for(; n > 0 && cursor != end(); --n, ++cursor) {
+            *cursor = value;
+        }
+        if(n == 0) {
+            erase(cursor, end());
+        }
+        else {
+            insert(end(), n, value);
+        }
+    }
+    void assign(std::initializer_list<T> init) {
+        assign(init.begin(), init.end());
+    }
+
+    allocator_type get_allocator() const noexcept { return Alloc(cache.get_allocator()); }
+
+    // 元素访问
+    reference front() noexcept { return *begin(); }
+    const_reference front() const noexcept { return *begin(); }
+    reference back() noexcept { return *--end(); }
+    const_reference back() const noexcept { return *--end(); }
+
+    // 迭代器
+    iterator begin() noexcept { return iterator(sentinel.next); }
+    const_iterator begin() const noexcept { return const_iterator(sentinel.next); }
+    const_iterator cbegin() const noexcept { return begin(); }
+    iterator end() noexcept { return iterator(&sentinel); }
+    const_iterator end() const noexcept { return const_iterator(&sentinel); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // 容量
+    bool empty() const noexcept { return count == 0; }
+    size_t size() const noexcept { return count; }
+    size_t max_size() const noexcept { return node_alloc_traits::max_size(cache.get_allocator()); }
+
+    // 节点缓存
+    size_t node_cache_size() const noexcept { return cache.cached(); }
+    void set_node_cache_limit(size_t limit) noexcept { cache.set_limit(limit); }
+    void shrink_node_cache() noexcept { cache.release(); }
+
+    // 修改
+    void clear() noexcept {
+        list_node_base* node = sentinel.next;
+        while(node != &sentinel) {
+            list_node_base* next = node->next;
+            destroy_node(static_cast<node_type*>(node));
+            node = next;
+        }
+        reset_sentinel();
+        count = 0;
+    }
+
+    template<typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        node_type* node = create_node(std::forward<Args>(args)...);
+        link_before(pos.node, node);
+        return iterator(node);
+    }
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+    iterator insert(const_iterator pos, size_t n, const T& value) {
+        return insert_staged(pos, [n, &value](list& staging) {
+            for(size_t i = 0; i < n; i++) {
+                staging.emplace_back(value);
+            }
+        });
+    }
+    template<std::input_iterator InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        return insert_staged(pos, [&first, &last](list& staging) {
+            for(; first != last; ++first) {
+                staging.emplace_back(*first);
+            }
+        });
+    }
+    iterator insert(const_iterator pos, std::initializer_list<T> init) {
+        return insert(pos, init.begin(), init.end());
+    }
+
+    iterator erase(const_iterator pos) noexcept {
+        list_node_base* next = pos.node->next;
+        unlink(pos.node);
+        destroy_node(static_cast<node_type*>(pos.node));
+        return iterator(next);
+    }
+    iterator erase(const_iterator first, const_iterator last) noexcept {
+        while(first != last) {
+            first = erase(first);
+        }
+        return iterator(last.node);
+    }
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args) { return *emplace(end(), std::forward<Args>(args)...); }
+    template<typename... Args>
+    reference emplace_front(Args&&... args) { return *emplace(begin(), std::forward<Args>(args)...); }
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void push_front(const T& value) { emplace_front(value); }
+    void push_front(T&& value) { emplace_front(std::move(value)); }
+    void pop_back() noexcept { erase(--end()); }
+    void pop_front() noexcept { erase(begin()); }
+
+    void resize(size_t n) {
+        resize_with(n, [this] { emplace_back(); });
+    }
+    void resize(size_t n, const T& value) {
+        resize_with(n, [this, &value] { emplace_back(value); });
+    }
+
+    void swap(list& other) noexcept {
+        list_node_base* mine_first = sentinel.next;
+        list_node_base* mine_last = sentinel.prev;
+        size_t mine_count = count;
+        bool mine_empty = empty();
+        if(other.empty()) {
+            reset_sentinel();
+        }
+        else {
+            attach(other.sentinel.next, other.sentinel.prev);
+        }
+        count = other.count;
+        if(mine_empty) {
+            other.reset_sentinel();
+        }
+        else {
+            other.attach(mine_first, mine_last);
+        }
+        other.count = mine_count;
+        cache.swap(other.cache);
+    }
+
+    // 链表操作：只改指针，不申请也不释放节点
+    void splice(const_iterator pos, list& other) noexcept {
+        splice_all(pos, other);
+    }
+    void splice(const_iterator pos, list&& other) noexcept {
+        splice_all(pos, other);
+    }
+    void splice(const_iterator pos, list& other, const_iterator it) noexcept {
+        list_node_base* next = it.node->next;
+        if(pos.node == it.node || pos.node == next) {
+            return;
+        }
+        pos.node->transfer(it.node, next);
+        other.count--;
+        count++;
+    }
+    void splice(const_iterator pos, list&& other, const_iterator it) noexcept {
+        splice(pos, other, it);
+    }
+    void splice(const_iterator pos, list& other, const_iterator first, const_iterator last) noexcept {
+        if(first == last) {
+            return;
+        }
+        if(&other != this) {
+            size_t moved = std::distance(first, last);
+            other.count -= moved;
+            count += moved;
+        }
+        pos.node->transfer(first.node, last.node);
+    }
+    void splice(const_iterator pos, list&& other, const_iterator first, const_iterator last) noexcept {
+        splice(pos, other, first, last);
+    }
+
+    // 合并两个有序链表，结果稳定：相等元素中this的在前
+    template<typename Compare>
+    void merge(list& other, Compare comp) {
+        if(&other == this) {
+            return;
+        }
+        iterator first1 = begin();
+        iterator first2 = other.begin();
+        while(first1 != end() && first2 != other.end()) {
+            if(comp(*first2, *first1)) {
+                iterator next = std::next(first2);
+                first1.node->transfer(first2.node, next.node);
+                first2 = next;
+            }
+            else {
+                ++first1;
+            }
+        }
+        if(first2 != other.end()) {
+            end().node->transfer(first2.node, other.end().node);
+        }
+        count += other.count;
+        other.count = 0;
+    }
+    template<typename Compare>
+    void merge(list&& other, Compare comp) { merge(other, comp); }
+    void merge(list& other) { merge(other, std::less<>()); }
+    void merge(list&& other) { merge(other, std::less<>()); }
+
+    template<typename Predicate>
+    size_t remove_if(Predicate pred) {
+        size_t removed = 0;
+        for(iterator it = begin(); it != end();) {
+            if(pred(*it)) {
+                it = erase(it);
+                removed++;
+            }
+            else {
+                ++it;
+            }
+        }
+        return removed;
+    }
+    size_t remove(const T& value) {
+        // value可能是链表中的元素，先删其他相等元素，最后删它自己
+        size_t removed = 0;
+        iterator self = end();
+        for(iterator it = begin(); it != end();) {
+            if(*it == value) {
+                if(&*it == &value) {
+                    self = it++;
+                    continue;
+                }
+                it = erase(it);
+                removed++;
+            }
+            else {
+                ++it;
+            }
+        }
+        if(self != end()) {
+            erase(self);
+            removed++;
+        }
+        return removed;
+    }
+
+    template<typename BinaryPredicate>
+    size_t unique(BinaryPredicate pred) {
+        size_t removed = 0;
+        if(empty()) {
+            return 0;
+        }
+        iterator prev = begin();
+        for(iterator it = std::next(prev); it != end();) {
+            if(pred(*prev, *it)) {
+                it = erase(it);
+                removed++;
+            }
+            else {
+                prev = it++;
+            }
+        }
+        return removed;
+    }
+    size_t unique() { return unique(std::equal_to<>()); }
+
+    void reverse() noexcept {
+        list_node_base* node = &sentinel;
+        do {
+            std::swap(node->prev, node->next);
+            node = node->prev;
+        } while(node != &sentinel);
+    }
+
+    // 自底向上归并排序(SGI做法)：carry与counter[i](长度2^i)之间只做splice与merge，不移动元素
+    template<typename Compare>
+    void sort(Compare comp) {
+        if(count < 2) {
+            return;
+        }
+        list carry(get_allocator());
+        list counter[64] = {};
+        int fill = 0;
+        while(!empty()) {
+            carry.splice(carry.begin(), *this, begin());
+            int i = 0;
+            while(i < fill && !counter[i].empty()) {
+                counter[i].merge(carry, comp);
+                carry.swap_nodes(counter[i++]);
+            }
+            carry.swap_nodes(counter[i]);
+            if(i == fill) {
+                fill++;
+            }
+        }
+        for(int i = 1; i < fill; i++) {
+            counter[i].merge(counter[i - 1], comp);
+        }
+        swap_nodes(counter[fill - 1]);
+    }
+    void sort() { sort(std::less<>()); }
+
+private:
+    void reset_sentinel() noexcept {
+        sentinel.prev = sentinel.next = &sentinel;
+    }
+
+    // 把first...last整段挂到哨兵上(覆盖原有内容)
+    void attach(list_node_base* first, list_node_base* last) noexcept {
+        sentinel.next = first;
+        sentinel.prev = last;
+        first->prev = &sentinel;
+        last->next = &sentinel;
+    }
+
+    void take_nodes(list& other) noexcept {
+        if(!other.empty()) {
+            attach(other.sentinel.next, other.sentinel.prev);
+            count = other.count;
+            other.reset_sentinel();
+            other.count = 0;
+        }
+    }
+
+    // 只交换节点，不交换缓存(sort中的临时链表共用同一个分配器)
+    void swap_nodes(list& other) noexcept {
+        list temp(std::move(*this));
+        reset_sentinel();
+        count = 0;
+        cache.swap(temp.cache);
+        take_nodes(other);
+        other.take_nodes(temp);
+    }
+
+    // 先在临时链表中构造，全部成功后整段接入，构造失败时原链表不变
+    // 临时链表借用本链表的节点缓存：节点取自缓存，失败时已构造的节点也回到缓存
+    template<typename Fill>
+    iterator insert_staged(const_iterator pos, Fill fill) {
+        list staging(get_allocator());
+        staging.cache.swap(cache);
+        try {
+            fill(staging);
+        } catch (...) {
+            staging.clear();
+            staging.cache.swap(cache);
+            throw;
+        }
+        staging.cache.swap(cache);
+        return splice_all(pos, staging);
+    }
+
+    iterator splice_all(const_iterator pos, list& other) noexcept {
+        if(other.empty()) {
+            return iterator(pos.node);
+        }
+        list_node_base* first = other.sentinel.next;
+        pos.node->transfer(first, &other.sentinel);
+        count += other.count;
+        other.count = 0;
+        return iterator(first);
+    }
+
+    template<typename Append>
+    void resize_with(size_t n, Append append) {
+        while(count > n) {
+            pop_back();
+        }
+        while(count < n) {
+            append();
+        }
+    }
+
+    template<typename... Args>
+    node_type* create_node(Args&&... args) {
+        node_type* node = cache.acquire(count);
+        try {
+            ::new((void*)&node->value) T(std::forward<Args>(args)...);
+        } catch (...) {
+            cache.recycle(node);
+            throw;
+        }
+        return node;
+    }
+
+    void destroy_node(node_type* node) noexcept {
+        node->value.~T();
+        cache.recycle(node);
+    }
+
+    void link_before(list_node_base* pos, list_node_base* node) noexcept {
+        node->next = pos;
+        node->prev = pos->prev;
+        pos->prev->next = node;
+        pos->prev = node;
+        count++;
+    }
+
+    void unlink(list_node_base* node) noexcept {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        count--;
+    }
+};
+
+template<typename T, typename Alloc>
+bool operator==(const list<T, Alloc>& a, const list<T, Alloc>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+template<typename T, typename Alloc>
+bool operator!=(const list<T, Alloc>& a, const list<T, Alloc>& b) {
+    return !(a == b);
+}
+
+template<typename T, typename Alloc>
+bool operator<(const list<T, Alloc>& a, const list<T, Alloc>& b) {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+}
+
+template<typename T, typename Alloc>
+void swap(list<T, Alloc>& a, list<T, Alloc>& b) noexcept {
+    a.swap(b);
+}
+
+} // namespace Cat
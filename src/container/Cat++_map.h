@@ -0,0 +1,229 @@
+#pragma once
+#include "Cat++_rb_tree.h"
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+//map
+/*
+基于红黑树的有序映射，接口与std::map一致
+- 节点来自分配器，删除的节点进入容器自带的节点缓存，见Cat++_rb_tree.h
+- extract/insert(node_type&&)/merge只移动节点，不申请也不释放内存
+*/
+
+namespace Cat {
+
+template<typename Key, typename T, typename Compare = std::less<Key>, typename Alloc = alloc_t<std::pair<const Key, T>>>
+class map {
+public:
+    typedef Key                                     key_type;
+    typedef T                                       mapped_type;
+    typedef std::pair<const Key, T>                 value_type;
+    typedef Compare                                 key_compare;
+    typedef Alloc                                   allocator_type;
+    typedef size_t                                  size_type;
+    typedef ptrdiff_t                               difference_type;
+    typedef value_type&                             reference;
+    typedef const value_type&                       const_reference;
+
+private:
+    struct key_of_value {
+        const Key& operator()(const value_type& value) const noexcept { return value.first; }
+    };
+    using tree_type = rb_tree<Key, value_type, key_of_value, Compare, Alloc>;
+
+    tree_type tree;
+
+public:
+    typedef typename tree_type::iterator            iterator;
+    typedef typename tree_type::const_iterator      const_iterator;
+    typedef std::reverse_iterator<iterator>         reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>   const_reverse_iterator;
+    typedef rb_node_handle<value_type, Alloc, Key, T> node_type;
+    typedef rb_insert_return<iterator, node_type>   insert_return_type;
+
+    class value_compare {
+    protected:
+        Compare comp;
+        friend class map;
+        explicit value_compare(Compare c) : comp(c) {}
+
+    public:
+        bool operator()(const value_type& a, const value_type& b) const { return comp(a.first, b.first); }
+    };
+
+    // 构造函数
+    map() = default;
+    explicit map(const Compare& comp, const Alloc& a = Alloc()) : tree(comp, a) {}
+    explicit map(const Alloc& a) : tree(Compare(), a) {}
+    template<std::input_iterator InputIt>
+    map(InputIt first, InputIt last, const Compare& comp = Compare(), const Alloc& a = Alloc()) : tree(comp, a) {
+        insert(first, last);
+    }
+    map(std::initializer_list<value_type> init, const Compare& comp = Compare(), const Alloc& a = Alloc()) : tree(comp, a) {
+        insert(init.begin(), init.end());
+    }
+
+    map& operator=(std::initializer_list<value_type> init) {
+        clear();
+        insert(init.begin(), init.end());
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return tree.get_allocator(); }
+    key_compare key_comp() const { return tree.key_comp(); }
+    value_compare value_comp() const { return value_compare(tree.key_comp()); }
+
+    // 元素访问
+    T& at(const Key& key) {
+        iterator it = find(key);
+        if(it == end()) {
+            throw std::out_of_range("Cat::map::at");
+        }
+        return it->second;
+    }
+    const T& at(const Key& key) const {
+        const_iterator it = find(key);
+        if(it == end()) {
+            throw std::out_of_range("Cat::map::at");
+        }
+        return it->second;
+    }
+    T& operator[](const Key& key) { return try_emplace(key).first->second; }
+    T& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+
+    // 迭代器
+    iterator begin() noexcept { return tree.begin(); }
+    const_iterator begin() const noexcept { return tree.begin(); }
+    const_iterator cbegin() const noexcept { return tree.begin(); }
+    iterator end() noexcept { return tree.end(); }
+    const_iterator end() const noexcept { return tree.end(); }
+    const_iterator cend() const noexcept { return tree.end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // 容量
+    bool empty() const noexcept { return tree.empty(); }
+    size_t size() const noexcept { return tree.size(); }
+    size_t max_size() const noexcept { return tree.max_size(); }
+
+    // 节点缓存
+    size_t node_cache_size() const noexcept { return tree.node_cache_size(); }
+    void set_node_cache_limit(size_t limit) noexcept { tree.set_node_cache_limit(limit); }
+    void shrink_node_cache() noexcept { tree.shrink_node_cache(); }
+
+    // 修改
+    void clear() noexcept { tree.clear(); }
+
+    std::pair<iterator, bool> insert(const value_type& value) { return tree.try_emplace_unique(value.first, value); }
+    std::pair<iterator, bool> insert(value_type&& value) { return tree.try_emplace_unique(value.first, std::move(value)); }
+    template<typename P> requires std::is_constructible_v<value_type, P&&>
+    std::pair<iterator, bool> insert(P&& value) { return tree.emplace_unique(std::forward<P>(value)); }
+    iterator insert(const_iterator hint, const value_type& value) { return tree.emplace_hint_unique(hint, value); }
+    iterator insert(const_iterator hint, value_type&& value) { return tree.emplace_hint_unique(hint, std::move(value)); }
+    template<std::input_iterator InputIt>
+    void insert(InputIt first, InputIt last) {
+        for(; first != last; ++first) {
+            tree.emplace_hint_unique(end(), *first);
+        }
+    }
+    void insert(std::initializer_list<value_type> init) { insert(init.begin(), init.end()); }
+    insert_return_type insert(node_type&& handle) { return tree.insert_node(std::move(handle)); }
+    iterator insert(const_iterator, node_type&& handle) { return tree.insert_node(std::move(handle)).position; }
+
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj) {
+        return assign_or_emplace(key, std::forward<M>(obj));
+    }
+    template<typename M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj) {
+        return assign_or_emplace(std::move(key), std::forward<M>(obj));
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) { return tree.emplace_unique(std::forward<Args>(args)...); }
+    template<typename... Args>
+    iterator emplace_hint(const_iterator hint, Args&&... args) { return tree.emplace_hint_unique(hint, std::forward<Args>(args)...); }
+
+    // 键已存在时不构造值
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args) {
+        return tree.try_emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(key),
+                                       std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args) {
+        return tree.try_emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                                       std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    iterator erase(iterator pos) noexcept { return tree.erase(pos); }
+    iterator erase(const_iterator pos) noexcept { return tree.erase(pos); }
+    iterator erase(const_iterator first, const_iterator last) noexcept { return tree.erase(first, last); }
+    size_t erase(const Key& key) { return tree.erase_key(key); }
+
+    void swap(map& other) noexcept { tree.swap(other.tree); }
+
+    node_type extract(const_iterator pos) noexcept { return tree.template extract<node_type>(pos); }
+    node_type extract(const Key& key) {
+        const_iterator it = find(key);
+        return it == end() ? node_type() : extract(it);
+    }
+
+    template<typename OtherCompare>
+    void merge(map<Key, T, OtherCompare, Alloc>& other) { tree.merge(other.tree); }
+    template<typename OtherCompare>
+    void merge(map<Key, T, OtherCompare, Alloc>&& other) { tree.merge(other.tree); }
+
+    // 查找
+    size_t count(const Key& key) const { return tree.count_key(key); }
+    bool contains(const Key& key) const { return tree.count_key(key) != 0; }
+    iterator find(const Key& key) { return tree.find(key); }
+    const_iterator find(const Key& key) const { return tree.find(key); }
+    iterator lower_bound(const Key& key) { return tree.lower_bound(key); }
+    const_iterator lower_bound(const Key& key) const { return tree.lower_bound(key); }
+    iterator upper_bound(const Key& key) { return tree.upper_bound(key); }
+    const_iterator upper_bound(const Key& key) const { return tree.upper_bound(key); }
+    std::pair<iterator, iterator> equal_range(const Key& key) { return tree.equal_range(key); }
+    std::pair<const_iterator, const_iterator> equal_range(const Key& key) const { return tree.equal_range(key); }
+
+private:
+    template<typename, typename, typename, typename>
+    friend class map;
+
+    template<typename K, typename M>
+    std::pair<iterator, bool> assign_or_emplace(K&& key, M&& obj) {
+        iterator it = lower_bound(key);
+        if(it != end() && !tree.key_comp()(key, it->first)) {
+            it->second = std::forward<M>(obj);
+            return {it, false};
+        }
+        return {tree.emplace_hint_unique(it, std::forward<K>(key), std::forward<M>(obj)), true};
+    }
+};
+
+template<typename Key, typename T, typename Compare, typename Alloc>
+bool operator==(const map<Key, T, Compare, Alloc>& a, const map<Key, T, Compare, Alloc>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+template<typename Key, typename T, typename Compare, typename Alloc>
+bool operator!=(const map<Key, T, Compare, Alloc>& a, const map<Key, T, Compare, Alloc>& b) {
+    return !(a == b);
+}
+
+template<typename Key, typename T, typename Compare, typename Alloc>
+bool operator<(const map<Key, T, Compare, Alloc>& a, const map<Key, T, Compare, Alloc>& b) {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+}
+
+template<typename Key, typename T, typename Compare, typename Alloc>
+void swap(map<Key, T, Compare, Alloc>& a, map<Key, T, Compare, Alloc>& b) noexcept {
+    a.swap(b);
+}
+
+} // namespace Cat
@@ -0,0 +1,442 @@
+#pragma once
+#include "../Cat++_config.h"
+#include "../alloc/Cat++_hazard_pointer.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+//多生产者多消费者队列
+/*
+mpmc_queue<T>：有界数组队列(序号法)
+1）每个格子带一个序号sequence，初值为格子下标；enqueue_pos/dequeue_pos各占一个缓存行
+2）生产者读enqueue_pos = pos，格子序号等于pos表示可写：CAS把enqueue_pos推进到pos + 1认领格子，
+   写入元素后把序号置为pos + 1发布；序号小于pos表示队列已满
+3）消费者读dequeue_pos = pos，格子序号等于pos + 1表示可读：认领后取出元素，把序号置为pos + 容量，留给下一圈的生产者
+4）批量：从pos起连续检查多个格子，一次CAS认领整段(遇到不可用的格子就截断)，再逐个写入/取出并发布
+生产者与消费者只在各自的位置计数器上竞争，不加锁，不申请内存
+
+linked_mpmc_queue<T>：无界链式队列(Michael-Scott)
+1）单链表带一个哨兵节点，head指向哨兵，tail指向最后一个节点(或落后一步，由下一次操作推进)
+2）节点来自Alloc(默认pool_allocator<true, T>，按节点类型rebind)
+3）出队摘下的旧哨兵可能仍被其他线程读取，交给hazard_pointers延迟归还(见Cat++_hazard_pointer.h)；
+   节点在任何线程登记期间不会回到内存池，因此CAS不会遇到ABA
+4）批量入队先在本线程把节点串成一段，再一次CAS挂到队尾
+元素的构造可以抛出异常(抛出时队列不变)；移动不能抛出：认领的格子/摘下的节点必须完成发布或取出
+*/
+
+namespace Cat {
+
+template<typename T, typename Alloc = alloc_t<T>>
+class mpmc_queue {
+private:
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                  "mpmc_queue elements must be nothrow movable");
+
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct cell {
+        std::atomic<size_t> sequence;
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    using cell_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<cell>;
+    using cell_traits = std::allocator_traits<cell_allocator>;
+
+    alignas(CACHE_LINE) std::atomic<size_t> enqueue_pos{0};
+    alignas(CACHE_LINE) std::atomic<size_t> dequeue_pos{0};
+    alignas(CACHE_LINE) cell* cells;       // 双方只读
+    size_t mask;
+    [[no_unique_address]] cell_allocator alloc;
+
+    static size_t round_capacity(size_t capacity) noexcept {
+        size_t result = 2;
+        while(result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+    // 在已认领的格子中构造元素，只用于不抛出的构造：认领的格子必须发布
+    template<typename... Args>
+    static void construct(cell& target, Args&&... args) noexcept(std::is_nothrow_constructible_v<T, Args...>) {
+        ::new((void*)target.storage) T(std::forward<Args>(args)...);
+    }
+
+public:
+    typedef T           value_type;
+    typedef size_t      size_type;
+    typedef Alloc       allocator_type;
+
+    explicit mpmc_queue(size_t capacity, const Alloc& a = Alloc()) : mask(round_capacity(capacity) - 1), alloc(a) {
+        cells = cell_traits::allocate(alloc, mask + 1);
+        if(cells == nullptr) {
+            throw OutOfMemoryException();
+        }
+        for(size_t i = 0; i <= mask; i++) {
+            ::new((void*)&cells[i].sequence) std::atomic<size_t>(i);
+        }
+    }
+
+    mpmc_queue(const mpmc_queue&) = delete;
+    mpmc_queue& operator=(const mpmc_queue&) = delete;
+
+    ~mpmc_queue() {
+        size_t end = enqueue_pos.load(std::memory_order_relaxed);
+        for(size_t pos = dequeue_pos.load(std::memory_order_relaxed); pos != end; pos++) {
+            cells[pos & mask].value()->~T();
+        }
+        cell_traits::deallocate(alloc, cells, mask + 1);
+    }
+
+    size_t capacity() const noexcept { return mask + 1; }
+
+    // 元素个数的近似值
+    size_t size_approx() const noexcept {
+        size_t head = dequeue_pos.load(std::memory_order_acquire);
+        size_t tail = enqueue_pos.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const noexcept { return size_approx() == 0; }
+
+    // 队列已满时返回false；构造可能抛出时先构造临时对象再移入，认领的格子总能发布
+    template<typename... Args>
+    bool try_emplace(Args&&... args) {
+        if constexpr (!std::is_nothrow_constructible_v<T, Args...>) {
+            return try_emplace(T(std::forward<Args>(args)...));
+        }
+        else {
+            size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+            cell* target;
+            for(;;) {
+                target = &cells[pos & mask];
+                size_t sequence = target->sequence.load(std::memory_order_acquire);
+                intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+                if(diff == 0) {
+                    if(enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                }
+                else if(diff < 0) {
+                    return false;
+                }
+                else {
+                    pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+            construct(*target, std::forward<Args>(args)...);
+            target->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+    }
+
+    bool try_push(const T& value) { return try_emplace(value); }
+    bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+    // 队列为空时返回false
+    bool try_pop(T& out) noexcept {
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        cell* source;
+        for(;;) {
+            source = &cells[pos & mask];
+            size_t sequence = source->sequence.load(std::memory_order_acquire);
+            intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+            if(diff == 0) {
+                if(dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if(diff < 0) {
+                return false;
+            }
+            else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        T* value = source->value();
+        out = std::move(*value);
+        value->~T();
+        source->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 从first起写入至多count个元素，返回写入的个数(队列满时截断，从first + 返回值继续即可)
+    // 构造可能抛出时逐个转换后写入，不一次认领整段
+    template<typename InputIt>
+    size_t try_push_batch(InputIt first, size_t count) {
+        if constexpr (!std::is_nothrow_constructible_v<T, decltype(*first)>) {
+            size_t n = 0;
+            while(n < count && try_emplace(*first)) {
+                ++first;
+                n++;
+            }
+            return n;
+        }
+        else {
+            if(count == 0) {
+                return 0;
+            }
+            size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+            size_t n;
+            for(;;) {
+                n = 0;
+                while(n < count && n <= mask
+                      && cells[(pos + n) & mask].sequence.load(std::memory_order_acquire) == pos + n) {
+                    n++;
+                }
+                if(n == 0) {
+                    intptr_t diff = (intptr_t)cells[pos & mask].sequence.load(std::memory_order_acquire) - (intptr_t)pos;
+                    if(diff < 0) {
+                        return 0;
+                    }
+                    pos = enqueue_pos.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if(enqueue_pos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            for(size_t i = 0; i < n; i++, ++first) {
+                cell& target = cells[(pos + i) & mask];
+                construct(target, *first);
+                target.sequence.store(pos + i + 1, std::memory_order_release);
+            }
+            return n;
+        }
+    }
+
+    // 至多取出max_count个元素写入out，返回取出的个数
+    template<typename OutputIt>
+    size_t try_pop_batch(OutputIt out, size_t max_count) {
+        if(max_count == 0) {
+            return 0;
+        }
+        size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        size_t n;
+        for(;;) {
+            n = 0;
+            while(n < max_count && n <= mask
+                  && cells[(pos + n) & mask].sequence.load(std::memory_order_acquire) == pos + n + 1) {
+                n++;
+            }
+            if(n == 0) {
+                intptr_t diff = (intptr_t)cells[pos & mask].sequence.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+                if(diff < 0) {
+                    return 0;
+                }
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+                continue;
+            }
+            if(dequeue_pos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for(size_t i = 0; i < n; i++, ++out) {
+            cell& source = cells[(pos + i) & mask];
+            T* value = source.value();
+            *out = std::move(*value);
+            value->~T();
+            source.sequence.store(pos + i + mask + 1, std::memory_order_release);
+        }
+        return n;
+    }
+};
+
+template<typename T, typename Alloc = pool_allocator<true, T>>
+class linked_mpmc_queue {
+private:
+    static_assert(std::is_nothrow_move_constructible_v<T>, "linked_mpmc_queue elements must be nothrow move constructible");
+
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct node {
+        std::atomic<node*> next;
+        alignas(T) unsigned char storage[sizeof(T)];     // 哨兵节点不含元素
+
+        T* value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    using node_allocator = typename std::allocator_traits<Alloc>::template rebind_alloc<node>;
+    using node_traits = std::allocator_traits<node_allocator>;
+    static_assert(std::is_default_constructible_v<node_allocator>,
+                  "retired nodes are released through a default constructed allocator");
+
+    alignas(CACHE_LINE) std::atomic<node*> head;
+    alignas(CACHE_LINE) std::atomic<node*> tail;
+
+    static node* make_node() {
+        node_allocator alloc;
+        node* result = node_traits::allocate(alloc, 1);
+        if(result == nullptr) {
+            throw OutOfMemoryException();
+        }
+        ::new((void*)&result->next) std::atomic<node*>(nullptr);
+        return result;
+    }
+
+    static void free_node(node* target) noexcept {
+        node_allocator alloc;
+        node_traits::deallocate(alloc, target, 1);
+    }
+
+    static void reclaim(void* target) { free_node(static_cast<node*>(target)); }
+
+    // 摘下哨兵，把新哨兵中的元素交给sink(T&&)；队列为空时返回false
+    template<typename Sink>
+    bool pop_into(Sink&& sink) {
+        for(;;) {
+            node* first = hazard_pointers::protect(0, head);
+            node* last = tail.load(std::memory_order_acquire);
+            node* next = hazard_pointers::protect(1, first->next);
+            if(first != head.load(std::memory_order_acquire)) {
+                continue;
+            }
+            if(next == nullptr) {
+                hazard_pointers::clear_all();
+                return false;
+            }
+            if(first == last) {
+                // tail落后一步，先帮忙推进
+                tail.compare_exchange_weak(last, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+            if(head.compare_exchange_weak(first, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                // next成为新的哨兵，它的元素归本线程；登记保证next在读取期间不被回收
+                T* value = next->value();
+                sink(std::move(*value));
+                value->~T();
+                hazard_pointers::clear_all();
+                hazard_pointers::retire(first, reclaim);
+                return true;
+            }
+        }
+    }
+
+    // 把已串好的first...last挂到队尾
+    void link(node* first, node* last) {
+        for(;;) {
+            node* current = hazard_pointers::protect(0, tail);
+            node* next = current->next.load(std::memory_order_acquire);
+            if(current != tail.load(std::memory_order_acquire)) {
+                continue;
+            }
+            if(next != nullptr) {
+                tail.compare_exchange_weak(current, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+            if(current->next.compare_exchange_weak(next, first, std::memory_order_release, std::memory_order_relaxed)) {
+                tail.compare_exchange_strong(current, last, std::memory_order_release, std::memory_order_relaxed);
+                hazard_pointers::clear(0);
+                return;
+            }
+        }
+    }
+
+public:
+    typedef T           value_type;
+    typedef Alloc       allocator_type;
+
+    linked_mpmc_queue() {
+        node* dummy = make_node();
+        head.store(dummy, std::memory_order_relaxed);
+        tail.store(dummy, std::memory_order_relaxed);
+    }
+
+    linked_mpmc_queue(const linked_mpmc_queue&) = delete;
+    linked_mpmc_queue& operator=(const linked_mpmc_queue&) = delete;
+
+    // 析构时不应再有其他线程访问队列
+    ~linked_mpmc_queue() {
+        node* current = head.load(std::memory_order_relaxed);
+        node* next = current->next.load(std::memory_order_relaxed);
+        free_node(current);
+        while(next) {
+            current = next;
+            next = current->next.load(std::memory_order_relaxed);
+            current->value()->~T();
+            free_node(current);
+        }
+    }
+
+    template<typename... Args>
+    void emplace(Args&&... args) {
+        node* target = make_node();
+        try {
+            ::new((void*)target->storage) T(std::forward<Args>(args)...);
+        } catch (...) {
+            free_node(target);
+            throw;
+        }
+        link(target, target);
+    }
+
+    void push(const T& value) { emplace(value); }
+    void push(T&& value) { emplace(std::move(value)); }
+
+    // 把[first, first + count)串成一段后一次挂到队尾
+    template<typename InputIt>
+    void push_batch(InputIt first, size_t count) {
+        if(count == 0) {
+            return;
+        }
+        node* chain = nullptr;
+        node* last = nullptr;
+        try {
+            for(size_t i = 0; i < count; i++, ++first) {
+                node* target = make_node();
+                try {
+                    ::new((void*)target->storage) T(*first);
+                } catch (...) {
+                    free_node(target);
+                    throw;
+                }
+                if(last) {
+                    last->next.store(target, std::memory_order_relaxed);
+                }
+                else {
+                    chain = target;
+                }
+                last = target;
+            }
+        } catch (...) {
+            while(chain) {
+                node* next = chain->next.load(std::memory_order_relaxed);
+                chain->value()->~T();
+                free_node(chain);
+                chain = next;
+            }
+            throw;
+        }
+        link(chain, last);
+    }
+
+    // 队列为空时返回false
+    bool try_pop(T& out) {
+        return pop_into([&](T&& value) { out = std::move(value); });
+    }
+
+    // 至多取出max_count个元素写入out，返回取出的个数
+    template<typename OutputIt>
+    size_t try_pop_batch(OutputIt out, size_t max_count) {
+        size_t n = 0;
+        while(n < max_count && pop_into([&](T&& value) { *out = std::move(value); ++out; })) {
+            n++;
+        }
+        return n;
+    }
+
+    // 是否为空的近似值
+    bool empty() {
+        node* first = hazard_pointers::protect(0, head);
+        bool result = first->next.load(std::memory_order_acquire) == nullptr;
+        hazard_pointers::clear(0);
+        return result;
+    }
+};
+
+} // namespace Cat
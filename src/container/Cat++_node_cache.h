@@ -0,0 +1,156 @@
+#pragma once
+#include "../execption/allocator_exception.h"
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+//节点缓存
+/*
+链式容器(list、map、set)的每个容器自带一份节点缓存：
+1）删除元素(erase、clear、pop)时，节点析构其中的值后挂到缓存链表，不归还分配器
+2）插入元素时优先从缓存取节点，缓存为空才向分配器申请
+   分配器提供allocate_batch时按容器当前大小一次申请多个节点(至多REFILL_NODES个)，其余留在缓存
+3）缓存节点数超过上限(limit)时，多出的节点归还分配器；分配器提供deallocate_batch时按批归还
+因此clear后再填充的循环不会访问分配器
+默认上限不封顶，容器析构或调用shrink_node_cache()时全部归还
+*/
+
+namespace Cat {
+
+template<typename Node, typename Alloc>
+class node_cache {
+private:
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    // 空闲节点复用节点本身的内存存放next指针
+    struct free_node {
+        free_node* next;
+    };
+    static_assert(sizeof(Node) >= sizeof(free_node), "node must hold a pointer");
+
+    static constexpr size_t REFILL_NODES = 32;                  // 一次批量申请的节点数上限
+    static constexpr size_t RELEASE_BATCH = 64;                 // 一次批量归还的节点数
+
+    static constexpr bool HAS_BATCH = requires(Alloc a, Node** nodes) {
+        { a.allocate_batch(size_t(1), size_t(1), nodes) } -> std::convertible_to<size_t>;
+        a.deallocate_batch(size_t(1), size_t(1), nodes);
+    };
+
+    [[no_unique_address]] Alloc alloc;
+    free_node* head = nullptr;                                  // 缓存链表
+    size_t count = 0;                                           // 缓存节点数
+    size_t limit = size_t(-1);                                  // 缓存节点数上限
+
+public:
+    node_cache() = default;
+    explicit node_cache(const Alloc& a) noexcept : alloc(a) {}
+    node_cache(node_cache&& other) noexcept
+        : alloc(std::move(other.alloc)), head(other.head), count(other.count), limit(other.limit) {
+        other.head = nullptr;
+        other.count = 0;
+    }
+    node_cache(const node_cache&) = delete;
+    node_cache& operator=(const node_cache&) = delete;
+    node_cache& operator=(node_cache&&) = delete;
+    ~node_cache() { release(); }
+
+    Alloc& get_allocator() noexcept { return alloc; }
+    const Alloc& get_allocator() const noexcept { return alloc; }
+
+    // 取一个未构造的节点；live为容器当前节点数，用于决定批量申请的个数
+    Node* acquire(size_t live = 0) {
+        if(head == nullptr) {
+            refill(live);
+        }
+        free_node* node = head;
+        head = node->next;
+        count--;
+        return reinterpret_cast<Node*>(node);
+    }
+
+    // 回收已析构值的节点
+    void recycle(Node* node) noexcept {
+        if(count >= limit) {
+            alloc_traits::deallocate(alloc, node, 1);
+            return;
+        }
+        free_node* entry = ::new((void*)node) free_node;
+        entry->next = head;
+        head = entry;
+        count++;
+    }
+
+    size_t cached() const noexcept { return count; }
+    size_t get_limit() const noexcept { return limit; }
+
+    // 设置缓存上限，多出的节点立即归还
+    void set_limit(size_t new_limit) noexcept {
+        limit = new_limit;
+        shrink(limit);
+    }
+
+    // 缓存节点归还到只剩keep个
+    void shrink(size_t keep = 0) noexcept {
+        if constexpr (HAS_BATCH) {
+            Node* batch[RELEASE_BATCH];
+            while(count > keep) {
+                size_t n = 0;
+                while(n < RELEASE_BATCH && count > keep) {
+                    batch[n++] = reinterpret_cast<Node*>(head);
+                    head = head->next;
+                    count--;
+                }
+                alloc.deallocate_batch(1, n, batch);
+            }
+        }
+        else {
+            while(count > keep) {
+                free_node* node = head;
+                head = node->next;
+                count--;
+                alloc_traits::deallocate(alloc, reinterpret_cast<Node*>(node), 1);
+            }
+        }
+    }
+
+    void release() noexcept { shrink(0); }
+
+    // 交换分配器与缓存
+    void swap(node_cache& other) noexcept {
+        using std::swap;
+        swap(alloc, other.alloc);
+        swap(head, other.head);
+        swap(count, other.count);
+        swap(limit, other.limit);
+    }
+
+private:
+    void refill(size_t live) {
+        if constexpr (HAS_BATCH) {
+            size_t want = live / 8;
+            want = want > REFILL_NODES ? REFILL_NODES : (want < 1 ? 1 : want);
+            if(want > 1) {
+                Node* batch[REFILL_NODES];
+                size_t got = alloc.allocate_batch(1, want, batch);
+                for(size_t i = 0; i < got; i++) {
+                    free_node* entry = ::new((void*)batch[i]) free_node;
+                    entry->next = head;
+                    head = entry;
+                }
+                count += got;
+                if(got > 0) {
+                    return;
+                }
+            }
+        }
+        Node* node = alloc_traits::allocate(alloc, 1);
+        if(node == nullptr) {
+            throw OutOfMemoryException();
+        }
+        head = ::new((void*)node) free_node{nullptr};
+        count++;
+    }
+};
+
+} // namespace Cat
@@ -0,0 +1,847 @@
+#pragma once
+#include "../Cat++_config.h"
+#include "Cat++_node_cache.h"
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+//红黑树
+/*
+map、set的底层实现(SGI做法)
+1）header节点是树的成员：parent指向根，left指向最小节点，right指向最大节点；根的parent指向header
+   header为红色，用来在迭代器--end()时与根区分
+2）节点经allocator_traits::rebind_alloc从分配器申请，删除的节点进入节点缓存(见Cat++_node_cache.h)
+3）extract()把节点连同值摘下交给node_handle，insert(node_handle)再挂回，整个过程不申请也不释放节点
+   merge()逐个摘下另一棵树中本树没有的键挂到本树，同样不访问分配器；两棵树的分配器须相等
+*/
+
+namespace Cat {
+
+enum class rb_color : bool { RED = false, BLACK = true };
+
+struct rb_node_base {
+    rb_node_base* parent;
+    rb_node_base* left;
+    rb_node_base* right;
+    rb_color color;
+
+    static rb_node_base* minimum(rb_node_base* node) noexcept {
+        while(node->left) {
+            node = node->left;
+        }
+        return node;
+    }
+    static rb_node_base* maximum(rb_node_base* node) noexcept {
+        while(node->right) {
+            node = node->right;
+        }
+        return node;
+    }
+
+    static rb_node_base* increment(rb_node_base* node) noexcept {
+        if(node->right) {
+            return minimum(node->right);
+        }
+        rb_node_base* up = node->parent;
+        while(node == up->right) {
+            node = up;
+            up = up->parent;
+        }
+        // 只有一个节点且node为根时，up为header，node->right == up
+        return node->right != up ? up : node;
+    }
+    static rb_node_base* decrement(rb_node_base* node) noexcept {
+        // node为header(end())时返回最大节点
+        if(node->color == rb_color::RED && node->parent->parent == node) {
+            return node->right;
+        }
+        if(node->left) {
+            return maximum(node->left);
+        }
+        rb_node_base* up = node->parent;
+        while(node == up->left) {
+            node = up;
+            up = up->parent;
+        }
+        return up;
+    }
+};
+
+// 旋转、插入后与删除后的再平衡，算法同《算法导论》第13章
+struct rb_tree_algo {
+    using node = rb_node_base;
+
+    static void rotate_left(node* x, node*& root) noexcept {
+        node* y = x->right;
+        x->right = y->left;
+        if(y->left) {
+            y->left->parent = x;
+        }
+        y->parent = x->parent;
+        if(x == root) {
+            root = y;
+        }
+        else if(x == x->parent->left) {
+            x->parent->left = y;
+        }
+        else {
+            x->parent->right = y;
+        }
+        y->left = x;
+        x->parent = y;
+    }
+
+    static void rotate_right(node* x, node*& root) noexcept {
+        node* y = x->left;
+        x->left = y->right;
+        if(y->right) {
+            y->right->parent = x;
+        }
+        y->parent = x->parent;
+        if(x == root) {
+            root = y;
+        }
+        else if(x == x->parent->right) {
+            x->parent->right = y;
+        }
+        else {
+            x->parent->left = y;
+        }
+        y->right = x;
+        x->parent = y;
+    }
+
+    // 把x挂到parent的左(left == true)或右子节点并再平衡，同时维护header的leftmost/rightmost
+    static void insert_and_rebalance(bool left, node* x, node* parent, node& header) noexcept {
+        node*& root = header.parent;
+        x->parent = parent;
+        x->left = x->right = nullptr;
+        x->color = rb_color::RED;
+        if(left) {
+            parent->left = x;
+            if(parent == &header) {
+                header.parent = x;
+                header.right = x;
+            }
+            else if(parent == header.left) {
+                header.left = x;
+            }
+        }
+        else {
+            parent->right = x;
+            if(parent == header.right) {
+                header.right = x;
+            }
+        }
+        while(x != root && x->parent->color == rb_color::RED) {
+            node* grand = x->parent->parent;
+            if(x->parent == grand->left) {
+                node* uncle = grand->right;
+                if(uncle && uncle->color == rb_color::RED) {
+                    x->parent->color = rb_color::BLACK;
+                    uncle->color = rb_color::BLACK;
+                    grand->color = rb_color::RED;
+                    x = grand;
+                }
+                else {
+                    if(x == x->parent->right) {
+                        x = x->parent;
+                        rotate_left(x, root);
+                    }
+                    x->parent->color = rb_color::BLACK;
+                    grand->color = rb_color::RED;
+                    rotate_right(grand, root);
+                }
+            }
+            else {
+                node* uncle = grand->left;
+                if(uncle && uncle->color == rb_color::RED) {
+                    x->parent->color = rb_color::BLACK;
+                    uncle->color = rb_color::BLACK;
+                    grand->color = rb_color::RED;
+                    x = grand;
+                }
+                else {
+                    if(x == x->parent->left) {
+                        x = x->parent;
+                        rotate_right(x, root);
+                    }
+                    x->parent->color = rb_color::BLACK;
+                    grand->color = rb_color::RED;
+                    rotate_left(grand, root);
+                }
+            }
+        }
+        root->color = rb_color::BLACK;
+    }
+
+    // 把z从树中摘下并再平衡，返回z(由调用者析构/回收)
+    static node* erase_and_rebalance(node* z, node& header) noexcept {
+        node*& root = header.parent;
+        node*& leftmost = header.left;
+        node*& rightmost = header.right;
+        node* y = z;
+        node* x = nullptr;
+        node* x_parent = nullptr;
+        if(y->left == nullptr) {
+            x = y->right;
+        }
+        else if(y->right == nullptr) {
+            x = y->left;
+        }
+        else {
+            y = node::minimum(y->right);
+            x = y->right;
+        }
+        if(y != z) {
+            // z有两个子节点：用后继y顶替z的位置
+            z->left->parent = y;
+            y->left = z->left;
+            if(y != z->right) {
+                x_parent = y->parent;
+                if(x) {
+                    x->parent = y->parent;
+                }
+                y->parent->left = x;
+                y->right = z->right;
+                z->right->parent = y;
+            }
+            else {
+                x_parent = y;
+            }
+            if(root == z) {
+                root = y;
+            }
+            else if(z->parent->left == z) {
+                z->parent->left = y;
+            }
+            else {
+                z->parent->right = y;
+            }
+            y->parent = z->parent;
+            std::swap(y->color, z->color);
+            y = z;
+        }
+        else {
+            x_parent = y->parent;
+            if(x) {
+                x->parent = y->parent;
+            }
+            if(root == z) {
+                root = x;
+            }
+            else if(z->parent->left == z) {
+                z->parent->left = x;
+            }
+            else {
+                z->parent->right = x;
+            }
+            if(leftmost == z) {
+                leftmost = z->right == nullptr ? z->parent : node::minimum(x);
+            }
+            if(rightmost == z) {
+                rightmost = z->left == nullptr ? z->parent : node::maximum(x);
+            }
+        }
+        if(y->color != rb_color::RED) {
+            while(x != root && (x == nullptr || x->color == rb_color::BLACK)) {
+                if(x == x_parent->left) {
+                    node* w = x_parent->right;
+                    if(w->color == rb_color::RED) {
+                        w->color = rb_color::BLACK;
+                        x_parent->color = rb_color::RED;
+                        rotate_left(x_parent, root);
+                        w = x_parent->right;
+                    }
+                    if((w->left == nullptr || w->left->color == rb_color::BLACK) &&
+                       (w->right == nullptr || w->right->color == rb_color::BLACK)) {
+                        w->color = rb_color::RED;
+                        x = x_parent;
+                        x_parent = x_parent->parent;
+                    }
+                    else {
+                        if(w->right == nullptr || w->right->color == rb_color::BLACK) {
+                            w->left->color = rb_color::BLACK;
+                            w->color = rb_color::RED;
+                            rotate_right(w, root);
+                            w = x_parent->right;
+                        }
+                        w->color = x_parent->color;
+                        x_parent->color = rb_color::BLACK;
+                        if(w->right) {
+                            w->right->color = rb_color::BLACK;
+                        }
+                        rotate_left(x_parent, root);
+                        break;
+                    }
+                }
+                else {
+                    node* w = x_parent->left;
+                    if(w->color == rb_color::RED) {
+                        w->color = rb_color::BLACK;
+                        x_parent->color = rb_color::RED;
+                        rotate_right(x_parent, root);
+                        w = x_parent->left;
+                    }
+                    if((w->right == nullptr || w->right->color == rb_color::BLACK) &&
+                       (w->left == nullptr || w->left->color == rb_color::BLACK)) {
+                        w->color = rb_color::RED;
+                        x = x_parent;
+                        x_parent = x_parent->parent;
+                    }
+                    else {
+                        if(w->left == nullptr || w->left->color == rb_color::BLACK) {
+                            w->right->color = rb_color::BLACK;
+                            w->color = rb_color::RED;
+                            rotate_left(w, root);
+                            w = x_parent->left;
+                        }
+                        w->color = x_parent->color;
+                        x_parent->color = rb_color::BLACK;
+                        if(w->left) {
+                            w->left->color = rb_color::BLACK;
+                        }
+                        rotate_right(x_parent, root);
+                        break;
+                    }
+                }
+            }
+            if(x) {
+                x->color = rb_color::BLACK;
+            }
+        }
+        return y;
+    }
+};
+
+template<typename Value>
+struct rb_node : rb_node_base {
+    Value value;
+};
+
+template<typename Value, bool Const>
+class rb_tree_iterator {
+private:
+    template<typename, typename, typename, typename, typename>
+    friend class rb_tree;
+    template<typename, bool>
+    friend class rb_tree_iterator;
+
+    rb_node_base* node = nullptr;
+
+public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Value;
+    using difference_type = ptrdiff_t;
+    using pointer = std::conditional_t<Const, const Value*, Value*>;
+    using reference = std::conditional_t<Const, const Value&, Value&>;
+
+    rb_tree_iterator() noexcept = default;
+    explicit rb_tree_iterator(const rb_node_base* target) noexcept : node(const_cast<rb_node_base*>(target)) {}
+    template<bool OtherConst> requires (Const && !OtherConst)
+    rb_tree_iterator(const rb_tree_iterator<Value, OtherConst>& other) noexcept : node(other.node) {}
+
+    reference operator*() const noexcept { return static_cast<rb_node<Value>*>(node)->value; }
+    pointer operator->() const noexcept { return &static_cast<rb_node<Value>*>(node)->value; }
+
+    rb_tree_iterator& operator++() noexcept { node = rb_node_base::increment(node); return *this; }
+    rb_tree_iterator operator++(int) noexcept { rb_tree_iterator old = *this; ++*this; return old; }
+    rb_tree_iterator& operator--() noexcept { node = rb_node_base::decrement(node); return *this; }
+    rb_tree_iterator operator--(int) noexcept { rb_tree_iterator old = *this; --*this; return old; }
+
+    template<bool OtherConst>
+    bool operator==(const rb_tree_iterator<Value, OtherConst>& other) const noexcept { return node == other.node; }
+};
+
+// 节点句柄：extract()的返回值，独占一个已摘下的节点，析构时销毁值并释放节点
+// map的句柄提供key()/mapped()，set的句柄提供value()
+template<typename Value, typename Alloc, typename Key, typename Mapped>
+class rb_node_handle {
+private:
+    template<typename, typename, typename, typename, typename>
+    friend class rb_tree;
+
+    using node_type = rb_node<Value>;
+    using node_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<node_type>;
+
+    node_type* node = nullptr;
+    std::optional<node_alloc> alloc;
+
+    rb_node_handle(node_type* target, const node_alloc& a) noexcept : node(target), alloc(a) {}
+
+    node_type* release() noexcept {
+        node_type* result = node;
+        node = nullptr;
+        alloc.reset();
+        return result;
+    }
+
+public:
+    using allocator_type = Alloc;
+
+    constexpr rb_node_handle() noexcept = default;
+    rb_node_handle(rb_node_handle&& other) noexcept : node(other.node), alloc(std::move(other.alloc)) {
+        other.node = nullptr;
+        other.alloc.reset();
+    }
+    rb_node_handle& operator=(rb_node_handle&& other) noexcept {
+        if(this != &other) {
+            destroy();
+            node = other.node;
+            alloc = std::move(other.alloc);
+            other.node = nullptr;
+            other.alloc.reset();
+        }
+        return *this;
+    }
+    ~rb_node_handle() { destroy(); }
+
+    bool empty() const noexcept { return node == nullptr; }
+    explicit operator bool() const noexcept { return node != nullptr; }
+    allocator_type get_allocator() const { return Alloc(*alloc); }
+
+    // map：键可修改，便于改键后重新插入
+    template<typename K = Key> requires (!std::is_void_v<Mapped>)
+    K& key() const noexcept { return const_cast<K&>(node->value.first); }
+    template<typename M = Mapped> requires (!std::is_void_v<M>)
+    M& mapped() const noexcept { return node->value.second; }
+    // set
+    template<typename V = Value> requires std::is_void_v<Mapped>
+    V& value() const noexcept { return node->value; }
+
+    void swap(rb_node_handle& other) noexcept {
+        std::swap(node, other.node);
+        alloc.swap(other.alloc);
+    }
+
+private:
+    void destroy() noexcept {
+        if(node) {
+            node->value.~Value();
+            std::allocator_traits<node_alloc>::deallocate(*alloc, node, 1);
+            node = nullptr;
+            alloc.reset();
+        }
+    }
+};
+
+template<typename Iterator, typename NodeHandle>
+struct rb_insert_return {
+    Iterator position;
+    bool inserted;
+    NodeHandle node;
+};
+
+// KeyOfValue从值中取出键：set为恒等，map取pair::first
+template<typename Key, typename Value, typename KeyOfValue, typename Compare, typename Alloc>
+class rb_tree {
+private:
+    using node_type = rb_node<Value>;
+    using node_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<node_type>;
+    using node_alloc_traits = std::allocator_traits<node_alloc>;
+    using base_ptr = rb_node_base*;
+
+public:
+    typedef Key                                     key_type;
+    typedef Value                                   value_type;
+    typedef Compare                                 key_compare;
+    typedef Alloc                                   allocator_type;
+    typedef size_t                                  size_type;
+    typedef ptrdiff_t                               difference_type;
+    typedef rb_tree_iterator<Value, false>          iterator;
+    typedef rb_tree_iterator<Value, true>           const_iterator;
+
+private:
+    rb_node_base header;                                     // parent为根，left为最小节点，right为最大节点
+    size_t count = 0;                                        // 节点数
+    [[no_unique_address]] Compare comp;                      // 键比较
+    node_cache<node_type, node_alloc> cache;                 // 节点缓存(含分配器)
+
+public:
+    // 构造函数和析构函数
+    explicit rb_tree(const Compare& c = Compare(), const Alloc& a = Alloc()) : comp(c), cache(node_alloc(a)) {
+        reset_header();
+    }
+    rb_tree(const rb_tree& other)
+        : comp(other.comp),
+          cache(node_alloc(std::allocator_traits<Alloc>::select_on_container_copy_construction(Alloc(other.cache.get_allocator())))) {
+        reset_header();
+        clone(other);
+    }
+    rb_tree(rb_tree&& other) noexcept : comp(std::move(other.comp)), cache(std::move(other.cache)) {
+        reset_header();
+        take_nodes(other);
+    }
+    ~rb_tree() {
+        clear();
+    }
+
+    // 先清空，节点进入缓存，再从缓存取节点复制other，反复赋值不访问分配器
+    // 复制失败时已复制的部分回到缓存，本树为空(与std::map相同，只保证基本异常安全)
+    rb_tree& operator=(const rb_tree& other) {
+        if(this != &other) {
+            clear();
+            comp = other.comp;
+            clone(other);
+        }
+        return *this;
+    }
+    rb_tree& operator=(rb_tree&& other) noexcept {
+        if(this != &other) {
+            clear();
+            swap(other);
+        }
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return Alloc(cache.get_allocator()); }
+    key_compare key_comp() const { return comp; }
+
+    // 迭代器
+    iterator begin() noexcept { return iterator(header.left); }
+    const_iterator begin() const noexcept { return const_iterator(header.left); }
+    iterator end() noexcept { return iterator(&header); }
+    const_iterator end() const noexcept { return const_iterator(&header); }
+
+    // 容量
+    bool empty() const noexcept { return count == 0; }
+    size_t size() const noexcept { return count; }
+    size_t max_size() const noexcept { return node_alloc_traits::max_size(cache.get_allocator()); }
+
+    // 节点缓存
+    size_t node_cache_size() const noexcept { return cache.cached(); }
+    void set_node_cache_limit(size_t limit) noexcept { cache.set_limit(limit); }
+    void shrink_node_cache() noexcept { cache.release(); }
+
+    void clear() noexcept {
+        destroy_subtree(header.parent);
+        reset_header();
+        count = 0;
+    }
+
+    void swap(rb_tree& other) noexcept {
+        rb_node_base mine = header;
+        size_t mine_count = count;
+        reset_header();
+        count = 0;
+        take_nodes(other);
+        if(mine.parent) {
+            other.header = mine;
+            other.header.parent->parent = &other.header;
+            other.count = mine_count;
+        }
+        cache.swap(other.cache);
+        std::swap(comp, other.comp);
+    }
+
+    // 查找
+    template<typename K>
+    iterator find(const K& key) { return iterator(find_node(key)); }
+    template<typename K>
+    const_iterator find(const K& key) const { return const_iterator(find_node(key)); }
+    template<typename K>
+    iterator lower_bound(const K& key) { return iterator(lower_node(key)); }
+    template<typename K>
+    const_iterator lower_bound(const K& key) const { return const_iterator(lower_node(key)); }
+    template<typename K>
+    iterator upper_bound(const K& key) { return iterator(upper_node(key)); }
+    template<typename K>
+    const_iterator upper_bound(const K& key) const { return const_iterator(upper_node(key)); }
+    template<typename K>
+    std::pair<iterator, iterator> equal_range(const K& key) { return {lower_bound(key), upper_bound(key)}; }
+    template<typename K>
+    std::pair<const_iterator, const_iterator> equal_range(const K& key) const { return {lower_bound(key), upper_bound(key)}; }
+    template<typename K>
+    size_t count_key(const K& key) const { return find_node(key) != &header ? 1 : 0; }
+
+    // 插入：键已存在时不插入，返回已有元素
+    // 先查找插入位置，键不存在才构造节点
+    template<typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace_unique(const K& key, Args&&... args) {
+        slot pos = insert_position(key);
+        if(pos.parent == nullptr) {
+            return {iterator(pos.existing), false};
+        }
+        node_type* node = create_node(std::forward<Args>(args)...);
+        link(node, pos);
+        return {iterator(node), true};
+    }
+
+    // 先构造节点再查找(键需从参数构造时使用)，键已存在时回收节点
+    template<typename... Args>
+    std::pair<iterator, bool> emplace_unique(Args&&... args) {
+        node_type* node = create_node(std::forward<Args>(args)...);
+        slot pos = insert_position(KeyOfValue()(node->value));
+        if(pos.parent == nullptr) {
+            destroy_node(node);
+            return {iterator(pos.existing), false};
+        }
+        link(node, pos);
+        return {iterator(node), true};
+    }
+
+    // 带位置提示的插入：hint恰好是插入位置的后继时O(1)，否则退化为普通插入
+    template<typename... Args>
+    iterator emplace_hint_unique(const_iterator hint, Args&&... args) {
+        node_type* node = create_node(std::forward<Args>(args)...);
+        const Key& key = KeyOfValue()(node->value);
+        base_ptr next = hint.node;
+        if(next == &header) {
+            if(count > 0 && comp(key_of(header.right), key)) {
+                link(node, {header.right, false, nullptr});
+                return iterator(node);
+            }
+        }
+        else if(comp(key, key_of(next))) {
+            base_ptr before = next == header.left ? nullptr : rb_node_base::decrement(next);
+            if(before == nullptr || comp(key_of(before), key)) {
+                // next有左子树时，前驱before没有右子节点
+                link(node, next->left == nullptr ? slot{next, true, nullptr} : slot{before, false, nullptr});
+                return iterator(node);
+            }
+        }
+        slot pos = insert_position(key);
+        if(pos.parent == nullptr) {
+            destroy_node(node);
+            return iterator(pos.existing);
+        }
+        link(node, pos);
+        return iterator(node);
+    }
+
+    // 删除
+    iterator erase(const_iterator pos) noexcept {
+        iterator next(rb_node_base::increment(pos.node));
+        base_ptr node = rb_tree_algo::erase_and_rebalance(pos.node, header);
+        count--;
+        destroy_node(static_cast<node_type*>(node));
+        return next;
+    }
+    iterator erase(const_iterator first, const_iterator last) noexcept {
+        if(first == begin() && last == end()) {
+            clear();
+            return end();
+        }
+        while(first != last) {
+            first = erase(first);
+        }
+        return iterator(last.node);
+    }
+    template<typename K>
+    size_t erase_key(const K& key) {
+        base_ptr node = find_node(key);
+        if(node == &header) {
+            return 0;
+        }
+        erase(const_iterator(node));
+        return 1;
+    }
+
+    // 节点句柄
+    template<typename Handle>
+    Handle extract(const_iterator pos) noexcept {
+        base_ptr node = rb_tree_algo::erase_and_rebalance(pos.node, header);
+        count--;
+        return Handle(static_cast<node_type*>(node), cache.get_allocator());
+    }
+
+    template<typename Handle>
+    rb_insert_return<iterator, Handle> insert_node(Handle&& handle) {
+        if(handle.empty()) {
+            return {end(), false, Handle()};
+        }
+        slot pos = insert_position(KeyOfValue()(handle.node->value));
+        if(pos.parent == nullptr) {
+            return {iterator(pos.existing), false, std::move(handle)};
+        }
+        node_type* node = handle.release();
+        link(node, pos);
+        return {iterator(node), true, Handle()};
+    }
+
+    // 把other中本树没有的键移到本树，只改指针
+    template<typename OtherCompare>
+    void merge(rb_tree<Key, Value, KeyOfValue, OtherCompare, Alloc>& other) noexcept(noexcept(comp(std::declval<const Key&>(), std::declval<const Key&>()))) {
+        for(auto it = other.begin(); it != other.end();) {
+            base_ptr source = it.node;
+            ++it;
+            slot pos = insert_position(KeyOfValue()(static_cast<node_type*>(source)->value));
+            if(pos.parent == nullptr) {
+                continue;
+            }
+            rb_tree_algo::erase_and_rebalance(source, other.header);
+            other.count--;
+            link(static_cast<node_type*>(source), pos);
+        }
+    }
+
+private:
+    template<typename, typename, typename, typename, typename>
+    friend class rb_tree;
+
+    // 插入位置：新节点挂为parent的左(left == true)或右子节点；键已存在时parent为nullptr，existing为相等节点
+    struct slot {
+        base_ptr parent;
+        bool left;
+        base_ptr existing;
+    };
+
+    static const Key& key_of(const rb_node_base* node) noexcept {
+        return KeyOfValue()(static_cast<const node_type*>(node)->value);
+    }
+
+    void reset_header() noexcept {
+        header.color = rb_color::RED;
+        header.parent = nullptr;
+        header.left = header.right = &header;
+    }
+
+    void take_nodes(rb_tree& other) noexcept {
+        if(other.header.parent) {
+            header.parent = other.header.parent;
+            header.left = other.header.left;
+            header.right = other.header.right;
+            header.parent->parent = &header;
+            count = other.count;
+            other.reset_header();
+            other.count = 0;
+        }
+    }
+
+    template<typename K>
+    slot insert_position(const K& key) {
+        base_ptr parent = &header;
+        base_ptr node = header.parent;
+        bool left = true;
+        while(node) {
+            parent = node;
+            left = comp(key, key_of(node));
+            node = left ? node->left : node->right;
+        }
+        base_ptr before = parent;
+        if(left) {
+            if(parent == header.left) {
+                return {parent, true, nullptr};
+            }
+            before = rb_node_base::decrement(parent);
+        }
+        if(comp(key_of(before), key)) {
+            return {parent, left, nullptr};
+        }
+        return {nullptr, false, before};
+    }
+
+    void link(node_type* node, const slot& pos) noexcept {
+        rb_tree_algo::insert_and_rebalance(pos.left, node, pos.parent, header);
+        count++;
+    }
+
+    template<typename K>
+    base_ptr lower_node(const K& key) const {
+        const rb_node_base* result = &header;
+        const rb_node_base* node = header.parent;
+        while(node) {
+            if(!comp(key_of(node), key)) {
+                result = node;
+                node = node->left;
+            }
+            else {
+                node = node->right;
+            }
+        }
+        return const_cast<base_ptr>(result);
+    }
+
+    template<typename K>
+    base_ptr upper_node(const K& key) const {
+        const rb_node_base* result = &header;
+        const rb_node_base* node = header.parent;
+        while(node) {
+            if(comp(key, key_of(node))) {
+                result = node;
+                node = node->left;
+            }
+            else {
+                node = node->right;
+            }
+        }
+        return const_cast<base_ptr>(result);
+    }
+
+    template<typename K>
+    base_ptr find_node(const K& key) const {
+        base_ptr node = lower_node(key);
+        return node == &header || comp(key, key_of(node)) ? const_cast<base_ptr>(&header) : node;
+    }
+
+    template<typename... Args>
+    node_type* create_node(Args&&... args) {
+        node_type* node = cache.acquire(count);
+        try {
+            ::new((void*)&node->value) Value(std::forward<Args>(args)...);
+        } catch (...) {
+            cache.recycle(node);
+            throw;
+        }
+        return node;
+    }
+
+    void destroy_node(node_type* node) noexcept {
+        node->value.~Value();
+        cache.recycle(node);
+    }
+
+    // 后序遍历销毁：只对右子树递归，左子树循环处理
+    void destroy_subtree(base_ptr node) noexcept {
+        while(node) {
+            destroy_subtree(node->right);
+            base_ptr left = node->left;
+            destroy_node(static_cast<node_type*>(node));
+            node = left;
+        }
+    }
+
+    // 本树为空时按other的结构复制全部节点，失败时本树仍为空
+    void clone(const rb_tree& other) {
+        if(other.header.parent) {
+            header.parent = copy_subtree(other.header.parent, &header);
+            header.left = rb_node_base::minimum(header.parent);
+            header.right = rb_node_base::maximum(header.parent);
+            count = other.count;
+        }
+    }
+
+    // 按结构复制子树(含颜色)，构造失败时销毁已复制的部分
+    base_ptr copy_subtree(const rb_node_base* source, base_ptr parent) {
+        node_type* top = create_node(static_cast<const node_type*>(source)->value);
+        top->color = source->color;
+        top->parent = parent;
+        top->left = top->right = nullptr;
+        try {
+            if(source->right) {
+                top->right = copy_subtree(source->right, top);
+            }
+            base_ptr dest = top;
+            for(source = source->left; source; source = source->left) {
+                node_type* node = create_node(static_cast<const node_type*>(source)->value);
+                node->color = source->color;
+                node->left = node->right = nullptr;
+                node->parent = dest;
+                dest->left = node;
+                if(source->right) {
+                    node->right = copy_subtree(source->right, node);
+                }
+                dest = node;
+            }
+        } catch (...) {
+            destroy_subtree(top);
+            throw;
+        }
+        return top;
+    }
+};
+
+} // namespace Cat
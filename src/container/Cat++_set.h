@@ -0,0 +1,160 @@
+#pragma once
+#include "Cat++_rb_tree.h"
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <utility>
+//set
+/*
+基于红黑树的有序集合，接口与std::set一致
+- 节点来自分配器，删除的节点进入容器自带的节点缓存，见Cat++_rb_tree.h
+- 元素不可修改，iterator与const_iterator相同
+*/
+
+namespace Cat {
+
+template<typename Key, typename Compare = std::less<Key>, typename Alloc = alloc_t<Key>>
+class set {
+public:
+    typedef Key                                     key_type;
+    typedef Key                                     value_type;
+    typedef Compare                                 key_compare;
+    typedef Compare                                 value_compare;
+    typedef Alloc                                   allocator_type;
+    typedef size_t                                  size_type;
+    typedef ptrdiff_t                               difference_type;
+    typedef value_type&                             reference;
+    typedef const value_type&                       const_reference;
+
+private:
+    struct identity {
+        const Key& operator()(const Key& value) const noexcept { return value; }
+    };
+    using tree_type = rb_tree<Key, Key, identity, Compare, Alloc>;
+
+    tree_type tree;
+
+public:
+    typedef typename tree_type::const_iterator      iterator;
+    typedef typename tree_type::const_iterator      const_iterator;
+    typedef std::reverse_iterator<iterator>         reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>   const_reverse_iterator;
+    typedef rb_node_handle<Key, Alloc, Key, void>   node_type;
+    typedef rb_insert_return<iterator, node_type>   insert_return_type;
+
+    // 构造函数
+    set() = default;
+    explicit set(const Compare& comp, const Alloc& a = Alloc()) : tree(comp, a) {}
+    explicit set(const Alloc& a) : tree(Compare(), a) {}
+    template<std::input_iterator InputIt>
+    set(InputIt first, InputIt last, const Compare& comp = Compare(), const Alloc& a = Alloc()) : tree(comp, a) {
+        insert(first, last);
+    }
+    set(std::initializer_list<Key> init, const Compare& comp = Compare(), const Alloc& a = Alloc()) : tree(comp, a) {
+        insert(init.begin(), init.end());
+    }
+
+    set& operator=(std::initializer_list<Key> init) {
+        clear();
+        insert(init.begin(), init.end());
+        return *this;
+    }
+
+    allocator_type get_allocator() const noexcept { return tree.get_allocator(); }
+    key_compare key_comp() const { return tree.key_comp(); }
+    value_compare value_comp() const { return tree.key_comp(); }
+
+    // 迭代器
+    iterator begin() const noexcept { return tree.begin(); }
+    iterator cbegin() const noexcept { return tree.begin(); }
+    iterator end() const noexcept { return tree.end(); }
+    iterator cend() const noexcept { return tree.end(); }
+    reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+
+    // 容量
+    bool empty() const noexcept { return tree.empty(); }
+    size_t size() const noexcept { return tree.size(); }
+    size_t max_size() const noexcept { return tree.max_size(); }
+
+    // 节点缓存
+    size_t node_cache_size() const noexcept { return tree.node_cache_size(); }
+    void set_node_cache_limit(size_t limit) noexcept { tree.set_node_cache_limit(limit); }
+    void shrink_node_cache() noexcept { tree.shrink_node_cache(); }
+
+    // 修改
+    void clear() noexcept { tree.clear(); }
+
+    std::pair<iterator, bool> insert(const Key& value) { return tree.try_emplace_unique(value, value); }
+    std::pair<iterator, bool> insert(Key&& value) { return tree.try_emplace_unique(value, std::move(value)); }
+    iterator insert(const_iterator hint, const Key& value) { return tree.emplace_hint_unique(hint, value); }
+    iterator insert(const_iterator hint, Key&& value) { return tree.emplace_hint_unique(hint, std::move(value)); }
+    template<std::input_iterator InputIt>
+    void insert(InputIt first, InputIt last) {
+        for(; first != last; ++first) {
+            tree.emplace_hint_unique(end(), *first);
+        }
+    }
+    void insert(std::initializer_list<Key> init) { insert(init.begin(), init.end()); }
+    insert_return_type insert(node_type&& handle) {
+        auto result = tree.insert_node(std::move(handle));
+        return {result.position, result.inserted, std::move(result.node)};
+    }
+    iterator insert(const_iterator, node_type&& handle) { return tree.insert_node(std::move(handle)).position; }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args) { return tree.emplace_unique(std::forward<Args>(args)...); }
+    template<typename... Args>
+    iterator emplace_hint(const_iterator hint, Args&&... args) { return tree.emplace_hint_unique(hint, std::forward<Args>(args)...); }
+
+    iterator erase(const_iterator pos) noexcept { return tree.erase(pos); }
+    iterator erase(const_iterator first, const_iterator last) noexcept { return tree.erase(first, last); }
+    size_t erase(const Key& key) { return tree.erase_key(key); }
+
+    void swap(set& other) noexcept { tree.swap(other.tree); }
+
+    node_type extract(const_iterator pos) noexcept { return tree.template extract<node_type>(pos); }
+    node_type extract(const Key& key) {
+        const_iterator it = find(key);
+        return it == end() ? node_type() : extract(it);
+    }
+
+    template<typename OtherCompare>
+    void merge(set<Key, OtherCompare, Alloc>& other) { tree.merge(other.tree); }
+    template<typename OtherCompare>
+    void merge(set<Key, OtherCompare, Alloc>&& other) { tree.merge(other.tree); }
+
+    // 查找
+    size_t count(const Key& key) const { return tree.count_key(key); }
+    bool contains(const Key& key) const { return tree.count_key(key) != 0; }
+    iterator find(const Key& key) const { return tree.find(key); }
+    iterator lower_bound(const Key& key) const { return tree.lower_bound(key); }
+    iterator upper_bound(const Key& key) const { return tree.upper_bound(key); }
+    std::pair<iterator, iterator> equal_range(const Key& key) const { return tree.equal_range(key); }
+
+private:
+    template<typename, typename, typename>
+    friend class set;
+};
+
+template<typename Key, typename Compare, typename Alloc>
+bool operator==(const set<Key, Compare, Alloc>& a, const set<Key, Compare, Alloc>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+template<typename Key, typename Compare, typename Alloc>
+bool operator!=(const set<Key, Compare, Alloc>& a, const set<Key, Compare, Alloc>& b) {
+    return !(a == b);
+}
+
+template<typename Key, typename Compare, typename Alloc>
+bool operator<(const set<Key, Compare, Alloc>& a, const set<Key, Compare, Alloc>& b) {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+}
+
+template<typename Key, typename Compare, typename Alloc>
+void swap(set<Key, Compare, Alloc>& a, set<Key, Compare, Alloc>& b) noexcept {
+    a.swap(b);
+}
+
+} // namespace Cat
@@ -0,0 +1,162 @@
+#pragma once
+#include "../Cat++_config.h"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+//单生产者单消费者环形队列
+/*
+固定容量的无锁环形队列，恰好一个线程push、一个线程pop：
+1）容量向上取整到2的幂，下标用按位与取模；head/tail单调递增，head - tail即元素个数
+2）生产者只写head、消费者只写tail，二者各占一个缓存行，互不造成伪共享
+3）生产者缓存最近读到的tail(cached_tail)，只有按缓存判断已满时才去读消费者的缓存行；消费者同理缓存head，
+   队列不空不满时，push/pop都只访问本方的缓存行和元素本身
+4）批量push/pop一次发布整批元素，head/tail各只写一次
+缓冲区由Alloc分配，分配器返回nullptr时抛出OutOfMemoryException
+*/
+
+namespace Cat {
+
+template<typename T, typename Alloc = alloc_t<T>>
+class spsc_ring {
+private:
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct alignas(CACHE_LINE) producer_side {
+        std::atomic<size_t> head{0};       // 下一个写入位置
+        size_t cached_tail = 0;            // 生产者最近读到的tail
+    };
+
+    struct alignas(CACHE_LINE) consumer_side {
+        std::atomic<size_t> tail{0};       // 下一个读取位置
+        size_t cached_head = 0;            // 消费者最近读到的head
+    };
+
+    producer_side producer;
+    consumer_side consumer;
+    alignas(CACHE_LINE) T* buffer;         // 两方只读
+    size_t mask;
+    [[no_unique_address]] Alloc alloc;
+
+    static size_t round_capacity(size_t capacity) noexcept {
+        size_t result = 2;
+        while(result < capacity) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+public:
+    typedef T           value_type;
+    typedef size_t      size_type;
+    typedef Alloc       allocator_type;
+
+    explicit spsc_ring(size_t capacity, const Alloc& a = Alloc()) : mask(round_capacity(capacity) - 1), alloc(a) {
+        buffer = alloc_traits::allocate(alloc, mask + 1);
+        if(buffer == nullptr) {
+            throw OutOfMemoryException();
+        }
+    }
+
+    spsc_ring(const spsc_ring&) = delete;
+    spsc_ring& operator=(const spsc_ring&) = delete;
+
+    ~spsc_ring() {
+        size_t head = producer.head.load(std::memory_order_relaxed);
+        for(size_t i = consumer.tail.load(std::memory_order_relaxed); i != head; i++) {
+            alloc_traits::destroy(alloc, buffer + (i & mask));
+        }
+        alloc_traits::deallocate(alloc, buffer, mask + 1);
+    }
+
+    size_t capacity() const noexcept { return mask + 1; }
+
+    // 元素个数的近似值：另一方可能正在修改
+    size_t size_approx() const noexcept {
+        size_t tail = consumer.tail.load(std::memory_order_acquire);
+        size_t head = producer.head.load(std::memory_order_acquire);
+        return head - tail;
+    }
+
+    bool empty() const noexcept { return size_approx() == 0; }
+
+    // 生产者：队列已满时返回false
+    template<typename... Args>
+    bool try_emplace(Args&&... args) {
+        size_t head = producer.head.load(std::memory_order_relaxed);
+        if(head - producer.cached_tail > mask) {
+            producer.cached_tail = consumer.tail.load(std::memory_order_acquire);
+            if(head - producer.cached_tail > mask) {
+                return false;
+            }
+        }
+        alloc_traits::construct(alloc, buffer + (head & mask), std::forward<Args>(args)...);
+        producer.head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(const T& value) { return try_emplace(value); }
+    bool try_push(T&& value) { return try_emplace(std::move(value)); }
+
+    // 生产者：从first起写入至多count个元素，返回写入的个数
+    template<typename InputIt>
+    size_t try_push_batch(InputIt first, size_t count) {
+        size_t head = producer.head.load(std::memory_order_relaxed);
+        size_t room = capacity() - (head - producer.cached_tail);
+        if(room < count) {
+            producer.cached_tail = consumer.tail.load(std::memory_order_acquire);
+            room = capacity() - (head - producer.cached_tail);
+        }
+        size_t n = count < room ? count : room;
+        for(size_t i = 0; i < n; i++, ++first) {
+            alloc_traits::construct(alloc, buffer + ((head + i) & mask), *first);
+        }
+        if(n) {
+            producer.head.store(head + n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    // 消费者：队列为空时返回false
+    bool try_pop(T& out) {
+        size_t tail = consumer.tail.load(std::memory_order_relaxed);
+        if(tail == consumer.cached_head) {
+            consumer.cached_head = producer.head.load(std::memory_order_acquire);
+            if(tail == consumer.cached_head) {
+                return false;
+            }
+        }
+        T* slot = buffer + (tail & mask);
+        out = std::move(*slot);
+        alloc_traits::destroy(alloc, slot);
+        consumer.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 消费者：至多取出max_count个元素写入out，返回取出的个数
+    template<typename OutputIt>
+    size_t try_pop_batch(OutputIt out, size_t max_count) {
+        size_t tail = consumer.tail.load(std::memory_order_relaxed);
+        size_t available = consumer.cached_head - tail;
+        if(available < max_count) {
+            consumer.cached_head = producer.head.load(std::memory_order_acquire);
+            available = consumer.cached_head - tail;
+        }
+        size_t n = max_count < available ? max_count : available;
+        for(size_t i = 0; i < n; i++, ++out) {
+            T* slot = buffer + ((tail + i) & mask);
+            *out = std::move(*slot);
+            alloc_traits::destroy(alloc, slot);
+        }
+        if(n) {
+            consumer.tail.store(tail + n, std::memory_order_release);
+        }
+        return n;
+    }
+};
+
+} // namespace Cat
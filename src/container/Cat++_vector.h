@@ -0,0 +1,503 @@
+#pragma once
+#include "../Cat++_config.h"
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+//vector
+/*
+连续存储的动态数组，接口与std::vector一致，迭代器即原始指针
+
+扩容策略：
+1）元素可平凡重定位(is_trivially_relocatable)且分配器提供reallocate时，扩容直接调用reallocate：
+   allocator对应realloc，大块常可原地扩展；mmap页来源对应mremap，只改页表不复制数据
+2）其他情况按std::vector的做法：申请新缓冲区，逐个移动构造(移动可能抛异常时复制构造)，析构旧元素，释放旧缓冲区
+容量按2倍增长
+
+元素的构造/析构由vector直接完成，不经过分配器的construct/destroy(它们会吞掉构造函数的异常)
+分配器返回nullptr时抛出OutOfMemoryException
+*/
+
+namespace Cat {
+
+// 可平凡重定位：按字节搬到新地址后无需调用移动构造和析构，默认等价于可平凡复制
+// 自定义类型(如只持有堆指针的类型)可特化为true_type，让vector走reallocate扩容
+template<typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// std::pair的赋值运算符不平凡，但成员都可平凡重定位时pair本身也可以
+template<typename T1, typename T2>
+struct is_trivially_relocatable<std::pair<T1, T2>>
+    : std::bool_constant<is_trivially_relocatable<T1>::value && is_trivially_relocatable<T2>::value> {};
+
+template<typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// 分配器是否提供reallocate(ptr, old_size, new_size)
+template<typename Alloc>
+concept reallocating_allocator = requires(Alloc a, typename Alloc::value_type* p, size_t n) {
+    { a.reallocate(p, n, n) } -> std::same_as<typename Alloc::value_type*>;
+};
+
+template<typename T, typename Alloc = alloc_t<T>>
+class vector {
+private:
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    // 扩容时能否用reallocate代替申请+移动+释放
+    static constexpr bool RELOCATE_BY_REALLOC = is_trivially_relocatable_v<T> && reallocating_allocator<Alloc>;
+
+public:
+    typedef T                                       value_type;
+    typedef Alloc                                   allocator_type;
+    typedef size_t                                  size_type;
+    typedef ptrdiff_t                               difference_type;
+    typedef T&                                      reference;
+    typedef const T&                                const_reference;
+    typedef T*                                      pointer;
+    typedef const T*                                const_pointer;
+    typedef T*                                      iterator;
+    typedef const T*                                const_iterator;
+    typedef std::reverse_iterator<iterator>         reverse_iterator;
+    typedef std::reverse_iterator<const_iterator>   const_reverse_iterator;
+
+private:
+    [[no_unique_address]] Alloc alloc;
+    T* start = nullptr;                                      // 首元素
+    T* finish = nullptr;                                     // 尾后元素
+    T* end_of_storage = nullptr;                             // 缓冲区末尾
+
+public:
+    // 构造函数和析构函数
+    vector() noexcept(noexcept(Alloc())) = default;
+    explicit vector(const Alloc& a) noexcept : alloc(a) {}
+    explicit vector(size_t count, const Alloc& a = Alloc()) : alloc(a) {
+        resize(count);
+    }
+    vector(size_t count, const T& value, const Alloc& a = Alloc()) : alloc(a) {
+        assign(count, value);
+    }
+    template<std::input_iterator InputIt>
+    vector(InputIt first, InputIt last, const Alloc& a = Alloc()) : alloc(a) {
+        assign(first, last);
+    }
+    vector(std::initializer_list<T> init, const Alloc& a = Alloc()) : alloc(a) {
+        assign(init.begin(), init.end());
+    }
+    vector(const vector& other)
+        : alloc(alloc_traits::select_on_container_copy_construction(other.alloc)) {
+        assign(other.begin(), other.end());
+    }
+    vector(const vector& other, const Alloc& a) : alloc(a) {
+        assign(other.begin(), other.end());
+    }
+    vector(vector&& other) noexcept : alloc(std::move(other.alloc)) {
+        steal(other);
+    }
+    vector(vector&& other, const Alloc& a) : alloc(a) {
+        if(alloc == other.alloc) {
+            steal(other);
+        }
+        else {
+            assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        }
+    }
+    ~vector() {
+        release();
+    }
+
+    vector& operator=(const vector& other) {
+        if(this != &other) {
+            if constexpr (alloc_traits::propagate_on_container_copy_assignment::value) {
+                if(alloc != other.alloc) {
+                    release();
+                }
+                alloc = other.alloc;
+            }
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+    vector& operator=(vector&& other) noexcept(alloc_traits::propagate_on_container_move_assignment::value
+                                               || alloc_traits::is_always_equal::value) {
+        if(this == &other) {
+            return *this;
+        }
+        if constexpr (alloc_traits::propagate_on_container_move_assignment::value) {
+            release();
+            alloc = std::move(other.alloc);
+            steal(other);
+        }
+        else {
+            if(alloc == other.alloc) {
+                release();
+                steal(other);
+            }
+            else {
+                assign(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+            }
+        }
+        return *this;
+    }
+    vector& operator=(std::initializer_list<T> init) {
+        assign(init.begin(), init.end());
+        return *this;
+    }
+
+    void assign(size_t count, const T& value) {
+        if(count > capacity()) {
+            vector fresh(alloc);
+            fresh.reserve(count);
+            fresh.finish = std::uninitialized_fill_n(fresh.start, count, value);
+            swap(fresh);
+            return;
+        }
+        size_t common = std::min(count, size());
+        std::fill_n(start, common, value);
+        if(count > common) {
+            finish = std::uninitialized_fill_n(finish, count - common, value);
+        }
+        else {
+            destroy_tail(start + count);
+        }
+    }
+    template<std::input_iterator InputIt>
+    void assign(InputIt first, InputIt last) {
+        if constexpr (std::forward_iterator<InputIt>) {
+            size_t count = std::distance(first, last);
+            if(count > capacity()) {
+                vector fresh(alloc);
+                fresh.reserve(count);
+                fresh.finish = std::uninitialized_copy(first, last, fresh.start);
+                swap(fresh);
+                return;
+            }
+        }
+        T* cursor = start;
+        for(; first != last && cursor != finish; ++first, ++cursor) {
+            *cursor = *first;
+        }
+        if(cursor != finish) {
+            destroy_tail(cursor);
+        }
+        for(; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+    void assign(std::initializer_list<T> init) {
+        assign(init.begin(), init.end());
+    }
+
+    allocator_type get_allocator() const noexcept { return alloc; }
+
+    // 元素访问
+    reference at(size_t pos) {
+        if(pos >= size()) {
+            throw std::out_of_range("Cat::vector::at");
+        }
+        return start[pos];
+    }
+    const_reference at(size_t pos) const {
+        if(pos >= size()) {
+            throw std::out_of_range("Cat::vector::at");
+        }
+        return start[pos];
+    }
+    reference operator[](size_t pos) noexcept { return start[pos]; }
+    const_reference operator[](size_t pos) const noexcept { return start[pos]; }
+    reference front() noexcept { return *start; }
+    const_reference front() const noexcept { return *start; }
+    reference back() noexcept { return *(finish - 1); }
+    const_reference back() const noexcept { return *(finish - 1); }
+    T* data() noexcept { return start; }
+    const T* data() const noexcept { return start; }
+
+    // 迭代器
+    iterator begin() noexcept { return start; }
+    const_iterator begin() const noexcept { return start; }
+    const_iterator cbegin() const noexcept { return start; }
+    iterator end() noexcept { return finish; }
+    const_iterator end() const noexcept { return finish; }
+    const_iterator cend() const noexcept { return finish; }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(finish); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(finish); }
+    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator(finish); }
+    reverse_iterator rend() noexcept { return reverse_iterator(start); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(start); }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator(start); }
+
+    // 容量
+    bool empty() const noexcept { return start == finish; }
+    size_t size() const noexcept { return finish - start; }
+    size_t capacity() const noexcept { return end_of_storage - start; }
+    size_t max_size() const noexcept { return alloc_traits::max_size(alloc); }
+
+    void reserve(size_t new_capacity) {
+        if(new_capacity > capacity()) {
+            reallocate_storage(new_capacity);
+        }
+    }
+    void shrink_to_fit() {
+        if(finish == start) {
+            release();
+        }
+        else if(finish != end_of_storage) {
+            reallocate_storage(size());
+        }
+    }
+
+    // 修改
+    void clear() noexcept {
+        destroy_tail(start);
+    }
+
+    template<typename... Args>
+    reference emplace_back(Args&&... args) {
+        if(finish == end_of_storage) {
+            // 参数可能引用自身元素，先在新缓冲区的尾部构造，再搬运旧元素
+            if constexpr (!RELOCATE_BY_REALLOC) {
+                return grow_and_emplace(std::forward<Args>(args)...);
+            }
+            else {
+                T value(std::forward<Args>(args)...);
+                reallocate_storage(next_capacity(size() + 1));
+                ::new((void*)finish) T(std::move(value));
+                return *finish++;
+            }
+        }
+        ::new((void*)finish) T(std::forward<Args>(args)...);
+        return *finish++;
+    }
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+    void pop_back() noexcept {
+        (--finish)->~T();
+    }
+
+    template<typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        size_t offset = pos - start;
+        emplace_back(std::forward<Args>(args)...);
+        std::rotate(start + offset, finish - 1, finish);
+        return start + offset;
+    }
+    iterator insert(const_iterator pos, const T& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, T&& value) { return emplace(pos, std::move(value)); }
+    iterator insert(const_iterator pos, size_t count, const T& value) {
+        size_t offset = pos - start;
+        if(count > 0) {
+            T copy(value);
+            if(size() + count > capacity()) {
+                reallocate_storage(next_capacity(size() + count));
+            }
+            size_t old_size = size();
+            finish = std::uninitialized_fill_n(finish, count, copy);
+            std::rotate(start + offset, start + old_size, finish);
+        }
+        return start + offset;
+    }
+    // 先追加到尾部，再旋转到pos处
+    template<std::input_iterator InputIt>
+    iterator insert(const_iterator pos, InputIt first, InputIt last) {
+        size_t offset = pos - start;
+        size_t old_size = size();
+        if constexpr (std::forward_iterator<InputIt>) {
+            size_t count = std::distance(first, last);
+            if(size() + count > capacity()) {
+                reallocate_storage(next_capacity(size() + count));
+            }
+            finish = std::uninitialized_copy(first, last, finish);
+        }
+        else {
+            for(; first != last; ++first) {
+                emplace_back(*first);
+            }
+        }
+        std::rotate(start + offset, start + old_size, finish);
+        return start + offset;
+    }
+    iterator insert(const_iterator pos, std::initializer_list<T> init) {
+        return insert(pos, init.begin(), init.end());
+    }
+
+    iterator erase(const_iterator pos) {
+        return erase(pos, pos + 1);
+    }
+    iterator erase(const_iterator first, const_iterator last) {
+        T* from = start + (first - start);
+        if(first != last) {
+            destroy_tail(std::move(start + (last - start), finish, from));
+        }
+        return from;
+    }
+
+    void resize(size_t count) {
+        if(count < size()) {
+            destroy_tail(start + count);
+            return;
+        }
+        reserve(count);
+        for(; size() < count; ++finish) {
+            ::new((void*)finish) T();
+        }
+    }
+    void resize(size_t count, const T& value) {
+        if(count < size()) {
+            destroy_tail(start + count);
+            return;
+        }
+        if(count > capacity()) {
+            T copy(value);
+            reserve(count);
+            finish = std::uninitialized_fill_n(finish, count - size(), copy);
+            return;
+        }
+        finish = std::uninitialized_fill_n(finish, count - size(), value);
+    }
+
+    void swap(vector& other) noexcept {
+        if constexpr (alloc_traits::propagate_on_container_swap::value) {
+            std::swap(alloc, other.alloc);
+        }
+        std::swap(start, other.start);
+        std::swap(finish, other.finish);
+        std::swap(end_of_storage, other.end_of_storage);
+    }
+
+private:
+    size_t next_capacity(size_t needed) const noexcept {
+        size_t doubled = capacity() * 2;
+        return doubled > needed ? doubled : needed;
+    }
+
+    T* allocate_storage(size_t count) {
+        T* result = alloc_traits::allocate(alloc, count);
+        if(result == nullptr) {
+            throw OutOfMemoryException();
+        }
+        return result;
+    }
+
+    // 把缓冲区换成new_capacity(>= size())个元素的大小
+    void reallocate_storage(size_t new_capacity) {
+        size_t count = size();
+        T* fresh;
+        if constexpr (RELOCATE_BY_REALLOC) {
+            fresh = start ? alloc.reallocate(start, capacity(), new_capacity) : allocate_storage(new_capacity);
+            if(fresh == nullptr) {
+                throw OutOfMemoryException();
+            }
+        }
+        else {
+            fresh = allocate_storage(new_capacity);
+            try {
+                relocate_elements(fresh);
+            } catch (...) {
+                alloc_traits::deallocate(alloc, fresh, new_capacity);
+                throw;
+            }
+            release();
+        }
+        start = fresh;
+        finish = fresh + count;
+        end_of_storage = fresh + new_capacity;
+    }
+
+    // 扩容并在新缓冲区尾部构造元素，构造成功后才搬运旧元素，args可以引用旧元素
+    template<typename... Args>
+    reference grow_and_emplace(Args&&... args) {
+        size_t count = size();
+        size_t new_capacity = next_capacity(count + 1);
+        T* fresh = allocate_storage(new_capacity);
+        try {
+            ::new((void*)(fresh + count)) T(std::forward<Args>(args)...);
+        } catch (...) {
+            alloc_traits::deallocate(alloc, fresh, new_capacity);
+            throw;
+        }
+        try {
+            relocate_elements(fresh);
+        } catch (...) {
+            (fresh + count)->~T();
+            alloc_traits::deallocate(alloc, fresh, new_capacity);
+            throw;
+        }
+        release();
+        start = fresh;
+        finish = fresh + count + 1;
+        end_of_storage = fresh + new_capacity;
+        return *(finish - 1);
+    }
+
+    // 把全部元素构造到fresh：移动构造不抛异常(或不可复制)时移动，否则复制，保证扩容失败时原元素不变
+    void relocate_elements(T* fresh) {
+        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
+            std::uninitialized_move(start, finish, fresh);
+        }
+        else {
+            std::uninitialized_copy(start, finish, fresh);
+        }
+    }
+
+    void destroy_tail(T* new_finish) noexcept {
+        std::destroy(new_finish, finish);
+        finish = new_finish;
+    }
+
+    // 析构全部元素并释放缓冲区
+    void release() noexcept {
+        if(start) {
+            std::destroy(start, finish);
+            alloc_traits::deallocate(alloc, start, capacity());
+        }
+        start = finish = end_of_storage = nullptr;
+    }
+
+    void steal(vector& other) noexcept {
+        start = other.start;
+        finish = other.finish;
+        end_of_storage = other.end_of_storage;
+        other.start = other.finish = other.end_of_storage = nullptr;
+    }
+};
+
+template<typename T, typename Alloc>
+bool operator==(const vector<T, Alloc>& a, const vector<T, Alloc>& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+}
+
+template<typename T, typename Alloc>
+bool operator!=(const vector<T, Alloc>& a, const vector<T, Alloc>& b) {
+    return !(a == b);
+}
+
+template<typename T, typename Alloc>
+bool operator<(const vector<T, Alloc>& a, const vector<T, Alloc>& b) {
+    return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+}
+
+template<typename T, typename Alloc>
+bool operator>(const vector<T, Alloc>& a, const vector<T, Alloc>& b) {
+    return b < a;
+}
+
+template<typename T, typename Alloc>
+bool operator<=(const vector<T, Alloc>& a, const vector<T, Alloc>& b) {
+    return !(b < a);
+}
+
+template<typename T, typename Alloc>
+bool operator>=(const vector<T, Alloc>& a, const vector<T, Alloc>& b) {
+    return !(a < b);
+}
+
+template<typename T, typename Alloc>
+void swap(vector<T, Alloc>& a, vector<T, Alloc>& b) noexcept {
+    a.swap(b);
+}
+
+} // namespace Cat
@@ -0,0 +1,400 @@
+#pragma once
+#include "../container/Cat++_mpmc_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+//工作窃取线程池
+/*
+fork-join式的线程池，供并行算法(见Cat++_parallel_algorithm.h)使用：
+1）每个工作线程一个Chase-Lev双端队列：本线程在底部压入/弹出(LIFO，缓存热)，其他线程从顶部窃取(FIFO，拿走最大的子任务)
+2）fork_join(a, b)：把b压入本线程队列，当场执行a，再尝试弹回b自己执行；b已被窃取时一边等待一边执行其他任务
+3）任务帧(task_frame)放在fork_join的栈上，不申请内存；等待期间帧一直有效
+4）外部线程通过run(f)提交根任务：放入注入队列(linked_mpmc_queue)，在条件变量上阻塞等待完成；在工作线程内调用run直接执行
+5）空闲的工作线程先自旋窃取，之后在epoch上等待(std::atomic::wait)；压入任务时只有存在休眠线程才唤醒
+任务中抛出的异常在fork_join/run的调用处重新抛出
+*/
+
+/*
+Chase-Lev双端队列(Lê等人的C11版本，关键操作用seq_cst，不依赖单独的栅栏)：
+- bottom只由所属线程写；top由窃取者与所属线程在只剩一个元素时用CAS竞争
+- 数组满时换一个两倍大的数组，旧数组留到队列析构时释放(窃取者可能仍在读)
+*/
+
+namespace Cat {
+
+class thread_pool;
+
+namespace detail {
+
+// 外部线程等待根任务用；done须在持锁时置位，等待者才能在返回后立即销毁帧
+struct task_waiter {
+    std::mutex mutex;
+    std::condition_variable ready;
+};
+
+struct pool_task {
+    void (*invoke)(pool_task*);
+    std::atomic<bool> done{false};
+    task_waiter* waiter = nullptr;                           // 非空：外部线程在等待
+    std::exception_ptr error;
+
+    // done置位后帧随时可能被销毁，之后不再访问this
+    void execute() noexcept {
+        invoke(this);
+        task_waiter* w = waiter;
+        if(w == nullptr) {
+            done.store(true, std::memory_order_release);
+            return;
+        }
+        std::lock_guard<std::mutex> lock(w->mutex);
+        done.store(true, std::memory_order_release);
+        w->ready.notify_all();
+    }
+};
+
+template<typename F>
+struct task_frame : pool_task {
+    F& function;
+
+    explicit task_frame(F& f) : function(f) {
+        invoke = [](pool_task* self) {
+            task_frame* frame = static_cast<task_frame*>(self);
+            try {
+                frame->function();
+            } catch (...) {
+                frame->error = std::current_exception();
+            }
+        };
+    }
+};
+
+class work_deque {
+private:
+    struct ring {
+        int64_t capacity;
+        std::unique_ptr<std::atomic<pool_task*>[]> slots;
+        explicit ring(int64_t size) : capacity(size), slots(new std::atomic<pool_task*>[size]) {}
+        pool_task* get(int64_t i) const noexcept { return slots[i & (capacity - 1)].load(std::memory_order_relaxed); }
+        void put(int64_t i, pool_task* task) noexcept { slots[i & (capacity - 1)].store(task, std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    std::atomic<ring*> array;
+    std::vector<std::unique_ptr<ring>> rings;                // 全部用过的数组，析构时释放
+
+    ring* grow(ring* old, int64_t t, int64_t b) {
+        rings.push_back(std::make_unique<ring>(old->capacity * 2));
+        ring* bigger = rings.back().get();
+        for(int64_t i = t; i < b; i++) {
+            bigger->put(i, old->get(i));
+        }
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+public:
+    static constexpr int64_t INITIAL_CAPACITY = 256;
+
+    work_deque() {
+        rings.push_back(std::make_unique<ring>(INITIAL_CAPACITY));
+        array.store(rings.back().get(), std::memory_order_relaxed);
+    }
+
+    work_deque(const work_deque&) = delete;
+    work_deque& operator=(const work_deque&) = delete;
+
+    // 所属线程：压入底部
+    void push(pool_task* task) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        ring* a = array.load(std::memory_order_relaxed);
+        if(b - t > a->capacity - 1) {
+            a = grow(a, t, b);
+        }
+        a->put(b, task);
+        // seq_cst：与空闲线程登记休眠(sleepers)构成Dekker式的先写后读，见thread_pool::notify
+        bottom.store(b + 1, std::memory_order_seq_cst);
+    }
+
+    // 所属线程：从底部弹出，空时返回nullptr
+    pool_task* pop() noexcept {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        ring* a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_seq_cst);
+        if(t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        pool_task* task = a->get(b);
+        if(t == b) {
+            // 只剩一个元素，与窃取者竞争
+            if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                task = nullptr;
+            }
+            bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return task;
+    }
+
+    // 其他线程：从顶部窃取，空或竞争失败时返回nullptr
+    pool_task* steal() noexcept {
+        int64_t t = top.load(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_seq_cst);
+        if(t >= b) {
+            return nullptr;
+        }
+        ring* a = array.load(std::memory_order_acquire);
+        pool_task* task = a->get(t);
+        if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return task;
+    }
+
+    bool empty() const noexcept {
+        return top.load(std::memory_order_seq_cst) >= bottom.load(std::memory_order_seq_cst);
+    }
+};
+
+} // namespace detail
+
+class thread_pool {
+private:
+    using task = detail::pool_task;
+
+    static constexpr int SPIN_ROUNDS = 64;                   // 休眠前的空转轮数(每轮窃取一遍并yield)
+
+    struct alignas(64) worker {
+        detail::work_deque deque;
+        uint64_t random_state;
+    };
+
+    std::vector<std::unique_ptr<worker>> workers;
+    std::vector<std::thread> threads;
+    linked_mpmc_queue<task*> injected;                       // 外部线程提交的根任务
+    std::atomic<size_t> injected_count{0};
+    std::atomic<uint32_t> epoch{0};                          // 唤醒计数，休眠线程在其上等待
+    std::atomic<int> sleepers{0};
+    std::atomic<bool> stopping{false};
+
+    static inline thread_local thread_pool* current_pool = nullptr;
+    static inline thread_local worker* current_worker = nullptr;
+
+    void notify() noexcept {
+        if(sleepers.load(std::memory_order_seq_cst) > 0) {
+            epoch.fetch_add(1, std::memory_order_seq_cst);
+            epoch.notify_one();
+        }
+    }
+
+    task* steal_from_others(worker& self) noexcept {
+        size_t count = workers.size();
+        if(count < 2) {
+            return nullptr;
+        }
+        // xorshift选起点，依次尝试其他线程
+        self.random_state ^= self.random_state << 13;
+        self.random_state ^= self.random_state >> 7;
+        self.random_state ^= self.random_state << 17;
+        size_t start = (size_t)(self.random_state % count);
+        for(size_t i = 0; i < count; i++) {
+            worker& victim = *workers[(start + i) % count];
+            if(&victim == &self) {
+                continue;
+            }
+            if(task* stolen = victim.deque.steal()) {
+                return stolen;
+            }
+        }
+        return nullptr;
+    }
+
+    task* find_work(worker& self) {
+        if(task* own = self.deque.pop()) {
+            return own;
+        }
+        if(injected_count.load(std::memory_order_acquire) != 0) {
+            task* root;
+            if(injected.try_pop(root)) {
+                injected_count.fetch_sub(1, std::memory_order_relaxed);
+                return root;
+            }
+        }
+        return steal_from_others(self);
+    }
+
+    bool has_visible_work() const noexcept {
+        if(injected_count.load(std::memory_order_seq_cst) != 0) {
+            return true;
+        }
+        for(const std::unique_ptr<worker>& w : workers) {
+            if(!w->deque.empty()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void worker_loop(worker& self) {
+        current_pool = this;
+        current_worker = &self;
+        int idle = 0;
+        while(!stopping.load(std::memory_order_acquire)) {
+            if(task* next = find_work(self)) {
+                next->execute();
+                idle = 0;
+                continue;
+            }
+            if(++idle < SPIN_ROUNDS) {
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t seen = epoch.load(std::memory_order_seq_cst);
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            if(!has_visible_work() && !stopping.load(std::memory_order_seq_cst)) {
+                epoch.wait(seen, std::memory_order_seq_cst);
+            }
+            sleepers.fetch_sub(1, std::memory_order_seq_cst);
+            idle = 0;
+        }
+        current_pool = nullptr;
+        current_worker = nullptr;
+    }
+
+    // 等待本线程压入的任务完成：先尝试弹回自己执行，已被窃取则执行其他任务直到它完成
+    void join(task& pending) {
+        worker& self = *current_worker;
+        while(!pending.done.load(std::memory_order_acquire)) {
+            if(task* next = find_work(self)) {
+                next->execute();
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+public:
+    // workers个工作线程，0表示硬件线程数
+    explicit thread_pool(unsigned worker_count = 0) {
+        if(worker_count == 0) {
+            worker_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for(unsigned i = 0; i < worker_count; i++) {
+            workers.push_back(std::make_unique<worker>());
+            workers.back()->random_state = 0x9E3779B97F4A7C15ull * (i + 1);
+        }
+        for(unsigned i = 0; i < worker_count; i++) {
+            threads.emplace_back([this, i] { worker_loop(*workers[i]); });
+        }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    // 析构前应等待已提交的任务完成
+    ~thread_pool() {
+        stopping.store(true, std::memory_order_seq_cst);
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        epoch.notify_all();
+        for(std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // 进程内共用的线程池(硬件线程数个工作线程)
+    static thread_pool& get_default() {
+        static thread_pool instance;
+        return instance;
+    }
+
+    size_t size() const noexcept { return workers.size(); }
+
+    // 当前线程是否是本线程池的工作线程
+    bool in_worker() const noexcept { return current_pool == this; }
+
+    // 在线程池中执行f并等待完成；工作线程内调用时直接执行
+    template<typename F>
+    void run(F&& f) {
+        if(in_worker()) {
+            f();
+            return;
+        }
+        detail::task_waiter waiter;
+        detail::task_frame<F> frame(f);
+        frame.waiter = &waiter;
+        injected_count.fetch_add(1, std::memory_order_seq_cst);
+        injected.push(&frame);
+        notify();
+        {
+            std::unique_lock<std::mutex> lock(waiter.mutex);
+            waiter.ready.wait(lock, [&] { return frame.done.load(std::memory_order_acquire); });
+        }
+        if(frame.error) {
+            std::rethrow_exception(frame.error);
+        }
+    }
+
+    // 并行执行a与b，二者都完成后返回；不在工作线程内时经由run进入线程池
+    template<typename A, typename B>
+    void fork_join(A&& a, B&& b) {
+        if(!in_worker()) {
+            run([&] { fork_join(a, b); });
+            return;
+        }
+        detail::task_frame<B> frame(b);
+        current_worker->deque.push(&frame);
+        notify();
+        std::exception_ptr error;
+        try {
+            a();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        // 帧在栈上：无论a是否抛出，都须等b完成
+        task* top = current_worker->deque.pop();
+        if(top == &frame) {
+            frame.execute();
+        }
+        else {
+            if(top != nullptr) {
+                // 弹出的是a留下的任务(a正常返回时不会发生)，放回去
+                current_worker->deque.push(top);
+            }
+            join(frame);
+        }
+        if(error) {
+            std::rethrow_exception(error);
+        }
+        if(frame.error) {
+            std::rethrow_exception(frame.error);
+        }
+    }
+
+    // 把[begin, end)二分到不超过grain的小段，对每段并行调用body(lo, hi)
+    template<typename F>
+    void parallel_for(size_t begin, size_t end, size_t grain, F&& body) {
+        if(grain == 0) {
+            grain = 1;
+        }
+        if(end - begin <= grain) {
+            body(begin, end);
+            return;
+        }
+        size_t middle = begin + (end - begin) / 2;
+        fork_join([&] { parallel_for(begin, middle, grain, body); },
+                  [&] { parallel_for(middle, end, grain, body); });
+    }
+};
+
+} // namespace Cat
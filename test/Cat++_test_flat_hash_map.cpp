@@ -0,0 +1,278 @@
+#include "container/Cat++_flat_hash_map.h"
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+//flat_hash_map与std::unordered_map的差分测试
+/*
+同一串随机操作同时作用于Cat::flat_hash_map与std::unordered_map，每批操作后逐元素比较：
+1）insert/emplace/try_emplace/insert_or_assign/operator[]/erase(键、迭代器)的混合，值为std::string(移动不抛异常，墓碑原地重排)
+2）std::string作键(pair<const std::string, T>移动时复制键，墓碑清除走同容量的新数组)：元素数恒定的插入/删除循环不扩容
+3）Hash与KeyEqual带is_transparent时，用std::string_view与const char*查找、删除
+4）可平凡重定位的值配合带reallocate的分配器：reserve/rehash与插入时的扩容调用reallocate，元素不丢失
+5）控制字节组的匹配与逐字节定义一致
+CMakeLists.txt另用CAT_HASH_SSE2=0把本文件编译为test_flat_hash_scalar，在逐字节比较的路径上再跑一遍
+*/
+
+namespace {
+
+struct realloc_counter {
+    static inline long reallocations = 0;
+};
+
+// 用malloc/realloc实现、统计reallocate次数的分配器
+template<typename T>
+struct counting_realloc_allocator {
+    using value_type = T;
+
+    counting_realloc_allocator() noexcept = default;
+    template<typename U>
+    counting_realloc_allocator(const counting_realloc_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return static_cast<T*>(malloc(n * sizeof(T))); }
+    void deallocate(T* ptr, size_t) noexcept { free(ptr); }
+    T* reallocate(T* ptr, size_t, size_t new_size) {
+        realloc_counter::reallocations++;
+        return static_cast<T*>(realloc((void*)ptr, new_size * sizeof(T)));
+    }
+
+    template<typename U>
+    bool operator==(const counting_realloc_allocator<U>&) const noexcept { return true; }
+};
+
+// 带is_transparent的字符串哈希，可直接用std::string_view与const char*查找
+struct string_hash {
+    using is_transparent = void;
+    size_t operator()(std::string_view text) const noexcept { return std::hash<std::string_view>()(text); }
+};
+
+template<typename Map, typename Expected>
+bool same(const Map& map, const Expected& expected) {
+    if(map.size() != expected.size()) {
+        return false;
+    }
+    size_t iterated = 0;
+    for(const auto& value : map) {
+        auto it = expected.find(value.first);
+        if(it == expected.end() || !(it->second == value.second)) {
+            return false;
+        }
+        iterated++;
+    }
+    for(const auto& value : expected) {
+        auto it = map.find(value.first);
+        if(it == map.end() || !(it->second == value.second)) {
+            return false;
+        }
+    }
+    return iterated == expected.size();
+}
+
+std::string key_text(uint64_t i) {
+    return "key-" + std::to_string(i) + std::string(i % 24, '#');         // 长短混合，含堆上的字符串
+}
+
+} // namespace
+
+CAT_TEST(flat_hash_map_matches_std) {
+    std::mt19937_64 rng(21);
+    Cat::flat_hash_map<long, std::string> mine;
+    std::unordered_map<long, std::string> expected;
+    for(int round = 0; round < 200000; round++) {
+        long key = (long)(rng() % 5000);
+        std::string value = key_text(rng() % 100);
+        switch(rng() % 8) {
+        case 0:
+            CAT_CHECK(mine.insert({key, value}).second == expected.insert({key, value}).second);
+            break;
+        case 1:
+            CAT_CHECK(mine.emplace(key, value).second == expected.emplace(key, value).second);
+            break;
+        case 2:
+            CAT_CHECK(mine.try_emplace(key, value).second == expected.try_emplace(key, value).second);
+            break;
+        case 3:
+            CAT_CHECK(mine.insert_or_assign(key, value).second == expected.insert_or_assign(key, value).second);
+            break;
+        case 4:
+            mine[key] += "x";
+            expected[key] += "x";
+            break;
+        case 5:
+        case 6:
+            CAT_CHECK(mine.erase(key) == expected.erase(key));
+            break;
+        default: {
+            auto it = mine.find(key);
+            CAT_REQUIRE((it == mine.end()) == (expected.find(key) == expected.end()));
+            if(it != mine.end()) {
+                CAT_CHECK(it->second == expected[key]);
+                expected.erase(key);
+                mine.erase(it);
+            }
+            break;
+        }
+        }
+        if(round % 4096 == 0) {
+            CAT_REQUIRE(same(mine, expected));
+        }
+    }
+    CAT_CHECK(same(mine, expected));
+    CAT_CHECK(mine.load_factor() <= mine.max_load_factor());
+
+    // 边遍历边删除，erase返回下一个元素
+    for(auto it = mine.begin(); it != mine.end();) {
+        if(it->first % 3 == 0) {
+            expected.erase(it->first);
+            it = mine.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    CAT_CHECK(same(mine, expected));
+
+    Cat::flat_hash_map<long, std::string> copy(mine);
+    CAT_CHECK(copy == mine);
+    Cat::flat_hash_map<long, std::string> moved(std::move(copy));
+    CAT_CHECK(moved == mine && copy.empty() && copy.begin() == copy.end());
+    copy = moved;
+    CAT_CHECK(same(copy, expected));
+    mine.clear();
+    CAT_CHECK(mine.empty() && mine.begin() == mine.end());
+    mine.rehash(0);
+    CAT_CHECK(mine.bucket_count() == 0);
+}
+
+CAT_TEST(flat_hash_map_churn_keeps_capacity) {
+    constexpr size_t LIVE = 1000;
+    constexpr size_t ROUNDS = 200000;
+
+    // std::string作键：pair<const std::string, long>移动可能抛异常，墓碑清除走同容量的新数组
+    Cat::flat_hash_map<std::string, long> strings;
+    std::unordered_map<std::string, long> expected_strings;
+    // long作键：可平凡重定位，墓碑原地重排
+    Cat::flat_hash_map<long, long> longs;
+    for(size_t i = 0; i < LIVE; i++) {
+        strings.emplace(key_text(i), (long)i);
+        expected_strings.emplace(key_text(i), (long)i);
+        longs.emplace((long)i, (long)i);
+    }
+    size_t string_buckets = strings.bucket_count();
+    size_t long_buckets = longs.bucket_count();
+    CAT_CHECK(string_buckets == long_buckets);
+    for(size_t i = LIVE; i < ROUNDS; i++) {
+        CAT_REQUIRE(strings.erase(key_text(i - LIVE)) == 1);
+        expected_strings.erase(key_text(i - LIVE));
+        strings.emplace(key_text(i), (long)i);
+        expected_strings.emplace(key_text(i), (long)i);
+        CAT_REQUIRE(longs.erase((long)(i - LIVE)) == 1);
+        longs.emplace((long)i, (long)i);
+        if(i % 8192 == 0) {
+            CAT_REQUIRE(same(strings, expected_strings));
+        }
+    }
+    CAT_CHECK(same(strings, expected_strings));
+    CAT_CHECK(strings.bucket_count() == string_buckets);
+    CAT_CHECK(longs.bucket_count() == long_buckets);
+    CAT_CHECK(longs.size() == LIVE);
+}
+
+CAT_TEST(flat_hash_map_heterogeneous_lookup) {
+    Cat::flat_hash_map<std::string, int, string_hash, std::equal_to<>> map;
+    for(int i = 0; i < 1000; i++) {
+        map.emplace(key_text((uint64_t)i), i);
+    }
+    for(int i = 0; i < 1000; i++) {
+        std::string text = key_text((uint64_t)i);
+        std::string_view view = text;
+        auto it = map.find(view);
+        CAT_REQUIRE(it != map.end());
+        CAT_CHECK(it->second == i);
+        CAT_CHECK(map.contains(text.c_str()));
+        CAT_CHECK(map.count(view) == 1);
+    }
+    CAT_CHECK(!map.contains(std::string_view("missing")));
+    CAT_CHECK(map.count("missing") == 0);
+    CAT_CHECK(map.erase(std::string_view("key-7#######")) == 1);
+    CAT_CHECK(map.erase("key-7#######") == 0);
+    CAT_CHECK(map.size() == 999);
+
+    const auto& constant = map;
+    CAT_CHECK(constant.find(std::string_view("key-8########"))->second == 8);
+}
+
+CAT_TEST(flat_hash_map_reserve_through_reallocate) {
+    using alloc = counting_realloc_allocator<std::pair<const long, long>>;
+    Cat::flat_hash_map<long, long, std::hash<long>, std::equal_to<long>, alloc> map;
+    std::unordered_map<long, long> expected;
+    std::mt19937_64 rng(22);
+    for(int i = 0; i < 3000; i++) {
+        long key = (long)(rng() % 100000);
+        map.emplace(key, i);
+        expected.emplace(key, i);
+    }
+    CAT_CHECK(realloc_counter::reallocations > 0);           // 插入时的扩容
+    CAT_CHECK(same(map, expected));
+
+    long before = realloc_counter::reallocations;
+    map.reserve(100000);
+    CAT_CHECK(realloc_counter::reallocations == before + 1);
+    CAT_CHECK(map.bucket_count() >= 100000);
+    CAT_CHECK(same(map, expected));
+
+    before = realloc_counter::reallocations;
+    size_t buckets = map.bucket_count();
+    map.rehash(buckets * 2);
+    CAT_CHECK(realloc_counter::reallocations == before + 1);
+    CAT_CHECK(map.bucket_count() == buckets * 2);
+    CAT_CHECK(same(map, expected));
+
+    // 缩小容量时申请新数组
+    map.rehash(0);
+    CAT_CHECK(map.bucket_count() < buckets);
+    CAT_CHECK(map.load_factor() <= map.max_load_factor());
+    CAT_CHECK(same(map, expected));
+
+    for(auto it = expected.begin(); it != expected.end();) {
+        if(it->first % 2) {
+            CAT_CHECK(map.erase(it->first) == 1);
+            it = expected.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    map.rehash(0);
+    CAT_CHECK(same(map, expected));
+}
+
+CAT_TEST(flat_hash_map_probe_group_matches_bytes) {
+    using ctrl_t = Cat::probe_group::ctrl_t;
+    std::mt19937 rng(23);
+    const ctrl_t specials[] = {Cat::probe_group::EMPTY, Cat::probe_group::DELETED, Cat::probe_group::SENTINEL, 0, 0x7F};
+    for(int round = 0; round < 10000; round++) {
+        alignas(16) ctrl_t bytes[Cat::probe_group::WIDTH];
+        for(ctrl_t& c : bytes) {
+            c = rng() % 2 ? specials[rng() % 5] : ctrl_t(rng() % 128);
+        }
+        Cat::probe_group group(bytes);
+        ctrl_t tag = ctrl_t(rng() % 128);
+        uint32_t match = 0;
+        uint32_t empty = 0;
+        uint32_t free = 0;
+        for(size_t i = 0; i < Cat::probe_group::WIDTH; i++) {
+            match |= uint32_t(bytes[i] == tag) << i;
+            empty |= uint32_t(bytes[i] == Cat::probe_group::EMPTY) << i;
+            free |= uint32_t(bytes[i] < 0) << i;
+        }
+        CAT_CHECK(group.match(tag) == match);
+        CAT_CHECK(group.match_empty() == empty);
+        CAT_CHECK(group.match_free() == free);
+    }
+}
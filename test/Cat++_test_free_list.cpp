@@ -0,0 +1,187 @@
+#include "alloc/Cat++_free_list.h"
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+//free_list<true>并发测试
+/*
+THREADS个线程在同一个带版本号的Treiber栈上随机混合push、pop、push_chain、push_all、pop_all：
+1）每个节点有一个所有者标记，取得节点的线程用exchange登记自己，登记前的值必须是“无人持有”，
+   否则说明同一节点被两个线程同时取得(ABA或丢失更新)
+2）交还节点前先清除标记，再挂回栈
+3）结束后全部节点回到栈中，pop_all数出的节点恰好每个一次
+*/
+
+namespace {
+
+constexpr int THREADS = 4;
+constexpr size_t NODES = 1024;
+constexpr int ROUNDS = 500000;
+constexpr int FREE = -1;
+
+struct shared_state {
+    Cat::free_list<true> list;
+    std::vector<Cat::free_list_node> nodes = std::vector<Cat::free_list_node>(NODES);
+    std::vector<std::atomic<int>> owner = std::vector<std::atomic<int>>(NODES);
+
+    size_t index_of(Cat::free_list_node* node) const { return (size_t)(node - nodes.data()); }
+};
+
+void claim(shared_state& state, Cat::free_list_node* node, int self) {
+    size_t index = state.index_of(node);
+    CAT_REQUIRE(index < NODES);
+    int previous = state.owner[index].exchange(self, std::memory_order_acq_rel);
+    CAT_CHECK(previous == FREE);
+}
+
+void release(shared_state& state, Cat::free_list_node* node) {
+    state.owner[state.index_of(node)].store(FREE, std::memory_order_release);
+}
+
+void worker(shared_state& state, int self) {
+    std::vector<Cat::free_list_node*> held;
+    uint64_t random = 0x9E3779B97F4A7C15ull * (self + 1);
+    for(int round = 0; round < ROUNDS; round++) {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        switch(random % 8) {
+        case 0: case 1: case 2: {
+            if(Cat::free_list_node* node = state.list.pop()) {
+                claim(state, node, self);
+                held.push_back(node);
+            }
+            break;
+        }
+        case 3: case 4: {
+            if(!held.empty()) {
+                Cat::free_list_node* node = held.back();
+                held.pop_back();
+                release(state, node);
+                state.list.push(node);
+            }
+            break;
+        }
+        case 5: case 6: {
+            // 把手上至多8个节点串成一段一次挂回
+            size_t count = held.size() < 8 ? held.size() : 8;
+            if(count == 0) {
+                break;
+            }
+            Cat::free_list_node* first = held[held.size() - count];
+            for(size_t i = held.size() - count; i < held.size(); i++) {
+                release(state, held[i]);
+                held[i]->block = i + 1 < held.size() ? held[i + 1] : nullptr;
+            }
+            Cat::free_list_node* last = held.back();
+            held.resize(held.size() - count);
+            if((random >> 8) & 1) {
+                state.list.push_all(first);
+            }
+            else {
+                state.list.push_chain(first, last);
+            }
+            break;
+        }
+        default: {
+            if(random % 64 == 7) {
+                for(Cat::free_list_node* node = state.list.pop_all(); node;) {
+                    Cat::free_list_node* next = node->block;
+                    claim(state, node, self);
+                    held.push_back(node);
+                    node = next;
+                }
+            }
+            break;
+        }
+        }
+    }
+    for(Cat::free_list_node* node : held) {
+        release(state, node);
+        state.list.push(node);
+    }
+}
+
+} // namespace
+
+CAT_TEST(free_list_concurrent_ownership) {
+    shared_state state;
+    for(std::atomic<int>& o : state.owner) {
+        o.store(FREE, std::memory_order_relaxed);
+    }
+    for(Cat::free_list_node& node : state.nodes) {
+        state.list.push(&node);
+    }
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < THREADS; t++) {
+        threads.emplace_back(worker, std::ref(state), t);
+    }
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<int> seen(NODES, 0);
+    size_t count = 0;
+    for(Cat::free_list_node* node = state.list.pop_all(); node; node = node->block) {
+        size_t index = state.index_of(node);
+        CAT_REQUIRE(index < NODES);
+        seen[index]++;
+        count++;
+        CAT_CHECK(state.owner[index].load() == FREE);
+    }
+    CAT_CHECK(count == NODES);
+    for(size_t i = 0; i < NODES; i++) {
+        CAT_CHECK(seen[i] == 1);
+    }
+}
+
+CAT_TEST(free_list_single_thread_order) {
+    Cat::free_list<true> list;
+    Cat::free_list_node nodes[4];
+    CAT_CHECK(list.empty());
+    list.push(&nodes[0]);
+    nodes[1].block = &nodes[2];
+    list.push_chain(&nodes[1], &nodes[2]);
+    CAT_CHECK(list.pop() == &nodes[1]);
+    CAT_CHECK(list.pop() == &nodes[2]);
+    list.push(&nodes[3]);
+    Cat::free_list_node* all = list.pop_all();
+    CAT_CHECK(all == &nodes[3]);
+    CAT_CHECK(all->block == &nodes[0]);
+    CAT_CHECK(nodes[0].block == nullptr);
+    CAT_CHECK(list.empty());
+}
+
+namespace {
+
+template<bool threads>
+void check_push_all() {
+    Cat::free_list_node nodes[6];
+    for(int i = 0; i < 5; i++) {
+        nodes[i].block = &nodes[i + 1];
+    }
+    nodes[2].block = nullptr;                       // 两条链：0-1-2与3-4-5
+    nodes[5].block = nullptr;
+
+    Cat::free_list<threads> list;
+    list.push_all(&nodes[3]);                       // 栈为空：整条链直接成为栈
+    CAT_CHECK(list.top() == &nodes[3]);
+    list.push_all(&nodes[0]);                       // 栈不空：栈上已有的节点接到链前
+    const int expected[] = {3, 4, 5, 0, 1, 2};
+    int count = 0;
+    for(Cat::free_list_node* node = list.pop_all(); node; node = node->block) {
+        CAT_REQUIRE(count < 6);
+        CAT_CHECK(node == &nodes[expected[count++]]);
+    }
+    CAT_CHECK(count == 6);
+    CAT_CHECK(list.empty());
+}
+
+} // namespace
+
+CAT_TEST(free_list_push_all_keeps_every_node) {
+    check_push_all<false>();
+    check_push_all<true>();
+}
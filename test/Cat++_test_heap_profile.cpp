@@ -0,0 +1,74 @@
+#include "Cat++_config.h"
+#include "alloc/Cat++_heap_profile.h"
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+#include <cstddef>
+#include <vector>
+//重分配失败时采样堆分析的记账
+/*
+reallocate失败时旧块仍在用，它的样本必须保留；成功后旧样本注销、新块按新大小采样：
+1）failing_page_source：reallocate总是失败的mmap页来源，确定地走pool_allocator大块路径的失败分支
+2）采样间隔设为1字节，每次分配都被采样，在用对象数即在用样本数
+*/
+
+namespace {
+
+struct failing_page_source : Cat::mmap_page_source {
+    static void* reallocate(void*, size_t, size_t) noexcept { return nullptr; }
+};
+
+constexpr size_t LARGE = 64 * 1024;      // 超过内存池上限，走页来源
+
+double live_objects() {
+    double total = 0;
+    for(const Cat::heap_site& site : Cat::heap_profiler::snapshot()) {
+        total += site.live_objects;
+    }
+    return total;
+}
+
+// 采样开启后每次分配都被采样，结束时清空，不影响其他用例
+struct sample_everything {
+    sample_everything() {
+        Cat::heap_profiler::reset();
+        Cat::heap_profiler::start(1);
+    }
+    ~sample_everything() {
+        Cat::heap_profiler::stop();
+        Cat::heap_profiler::reset();
+    }
+};
+
+template<class PageSource>
+void check_reallocate_sample(bool expect_failure) {
+    using alloc = Cat::pool_allocator<true, std::byte, PageSource>;
+    sample_everything profiler;
+    std::byte* ptr = alloc().allocate(LARGE);
+    CAT_REQUIRE(ptr != nullptr);
+    CAT_CHECK(live_objects() > 0.5 && live_objects() < 1.5);
+
+    std::byte* grown = alloc().reallocate(ptr, LARGE, 2 * LARGE);
+    CAT_CHECK((grown == nullptr) == expect_failure);
+    if(grown == nullptr) {
+        CAT_CHECK(live_objects() > 0.5 && live_objects() < 1.5);      // 旧块的样本仍在
+        alloc().deallocate(ptr, LARGE);
+    }
+    else {
+        CAT_CHECK(live_objects() > 0.5 && live_objects() < 1.5);      // 旧样本注销，新块一个样本
+        alloc().deallocate(grown, 2 * LARGE);
+    }
+    CAT_CHECK(live_objects() < 0.5);
+}
+
+} // namespace
+
+#if CAT_HAS_MMAP
+
+CAT_TEST(heap_profile_page_source_realloc_failure) {
+    check_reallocate_sample<failing_page_source>(true);
+}
+
+CAT_TEST(heap_profile_page_source_realloc_success) {
+    check_reallocate_sample<Cat::mmap_page_source>(false);
+}
+
+#endif
@@ -0,0 +1,369 @@
+#include "container/Cat++_list.h"
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+//list与std::list的差分测试
+/*
+同一串随机操作同时作用于Cat::list与std::list，每批操作后逐元素比较：
+1）push/pop/insert(单个、n个、区间)/erase/resize/assign
+2）splice(整段、单个、区间，含同一链表内)、merge(带稳定性检验)、sort、unique、remove、reverse
+3）节点缓存：用计数分配器统计申请/释放次数，clear后再填充(push、insert n个、区间insert、拷贝赋值)不访问分配器
+4）区间insert中途构造抛异常时原链表不变，已构造的值全部析构，节点回到缓存
+*/
+
+namespace {
+
+struct alloc_counter {
+    static inline long allocations = 0;
+    static inline long deallocations = 0;
+};
+
+// 统计节点申请/释放次数的分配器
+template<typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() noexcept = default;
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        alloc_counter::allocations++;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* ptr, size_t n) noexcept {
+        alloc_counter::deallocations++;
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template<typename U>
+    bool operator==(const counting_allocator<U>&) const noexcept { return true; }
+};
+
+long live_nodes() {
+    return alloc_counter::allocations - alloc_counter::deallocations;
+}
+
+struct test_failure : std::runtime_error {
+    test_failure() : std::runtime_error("injected failure") {}
+};
+
+// 拷贝构造第copies_left次时抛异常，live统计存活对象数
+struct fragile {
+    static inline int copies_left = -1;             // 小于0时不抛
+    static inline long live = 0;
+
+    int value;
+
+    fragile(int v) : value(v) { live++; }
+    fragile(const fragile& other) : value(other.value) {
+        if(copies_left == 0) {
+            throw test_failure();
+        }
+        if(copies_left > 0) {
+            copies_left--;
+        }
+        live++;
+    }
+    fragile& operator=(const fragile&) = default;
+    ~fragile() { live--; }
+
+    bool operator==(const fragile& other) const { return value == other.value; }
+};
+
+template<typename A, typename B>
+bool same(const A& a, const B& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), b.end())
+           && std::equal(a.rbegin(), a.rend(), b.rbegin(), b.rend());
+}
+
+// 第index个元素的迭代器(index可为size，即end())
+template<typename List>
+auto at(List& list, size_t index) {
+    return std::next(list.begin(), (ptrdiff_t)index);
+}
+
+} // namespace
+
+CAT_TEST(list_matches_std) {
+    std::mt19937 rng(1);
+    Cat::list<int> mine;
+    std::list<int> expected;
+    for(int round = 0; round < 20000; round++) {
+        int value = (int)(rng() % 1000);
+        size_t pos = rng() % (expected.size() + 1);
+        switch(rng() % 10) {
+        case 0: mine.push_back(value); expected.push_back(value); break;
+        case 1: mine.push_front(value); expected.push_front(value); break;
+        case 2:
+            if(!expected.empty()) {
+                mine.pop_back();
+                expected.pop_back();
+            }
+            break;
+        case 3:
+            if(!expected.empty()) {
+                mine.pop_front();
+                expected.pop_front();
+            }
+            break;
+        case 4:
+            CAT_CHECK(*mine.insert(at(mine, pos), value) == *expected.insert(at(expected, pos), value));
+            break;
+        case 5: {
+            size_t n = rng() % 5;
+            mine.insert(at(mine, pos), n, value);
+            expected.insert(at(expected, pos), n, value);
+            break;
+        }
+        case 6: {
+            std::vector<int> values(rng() % 6, value);
+            std::iota(values.begin(), values.end(), value);
+            mine.insert(at(mine, pos), values.begin(), values.end());
+            expected.insert(at(expected, pos), values.begin(), values.end());
+            break;
+        }
+        case 7:
+            if(pos < expected.size()) {
+                size_t last = pos + rng() % (expected.size() - pos + 1);
+                auto it = mine.erase(at(mine, pos), at(mine, last));
+                auto expected_it = expected.erase(at(expected, pos), at(expected, last));
+                CAT_CHECK(std::distance(mine.begin(), it) == std::distance(expected.begin(), expected_it));
+            }
+            break;
+        case 8: {
+            size_t n = expected.size() + rng() % 5 - 2;
+            if(n < 200) {
+                mine.resize(n, value);
+                expected.resize(n, value);
+            }
+            break;
+        }
+        default:
+            if(rng() % 50 == 0) {
+                std::vector<int> values(rng() % 20, value);
+                mine.assign(values.begin(), values.end());
+                expected.assign(values.begin(), values.end());
+            }
+            break;
+        }
+        if(round % 64 == 0) {
+            CAT_REQUIRE(same(mine, expected));
+        }
+    }
+    CAT_CHECK(same(mine, expected));
+
+    Cat::list<int> copy(mine);
+    CAT_CHECK(copy == mine);
+    Cat::list<int> moved(std::move(copy));
+    CAT_CHECK(moved == mine && copy.empty());
+    copy = moved;
+    CAT_CHECK(copy == mine);
+}
+
+CAT_TEST(list_splice_merge_sort_match_std) {
+    std::mt19937 rng(2);
+    for(int round = 0; round < 200; round++) {
+        std::vector<int> a_values(rng() % 40);
+        std::vector<int> b_values(rng() % 40);
+        for(int& x : a_values) x = (int)(rng() % 50);
+        for(int& x : b_values) x = (int)(rng() % 50);
+        Cat::list<int> a(a_values.begin(), a_values.end());
+        Cat::list<int> b(b_values.begin(), b_values.end());
+        std::list<int> expected_a(a_values.begin(), a_values.end());
+        std::list<int> expected_b(b_values.begin(), b_values.end());
+
+        size_t pos = rng() % (expected_a.size() + 1);
+        switch(round % 4) {
+        case 0:
+            a.splice(at(a, pos), b);
+            expected_a.splice(at(expected_a, pos), expected_b);
+            break;
+        case 1:
+            if(!expected_b.empty()) {
+                size_t from = rng() % expected_b.size();
+                a.splice(at(a, pos), b, at(b, from));
+                expected_a.splice(at(expected_a, pos), expected_b, at(expected_b, from));
+            }
+            break;
+        case 2: {
+            size_t first = rng() % (expected_b.size() + 1);
+            size_t last = first + rng() % (expected_b.size() - first + 1);
+            a.splice(at(a, pos), b, at(b, first), at(b, last));
+            expected_a.splice(at(expected_a, pos), expected_b, at(expected_b, first), at(expected_b, last));
+            break;
+        }
+        default:
+            // 同一链表内：把[first, last)移到pos，pos不在区间内
+            if(expected_a.size() >= 2) {
+                size_t first = rng() % expected_a.size();
+                size_t last = first + 1 + rng() % (expected_a.size() - first);
+                size_t to = first > 0 && rng() % 2 ? rng() % first : last + rng() % (expected_a.size() - last + 1);
+                a.splice(at(a, to), a, at(a, first), at(a, last));
+                expected_a.splice(at(expected_a, to), expected_a, at(expected_a, first), at(expected_a, last));
+            }
+            break;
+        }
+        CAT_REQUIRE(same(a, expected_a));
+        CAT_REQUIRE(same(b, expected_b));
+
+        a.sort();
+        b.sort(std::greater<>());
+        expected_a.sort();
+        expected_b.sort(std::greater<>());
+        CAT_CHECK(same(a, expected_a));
+        CAT_CHECK(same(b, expected_b));
+
+        b.reverse();
+        expected_b.reverse();
+        a.merge(b);
+        expected_a.merge(expected_b);
+        CAT_CHECK(same(a, expected_a));
+        CAT_CHECK(b.empty());
+
+        int target = (int)(rng() % 50);
+        CAT_CHECK(a.remove(target) == expected_a.remove(target));
+        CAT_CHECK(a.unique() == expected_a.unique());
+        CAT_CHECK(same(a, expected_a));
+    }
+}
+
+CAT_TEST(list_merge_and_sort_are_stable) {
+    using item = std::pair<int, int>;
+    auto by_key = [](const item& x, const item& y) { return x.first < y.first; };
+    std::mt19937 rng(3);
+    std::vector<item> values(5000);
+    for(size_t i = 0; i < values.size(); i++) {
+        values[i] = {(int)(rng() % 16), (int)i};
+    }
+    Cat::list<item> mine(values.begin(), values.end());
+    std::list<item> expected(values.begin(), values.end());
+    mine.sort(by_key);
+    expected.sort(by_key);
+    CAT_CHECK(same(mine, expected));
+
+    Cat::list<item> other(values.begin(), values.begin() + 1000);
+    std::list<item> expected_other(values.begin(), values.begin() + 1000);
+    other.sort(by_key);
+    expected_other.sort(by_key);
+    mine.merge(other, by_key);
+    expected.merge(expected_other, by_key);
+    CAT_CHECK(same(mine, expected));
+}
+
+CAT_TEST(list_node_cache_reuses_nodes) {
+    using counted_list = Cat::list<int, counting_allocator<int>>;
+    constexpr size_t N = 1000;
+    std::vector<int> values(N);
+    std::iota(values.begin(), values.end(), 0);
+    {
+        counted_list list;
+        for(size_t i = 0; i < N; i++) {
+            list.push_back((int)i);
+        }
+        long filled = alloc_counter::allocations;
+        list.clear();
+        CAT_CHECK(list.node_cache_size() == N);
+
+        for(int round = 0; round < 3; round++) {
+            for(size_t i = 0; i < N; i++) {
+                list.push_front((int)i);
+            }
+            list.clear();
+            list.insert(list.end(), N, 7);
+            list.clear();
+            list.insert(list.end(), values.begin(), values.end());
+            list.clear();
+        }
+        CAT_CHECK(alloc_counter::allocations == filled);
+
+        // 拷贝赋值复用已有节点与缓存
+        counted_list source(values.begin(), values.end());
+        filled = alloc_counter::allocations;
+        list = source;
+        list.clear();
+        list = source;
+        CAT_CHECK(alloc_counter::allocations == filled);
+        CAT_CHECK(list == source);
+
+        // 缓存上限：多出的节点归还分配器
+        list.clear();
+        list.set_node_cache_limit(10);
+        CAT_CHECK(list.node_cache_size() == 10);
+        list.shrink_node_cache();
+        CAT_CHECK(list.node_cache_size() == 0);
+        CAT_CHECK(live_nodes() == (long)source.size() + (long)source.node_cache_size());
+    }
+    CAT_CHECK(live_nodes() == 0);
+}
+
+CAT_TEST(list_range_insert_exception_safety) {
+    using fragile_list = Cat::list<fragile, counting_allocator<fragile>>;
+    std::vector<fragile> source;
+    for(int i = 0; i < 100; i++) {
+        source.emplace_back(i);
+    }
+    long live_before = fragile::live;
+    {
+        fragile_list list;
+        for(int i = 0; i < 10; i++) {
+            list.emplace_back(-i);
+        }
+        list.clear();                                   // 缓存中留10个节点
+        for(int i = 0; i < 5; i++) {
+            list.emplace_back(-i);
+        }
+        std::vector<int> before;
+        for(const fragile& x : list) {
+            before.push_back(x.value);
+        }
+        long nodes_before = live_nodes();
+
+        for(int fail_at : {0, 3, 50}) {
+            fragile::copies_left = fail_at;
+            bool thrown = false;
+            try {
+                list.insert(std::next(list.begin(), 2), source.begin(), source.end());
+            } catch (const test_failure&) {
+                thrown = true;
+            }
+            fragile::copies_left = -1;
+            CAT_CHECK(thrown);
+            // 原链表不变，已构造的值已析构，节点都回到本链表的缓存或归还分配器
+            CAT_REQUIRE(list.size() == before.size());
+            CAT_CHECK(std::equal(before.begin(), before.end(), list.begin(),
+                                 [](int v, const fragile& x) { return v == x.value; }));
+            CAT_CHECK(fragile::live == live_before + (long)list.size());
+            CAT_CHECK(live_nodes() == (long)list.size() + (long)list.node_cache_size());
+            CAT_CHECK(live_nodes() >= nodes_before);
+        }
+
+        // insert(pos, n, value)同样不变
+        fragile::copies_left = 3;
+        bool thrown = false;
+        try {
+            list.insert(list.begin(), 10, source[0]);
+        } catch (const test_failure&) {
+            thrown = true;
+        }
+        fragile::copies_left = -1;
+        CAT_CHECK(thrown);
+        CAT_CHECK(list.size() == before.size());
+        CAT_CHECK(fragile::live == live_before + (long)list.size());
+
+        list.insert(list.end(), source.begin(), source.end());
+        CAT_CHECK(list.size() == before.size() + source.size());
+        CAT_CHECK(list.back().value == 99);
+    }
+    CAT_CHECK(fragile::live == live_before);
+    CAT_CHECK(live_nodes() == 0);
+}
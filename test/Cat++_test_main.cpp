@@ -0,0 +1,9 @@
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+//单元测试入口
+/*
+test/下的各文件用CAT_TEST注册用例，这里统一运行；test_alloc 子串...只运行名字包含子串的用例
+*/
+
+int main(int argc, char** argv) {
+    return Cat::UnitTest::runAll(argc, argv);
+}
@@ -0,0 +1,386 @@
+#include "container/Cat++_map.h"
+#include "container/Cat++_set.h"
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+//map/set与std::map/std::set的差分测试
+/*
+同一串随机操作同时作用于Cat::map与std::map(set同理)，每批操作后正反两个方向逐元素比较：
+1）insert/emplace/try_emplace/insert_or_assign/operator[]/erase(键、位置、区间)与lower_bound/upper_bound/find
+2）extract后改键再insert、insert到另一个容器、merge：与std::版本结果相同，且整个过程不访问分配器
+3）节点缓存：用计数分配器统计申请次数，clear后再填充与反复拷贝赋值不访问分配器
+4）区间insert中途构造抛异常：已插入的元素保留(与std::map相同的基本保证)，已构造的值全部析构，节点不泄漏；
+   拷贝赋值失败时容器为空
+*/
+
+namespace {
+
+struct alloc_counter {
+    static inline long allocations = 0;
+    static inline long deallocations = 0;
+};
+
+// 统计节点申请/释放次数的分配器
+template<typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() noexcept = default;
+    template<typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        alloc_counter::allocations++;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* ptr, size_t n) noexcept {
+        alloc_counter::deallocations++;
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template<typename U>
+    bool operator==(const counting_allocator<U>&) const noexcept { return true; }
+};
+
+long live_nodes() {
+    return alloc_counter::allocations - alloc_counter::deallocations;
+}
+
+struct test_failure : std::runtime_error {
+    test_failure() : std::runtime_error("injected failure") {}
+};
+
+// 拷贝构造第copies_left次时抛异常，live统计存活对象数
+struct fragile {
+    static inline int copies_left = -1;             // 小于0时不抛
+    static inline long live = 0;
+
+    int value;
+
+    fragile(int v) : value(v) { live++; }
+    fragile(const fragile& other) : value(other.value) {
+        if(copies_left == 0) {
+            throw test_failure();
+        }
+        if(copies_left > 0) {
+            copies_left--;
+        }
+        live++;
+    }
+    fragile& operator=(const fragile&) = default;
+    ~fragile() { live--; }
+
+    bool operator<(const fragile& other) const { return value < other.value; }
+    bool operator==(const fragile& other) const { return value == other.value; }
+};
+
+template<typename A, typename B>
+bool same(const A& a, const B& b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), b.end())
+           && std::equal(a.rbegin(), a.rend(), b.rbegin(), b.rend());
+}
+
+// it与expected_it指向相同的元素，或同为end()
+template<typename A, typename B>
+bool same_position(const A& a, typename A::const_iterator it, const B& b, typename B::const_iterator expected_it) {
+    if(expected_it == b.end()) {
+        return it == a.end();
+    }
+    return it != a.end() && *it == *expected_it;
+}
+
+} // namespace
+
+CAT_TEST(map_matches_std) {
+    std::mt19937 rng(11);
+    Cat::map<int, std::string> mine;
+    std::map<int, std::string> expected;
+    for(int round = 0; round < 50000; round++) {
+        int key = (int)(rng() % 2000);
+        std::string value = std::to_string(rng() % 100);
+        value.append(rng() % 30, 'v');                                                        // 长短混合
+        switch(rng() % 10) {
+        case 0: {
+            auto [it, inserted] = mine.insert({key, value});
+            auto [expected_it, expected_inserted] = expected.insert({key, value});
+            CAT_CHECK(inserted == expected_inserted && *it == *expected_it);
+            break;
+        }
+        case 1: {
+            auto [it, inserted] = mine.emplace(key, value);
+            CAT_CHECK(inserted == expected.emplace(key, value).second && it->first == key);
+            break;
+        }
+        case 2:
+            CAT_CHECK(mine.try_emplace(key, value).second == expected.try_emplace(key, value).second);
+            break;
+        case 3:
+            CAT_CHECK(mine.insert_or_assign(key, value).second == expected.insert_or_assign(key, value).second);
+            break;
+        case 4:
+            mine[key] += "x";
+            expected[key] += "x";
+            break;
+        case 5: {
+            // 带提示插入：提示有时正确(lower_bound)，有时随意
+            auto hint = rng() % 2 ? mine.lower_bound(key) : mine.begin();
+            auto expected_hint = rng() % 2 ? expected.lower_bound(key) : expected.begin();
+            CAT_CHECK(mine.emplace_hint(hint, key, value)->first == expected.emplace_hint(expected_hint, key, value)->first);
+            break;
+        }
+        case 6:
+        case 7:
+            CAT_CHECK(mine.erase(key) == expected.erase(key));
+            break;
+        case 8: {
+            auto it = mine.lower_bound(key);
+            auto expected_it = expected.lower_bound(key);
+            CAT_REQUIRE(same_position(mine, it, expected, expected_it));
+            if(it != mine.end()) {
+                auto next = mine.erase(it);
+                auto expected_next = expected.erase(expected_it);
+                CAT_CHECK(same_position(mine, next, expected, expected_next));
+            }
+            break;
+        }
+        default: {
+            CAT_CHECK(same_position(mine, mine.upper_bound(key), expected, expected.upper_bound(key)));
+            CAT_CHECK(same_position(mine, mine.find(key), expected, expected.find(key)));
+            CAT_CHECK(mine.count(key) == expected.count(key));
+            if(rng() % 200 == 0) {
+                int last = key + (int)(rng() % 200);
+                mine.erase(mine.lower_bound(key), mine.lower_bound(last));
+                expected.erase(expected.lower_bound(key), expected.lower_bound(last));
+            }
+            break;
+        }
+        }
+        if(round % 256 == 0) {
+            CAT_REQUIRE(same(mine, expected));
+        }
+    }
+    CAT_CHECK(same(mine, expected));
+
+    Cat::map<int, std::string> copy(mine);
+    CAT_CHECK(copy == mine);
+    Cat::map<int, std::string> moved(std::move(copy));
+    CAT_CHECK(moved == mine && copy.empty());
+    copy = moved;
+    CAT_CHECK(same(copy, expected));
+    bool thrown = false;
+    try {
+        (void)mine.at(-1);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    CAT_CHECK(thrown);
+}
+
+CAT_TEST(set_matches_std) {
+    std::mt19937 rng(12);
+    Cat::set<int> mine;
+    std::set<int> expected;
+    for(int round = 0; round < 50000; round++) {
+        int key = (int)(rng() % 5000);
+        switch(rng() % 4) {
+        case 0:
+        case 1:
+            CAT_CHECK(mine.insert(key).second == expected.insert(key).second);
+            break;
+        case 2:
+            CAT_CHECK(mine.erase(key) == expected.erase(key));
+            break;
+        default:
+            CAT_CHECK(same_position(mine, mine.lower_bound(key), expected, expected.lower_bound(key)));
+            if(rng() % 500 == 0) {
+                mine.erase(mine.lower_bound(key), mine.upper_bound(key + 300));
+                expected.erase(expected.lower_bound(key), expected.upper_bound(key + 300));
+            }
+            break;
+        }
+        if(round % 256 == 0) {
+            CAT_REQUIRE(same(mine, expected));
+        }
+    }
+    CAT_CHECK(same(mine, expected));
+    mine.erase(mine.begin(), mine.end());
+    CAT_CHECK(mine.empty() && mine.begin() == mine.end());
+}
+
+CAT_TEST(map_extract_insert_merge_match_std) {
+    using counted_map = Cat::map<int, int, std::less<int>, counting_allocator<std::pair<const int, int>>>;
+    std::mt19937 rng(13);
+    for(int round = 0; round < 100; round++) {
+        counted_map a;
+        counted_map b;
+        std::map<int, int> expected_a;
+        std::map<int, int> expected_b;
+        for(int i = 0; i < 200; i++) {
+            int key = (int)(rng() % 300);
+            a.emplace(key, i);
+            expected_a.emplace(key, i);
+            key = (int)(rng() % 300);
+            b.emplace(key, -i);
+            expected_b.emplace(key, -i);
+        }
+        long allocations = alloc_counter::allocations;
+
+        // 摘下、改键、挂回：键冲突时节点留在返回的句柄中
+        for(int i = 0; i < 50; i++) {
+            int key = (int)(rng() % 300);
+            int new_key = (int)(rng() % 400);
+            auto handle = a.extract(key);
+            auto expected_handle = expected_a.extract(key);
+            CAT_REQUIRE(handle.empty() == expected_handle.empty());
+            if(handle.empty()) {
+                continue;
+            }
+            CAT_CHECK(handle.mapped() == expected_handle.mapped());
+            handle.key() = new_key;
+            expected_handle.key() = new_key;
+            auto& target = rng() % 2 ? a : b;
+            auto& expected_target = &target == &a ? expected_a : expected_b;
+            auto result = target.insert(std::move(handle));
+            auto expected_result = expected_target.insert(std::move(expected_handle));
+            CAT_CHECK(result.inserted == expected_result.inserted);
+            CAT_CHECK(result.node.empty() == expected_result.node.empty());
+            CAT_CHECK(result.position->first == expected_result.position->first);
+            if(!result.node.empty()) {
+                CAT_CHECK(result.node.key() == new_key);
+                CAT_CHECK(result.node.mapped() == expected_result.node.mapped());
+                // 重新插入失败的节点换个不冲突的键放回a
+                result.node.key() = 1000 + i;
+                expected_result.node.key() = 1000 + i;
+                a.insert(std::move(result.node));
+                expected_a.insert(std::move(expected_result.node));
+            }
+        }
+        CAT_CHECK(same(a, expected_a));
+        CAT_CHECK(same(b, expected_b));
+
+        a.merge(b);
+        expected_a.merge(expected_b);
+        CAT_CHECK(same(a, expected_a));
+        CAT_CHECK(same(b, expected_b));                  // b中只剩键冲突的元素
+        CAT_CHECK(alloc_counter::allocations == allocations);
+    }
+    CAT_CHECK(live_nodes() == 0);
+
+    // set的句柄
+    Cat::set<int> s = {1, 2, 3};
+    Cat::set<int> t = {3, 4};
+    auto handle = s.extract(2);
+    CAT_REQUIRE(!handle.empty());
+    handle.value() = 5;
+    CAT_CHECK(t.insert(std::move(handle)).inserted);
+    t.merge(s);
+    CAT_CHECK(same(t, std::set<int>{1, 3, 4, 5}));
+    CAT_CHECK(same(s, std::set<int>{3}));
+}
+
+CAT_TEST(map_node_cache_reuses_nodes) {
+    using counted_map = Cat::map<int, int, std::less<int>, counting_allocator<std::pair<const int, int>>>;
+    constexpr int N = 1000;
+    {
+        counted_map map;
+        for(int i = 0; i < N; i++) {
+            map.emplace(i, i);
+        }
+        long filled = alloc_counter::allocations;
+        map.clear();
+        CAT_CHECK(map.node_cache_size() == (size_t)N);
+        for(int round = 0; round < 3; round++) {
+            for(int i = N; i > 0; i--) {
+                map[i] = i;
+            }
+            map.clear();
+        }
+        CAT_CHECK(alloc_counter::allocations == filled);
+
+        // 拷贝赋值：先清空再从缓存取节点复制，反复赋值不访问分配器
+        counted_map source;
+        for(int i = 0; i < N; i++) {
+            source.emplace(i * 7 % N, i);
+        }
+        map.emplace(1, 1);
+        filled = alloc_counter::allocations;
+        for(int round = 0; round < 3; round++) {
+            map = source;
+            CAT_CHECK(map == source);
+        }
+        CAT_CHECK(alloc_counter::allocations == filled);
+        CAT_CHECK(map.node_cache_size() == 0);
+
+        map.clear();
+        map.set_node_cache_limit(10);
+        CAT_CHECK(map.node_cache_size() == 10);
+        map.shrink_node_cache();
+        CAT_CHECK(live_nodes() == (long)source.size() + (long)source.node_cache_size());
+    }
+    CAT_CHECK(live_nodes() == 0);
+}
+
+CAT_TEST(map_range_insert_exception_safety) {
+    using fragile_set = Cat::set<fragile, std::less<fragile>, counting_allocator<fragile>>;
+    std::vector<fragile> source;
+    for(int i = 0; i < 100; i++) {
+        source.emplace_back(i * 3);
+    }
+    long live_before = fragile::live;
+    {
+        fragile_set set;
+        std::set<int> expected;
+        for(int i = 0; i < 20; i++) {
+            set.emplace(i * 5);
+            expected.insert(i * 5);
+        }
+        for(int fail_at : {0, 7, 60}) {
+            fragile::copies_left = fail_at;
+            bool thrown = false;
+            try {
+                set.insert(source.begin(), source.end());
+            } catch (const test_failure&) {
+                thrown = true;
+            }
+            fragile::copies_left = -1;
+            CAT_CHECK(thrown);
+            // 抛出前插入的元素保留，其余不变
+            for(int i = 0; i < fail_at; i++) {
+                expected.insert(source[(size_t)i].value);
+            }
+            CAT_REQUIRE(set.size() == expected.size());
+            CAT_CHECK(std::equal(set.begin(), set.end(), expected.begin(),
+                                 [](const fragile& x, int v) { return x.value == v; }));
+            CAT_CHECK(fragile::live == live_before + (long)set.size());
+            CAT_CHECK(live_nodes() == (long)set.size() + (long)set.node_cache_size());
+        }
+
+        // 拷贝赋值中途失败：本容器为空，已复制的节点回到缓存
+        fragile_set other;
+        other.insert(source.begin(), source.end());
+        fragile::copies_left = 30;
+        bool thrown = false;
+        try {
+            set = other;
+        } catch (const test_failure&) {
+            thrown = true;
+        }
+        fragile::copies_left = -1;
+        CAT_CHECK(thrown);
+        CAT_CHECK(set.empty() && set.begin() == set.end());
+        CAT_CHECK(fragile::live == live_before + (long)other.size());
+        set = other;
+        CAT_CHECK(set == other);
+    }
+    CAT_CHECK(fragile::live == live_before);
+    CAT_CHECK(live_nodes() == 0);
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <unistd.h>
+//测试用的进程内存读数
+/*
+resident_bytes()：/proc/self/statm的第二项(常驻页数) × 页大小，读取失败时返回0
+*/
+
+namespace Cat::test {
+
+inline size_t resident_bytes() {
+    FILE* statm = fopen("/proc/self/statm", "r");
+    if(statm == nullptr) {
+        return 0;
+    }
+    unsigned long total = 0;
+    unsigned long resident = 0;
+    int fields = fscanf(statm, "%lu %lu", &total, &resident);
+    fclose(statm);
+    return fields == 2 ? (size_t)resident * (size_t)sysconf(_SC_PAGESIZE) : 0;
+}
+
+} // namespace Cat::test
@@ -0,0 +1,174 @@
+#include "container/Cat++_mpmc_queue.h"
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+//mpmc_queue / linked_mpmc_queue并发测试
+/*
+PRODUCERS个生产者与CONSUMERS个消费者在同一个队列上，随机混合单个与批量的push/pop：
+1）元素编码为 生产者编号 * ITEMS + 序号，每个元素有一个“已取出”标记，消费者取出时用exchange登记，
+   登记前的值必须是0，否则说明同一元素被取出了两次
+2）同一消费者看到的同一生产者的元素序号严格递增(各生产者的元素按push次序出队)
+3）结束后取出的总数恰好等于push的总数，每个标记恰好为1，队列为空
+有界队列的容量取得很小，让生产者频繁遇到队满、try_push_batch被截断，格子也反复回绕
+*/
+
+namespace {
+
+constexpr int PRODUCERS = 2;
+constexpr int CONSUMERS = 2;
+constexpr uint64_t ITEMS = 100000;
+constexpr uint64_t TOTAL = PRODUCERS * ITEMS;
+constexpr size_t MAX_BATCH = 16;
+constexpr size_t CAPACITY = 64;
+
+struct shared_state {
+    std::vector<std::atomic<uint8_t>> seen = std::vector<std::atomic<uint8_t>>(TOTAL);
+    std::atomic<uint64_t> popped{0};
+};
+
+uint64_t next_random(uint64_t& random) {
+    random ^= random << 13;
+    random ^= random >> 7;
+    random ^= random << 17;
+    return random;
+}
+
+// 有界队列：队满时返回实际写入的个数
+size_t push_some(Cat::mpmc_queue<uint64_t>& queue, const uint64_t* first, size_t count, bool batch) {
+    if(batch) {
+        return queue.try_push_batch(first, count);
+    }
+    return queue.try_push(*first) ? 1 : 0;
+}
+
+// 链表队列：总能写入
+size_t push_some(Cat::linked_mpmc_queue<uint64_t>& queue, const uint64_t* first, size_t count, bool batch) {
+    if(batch) {
+        queue.push_batch(first, count);
+        return count;
+    }
+    queue.push(*first);
+    return 1;
+}
+
+template<typename Queue>
+void producer(Queue& queue, int self) {
+    uint64_t random = 0x9E3779B97F4A7C15ull * (self + 1);
+    uint64_t staged[MAX_BATCH];
+    uint64_t sequence = 0;
+    while(sequence < ITEMS) {
+        size_t count = 1 + next_random(random) % MAX_BATCH;
+        if(count > ITEMS - sequence) {
+            count = (size_t)(ITEMS - sequence);
+        }
+        for(size_t i = 0; i < count; i++) {
+            staged[i] = self * ITEMS + sequence + i;
+        }
+        // 截断时从已写入的位置继续
+        size_t written = 0;
+        while(written < count) {
+            size_t n = push_some(queue, staged + written, count - written, next_random(random) % 2 == 0);
+            if(n == 0) {
+                std::this_thread::yield();
+            }
+            written += n;
+        }
+        sequence += count;
+    }
+}
+
+template<typename Queue>
+void consumer(Queue& queue, shared_state& state, int self) {
+    uint64_t random = 0xC2B2AE3D27D4EB4Full * (self + 1);
+    std::vector<int64_t> last(PRODUCERS, -1);
+    uint64_t received[MAX_BATCH];
+    while(state.popped.load(std::memory_order_relaxed) < TOTAL) {
+        size_t n;
+        if(next_random(random) % 2 == 0) {
+            n = queue.try_pop_batch(received, 1 + next_random(random) % MAX_BATCH);
+        }
+        else {
+            n = queue.try_pop(received[0]) ? 1 : 0;
+        }
+        if(n == 0) {
+            std::this_thread::yield();
+            continue;
+        }
+        for(size_t i = 0; i < n; i++) {
+            uint64_t item = received[i];
+            CAT_REQUIRE(item < TOTAL);
+            CAT_CHECK(state.seen[item].exchange(1, std::memory_order_acq_rel) == 0);
+            uint64_t from = item / ITEMS;
+            int64_t sequence = (int64_t)(item % ITEMS);
+            CAT_CHECK(sequence > last[from]);
+            last[from] = sequence;
+        }
+        state.popped.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+template<typename Queue>
+void run_concurrent(Queue& queue) {
+    shared_state state;
+    std::vector<std::thread> threads;
+    for(int t = 0; t < PRODUCERS; t++) {
+        threads.emplace_back([&queue, t] { producer(queue, t); });
+    }
+    for(int t = 0; t < CONSUMERS; t++) {
+        threads.emplace_back([&queue, &state, t] { consumer(queue, state, t); });
+    }
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+
+    CAT_CHECK(state.popped.load() == TOTAL);
+    for(uint64_t i = 0; i < TOTAL; i++) {
+        CAT_CHECK(state.seen[i].load() == 1);
+    }
+    uint64_t extra;
+    CAT_CHECK(!queue.try_pop(extra));
+    CAT_CHECK(queue.empty());
+}
+
+} // namespace
+
+CAT_TEST(mpmc_queue_concurrent_exactly_once) {
+    Cat::mpmc_queue<uint64_t> queue(CAPACITY);
+    run_concurrent(queue);
+    CAT_CHECK(queue.size_approx() == 0);
+}
+
+CAT_TEST(linked_mpmc_queue_concurrent_exactly_once) {
+    Cat::linked_mpmc_queue<uint64_t> queue;
+    run_concurrent(queue);
+}
+
+CAT_TEST(mpmc_queue_single_thread_batches) {
+    Cat::mpmc_queue<uint64_t> queue(8);
+    uint64_t values[12];
+    for(uint64_t i = 0; i < 12; i++) {
+        values[i] = i;
+    }
+    CAT_REQUIRE(queue.capacity() == 8);
+    CAT_CHECK(queue.try_push_batch(values, 12) == 8);                  // 队满时截断
+    CAT_CHECK(queue.try_push_batch(values + 8, 4) == 0);
+    uint64_t out[12];
+    CAT_CHECK(queue.try_pop_batch(out, 3) == 3);
+    CAT_CHECK(out[0] == 0 && out[1] == 1 && out[2] == 2);
+    CAT_CHECK(queue.try_push_batch(values + 8, 4) == 3);               // 跨过数组末尾回绕
+    CAT_CHECK(queue.try_pop_batch(out, 12) == 8);
+    for(size_t i = 0; i < 8; i++) {
+        CAT_CHECK(out[i] == i + 3);
+    }
+    CAT_CHECK(queue.empty());
+    CAT_CHECK(queue.try_pop_batch(out, 12) == 0);
+
+    Cat::linked_mpmc_queue<uint64_t> linked;
+    linked.push_batch(values, 5);
+    linked.push(99);
+    CAT_CHECK(linked.try_pop_batch(out, 12) == 6);
+    CAT_CHECK(out[0] == 0 && out[4] == 4 && out[5] == 99);
+    CAT_CHECK(linked.empty());
+}
@@ -0,0 +1,135 @@
+#include "alloc/Cat++_object_pool.h"
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+//object_pool<true>并发测试
+/*
+THREADS个线程在同一个对象池上随机混合acquire、release、acquire_handle，另有一个线程反复shrink/reserve并trim内存池：
+1）max_idle很小，release经常析构对象并归还slot，与其他线程的弹出交错，检验纪元守卫
+2）对象带所有者标记，取得对象的线程用exchange登记自己，登记前的值必须是“无人持有”
+3）全局计数构造与析构次数，对象池析构后二者相等
+*/
+
+namespace {
+
+constexpr int THREADS = 4;
+constexpr int ROUNDS = 200000;
+constexpr int HELD = 16;
+constexpr int FREE = -1;
+
+std::atomic<long> constructed{0};
+std::atomic<long> destroyed{0};
+
+struct tracked {
+    std::atomic<int> owner{FREE};
+    uint64_t payload = 0;
+
+    tracked() { constructed.fetch_add(1, std::memory_order_relaxed); }
+    ~tracked() { destroyed.fetch_add(1, std::memory_order_relaxed); }
+};
+
+using pool_type = Cat::object_pool<true, tracked>;
+
+void take(tracked* obj, int self) {
+    CAT_REQUIRE(obj != nullptr);
+    int previous = obj->owner.exchange(self, std::memory_order_acq_rel);
+    CAT_CHECK(previous == FREE);
+    obj->payload = (uint64_t)self;
+}
+
+void give(pool_type& pool, tracked* obj, int self) {
+    CAT_CHECK(obj->payload == (uint64_t)self);
+    obj->owner.store(FREE, std::memory_order_release);
+    pool.release(obj);
+}
+
+void worker(pool_type& pool, int self) {
+    std::vector<tracked*> held;
+    uint64_t random = 0x9E3779B97F4A7C15ull * (self + 1);
+    for(int round = 0; round < ROUNDS; round++) {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        switch(random % 4) {
+        case 0: case 1:
+            if(held.size() < HELD) {
+                tracked* obj = pool.acquire();
+                take(obj, self);
+                held.push_back(obj);
+                break;
+            }
+            [[fallthrough]];
+        case 2:
+            if(!held.empty()) {
+                give(pool, held.back(), self);
+                held.pop_back();
+            }
+            break;
+        default: {
+            pool_type::handle handle = pool.acquire_handle();
+            take(handle.get(), self);
+            handle->owner.store(FREE, std::memory_order_release);
+            break;
+        }
+        }
+    }
+    for(tracked* obj : held) {
+        give(pool, obj, self);
+    }
+}
+
+} // namespace
+
+CAT_TEST(object_pool_concurrent_acquire_release) {
+    long constructed_before = constructed.load();
+    long destroyed_before = destroyed.load();
+    {
+        pool_type pool(4);
+        std::atomic<bool> done{false};
+        std::thread maintainer([&] {
+            while(!done.load(std::memory_order_acquire)) {
+                pool.shrink(0);
+                pool.reserve(4);
+                Cat::alloc_pool<true>::trim();
+                std::this_thread::yield();
+            }
+        });
+        std::vector<std::thread> threads;
+        for(int t = 0; t < THREADS; t++) {
+            threads.emplace_back(worker, std::ref(pool), t);
+        }
+        for(std::thread& thread : threads) {
+            thread.join();
+        }
+        done.store(true, std::memory_order_release);
+        maintainer.join();
+
+        CAT_CHECK(pool.live() == 0);
+        CAT_CHECK(pool.total() == pool.idle());
+        CAT_CHECK(pool.idle() <= 4 + THREADS);
+    }
+    CAT_CHECK(constructed.load() - constructed_before == destroyed.load() - destroyed_before);
+}
+
+CAT_TEST(object_pool_limits) {
+    Cat::object_pool<true, tracked> pool(2, 3);
+    tracked* a = pool.acquire();
+    tracked* b = pool.acquire();
+    tracked* c = pool.acquire();
+    CAT_REQUIRE(a && b && c);
+    CAT_CHECK(pool.acquire() == nullptr);
+    pool.release(a);
+    pool.release(b);
+    pool.release(c);                    // 空闲数已达2，析构
+    CAT_CHECK(pool.idle() == 2);
+    CAT_CHECK(pool.total() == 2);
+    CAT_CHECK(pool.acquire() == b);     // 后进先出
+    pool.release(b);
+    pool.shrink(1);
+    CAT_CHECK(pool.idle() == 1);
+    CAT_CHECK(pool.reserve(3) == 2);    // 空闲数补到3
+    CAT_CHECK(pool.total() == 3);
+    CAT_CHECK(pool.reserve(5) == 0);    // 已达max_objects
+}
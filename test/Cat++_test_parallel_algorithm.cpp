@@ -0,0 +1,242 @@
+#include "algorithm/Cat++_parallel_algorithm.h"
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+//并行算法与std::版本的差分测试
+/*
+在4个工作线程的线程池上，对超过串行阈值(MIN_GRAIN / MIN_SORT_LEAF)的规模以及边界规模(0、1、阈值附近)：
+1）parallel_sort / parallel_stable_sort与std::sort / std::stable_sort结果逐元素相同，稳定排序用只比较键的pair检验相等元素的次序；
+   平凡类型与std::string(走先移动到缓冲区的路径)各测一遍
+2）parallel_for_each / parallel_transform / parallel_reduce / parallel_inclusive_scan与std::版本相同；
+   reduce与scan另用满足结合律、不满足交换律的运算(仿射变换复合)检验合并次序
+3）被调用的函数/比较器在中途抛出异常时，异常传回调用线程，之后线程池仍可正常使用
+*/
+
+namespace {
+
+const size_t SIZES[] = {0, 1, 2, 4095, 4097, 8193, 100000, 1000003};
+
+std::vector<uint64_t> random_values(size_t n, uint64_t seed, uint64_t range = 0) {
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> values(n);
+    for(uint64_t& x : values) {
+        x = range ? rng() % range : rng();
+    }
+    return values;
+}
+
+// 仿射变换x -> a * x + b，复合满足结合律、不满足交换律(模2^64)
+struct affine {
+    uint64_t a = 1;
+    uint64_t b = 0;
+    bool operator==(const affine&) const = default;
+};
+
+// 先应用lhs再应用rhs
+affine compose(const affine& lhs, const affine& rhs) {
+    return {lhs.a * rhs.a, lhs.b * rhs.a + rhs.b};
+}
+
+std::vector<affine> random_affines(size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<affine> values(n);
+    for(affine& f : values) {
+        f = {rng() | 1, rng()};
+    }
+    return values;
+}
+
+struct test_failure : std::runtime_error {
+    test_failure() : std::runtime_error("injected failure") {}
+};
+
+template<typename F>
+bool throws_injected(F f) {
+    try {
+        f();
+    } catch (const test_failure&) {
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+CAT_TEST(parallel_sort_matches_std) {
+    Cat::thread_pool pool(4);
+    for(size_t n : SIZES) {
+        std::vector<uint64_t> data = random_values(n, n + 1, n / 3 + 1);     // 带重复值
+        std::vector<uint64_t> expected = data;
+        std::sort(expected.begin(), expected.end());
+        Cat::parallel_sort(pool, data.begin(), data.end());
+        CAT_CHECK(data == expected);
+
+        data = random_values(n, n + 2);
+        expected = data;
+        std::sort(expected.begin(), expected.end(), std::greater<>());
+        Cat::parallel_sort<Cat::AllocatorType::ARENA>(pool, data.begin(), data.end(), std::greater<>());
+        CAT_CHECK(data == expected);
+    }
+}
+
+CAT_TEST(parallel_sort_strings_matches_std) {
+    Cat::thread_pool pool(4);
+    for(size_t n : {size_t(100), size_t(50000)}) {
+        std::vector<std::string> data;
+        for(uint64_t x : random_values(n, n, 5000)) {
+            data.push_back(std::to_string(x) + std::string(x % 40, 'x'));     // 长短混合，含堆上的字符串
+        }
+        std::vector<std::string> expected = data;
+        std::sort(expected.begin(), expected.end());
+        Cat::parallel_sort(pool, data.begin(), data.end());
+        CAT_CHECK(data == expected);
+    }
+}
+
+CAT_TEST(parallel_stable_sort_matches_std) {
+    Cat::thread_pool pool(4);
+    auto by_key = [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+        return a.first < b.first;
+    };
+    for(size_t n : SIZES) {
+        std::vector<std::pair<uint32_t, uint32_t>> data(n);
+        std::vector<uint64_t> keys = random_values(n, n + 3, 64);            // 大量相等的键
+        for(size_t i = 0; i < n; i++) {
+            data[i] = {(uint32_t)keys[i], (uint32_t)i};
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> expected = data;
+        std::stable_sort(expected.begin(), expected.end(), by_key);
+        Cat::parallel_stable_sort(pool, data.begin(), data.end(), by_key);
+        CAT_CHECK(data == expected);
+    }
+}
+
+CAT_TEST(parallel_for_each_transform_match_std) {
+    Cat::thread_pool pool(4);
+    auto mix = [](uint64_t x) { return (x ^ (x >> 31)) * 0x9E3779B97F4A7C15ull; };
+    for(size_t n : SIZES) {
+        std::vector<uint64_t> input = random_values(n, n + 4);
+
+        std::vector<uint64_t> data = input;
+        std::vector<uint64_t> expected = input;
+        std::for_each(expected.begin(), expected.end(), [&](uint64_t& x) { x = mix(x); });
+        Cat::parallel_for_each(pool, data.begin(), data.end(), [&](uint64_t& x) { x = mix(x); });
+        CAT_CHECK(data == expected);
+
+        std::vector<uint64_t> output(n);
+        std::transform(input.begin(), input.end(), expected.begin(), mix);
+        auto end = Cat::parallel_transform(pool, input.begin(), input.end(), output.begin(), mix);
+        CAT_CHECK(end == output.end());
+        CAT_CHECK(output == expected);
+    }
+}
+
+CAT_TEST(parallel_reduce_matches_std) {
+    Cat::thread_pool pool(4);
+    for(size_t n : SIZES) {
+        std::vector<uint64_t> values = random_values(n, n + 5);
+        CAT_CHECK(Cat::parallel_reduce(pool, values.begin(), values.end(), uint64_t(7))
+                  == std::reduce(values.begin(), values.end(), uint64_t(7)));
+
+        std::vector<affine> functions = random_affines(n, n + 6);
+        affine expected = std::accumulate(functions.begin(), functions.end(), affine{}, compose);
+        CAT_CHECK(Cat::parallel_reduce(pool, functions.begin(), functions.end(), affine{}, compose) == expected);
+    }
+}
+
+CAT_TEST(parallel_inclusive_scan_matches_std) {
+    Cat::thread_pool pool(4);
+    for(size_t n : SIZES) {
+        std::vector<uint64_t> values = random_values(n, n + 7);
+        std::vector<uint64_t> expected(n);
+        std::vector<uint64_t> output(n);
+        std::inclusive_scan(values.begin(), values.end(), expected.begin());
+        auto end = Cat::parallel_inclusive_scan(pool, values.begin(), values.end(), output.begin());
+        CAT_CHECK(end == output.end());
+        CAT_CHECK(output == expected);
+
+        // 原地扫描
+        Cat::parallel_inclusive_scan(pool, values.begin(), values.end(), values.begin());
+        CAT_CHECK(values == expected);
+
+        std::vector<affine> functions = random_affines(n, n + 8);
+        std::vector<affine> composed(n);
+        std::vector<affine> expected_composed(n);
+        std::inclusive_scan(functions.begin(), functions.end(), expected_composed.begin(), compose);
+        Cat::parallel_inclusive_scan(pool, functions.begin(), functions.end(), composed.begin(), compose);
+        CAT_CHECK(composed == expected_composed);
+    }
+}
+
+CAT_TEST(parallel_algorithms_propagate_exceptions) {
+    Cat::thread_pool pool(4);
+    const size_t n = 200000;
+    const size_t fail_at = n / 2 + 17;
+    std::vector<uint64_t> input = random_values(n, 9);
+
+    std::vector<uint64_t> data = input;
+    CAT_CHECK(throws_injected([&] {
+        Cat::parallel_for_each(pool, data.begin(), data.end(), [&](uint64_t& x) {
+            if(&x == &data[fail_at]) {
+                throw test_failure();
+            }
+        });
+    }));
+
+    std::vector<uint64_t> output(n);
+    CAT_CHECK(throws_injected([&] {
+        Cat::parallel_transform(pool, input.begin(), input.end(), output.begin(), [&](const uint64_t& x) {
+            if(&x == &input[fail_at]) {
+                throw test_failure();
+            }
+            return x;
+        });
+    }));
+
+    CAT_CHECK(throws_injected([&] {
+        Cat::parallel_reduce(pool, input.begin(), input.end(), uint64_t(0), [&](uint64_t a, uint64_t b) {
+            if(b == input[fail_at]) {
+                throw test_failure();
+            }
+            return a + b;
+        });
+    }));
+
+    CAT_CHECK(throws_injected([&] {
+        Cat::parallel_inclusive_scan(pool, input.begin(), input.end(), output.begin(), [&](uint64_t a, uint64_t b) {
+            if(b == input[fail_at]) {
+                throw test_failure();
+            }
+            return a + b;
+        });
+    }));
+
+    std::atomic<size_t> comparisons{0};
+    auto failing_less = [&](uint64_t a, uint64_t b) {
+        if(comparisons.fetch_add(1, std::memory_order_relaxed) == n * 4) {
+            throw test_failure();
+        }
+        return a < b;
+    };
+    data = input;
+    CAT_CHECK(throws_injected([&] { Cat::parallel_sort(pool, data.begin(), data.end(), failing_less); }));
+    comparisons = 0;
+    data = input;
+    CAT_CHECK(throws_injected([&] { Cat::parallel_stable_sort(pool, data.begin(), data.end(), failing_less); }));
+
+    // 异常之后线程池照常工作
+    data = input;
+    std::vector<uint64_t> expected = input;
+    std::sort(expected.begin(), expected.end());
+    Cat::parallel_sort(pool, data.begin(), data.end());
+    CAT_CHECK(data == expected);
+    CAT_CHECK(Cat::parallel_reduce(pool, input.begin(), input.end(), uint64_t(0))
+              == std::reduce(input.begin(), input.end(), uint64_t(0)));
+}
@@ -0,0 +1,142 @@
+#include "Cat++_test_memory.h"
+#include "alloc/Cat++_pool_alloc.h"
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+//alloc_pool::trim测试
+/*
+1）分配WORKING_SET字节并逐页写入，全部释放后trim()，常驻内存(RSS)至少回落一半工作集，pool_size随之减少；
+   mmap来源靠munmap归还，malloc来源靠trim末尾的malloc_trim
+2）多个线程反复分配/释放并校验块内容，同时另一个线程不停trim、后台回收线程也在运行：
+   块内容不被破坏，结束后trim能归还全部空闲chunk
+每个用例用带Tag的pool_config，得到独立的内存池，不受其他用例的残留节点影响
+*/
+
+namespace {
+
+constexpr size_t WORKING_SET = 64 * 1024 * 1024;
+constexpr size_t BLOCK = 4096;
+
+struct mmap_trim_tag;
+struct malloc_trim_tag;
+struct concurrent_trim_tag;
+
+template<class PageSource, class Tag>
+void check_trim_returns_memory() {
+    using config = Cat::pool_config<8, 128, 32 * 1024, 8, 20, Cat::adaptive_refill, Tag>;
+    using pool = Cat::alloc_pool<true, PageSource, config>;
+
+    size_t before = Cat::test::resident_bytes();
+    std::vector<void*> blocks;
+    for(size_t i = 0; i < WORKING_SET / BLOCK; i++) {
+        void* block = pool::allocate(BLOCK);
+        memset(block, (int)(i & 0xff), BLOCK);
+        blocks.push_back(block);
+    }
+    size_t peak = Cat::test::resident_bytes();
+    size_t pool_peak = pool::get_pool_size();
+    CAT_REQUIRE(peak >= before + WORKING_SET / 2);
+
+    for(void* block : blocks) {
+        pool::deallocate(block, BLOCK);
+    }
+    size_t released = pool::trim();
+    size_t after = Cat::test::resident_bytes();
+
+    CAT_CHECK(released >= WORKING_SET / 2);
+    CAT_CHECK(pool::get_pool_size() + released == pool_peak);
+    CAT_CHECK(pool::get_stats().released_bytes == released);
+    // AddressSanitizer的malloc把释放的内存放进隔离区，不归还系统，malloc来源只检查计数
+#if defined(__SANITIZE_ADDRESS__)
+    if(PageSource::USES_HEAP) {
+        return;
+    }
+#endif
+    CAT_CHECK(after + WORKING_SET / 2 <= peak);
+}
+
+} // namespace
+
+CAT_TEST(pool_trim_returns_memory_mmap) {
+    check_trim_returns_memory<Cat::mmap_page_source, mmap_trim_tag>();
+}
+
+CAT_TEST(pool_trim_returns_memory_malloc) {
+    check_trim_returns_memory<Cat::malloc_page_source, malloc_trim_tag>();
+}
+
+CAT_TEST(pool_trim_concurrent_with_allocation) {
+    using config = Cat::pool_config<8, 128, 32 * 1024, 8, 20, Cat::adaptive_refill, concurrent_trim_tag>;
+    using pool = Cat::alloc_pool<true, Cat::mmap_page_source, config>;
+    constexpr int THREADS = 4;
+    constexpr int ROUNDS = 200000;
+    constexpr size_t LIVE = 256;
+
+    std::atomic<bool> done{false};
+    std::atomic<size_t> trims{0};
+    pool::start_scavenger(std::chrono::milliseconds(1));
+    std::thread trimmer([&] {
+        while(!done.load(std::memory_order_acquire)) {
+            pool::trim();
+            trims.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < THREADS; t++) {
+        threads.emplace_back([t] {
+            struct slot {
+                unsigned char* block = nullptr;
+                size_t bytes = 0;
+                unsigned char mark = 0;
+            };
+            std::vector<slot> live(LIVE);
+            uint64_t random = 0x9E3779B97F4A7C15ull * (t + 1);
+            for(int round = 0; round < ROUNDS; round++) {
+                random ^= random << 13;
+                random ^= random >> 7;
+                random ^= random << 17;
+                slot& s = live[random % LIVE];
+                if(s.block) {
+                    // 块内容须保持写入时的样子：trim若释放了仍在使用的chunk，这里会读到别的数据或崩溃
+                    CAT_CHECK(s.block[0] == s.mark && s.block[s.bytes - 1] == s.mark);
+                    pool::deallocate(s.block, s.bytes);
+                    s.block = nullptr;
+                }
+                else {
+                    s.bytes = 8 + (size_t)(random >> 40) % 8192;
+                    s.mark = (unsigned char)(round * 31 + t);
+                    s.block = static_cast<unsigned char*>(pool::allocate(s.bytes));
+                    memset(s.block, s.mark, s.bytes);
+                }
+            }
+            for(slot& s : live) {
+                if(s.block) {
+                    CAT_CHECK(s.block[0] == s.mark && s.block[s.bytes - 1] == s.mark);
+                    pool::deallocate(s.block, s.bytes);
+                }
+            }
+        });
+    }
+    for(std::thread& thread : threads) {
+        thread.join();
+    }
+    done.store(true, std::memory_order_release);
+    trimmer.join();
+    pool::stop_scavenger();
+
+    CAT_CHECK(trims.load() > 0);
+    // 工作线程都已退出，节点全部回到中心池：除正在切分的chunk外都能归还
+    pool::trim();
+    size_t remaining = pool::get_pool_size();
+    pool::trim();
+    CAT_CHECK(pool::get_pool_size() == remaining);
+    Cat::pool_stats stats = pool::get_stats();
+    CAT_CHECK(stats.pool_bytes == remaining);
+    CAT_CHECK(stats.system_bytes == stats.released_bytes + remaining);
+}
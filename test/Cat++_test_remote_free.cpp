@@ -0,0 +1,228 @@
+#include "Cat++_test_memory.h"
+#include "alloc/Cat++_pool_alloc.h"
+#include "container/Cat++_spsc_ring.h"
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <unordered_set>
+//跨线程释放的内存上界
+/*
+生产者-消费者：线程A分配ITERATIONS个块经spsc_ring交给线程B释放，块的chunk属于A的线程堆，B的释放全部是远程释放：
+1）在途的块不超过环的容量，内存池持有的系统内存(get_stats().pool_bytes)不应随迭代次数增长
+2）预热WARMUP次后记下pool_bytes与RSS，之后每CHECK_EVERY次采样一次，最大值不超过预热值的两倍加SLACK
+批量版本：A用allocate_batch成批分配同一大小的块，B在其中穿插自己分配的块后用deallocate_batch一次归还：
+3）A的块按所属线程堆分段压入A的remote链表(remote_frees计数与之相符)，A之后的分配取回的正是这些块
+4）成批的生产者-消费者同样满足1）2）的内存上界
+用带Tag的pool_config，得到独立的内存池；mmap页来源的chunk不经过malloc，RSS不受libc堆(或ASan隔离区)影响
+*/
+
+namespace {
+
+constexpr size_t ITERATIONS = 4000000;
+constexpr size_t WARMUP = 200000;
+constexpr size_t CHECK_EVERY = 65536;
+constexpr size_t RING = 1024;
+constexpr size_t SLACK = 8 * 1024 * 1024;
+
+struct remote_free_tag;
+struct remote_free_batch_tag;
+
+#if CAT_HAS_MMAP
+using page_source = Cat::mmap_page_source;
+#else
+using page_source = Cat::malloc_page_source;
+#endif
+using config = Cat::pool_config<8, 128, 32 * 1024, 8, 20, Cat::adaptive_refill, remote_free_tag>;
+using pool = Cat::alloc_pool<true, page_source, config>;
+using batch_config = Cat::pool_config<8, 128, 32 * 1024, 8, 20, Cat::adaptive_refill, remote_free_batch_tag>;
+using batch_pool = Cat::alloc_pool<true, page_source, batch_config>;
+
+constexpr size_t BATCH = 32;
+constexpr size_t OWN_EVERY = 4;             // 消费者每OWN_EVERY个位置穿插一个自己的块
+
+struct block {
+    void* ptr;
+    size_t bytes;
+};
+
+struct block_batch {
+    void* ptrs[BATCH];
+    size_t bytes;
+};
+
+uint64_t total_remote_frees() {
+    uint64_t total = 0;
+    for(const Cat::size_class_stats& row : batch_pool::get_stats().classes) {
+        total += row.remote_frees;
+    }
+    return total;
+}
+
+// 8~512字节，覆盖线性级与几何级
+size_t size_of(size_t i) {
+    uint64_t x = (uint64_t)i * 0x9E3779B97F4A7C15ull;
+    return 8 + (size_t)((x >> 40) % 505);
+}
+
+} // namespace
+
+CAT_TEST(pool_remote_free_memory_bounded) {
+    Cat::spsc_ring<block> ring(RING);
+    std::atomic<bool> producer_done{false};
+    std::atomic<size_t> freed{0};
+
+    std::thread consumer([&] {
+        block b;
+        for(;;) {
+            if(ring.try_pop(b)) {
+                CAT_CHECK(*static_cast<unsigned char*>(b.ptr) == (unsigned char)b.bytes);
+                pool::deallocate(b.ptr, b.bytes);
+                freed.fetch_add(1, std::memory_order_relaxed);
+            }
+            else if(producer_done.load(std::memory_order_acquire) && ring.empty()) {
+                break;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    size_t warm_pool = 0;
+    size_t warm_rss = 0;
+    size_t max_pool = 0;
+    size_t max_rss = 0;
+    for(size_t i = 0; i < ITERATIONS; i++) {
+        size_t bytes = size_of(i);
+        void* ptr = pool::allocate(bytes);
+        CAT_REQUIRE(ptr != nullptr);
+        memset(ptr, (unsigned char)bytes, bytes);
+        while(!ring.try_push(block{ptr, bytes})) {
+            std::this_thread::yield();
+        }
+        if(i + 1 == WARMUP) {
+            warm_pool = pool::get_stats().pool_bytes;
+            warm_rss = Cat::test::resident_bytes();
+        }
+        else if(i > WARMUP && i % CHECK_EVERY == 0) {
+            max_pool = std::max(max_pool, (size_t)pool::get_stats().pool_bytes);
+            max_rss = std::max(max_rss, Cat::test::resident_bytes());
+        }
+    }
+    producer_done.store(true, std::memory_order_release);
+    consumer.join();
+
+    CAT_CHECK(freed.load() == ITERATIONS);
+    CAT_CHECK(warm_pool > 0);
+    CAT_CHECK(max_pool <= 2 * warm_pool + SLACK);
+    CAT_CHECK(max_rss <= 2 * warm_rss + SLACK);
+    // 全部释放后空闲chunk都能归还
+    pool::trim();
+    CAT_CHECK(pool::get_stats().pool_bytes <= warm_pool);
+}
+
+CAT_TEST(pool_remote_free_batch_returns_to_owner) {
+    constexpr size_t FOREIGN = 12;
+    constexpr size_t BYTES = 48;
+    void* foreign[FOREIGN];
+    CAT_REQUIRE(batch_pool::allocate_batch(BYTES, FOREIGN, foreign) == FOREIGN);
+    std::unordered_set<void*> expected(foreign, foreign + FOREIGN);
+    uint64_t remote_before = total_remote_frees();
+
+    // 另一个线程把A的块与自己的块交错成 A A A B A A A B ... 一次归还
+    std::thread other([&] {
+        void* mixed[FOREIGN + FOREIGN / 3];
+        size_t count = 0;
+        for(size_t i = 0; i < FOREIGN; i++) {
+            mixed[count++] = foreign[i];
+            if(i % 3 == 2) {
+                mixed[count++] = batch_pool::allocate(BYTES);
+            }
+        }
+        batch_pool::deallocate_batch(BYTES, count, mixed);
+    });
+    other.join();
+    CAT_CHECK(total_remote_frees() - remote_before == FOREIGN);
+
+    // 本线程缓存已空，下一次分配先取回remote链表
+    std::unordered_set<void*> returned;
+    void* again[FOREIGN];
+    for(size_t i = 0; i < FOREIGN; i++) {
+        again[i] = batch_pool::allocate(BYTES);
+        returned.insert(again[i]);
+    }
+    CAT_CHECK(returned == expected);
+    batch_pool::deallocate_batch(BYTES, FOREIGN, again);
+}
+
+CAT_TEST(pool_remote_free_batch_memory_bounded) {
+    constexpr size_t BATCHES = ITERATIONS / BATCH / 4;
+    constexpr size_t WARMUP_BATCHES = WARMUP / BATCH;
+    constexpr size_t CHECK_BATCHES = CHECK_EVERY / BATCH;
+    Cat::spsc_ring<block_batch> ring(RING / BATCH);
+    std::atomic<bool> producer_done{false};
+    std::atomic<size_t> freed{0};
+    uint64_t remote_before = total_remote_frees();
+
+    std::thread consumer([&] {
+        block_batch b;
+        void* mixed[BATCH + BATCH / OWN_EVERY];
+        for(;;) {
+            if(ring.try_pop(b)) {
+                size_t count = 0;
+                for(size_t i = 0; i < BATCH; i++) {
+                    CAT_CHECK(*static_cast<unsigned char*>(b.ptrs[i]) == (unsigned char)b.bytes);
+                    mixed[count++] = b.ptrs[i];
+                    if(i % OWN_EVERY == OWN_EVERY - 1) {
+                        mixed[count++] = batch_pool::allocate(b.bytes);
+                    }
+                }
+                batch_pool::deallocate_batch(b.bytes, count, mixed);
+                freed.fetch_add(BATCH, std::memory_order_relaxed);
+            }
+            else if(producer_done.load(std::memory_order_acquire) && ring.empty()) {
+                break;
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    size_t warm_pool = 0;
+    size_t warm_rss = 0;
+    size_t max_pool = 0;
+    size_t max_rss = 0;
+    for(size_t i = 0; i < BATCHES; i++) {
+        block_batch b;
+        b.bytes = size_of(i);
+        CAT_REQUIRE(batch_pool::allocate_batch(b.bytes, BATCH, b.ptrs) == BATCH);
+        for(void* ptr : b.ptrs) {
+            memset(ptr, (unsigned char)b.bytes, b.bytes);
+        }
+        while(!ring.try_push(b)) {
+            std::this_thread::yield();
+        }
+        if(i + 1 == WARMUP_BATCHES) {
+            warm_pool = batch_pool::get_stats().pool_bytes;
+            warm_rss = Cat::test::resident_bytes();
+        }
+        else if(i > WARMUP_BATCHES && i % CHECK_BATCHES == 0) {
+            max_pool = std::max(max_pool, (size_t)batch_pool::get_stats().pool_bytes);
+            max_rss = std::max(max_rss, Cat::test::resident_bytes());
+        }
+    }
+    producer_done.store(true, std::memory_order_release);
+    consumer.join();
+
+    CAT_CHECK(freed.load() == BATCHES * BATCH);
+    CAT_CHECK(total_remote_frees() > remote_before);
+    CAT_CHECK(warm_pool > 0);
+    CAT_CHECK(max_pool <= 2 * warm_pool + SLACK);
+    CAT_CHECK(max_rss <= 2 * warm_rss + SLACK);
+    batch_pool::trim();
+    CAT_CHECK(batch_pool::get_stats().pool_bytes <= warm_pool);
+}
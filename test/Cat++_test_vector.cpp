@@ -0,0 +1,368 @@
+#include "container/Cat++_vector.h"
+#include "dev_dependency/Cat++_test/Cat++_UnitTest.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+//vector测试
+/*
+1）可平凡重定位的元素配合带reallocate的分配器：扩容、reserve、shrink_to_fit都调用reallocate，只有第一次申请缓冲区；
+   特化is_trivially_relocatable的持有堆指针的类型同样走reallocate，不多析构也不泄漏
+2）不可平凡重定位的元素：扩容时逐个移动构造(移动不抛异常时)或复制构造(移动可能抛异常时)，用计数类型检查次数；
+   扩容中复制抛出异常时原内容不变；emplace_back的参数引用自身元素时扩容后仍正确
+3）每种AllocatorType下，insert(单个/count个/前向与输入迭代器区间)/emplace/erase/resize等的随机混合与std::vector逐元素比较
+*/
+
+namespace {
+
+struct counters {
+    static inline long allocations = 0;
+    static inline long deallocations = 0;
+    static inline long reallocations = 0;
+
+    static void reset() { allocations = deallocations = reallocations = 0; }
+};
+
+// 用malloc/realloc实现、统计调用次数的分配器
+template<typename T>
+struct counting_realloc_allocator {
+    using value_type = T;
+
+    counting_realloc_allocator() noexcept = default;
+    template<typename U>
+    counting_realloc_allocator(const counting_realloc_allocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        counters::allocations++;
+        return static_cast<T*>(malloc(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t) noexcept {
+        counters::deallocations++;
+        free(ptr);
+    }
+    T* reallocate(T* ptr, size_t, size_t new_size) {
+        counters::reallocations++;
+        return static_cast<T*>(realloc((void*)ptr, new_size * sizeof(T)));
+    }
+
+    template<typename U>
+    bool operator==(const counting_realloc_allocator<U>&) const noexcept { return true; }
+};
+
+// 只持有一个堆指针：移动后源对象置空，按字节搬运后不析构源对象也正确
+struct heap_handle {
+    static inline long live = 0;
+
+    long* value;
+
+    explicit heap_handle(long x) : value(new long(x)) { live++; }
+    heap_handle(heap_handle&& other) noexcept : value(other.value) { other.value = nullptr; }
+    heap_handle(const heap_handle&) = delete;
+    heap_handle& operator=(heap_handle&& other) noexcept {
+        std::swap(value, other.value);
+        return *this;
+    }
+    ~heap_handle() {
+        if(value) {
+            live--;
+            delete value;
+        }
+    }
+};
+
+// 统计构造、移动、复制与存活个数；copy_throws_at为剩余多少次复制后抛异常(负数表示不抛)
+template<bool NothrowMove>
+struct tracked {
+    static inline long live = 0;
+    static inline long moves = 0;
+    static inline long copies = 0;
+    static inline long copy_throws_at = -1;
+
+    long value;
+
+    explicit tracked(long x) : value(x) { live++; }
+    tracked(tracked&& other) noexcept(NothrowMove) : value(other.value) {
+        moves++;
+        live++;
+    }
+    tracked(const tracked& other) : value(other.value) {
+        if(copy_throws_at >= 0 && copy_throws_at-- == 0) {
+            throw std::runtime_error("injected copy failure");
+        }
+        copies++;
+        live++;
+    }
+    tracked& operator=(const tracked&) = default;
+    tracked& operator=(tracked&&) = default;
+    ~tracked() { live--; }
+
+    static void reset() { moves = copies = 0; copy_throws_at = -1; }
+};
+
+} // namespace
+
+template<>
+struct Cat::is_trivially_relocatable<heap_handle> : std::true_type {};
+
+namespace {
+
+template<typename T>
+std::vector<long> values_of(const T& v) {
+    std::vector<long> result;
+    for(const auto& x : v) {
+        result.push_back(x.value);
+    }
+    return result;
+}
+
+template<typename Mine, typename Expected>
+bool same(const Mine& mine, const Expected& expected) {
+    return mine.size() == expected.size() && std::equal(mine.begin(), mine.end(), expected.begin());
+}
+
+template<typename T>
+T make_value(std::mt19937_64& rng) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        return "value-" + std::to_string(rng() % 1000) + std::string(rng() % 24, '#');     // 长短混合，含堆上的字符串
+    }
+    else {
+        return (T)(rng() % 1000);
+    }
+}
+
+// 同一串随机操作同时作用于Cat::vector与std::vector
+template<typename T, Cat::AllocatorType Type>
+void check_matches_std(uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    Cat::vector<T, Cat::alloc_t<T, Type>> mine;
+    std::vector<T> expected;
+    for(int round = 0; round < 20000; round++) {
+        size_t pos = expected.empty() ? 0 : rng() % (expected.size() + 1);
+        T value = make_value<T>(rng);
+        switch(rng() % 12) {
+        case 0:
+        case 1:
+            mine.push_back(value);
+            expected.push_back(value);
+            break;
+        case 2:
+            CAT_CHECK(*mine.insert(mine.begin() + pos, value) == *expected.insert(expected.begin() + pos, value));
+            break;
+        case 3:
+            mine.emplace(mine.begin() + pos, value);
+            expected.emplace(expected.begin() + pos, value);
+            break;
+        case 4: {
+            size_t count = rng() % 8;
+            mine.insert(mine.begin() + pos, count, value);
+            expected.insert(expected.begin() + pos, count, value);
+            break;
+        }
+        case 5: {
+            std::vector<T> source(rng() % 8);
+            for(T& x : source) {
+                x = make_value<T>(rng);
+            }
+            mine.insert(mine.begin() + pos, source.begin(), source.end());
+            expected.insert(expected.begin() + pos, source.begin(), source.end());
+            break;
+        }
+        case 6: {
+            // 输入迭代器区间：只能逐个追加后旋转
+            std::ostringstream text;
+            size_t count = rng() % 8;
+            for(size_t i = 0; i < count; i++) {
+                text << rng() % 1000 << ' ';
+            }
+            std::istringstream first(text.str());
+            std::istringstream second(text.str());
+            mine.insert(mine.begin() + pos, std::istream_iterator<T>(first), std::istream_iterator<T>());
+            expected.insert(expected.begin() + pos, std::istream_iterator<T>(second), std::istream_iterator<T>());
+            break;
+        }
+        case 7:
+        case 8:
+            if(!expected.empty()) {
+                size_t at = rng() % expected.size();
+                auto it = mine.erase(mine.begin() + at);
+                auto expected_it = expected.erase(expected.begin() + at);
+                CAT_CHECK((size_t)(it - mine.begin()) == (size_t)(expected_it - expected.begin()));
+            }
+            break;
+        case 9:
+            if(!expected.empty()) {
+                size_t first = rng() % expected.size();
+                size_t last = first + rng() % (expected.size() - first + 1);
+                mine.erase(mine.begin() + first, mine.begin() + last);
+                expected.erase(expected.begin() + first, expected.begin() + last);
+            }
+            break;
+        case 10:
+            if(!expected.empty()) {
+                mine.pop_back();
+                expected.pop_back();
+            }
+            break;
+        default: {
+            size_t count = expected.size() + rng() % 16;
+            count = count > 8 ? count - 8 : 0;
+            mine.resize(count, value);
+            expected.resize(count, value);
+            break;
+        }
+        }
+        if(round % 256 == 0) {
+            CAT_REQUIRE(same(mine, expected));
+        }
+    }
+    CAT_CHECK(same(mine, expected));
+    mine.shrink_to_fit();
+    CAT_CHECK(same(mine, expected));
+    CAT_CHECK(mine.capacity() == mine.size());
+
+    Cat::vector<T, Cat::alloc_t<T, Type>> copy(mine);
+    CAT_CHECK(copy == mine);
+    copy.erase(copy.begin(), copy.end());
+    CAT_CHECK(copy.empty());
+}
+
+template<Cat::AllocatorType Type>
+void check_allocator_type() {
+    check_matches_std<long, Type>(31 + (uint64_t)Type);
+    check_matches_std<std::string, Type>(41 + (uint64_t)Type);
+    if constexpr (Type == Cat::AllocatorType::ARENA) {
+        Cat::arena::get_default<true>().reset();
+    }
+}
+
+} // namespace
+
+CAT_TEST(vector_grows_through_reallocate) {
+    static_assert(Cat::reallocating_allocator<counting_realloc_allocator<long>>);
+    counters::reset();
+    {
+        Cat::vector<long, counting_realloc_allocator<long>> v;
+        for(long i = 0; i < 100000; i++) {
+            v.push_back(i);
+        }
+        CAT_CHECK(counters::allocations == 1);                   // 只有第一次申请缓冲区
+        CAT_CHECK(counters::reallocations > 0);
+        CAT_CHECK(counters::deallocations == 0);
+
+        long before = counters::reallocations;
+        v.reserve(v.capacity() * 2);
+        CAT_CHECK(counters::reallocations == before + 1);
+        v.insert(v.begin(), 3, -1L);
+        v.shrink_to_fit();
+        CAT_CHECK(counters::reallocations == before + 2);
+        CAT_CHECK(v.capacity() == v.size());
+
+        // 参数引用自身元素时，先构造出值再reallocate
+        v.emplace_back(v[5]);
+        CAT_CHECK(v.back() == 2);
+        CAT_CHECK(v.size() == 100004);
+        bool ordered = v[0] == -1 && v[1] == -1 && v[2] == -1;
+        for(long i = 0; i < 100000; i++) {
+            ordered = ordered && v[i + 3] == i;
+        }
+        CAT_CHECK(ordered);
+        CAT_CHECK(counters::allocations == 1);
+    }
+    CAT_CHECK(counters::deallocations == 1);
+
+    // 特化了is_trivially_relocatable的类型：reallocate按字节搬运，搬运后不析构旧位置
+    counters::reset();
+    {
+        Cat::vector<heap_handle, counting_realloc_allocator<heap_handle>> v;
+        for(long i = 0; i < 5000; i++) {
+            v.emplace_back(i);
+        }
+        CAT_CHECK(counters::allocations == 1);
+        CAT_CHECK(counters::reallocations > 0);
+        CAT_CHECK(heap_handle::live == 5000);
+        bool ordered = true;
+        for(long i = 0; i < 5000; i++) {
+            ordered = ordered && *v[i].value == i;
+        }
+        CAT_CHECK(ordered);
+        v.erase(v.begin(), v.begin() + 100);
+        CAT_CHECK(heap_handle::live == 4900);
+        CAT_CHECK(*v.front().value == 100);
+    }
+    CAT_CHECK(heap_handle::live == 0);
+    CAT_CHECK(counters::deallocations == 1);
+}
+
+CAT_TEST(vector_grows_by_move_construction) {
+    using movable = tracked<true>;
+    using copy_only = tracked<false>;
+    static_assert(!Cat::is_trivially_relocatable_v<movable>);
+    counters::reset();
+    movable::reset();
+    {
+        // 带reallocate的分配器也不能用于不可平凡重定位的元素
+        Cat::vector<movable, counting_realloc_allocator<movable>> v;
+        long expected_moves = 0;
+        for(long i = 0; i < 1000; i++) {
+            if(v.size() == v.capacity()) {
+                expected_moves += (long)v.size();
+            }
+            v.emplace_back(i);
+        }
+        CAT_CHECK(counters::reallocations == 0);
+        CAT_CHECK(counters::allocations == counters::deallocations + 1);
+        CAT_CHECK(movable::moves == expected_moves);           // 每次扩容每个元素恰好移动一次
+        CAT_CHECK(movable::copies == 0);
+        CAT_CHECK(movable::live == 1000);
+
+        // 参数引用自身元素，扩容时先在新缓冲区构造
+        v.shrink_to_fit();
+        v.push_back(v[7]);
+        CAT_CHECK(v.back().value == 7);
+        CAT_CHECK(movable::copies == 1);
+        CAT_CHECK(movable::live == 1001);
+    }
+    CAT_CHECK(movable::live == 0);
+    CAT_CHECK(counters::allocations == counters::deallocations);
+
+    // 移动可能抛异常：扩容时复制，复制中途失败则原内容不变
+    copy_only::reset();
+    {
+        Cat::vector<copy_only> v;
+        for(long i = 0; i < 100; i++) {
+            v.emplace_back(i);
+        }
+        CAT_CHECK(copy_only::moves == 0);
+        CAT_CHECK(copy_only::copies > 0);
+        v.shrink_to_fit();
+        std::vector<long> before = values_of(v);
+        copy_only::copy_throws_at = 50;
+        bool thrown = false;
+        try {
+            v.emplace_back(100);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        copy_only::copy_throws_at = -1;
+        CAT_CHECK(thrown);
+        CAT_CHECK(values_of(v) == before);
+        CAT_CHECK(v.capacity() == 100);
+        CAT_CHECK(copy_only::live == 100);
+    }
+    CAT_CHECK(copy_only::live == 0);
+}
+
+CAT_TEST(vector_matches_std_for_each_allocator) {
+    check_allocator_type<Cat::AllocatorType::DEFAULT>();
+    check_allocator_type<Cat::AllocatorType::SIMPLE>();
+    check_allocator_type<Cat::AllocatorType::POOL>();
+    check_allocator_type<Cat::AllocatorType::POOL_SIMD>();
+    check_allocator_type<Cat::AllocatorType::POOL_TINY>();
+    check_allocator_type<Cat::AllocatorType::ARENA>();
+}
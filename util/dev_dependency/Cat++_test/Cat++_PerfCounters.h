@@ -0,0 +1,193 @@
+#pragma once
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Cat {
+
+/**
+ * @brief 硬件性能计数器(Linux perf_event_open)
+ *
+ * 每个计数器单独打开，只统计调用线程在用户态的事件(exclude_kernel，perf_event_paranoid <= 2即可使用)：
+ * - cycles、instructions
+ * - L1d读缺失、LLC缺失、dTLB读缺失
+ * - 分支预测失败
+ * 单独打开而不是成组打开：容器或虚拟机里常常只有部分事件可用，能打开几个就统计几个；
+ * 计数器被内核分时复用时按time_enabled/time_running折算
+ * 非Linux平台或全部打开失败时available()为false，Benchmark只报告计时结果
+ */
+class PerfCounters {
+public:
+    enum Event {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        DTLB_MISSES,
+        BRANCH_MISSES,
+        COUNT
+    };
+
+    static const char* name(int event) {
+        static const char* const names[COUNT] = {
+            "cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"
+        };
+        return names[event];
+    }
+
+    PerfCounters() {
+        for (int& fd : fds_) {
+            fd = -1;
+        }
+    }
+    ~PerfCounters() { close(); }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * @brief 为调用线程打开计数器，返回是否至少打开了一个；全部失败时只在第一次打印原因
+     */
+    bool open() {
+#if defined(__linux__)
+        int lastError = 0;
+        for (int event = 0; event < COUNT; ++event) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            configure(event, attr);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds_[event] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            if (fds_[event] < 0) {
+                lastError = errno;
+            }
+        }
+        if (!available()) {
+            reportUnavailable(strerror(lastError));
+        }
+#else
+        reportUnavailable("not supported on this platform");
+#endif
+        return available();
+    }
+
+    void close() {
+#if defined(__linux__)
+        for (int& fd : fds_) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            fd = -1;
+        }
+#endif
+    }
+
+    bool available() const {
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool available(int event) const { return fds_[event] >= 0; }
+
+    /**
+     * @brief 清零并开始计数
+     */
+    void start() {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+#endif
+    }
+
+    void stop() {
+#if defined(__linux__)
+        for (int fd : fds_) {
+            if (fd >= 0) {
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            }
+        }
+#endif
+    }
+
+    /**
+     * @brief 读出start()与stop()之间的计数(已按分时复用折算)，不可用的事件为NaN
+     */
+    void read(double values[COUNT]) const {
+        for (int event = 0; event < COUNT; ++event) {
+            values[event] = std::numeric_limits<double>::quiet_NaN();
+#if defined(__linux__)
+            uint64_t data[3];                                // value, time_enabled, time_running
+            if (fds_[event] < 0 || ::read(fds_[event], data, sizeof(data)) != (ssize_t)sizeof(data) || data[2] == 0) {
+                continue;
+            }
+            values[event] = (double)data[0] * ((double)data[1] / (double)data[2]);
+#endif
+        }
+    }
+
+private:
+    int fds_[COUNT];
+
+#if defined(__linux__)
+    static void configure(int event, perf_event_attr& attr) {
+        constexpr uint64_t readMiss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        switch (event) {
+        case CYCLES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case INSTRUCTIONS:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case L1D_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | readMiss;
+            break;
+        case LLC_MISSES:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case DTLB_MISSES:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | readMiss;
+            break;
+        default:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        }
+    }
+#endif
+
+    static void reportUnavailable(const char* reason) {
+        static std::atomic<bool> reported{false};
+        if (!reported.exchange(true)) {
+            fprintf(stderr, "hardware counters unavailable (%s), reporting timing only\n", reason);
+        }
+    }
+};
+
+} // namespace Cat
@@ -1,26 +1,138 @@
 #pragma once
+#include "Cat++_PerfCounters.h"
+#include <algorithm>
+#include <atomic>
+#include <barrier>
+#include <bit>
 #include <chrono>
-#include <string>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
 #include <limits>
+#include <map>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
-#include <functional>
-#include <ctime>
-#include <cstdio>
 
 namespace Cat {
 
+/**
+ * @brief 延迟直方图
+ *
+ * 对数-线性分桶(与HdrHistogram相同的思路)：
+ * - 小于SUB_BUCKETS(64)的值每纳秒一个桶
+ * - 之后每个2的幂区间再等分SUB_BUCKETS个桶，相对误差不超过1/64，
+ *   基线比较的阈值(默认5%)不会被分桶精度淹没
+ * 记录只做一次桶下标计算和一次自增，可按线程各持一份再合并
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 6;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    void record(uint64_t ns) {
+        counts_[bucketOf(ns)]++;
+        total_++;
+        max_ = std::max(max_, ns);
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < BUCKETS; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        total_ += other.total_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t max() const { return max_; }
+
+    /**
+     * @brief 分位数(纳秒)，返回所在桶的上界，p为[0, 1]
+     */
+    uint64_t percentile(double p) const {
+        if (total_ == 0) {
+            return 0;
+        }
+        uint64_t rank = (uint64_t)std::ceil(p * (double)total_);
+        rank = std::max<uint64_t>(rank, 1);
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                return std::min(upperBound(i), max_);
+            }
+        }
+        return max_;
+    }
+
+private:
+    uint64_t counts_[BUCKETS] = {};
+    uint64_t total_ = 0;
+    uint64_t max_ = 0;
+
+    static int bucketOf(uint64_t ns) {
+        if (ns < SUB_BUCKETS) {
+            return (int)ns;
+        }
+        int exponent = 63 - std::countl_zero(ns);                // ns >= SUB_BUCKETS，exponent >= SUB_BITS
+        int sub = (int)((ns >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1));
+        return (exponent - SUB_BITS + 1) * SUB_BUCKETS + sub;
+    }
+
+    static uint64_t upperBound(int bucket) {
+        if (bucket < SUB_BUCKETS) {
+            return (uint64_t)bucket;
+        }
+        int exponent = bucket / SUB_BUCKETS + SUB_BITS - 1;
+        uint64_t sub = (uint64_t)(bucket % SUB_BUCKETS);
+        return ((SUB_BUCKETS + sub + 1) << (exponent - SUB_BITS)) - 1;
+    }
+};
+
+/**
+ * @brief 基准测试配置
+ *
+ * 一次测试分三个阶段：
+ * - 预热：运行至少warmupMs，同时校准每个样本的迭代次数，使一个样本约为sampleMs
+ * - 吞吐：所有线程在启动屏障后同时开始，按样本计时(样本内不计时单次操作)，直到durationMs或samples个样本
+ * - 延迟：逐次计时至多latencyOps次操作、至多latencyMs(扣除计时器本身的开销)，填入延迟直方图
+ * hardwareCounters为true时，每个线程在吞吐阶段读取硬件计数器(见Cat++_PerfCounters.h)，结果折算为每次操作的事件数
+ */
+struct BenchmarkConfig {
+    double warmupMs = 50;          // 预热时长
+    double sampleMs = 1;           // 单个样本的目标时长
+    double durationMs = 300;       // 吞吐阶段的时长上限
+    int samples = 1000;            // 吞吐阶段的样本数上限
+    int latencyOps = 100000;       // 延迟阶段每线程逐次计时的操作数上限，0表示跳过
+    double latencyMs = 200;        // 延迟阶段的时长上限
+    int threads = 1;               // 线程数
+    int64_t fixedBatch = 0;        // 每个样本的迭代次数，0表示自动校准
+    bool hardwareCounters = false; // 吞吐阶段读取硬件计数器，不可用时只计时
+};
+
 /**
  * @brief 测试结果实体类
- * 
+ *
  * 存储单次测试的所有相关信息，包括：
  * - 测试名称和时间戳
- * - 性能指标（平均/最小/最大/总时间）
+ * - 性能指标（平均/最小/最大/总时间，按样本计）
+ * - 吞吐(全部线程合计的ops/s)、单次操作耗时的均值与标准差
+ * - 延迟分位数(p50/p90/p99/p99.9/max)
+ * - 每次操作的硬件事件数(cycles/instructions/缓存与TLB缺失/分支预测失败)，未读取或不可用时为NaN
  * - 迭代次数
  */
 class TestResult {
 public:
     // 构造函数
-    TestResult(std::string name, double avgTime, double minTime, 
+    TestResult(std::string name, double avgTime, double minTime,
               double maxTime, double totalTime, int iterations)
         : name_(std::move(name))
         , avgTime_(avgTime)
@@ -30,6 +142,8 @@ public:
         , iterations_(iterations)
         , timestamp_(getCurrentTimestamp()) {}
 
+    TestResult() : timestamp_(getCurrentTimestamp()) {}
+
     // 获取器
     const std::string& name() const { return name_; }
     double avgTime() const { return avgTime_; }
@@ -38,6 +152,31 @@ public:
     double totalTime() const { return totalTime_; }
     int iterations() const { return iterations_; }
     const std::string& timestamp() const { return timestamp_; }
+    int threads() const { return threads_; }
+    int64_t operations() const { return operations_; }
+    double opsPerSec() const { return opsPerSec_; }
+    double nsPerOp() const { return nsPerOp_; }
+    double nsPerOpStddev() const { return nsPerOpStddev_; }
+    uint64_t p50() const { return p50_; }
+    uint64_t p90() const { return p90_; }
+    uint64_t p99() const { return p99_; }
+    uint64_t p999() const { return p999_; }
+    uint64_t maxLatency() const { return maxLatency_; }
+    double perOp(PerfCounters::Event event) const { return perOp_[event]; }
+    double cyclesPerOp() const { return perOp_[PerfCounters::CYCLES]; }
+    double instructionsPerOp() const { return perOp_[PerfCounters::INSTRUCTIONS]; }
+    double l1dMissesPerOp() const { return perOp_[PerfCounters::L1D_MISSES]; }
+    double llcMissesPerOp() const { return perOp_[PerfCounters::LLC_MISSES]; }
+    double dtlbMissesPerOp() const { return perOp_[PerfCounters::DTLB_MISSES]; }
+    double branchMissesPerOp() const { return perOp_[PerfCounters::BRANCH_MISSES]; }
+    bool hasCounters() const {
+        for (double value : perOp_) {
+            if (!std::isnan(value)) {
+                return true;
+            }
+        }
+        return false;
+    }
 
     /**
      * @brief 打印测试结果
@@ -51,17 +190,188 @@ public:
         printf("Min: %.3f ms\n", minTime_);
         printf("Max: %.3f ms\n", maxTime_);
         printf("Total: %.3f ms\n", totalTime_);
+        if (operations_ > 0) {
+            printf("Threads: %d\n", threads_);
+            printf("Throughput: %.0f ops/s (%.2f +- %.2f ns/op)\n", opsPerSec_, nsPerOp_, nsPerOpStddev_);
+            printf("Latency: p50 %llu ns, p90 %llu ns, p99 %llu ns, p99.9 %llu ns, max %llu ns\n",
+                   (unsigned long long)p50_, (unsigned long long)p90_, (unsigned long long)p99_,
+                   (unsigned long long)p999_, (unsigned long long)maxLatency_);
+        }
+        if (hasCounters()) {
+            printf("Per op:");
+            for (int event = 0; event < PerfCounters::COUNT; ++event) {
+                if (!std::isnan(perOp_[event])) {
+                    printf(" %s %.3f", PerfCounters::name(event), perOp_[event]);
+                }
+            }
+            printf("\n");
+        }
         printf("===================\n\n");
     }
 
+    /**
+     * @brief 单行输出，配合printRowHeader()打印表格；counters为true时追加每次操作的硬件事件数与IPC，不可用的列为"-"
+     */
+    static void printRowHeader(bool counters = false) {
+        printf("%-40s %3s %14s %10s %8s %8s %8s %8s %10s",
+               "benchmark", "thr", "ops/s", "ns/op", "p50", "p90", "p99", "p99.9", "max");
+        if (counters) {
+            printf(" %9s %9s %5s %8s %8s %8s %8s", "cyc/op", "ins/op", "IPC", "L1d/op", "LLC/op", "dTLB/op", "br/op");
+        }
+        printf("\n");
+    }
+    void printRow(bool counters = false) const {
+        printf("%-40s %3d %14.0f %10.2f %8llu %8llu %8llu %8llu %10llu",
+               name_.c_str(), threads_, opsPerSec_, nsPerOp_,
+               (unsigned long long)p50_, (unsigned long long)p90_, (unsigned long long)p99_,
+               (unsigned long long)p999_, (unsigned long long)maxLatency_);
+        if (counters) {
+            printColumn(cyclesPerOp(), 9, 2);
+            printColumn(instructionsPerOp(), 9, 2);
+            printColumn(instructionsPerOp() / cyclesPerOp(), 5, 2);
+            printColumn(l1dMissesPerOp(), 8, 3);
+            printColumn(llcMissesPerOp(), 8, 3);
+            printColumn(dtlbMissesPerOp(), 8, 3);
+            printColumn(branchMissesPerOp(), 8, 3);
+        }
+        printf("\n");
+    }
+
+    /**
+     * @brief CSV输出，列与csvHeader()对应；名称中的逗号替换为分号，不可用的硬件事件列留空
+     */
+    static std::string csvHeader() {
+        std::string header = "name,threads,operations,ops_per_sec,ns_per_op,ns_per_op_stddev,p50_ns,p90_ns,p99_ns,p999_ns,max_ns,"
+                             "avg_ms,min_ms,max_ms,total_ms,samples,timestamp";
+        for (int event = 0; event < PerfCounters::COUNT; ++event) {
+            header += ",";
+            header += PerfCounters::name(event);
+            header += "_per_op";
+        }
+        return header;
+    }
+    std::string toCsv() const {
+        std::string name = name_;
+        std::replace(name.begin(), name.end(), ',', ';');
+        char buffer[512];
+        snprintf(buffer, sizeof(buffer), "%s,%d,%lld,%.1f,%.3f,%.3f,%llu,%llu,%llu,%llu,%llu,%.6f,%.6f,%.6f,%.3f,%d,%s",
+                 name.c_str(), threads_, (long long)operations_, opsPerSec_, nsPerOp_, nsPerOpStddev_,
+                 (unsigned long long)p50_, (unsigned long long)p90_, (unsigned long long)p99_,
+                 (unsigned long long)p999_, (unsigned long long)maxLatency_,
+                 avgTime_, minTime_, maxTime_, totalTime_, iterations_, timestamp_.c_str());
+        std::string line = buffer;
+        for (double value : perOp_) {
+            line += ",";
+            if (!std::isnan(value)) {
+                snprintf(buffer, sizeof(buffer), "%.4f", value);
+                line += buffer;
+            }
+        }
+        return line;
+    }
+
+    std::string toJson() const {
+        std::string name;
+        for (char c : name_) {
+            if (c == '"' || c == '\\') {
+                name += '\\';
+            }
+            name += c;
+        }
+        char buffer[768];
+        snprintf(buffer, sizeof(buffer),
+                 "{\"name\":\"%s\",\"threads\":%d,\"operations\":%lld,\"ops_per_sec\":%.1f,\"ns_per_op\":%.3f,"
+                 "\"ns_per_op_stddev\":%.3f,\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,\"max_ns\":%llu,"
+                 "\"avg_ms\":%.6f,\"min_ms\":%.6f,\"max_ms\":%.6f,\"total_ms\":%.3f,\"samples\":%d,\"timestamp\":\"%s\"",
+                 name.c_str(), threads_, (long long)operations_, opsPerSec_, nsPerOp_, nsPerOpStddev_,
+                 (unsigned long long)p50_, (unsigned long long)p90_, (unsigned long long)p99_,
+                 (unsigned long long)p999_, (unsigned long long)maxLatency_,
+                 avgTime_, minTime_, maxTime_, totalTime_, iterations_, timestamp_.c_str());
+        std::string json = buffer;
+        for (int event = 0; event < PerfCounters::COUNT; ++event) {
+            if (std::isnan(perOp_[event])) {
+                snprintf(buffer, sizeof(buffer), ",\"%s_per_op\":null", PerfCounters::name(event));
+            }
+            else {
+                snprintf(buffer, sizeof(buffer), ",\"%s_per_op\":%.4f", PerfCounters::name(event), perOp_[event]);
+            }
+            json += buffer;
+        }
+        return json + "}";
+    }
+
+    /**
+     * @brief 从toCsv()的一行解析，列数不符时返回false；没有硬件事件列的旧基线同样可以读取
+     */
+    static bool fromCsv(const std::string& line, TestResult& out) {
+        std::vector<std::string> fields;
+        size_t begin = 0;
+        for (;;) {
+            size_t end = line.find(',', begin);
+            fields.push_back(line.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+            if (end == std::string::npos) {
+                break;
+            }
+            begin = end + 1;
+        }
+        if ((fields.size() != 17 && fields.size() != 17 + PerfCounters::COUNT) || fields[0] == "name") {
+            return false;
+        }
+        out.name_ = fields[0];
+        out.threads_ = atoi(fields[1].c_str());
+        out.operations_ = atoll(fields[2].c_str());
+        out.opsPerSec_ = atof(fields[3].c_str());
+        out.nsPerOp_ = atof(fields[4].c_str());
+        out.nsPerOpStddev_ = atof(fields[5].c_str());
+        out.p50_ = strtoull(fields[6].c_str(), nullptr, 10);
+        out.p90_ = strtoull(fields[7].c_str(), nullptr, 10);
+        out.p99_ = strtoull(fields[8].c_str(), nullptr, 10);
+        out.p999_ = strtoull(fields[9].c_str(), nullptr, 10);
+        out.maxLatency_ = strtoull(fields[10].c_str(), nullptr, 10);
+        out.avgTime_ = atof(fields[11].c_str());
+        out.minTime_ = atof(fields[12].c_str());
+        out.maxTime_ = atof(fields[13].c_str());
+        out.totalTime_ = atof(fields[14].c_str());
+        out.iterations_ = atoi(fields[15].c_str());
+        out.timestamp_ = fields[16];
+        for (int event = 0; event < PerfCounters::COUNT; ++event) {
+            size_t field = 17 + (size_t)event;
+            out.perOp_[event] = field < fields.size() && !fields[field].empty()
+                              ? atof(fields[field].c_str()) : std::numeric_limits<double>::quiet_NaN();
+        }
+        return true;
+    }
+
 private:
+    friend class Benchmark;
+
     std::string name_;        // 测试名称
-    double avgTime_;          // 平均执行时间（毫秒）
-    double minTime_;          // 最小执行时间（毫秒）
-    double maxTime_;          // 最大执行时间（毫秒）
-    double totalTime_;        // 总执行时间（毫秒）
-    int iterations_;          // 迭代次数
+    double avgTime_ = 0;      // 平均样本时间（毫秒）
+    double minTime_ = 0;      // 最小样本时间（毫秒）
+    double maxTime_ = 0;      // 最大样本时间（毫秒）
+    double totalTime_ = 0;    // 总执行时间（毫秒）
+    int iterations_ = 0;      // 迭代(样本)次数
     std::string timestamp_;   // 测试执行时间戳
+    int threads_ = 1;         // 线程数
+    int64_t operations_ = 0;  // 吞吐阶段的总操作数(全部线程)
+    double opsPerSec_ = 0;    // 全部线程合计的吞吐
+    double nsPerOp_ = 0;      // 单次操作耗时均值(按样本)
+    double nsPerOpStddev_ = 0;// 单次操作耗时的样本标准差
+    uint64_t p50_ = 0;        // 延迟分位数(纳秒)
+    uint64_t p90_ = 0;
+    uint64_t p99_ = 0;
+    uint64_t p999_ = 0;
+    uint64_t maxLatency_ = 0;
+    double perOp_[PerfCounters::COUNT] = {NAN, NAN, NAN, NAN, NAN, NAN}; // 每次操作的硬件事件数
+
+    static void printColumn(double value, int width, int precision) {
+        if (std::isnan(value)) {
+            printf(" %*s", width, "-");
+        }
+        else {
+            printf(" %*.*f", width, precision, value);
+        }
+    }
 
     /**
      * @brief 获取当前时间戳
@@ -75,50 +385,376 @@ private:
     }
 };
 
+/**
+ * @brief 防止编译器把基准测试中的计算当作无用代码删除
+ */
+template<typename T>
+inline void doNotOptimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * @brief 基准测试运行器
+ *
+ * 被测函数以模板参数传入，直接内联到计时循环中(不经过std::function或虚函数)：
+ * - 单线程：f()
+ * - 多线程：f(threadIndex)，每个线程在启动屏障后同时开始
+ * 进度与结果只在计时阶段之外打印
+ */
+class Benchmark {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    template<typename F>
+    static TestResult run(const std::string& name, F&& f, const BenchmarkConfig& config = BenchmarkConfig()) {
+        const int threads = std::max(1, config.threads);
+        std::vector<ThreadReport> reports(threads);
+        std::barrier startBarrier(threads);
+        std::barrier latencyBarrier(threads);
+        std::atomic<int64_t> startNs{0};
+        std::atomic<int64_t> endNs{0};
+
+        auto body = [&](int index) {
+            ThreadReport& report = reports[index];
+            PerfCounters counters;
+            if (config.hardwareCounters) {
+                counters.open();
+            }
+            int64_t batch = warmup(f, index, config);
+
+            startBarrier.arrive_and_wait();
+            counters.start();
+            int64_t begin = nowNs();
+            int64_t expected = 0;
+            startNs.compare_exchange_strong(expected, begin);
+            int64_t deadline = begin + (int64_t)(config.durationMs * 1e6);
+            for (int s = 0; s < config.samples; ++s) {
+                int64_t sampleBegin = nowNs();
+                for (int64_t i = 0; i < batch; ++i) {
+                    invoke(f, index);
+                }
+                int64_t sampleEnd = nowNs();
+                report.sampleNs.push_back(sampleEnd - sampleBegin);
+                report.operations += batch;
+                if (sampleEnd >= deadline) {
+                    break;
+                }
+            }
+            int64_t end = nowNs();
+            counters.stop();
+            counters.read(report.counters);
+            int64_t seen = endNs.load();
+            while (seen < end && !endNs.compare_exchange_weak(seen, end)) {}
+            report.batch = batch;
+
+            // 延迟阶段同样同时开始，保持与吞吐阶段相同的竞争程度
+            latencyBarrier.arrive_and_wait();
+            if (config.latencyOps > 0) {
+                int64_t overhead = timerOverhead();
+                int64_t latencyEnd = nowNs() + (int64_t)(config.latencyMs * 1e6);
+                for (int i = 0; i < config.latencyOps; ++i) {
+                    int64_t opBegin = nowNs();
+                    invoke(f, index);
+                    int64_t opEnd = nowNs();
+                    int64_t elapsed = opEnd - opBegin - overhead;
+                    report.latency.record(elapsed > 0 ? (uint64_t)elapsed : 0);
+                    if (opEnd >= latencyEnd) {
+                        break;
+                    }
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        for (int t = 1; t < threads; ++t) {
+            workers.emplace_back(body, t);
+        }
+        body(0);
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        return summarize(name, reports, threads, endNs.load() - startNs.load());
+    }
+
+private:
+    struct ThreadReport {
+        std::vector<int64_t> sampleNs;
+        int64_t operations = 0;
+        int64_t batch = 1;
+        LatencyHistogram latency;
+        double counters[PerfCounters::COUNT];      // 吞吐阶段本线程的事件数，不可用为NaN
+    };
+
+    static int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    template<typename F>
+    static void invoke(F& f, int index) {
+        if constexpr (std::is_invocable_v<F&, int>) {
+            f(index);
+        }
+        else {
+            (void)index;
+            f();
+        }
+    }
+
+    /**
+     * @brief 预热并校准：批量从1开始翻倍，直到一个批次不短于sampleMs，且总时长不短于warmupMs
+     */
+    template<typename F>
+    static int64_t warmup(F& f, int index, const BenchmarkConfig& config) {
+        int64_t batch = config.fixedBatch > 0 ? config.fixedBatch : 1;
+        const int64_t target = (int64_t)(config.sampleMs * 1e6);
+        const int64_t warmupEnd = nowNs() + (int64_t)(config.warmupMs * 1e6);
+        for (;;) {
+            int64_t begin = nowNs();
+            for (int64_t i = 0; i < batch; ++i) {
+                invoke(f, index);
+            }
+            int64_t elapsed = nowNs() - begin;
+            if (config.fixedBatch == 0 && elapsed < target && batch < (int64_t(1) << 40)) {
+                batch *= 2;
+            }
+            else if (nowNs() >= warmupEnd) {
+                return batch;
+            }
+        }
+    }
+
+    /**
+     * @brief 两次连续取时间之差的最小值，逐次计时时从每次操作中扣除
+     */
+    static int64_t timerOverhead() {
+        int64_t best = std::numeric_limits<int64_t>::max();
+        for (int i = 0; i < 1000; ++i) {
+            int64_t a = nowNs();
+            int64_t b = nowNs();
+            best = std::min(best, b - a);
+        }
+        return best;
+    }
+
+    static TestResult summarize(const std::string& name, const std::vector<ThreadReport>& reports, int threads, int64_t wallNs) {
+        TestResult result;
+        result.name_ = name;
+        result.threads_ = threads;
+
+        std::vector<double> perOp;
+        LatencyHistogram latency;
+        double totalMs = 0;
+        double minMs = std::numeric_limits<double>::max();
+        double maxMs = 0;
+        for (const ThreadReport& report : reports) {
+            result.operations_ += report.operations;
+            latency.merge(report.latency);
+            for (int64_t ns : report.sampleNs) {
+                double ms = (double)ns / 1e6;
+                totalMs += ms;
+                minMs = std::min(minMs, ms);
+                maxMs = std::max(maxMs, ms);
+                perOp.push_back((double)ns / (double)report.batch);
+            }
+        }
+        result.iterations_ = (int)perOp.size();
+        result.totalTime_ = totalMs;
+        result.avgTime_ = perOp.empty() ? 0 : totalMs / (double)perOp.size();
+        result.minTime_ = perOp.empty() ? 0 : minMs;
+        result.maxTime_ = maxMs;
+        result.opsPerSec_ = wallNs > 0 ? (double)result.operations_ * 1e9 / (double)wallNs : 0;
+
+        double mean = 0;
+        for (double value : perOp) {
+            mean += value;
+        }
+        mean = perOp.empty() ? 0 : mean / (double)perOp.size();
+        double variance = 0;
+        for (double value : perOp) {
+            variance += (value - mean) * (value - mean);
+        }
+        result.nsPerOp_ = mean;
+        result.nsPerOpStddev_ = perOp.size() > 1 ? std::sqrt(variance / (double)(perOp.size() - 1)) : 0;
+
+        result.p50_ = latency.percentile(0.5);
+        result.p90_ = latency.percentile(0.9);
+        result.p99_ = latency.percentile(0.99);
+        result.p999_ = latency.percentile(0.999);
+        result.maxLatency_ = latency.max();
+
+        // 事件数在全部线程上合计后除以总操作数；任一线程缺少某个事件即视为不可用
+        for (int event = 0; event < PerfCounters::COUNT; ++event) {
+            double total = 0;
+            for (const ThreadReport& report : reports) {
+                total += report.counters[event];
+            }
+            result.perOp_[event] = result.operations_ > 0 ? total / (double)result.operations_
+                                                          : std::numeric_limits<double>::quiet_NaN();
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief 结果文件与基线比较
+ *
+ * - saveCsv/saveJson：保存一组结果，CSV可作为之后运行的基线
+ * - BenchmarkBaseline::load读取CSV基线，compare按名称与线程数对应，
+ *   吞吐下降或p99上升超过阈值即判为回退，返回回退的个数
+ */
+inline bool saveCsv(const std::string& path, const std::vector<TestResult>& results) {
+    FILE* out = fopen(path.c_str(), "w");
+    if (out == nullptr) {
+        fprintf(stderr, "cannot write %s\n", path.c_str());
+        return false;
+    }
+    fprintf(out, "%s\n", TestResult::csvHeader().c_str());
+    for (const TestResult& result : results) {
+        fprintf(out, "%s\n", result.toCsv().c_str());
+    }
+    fclose(out);
+    return true;
+}
+
+inline bool saveJson(const std::string& path, const std::vector<TestResult>& results) {
+    FILE* out = fopen(path.c_str(), "w");
+    if (out == nullptr) {
+        fprintf(stderr, "cannot write %s\n", path.c_str());
+        return false;
+    }
+    fprintf(out, "[\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        fprintf(out, "  %s%s\n", results[i].toJson().c_str(), i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "]\n");
+    fclose(out);
+    return true;
+}
+
+class BenchmarkBaseline {
+public:
+    bool load(const std::string& path) {
+        FILE* in = fopen(path.c_str(), "r");
+        if (in == nullptr) {
+            fprintf(stderr, "cannot read baseline %s\n", path.c_str());
+            return false;
+        }
+        char line[1024];
+        while (fgets(line, sizeof(line), in)) {
+            std::string text(line);
+            while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) {
+                text.pop_back();
+            }
+            TestResult result;
+            if (TestResult::fromCsv(text, result)) {
+                entries_[key(result)] = result;
+            }
+        }
+        fclose(in);
+        return true;
+    }
+
+    /**
+     * @brief 与基线比较并打印每一项的变化，thresholdPct为判定回退的百分比
+     */
+    int compare(const std::vector<TestResult>& results, double thresholdPct = 5.0) const {
+        int regressions = 0;
+        printf("%-40s %3s %14s %14s %8s %10s %10s %8s\n",
+               "benchmark", "thr", "base ops/s", "ops/s", "delta", "base p99", "p99", "delta");
+        for (const TestResult& result : results) {
+            auto found = entries_.find(key(result));
+            if (found == entries_.end()) {
+                printf("%-40s %3d %14s %14.0f   (new)\n", result.name().c_str(), result.threads(), "-", result.opsPerSec());
+                continue;
+            }
+            const TestResult& base = found->second;
+            double throughputDelta = base.opsPerSec() > 0 ? (result.opsPerSec() / base.opsPerSec() - 1) * 100 : 0;
+            double p99Delta = base.p99() > 0 ? ((double)result.p99() / (double)base.p99() - 1) * 100 : 0;
+            bool regressed = throughputDelta < -thresholdPct || p99Delta > thresholdPct;
+            regressions += regressed ? 1 : 0;
+            printf("%-40s %3d %14.0f %14.0f %+7.1f%% %10llu %10llu %+7.1f%%%s\n",
+                   result.name().c_str(), result.threads(), base.opsPerSec(), result.opsPerSec(), throughputDelta,
+                   (unsigned long long)base.p99(), (unsigned long long)result.p99(), p99Delta,
+                   regressed ? "  REGRESSION" : "");
+        }
+        return regressions;
+    }
+
+private:
+    std::map<std::string, TestResult> entries_;
+
+    static std::string key(const TestResult& result) {
+        std::string name = result.name();
+        std::replace(name.begin(), name.end(), ',', ';');
+        return name + "#" + std::to_string(result.threads());
+    }
+};
+
 /**
  * @brief 性能测试方法类
- * 
+ *
  * 提供性能测试的基础功能：
- * - 时间测量
- * - 多次迭代
- * - 结果统计
- * - 进度显示
+ * - runBenchmark：固定迭代次数，逐次计时，结果统计
+ * - runTimedBenchmark：预热与迭代次数校准，按样本计时直到时长或样本数上限，
+ *   结果统计(吞吐、标准差、延迟分位数)，可多线程运行
+ * - 进度显示(计时阶段之外)
  */
 class PerformanceTest {
 public:
     using TimePoint = std::chrono::steady_clock::time_point;
     using Duration = std::chrono::nanoseconds;
-    
+
+    virtual ~PerformanceTest() = default;
+
     /**
      * @brief 运行性能测试
      * @param name 测试名称
-     * @param iterations 迭代次数
+     * @param iterations 迭代次数，恰好执行这么多次runTest()，每次单独计时
      * @return 测试结果
      */
     TestResult runBenchmark(const std::string& name, int iterations = 100) {
         printf("\nRunning benchmark: %s\n", name.c_str());
         printf("Iterations: %d\n", iterations);
-        
+
         std::vector<double> times;
         times.reserve(iterations);
-        
+
         for (int i = 0; i < iterations; ++i) {
             auto start = std::chrono::steady_clock::now();
             runTest();
             auto end = std::chrono::steady_clock::now();
             times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
-            
+
             if ((i + 1) % 10 == 0) {
                 printf("Progress: %d/%d\n", i + 1, iterations);
             }
         }
-        
+
         return calculateResult(name, times, iterations);
     }
-    
+
+    /**
+     * @brief 按时长运行性能测试(见BenchmarkConfig)
+     * @param name 测试名称
+     * @param config 预热、吞吐、延迟各阶段的时长与样本数上限，线程数
+     * @return 测试结果
+     */
+    TestResult runTimedBenchmark(const std::string& name, const BenchmarkConfig& config = BenchmarkConfig()) {
+        printf("\nRunning benchmark: %s\n", name.c_str());
+        printf("Samples: up to %d, threads: %d\n", config.samples, config.threads);
+        TestResult result = Benchmark::run(name, [this] { runTest(); }, config);
+        printf("Progress: %d/%d samples\n", result.iterations(), config.samples);
+        return result;
+    }
+
 protected:
     /**
-     * @brief 执行具体的测试内容
+     * @brief 执行具体的测试内容(一次操作)；多线程运行时各线程并发调用
      */
     virtual void runTest() = 0;
 
@@ -126,19 +762,19 @@ private:
     /**
      * @brief 计算测试结果
      */
-    static TestResult calculateResult(const std::string& name, 
-                                    const std::vector<double>& times,
-                                    int iterations) {
+    static TestResult calculateResult(const std::string& name,
+                                      const std::vector<double>& times,
+                                      int iterations) {
         double totalTime = 0;
         double minTime = std::numeric_limits<double>::max();
         double maxTime = 0;
-        
+
         for (double time : times) {
             totalTime += time;
             minTime = std::min(minTime, time);
             maxTime = std::max(maxTime, time);
         }
-        
+
         return TestResult(
             name,                           // 测试名称
             totalTime / iterations,         // 平均时间
@@ -159,19 +795,53 @@ public:
      * @brief 构造函数
      * @param testFunc 测试函数
      */
-    explicit FunctionTest(std::function<void()> testFunc) 
+    explicit FunctionTest(std::function<void()> testFunc)
         : testFunc_(std::move(testFunc)) {}
-    
+
 protected:
     void runTest() override {
         testFunc_();
     }
-    
+
 private:
     std::function<void()> testFunc_;
 };
 
+/**
+ * @brief 内联的函数式性能测试包装器
+ *
+ * 与FunctionTest相同，但按被测函数的类型实例化，runTest()中直接调用，不经过std::function
+ */
+template<typename F>
+class InlineFunctionTest : public PerformanceTest {
+public:
+    /**
+     * @brief 构造函数
+     * @param testFunc 测试函数
+     */
+    explicit InlineFunctionTest(F testFunc)
+        : testFunc_(std::move(testFunc)) {}
+
+protected:
+    void runTest() override {
+        testFunc_();
+    }
+
+private:
+    F testFunc_;
+};
+
 } // namespace Cat
 
 // Cat::FunctionTest test([](){});
-// test.runBenchmark("SumTest", 5);
\ No newline at end of file
+// test.runBenchmark("SumTest", 5);
+//
+// Cat::InlineFunctionTest inlined([](){});
+// inlined.runTimedBenchmark("SumTest");
+//
+// Cat::BenchmarkConfig config;
+// config.threads = 4;
+// Cat::Benchmark::run("AllocTest", [](int thread) { ... }, config).printRow();
+//
+// config.hardwareCounters = true;
+// Cat::Benchmark::run("AllocTest", [](int thread) { ... }, config).printRow(true);
@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+namespace Cat {
+
+/**
+ * @brief 单元测试注册与运行
+ *
+ * test/下的每个.cpp用CAT_TEST定义用例，全部链接进同一个test_alloc，由Cat++_test_main.cpp调用runAll：
+ * - CAT_CHECK失败时记录文件与行号并继续执行；CAT_REQUIRE失败时结束当前用例
+ * - 检查可以在用例创建的线程中进行，失败计数是原子的
+ * - 用例中抛出的异常按失败处理
+ * - 命令行参数作为子串过滤用例名
+ */
+class UnitTest {
+public:
+    using TestFunction = void (*)();
+
+    static bool add(const char* name, TestFunction function) {
+        cases().push_back({name, function});
+        return true;
+    }
+
+    static void fail(const char* expression, const char* file, int line) {
+        // 失败的检查可能在循环里，只打印前若干条
+        if (failures_.fetch_add(1, std::memory_order_relaxed) < MAX_REPORTS) {
+            fprintf(stderr, "  %s:%d: check failed: %s\n", file, line, expression);
+        }
+    }
+
+    /**
+     * @brief 运行全部(或名字包含任一参数的)用例
+     * @return 有用例失败时返回1
+     */
+    static int runAll(int argc, char** argv) {
+        int passed = 0;
+        int failed = 0;
+        for (const Case& c : cases()) {
+            if (!selected(c.name, argc, argv)) {
+                continue;
+            }
+            printf("[ RUN  ] %s\n", c.name);
+            fflush(stdout);
+            failures_.store(0, std::memory_order_relaxed);
+            try {
+                c.function();
+            } catch (const std::exception& e) {
+                fail(e.what(), c.name, 0);
+            } catch (...) {
+                fail("unknown exception", c.name, 0);
+            }
+            bool ok = failures_.load(std::memory_order_relaxed) == 0;
+            printf("[ %s ] %s\n", ok ? " OK " : "FAIL", c.name);
+            fflush(stdout);
+            (ok ? passed : failed)++;
+        }
+        printf("%d passed, %d failed\n", passed, failed);
+        return failed == 0 ? 0 : 1;
+    }
+
+private:
+    static constexpr int MAX_REPORTS = 20;
+
+    struct Case {
+        const char* name;
+        TestFunction function;
+    };
+
+    static inline std::atomic<int> failures_{0};
+
+    static std::vector<Case>& cases() {
+        static std::vector<Case> instance;
+        return instance;
+    }
+
+    static bool selected(const char* name, int argc, char** argv) {
+        if (argc < 2) {
+            return true;
+        }
+        for (int i = 1; i < argc; ++i) {
+            if (strstr(name, argv[i]) != nullptr) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace Cat
+
+#define CAT_TEST(name)                                                      \
+    static void name();                                                     \
+    static const bool name##_registered = Cat::UnitTest::add(#name, name);  \
+    static void name()
+
+#define CAT_CHECK(expression)                                               \
+    ((expression) ? (void)0 : Cat::UnitTest::fail(#expression, __FILE__, __LINE__))
+
+#define CAT_REQUIRE(expression)                                             \
+    do {                                                                    \
+        if (!(expression)) {                                                \
+            Cat::UnitTest::fail(#expression, __FILE__, __LINE__);           \
+            return;                                                         \
+        }                                                                   \
+    } while (0)
+
+// CAT_TEST(vector_push_back) {
+//     Cat::vector<int> v;
+//     v.push_back(1);
+//     CAT_CHECK(v.size() == 1);
+// }